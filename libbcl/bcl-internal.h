@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _BCL_INTERNAL_H_
+#define _BCL_INTERNAL_H_
+
+#include <sys/cdefs.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bcl.h"
+
+/* Not every host <sys/cdefs.h> provides these */
+#ifndef __may_alias
+#define __may_alias __attribute__ ((__may_alias__))
+#endif /* !__may_alias */
+
+typedef uint32_t __may_alias bcl_word_t;
+
+/* Return the output position the current drain call must stop at */
+static inline uint32_t __always_inline
+__bcl_stream_out_end(const bcl_stream_t *stream, uint32_t max_size)
+{
+        const uint32_t out_left = stream->out_size - stream->out_pos;
+
+        if (max_size > out_left) {
+                return stream->out_size;
+        }
+
+        return (stream->out_pos + max_size);
+}
+
+/* Consume a single byte from the current input chunk */
+static inline uint8_t __always_inline
+__bcl_stream_byte_read(bcl_stream_t *stream)
+{
+        stream->in_size--;
+
+        return *stream->in++;
+}
+
+/* Build each aligned destination word out of two aligned source words. The SH-2
+ * can only shift by constant amounts, so this is always inlined with a
+ * constant shift */
+static inline void __always_inline
+__bcl_block_merge_copy(uint8_t *dst, const bcl_word_t *src_word,
+    uint32_t word_count, const uint32_t shift)
+{
+        for (; word_count > 0; word_count--) {
+                const uint32_t w0 = src_word[0];
+                const uint32_t w1 = src_word[1];
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+                *(bcl_word_t *)dst = (w0 >> shift) | (w1 << (32 - shift));
+#else
+                *(bcl_word_t *)dst = (w0 << shift) | (w1 >> (32 - shift));
+#endif /* __BYTE_ORDER__ */
+
+                dst += 4;
+                src_word++;
+        }
+}
+
+/* Copy 32-bits at a time. The destination is written in increasing address
+ * order and a source word is never read before it has been written, as long
+ * as the buffers are disjoint, or the source starts at least 4 bytes before
+ * the destination */
+static inline void __always_inline
+__bcl_block_copy(uint8_t *dst, const uint8_t *src, uint32_t length)
+{
+        /* Align the destination */
+        for (; (((uintptr_t)dst & 3) != 0) && (length > 0); length--) {
+                *dst++ = *src++;
+        }
+
+        const uint32_t word_count = length >> 2;
+        const uint32_t src_misalign = (uintptr_t)src & 3;
+
+        const bcl_word_t * const src_word =
+            (const bcl_word_t *)((uintptr_t)src & ~(uintptr_t)3);
+
+        switch (src_misalign) {
+        case 0:
+                for (uint32_t i = 0; i < word_count; i++) {
+                        ((bcl_word_t *)dst)[i] = src_word[i];
+                }
+                break;
+        case 1:
+                __bcl_block_merge_copy(dst, src_word, word_count, 8);
+                break;
+        case 2:
+                __bcl_block_merge_copy(dst, src_word, word_count, 16);
+                break;
+        case 3:
+                __bcl_block_merge_copy(dst, src_word, word_count, 24);
+                break;
+        }
+
+        dst += word_count << 2;
+        src += word_count << 2;
+
+        for (length &= 3; length > 0; length--) {
+                *dst++ = *src++;
+        }
+}
+
+#endif /* !_BCL_INTERNAL_H_ */
@@ -10,6 +10,7 @@
 
 #include <sys/cdefs.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 
 __BEGIN_DECLS
@@ -19,6 +20,215 @@ __BEGIN_DECLS
 /// @addtogroup BCL
 /// @{
 
+/// @brief Maximum number of nodes in a Huffman tree.
+#define BCL_HUFFMAN_TREE_NODES (511)
+
+/// @brief Size of @ref bcl_header_t in bytes.
+#define BCL_HEADER_SIZE (16)
+
+/// @brief Codec used to compress the payload of a BCL container.
+typedef enum bcl_codec {
+        /// The payload is stored uncompressed.
+        BCL_CODEC_NONE,
+        /// Huffman.
+        BCL_CODEC_HUFFMAN,
+        /// LZ77.
+        BCL_CODEC_LZ,
+        /// PRS.
+        BCL_CODEC_PRS,
+        /// RLE.
+        BCL_CODEC_RLE,
+        /// Number of codecs.
+        BCL_CODEC_COUNT
+} bcl_codec_t;
+
+/// @brief Errors returned by @ref bcl_decompress and the bounds-checked
+/// decompression functions.
+typedef enum bcl_error {
+        /// The magic or codec in the header is invalid.
+        BCL_ERROR_HEADER   = -1,
+        /// The output buffer is too small.
+        BCL_ERROR_OUT_SIZE = -2,
+        /// The input ends in the middle of the compressed stream.
+        BCL_ERROR_IN_SIZE  = -3,
+        /// The compressed stream references data outside of the output buffer,
+        /// or is otherwise malformed.
+        BCL_ERROR_CORRUPT  = -4
+} bcl_error_t;
+
+/// @brief Header of a BCL container, as decoded by @ref bcl_header_read.
+///
+/// @details A container is @ref BCL_HEADER_SIZE bytes of header immediately
+/// followed by the compressed payload. On disk, the header starts with the
+/// magic `"BCL"` followed by a byte holding the @ref bcl_codec_t, then the
+/// remaining fields as 32-bit big-endian values. The payload is 4-byte aligned
+/// as long as the container is.
+typedef struct bcl_header {
+        /// Codec used to compress the payload.
+        bcl_codec_t codec;
+        /// Size of the compressed payload in bytes.
+        uint32_t in_size;
+        /// Size of the decompressed data in bytes.
+        uint32_t out_size;
+        /// Adler-32 checksum of the decompressed data.
+        uint32_t checksum;
+} bcl_header_t;
+
+/// @brief Status returned when draining a streaming decompression context.
+typedef enum bcl_stream_status {
+        /// More input is needed. Call @ref bcl_stream_feed.
+        BCL_STREAM_STATUS_NEED_INPUT,
+        /// The output limit passed to the drain call has been reached.
+        BCL_STREAM_STATUS_OUTPUT_FULL,
+        /// The block has been fully decompressed.
+        BCL_STREAM_STATUS_DONE,
+        /// The compressed stream is corrupt.
+        BCL_STREAM_STATUS_ERROR
+} bcl_stream_status_t;
+
+/// @brief State shared by all streaming decompression contexts.
+///
+/// @details The output buffer must be able to hold the entire decompressed
+/// block, as LZ77 and PRS matches may reference any previously decompressed
+/// byte. Only the input is consumed piece-wise.
+///
+/// Streaming contexts never write past the end of the output buffer, nor read
+/// from before its start, so they are safe to use on untrusted input.
+typedef struct bcl_stream {
+        /// Current input chunk.
+        const uint8_t *in;
+        /// Number of bytes left to consume in the current input chunk.
+        uint32_t in_size;
+        /// Output buffer.
+        uint8_t *out;
+        /// Number of bytes decompressed so far.
+        uint32_t out_pos;
+        /// Size of the decompressed block in bytes.
+        uint32_t out_size;
+        /// Codec specific decoder state.
+        uint32_t state;
+} bcl_stream_t;
+
+/// @brief Streaming LZ77 decompression context.
+typedef struct bcl_lz_stream {
+        bcl_stream_t stream;
+        uint32_t length;
+        uint32_t offset;
+        uint8_t marker;
+} bcl_lz_stream_t;
+
+/// @brief Streaming PRS decompression context.
+typedef struct bcl_prs_stream {
+        bcl_stream_t stream;
+        uint32_t length;
+        int32_t offset;
+        uint8_t control;
+        uint8_t control_bits;
+        uint8_t offset_low;
+} bcl_prs_stream_t;
+
+/// @brief Streaming RLE decompression context.
+typedef struct bcl_rle_stream {
+        bcl_stream_t stream;
+        uint32_t length;
+        uint8_t marker;
+        uint8_t symbol;
+} bcl_rle_stream_t;
+
+/// @brief Streaming Huffman decompression context.
+///
+/// @details The recovered Huffman tree is kept in the context, so the context
+/// is roughly 3.5KiB in size.
+typedef struct bcl_huffman_stream {
+        bcl_stream_t stream;
+        uint32_t bits;
+        uint32_t bit_count;
+        uint16_t node;
+        uint16_t node_count;
+        uint16_t stack_count;
+        uint16_t stack[(BCL_HUFFMAN_TREE_NODES + 1) / 2];
+
+        struct {
+                int16_t children[2];
+                int16_t symbol;
+        } nodes[BCL_HUFFMAN_TREE_NODES];
+} bcl_huffman_stream_t;
+
+/// @brief Hand the next chunk of compressed input to a streaming context.
+///
+/// @details The chunk must stay valid until a drain call returns
+/// @ref BCL_STREAM_STATUS_NEED_INPUT. Any bytes left over from a previous chunk
+/// are discarded.
+///
+/// @param stream  The @ref bcl_stream_t member of the streaming context.
+/// @param[in] in      The input chunk.
+/// @param     in_size Size of the input chunk in bytes.
+static inline void __always_inline
+bcl_stream_feed(bcl_stream_t *stream, const void *in, uint32_t in_size)
+{
+        stream->in = (const uint8_t *)in;
+        stream->in_size = in_size;
+}
+
+/// @brief Decode the header of a BCL container.
+///
+/// @param[in]  in     The container.
+/// @param[out] header The decoded header.
+///
+/// @returns `0` on success, or @ref BCL_ERROR_HEADER.
+extern int32_t bcl_header_read(const void *in, bcl_header_t *header);
+
+/// @brief Encode the header of a BCL container.
+///
+/// @param[in]  header The header.
+/// @param[out] out    Buffer of at least @ref BCL_HEADER_SIZE bytes.
+extern void bcl_header_write(const bcl_header_t *header, void *out);
+
+/// @brief Calculate the Adler-32 checksum of a buffer.
+///
+/// @param[in] buffer The buffer.
+/// @param     size   Size of the buffer in bytes.
+///
+/// @returns The checksum.
+extern uint32_t bcl_checksum(const void *buffer, uint32_t size);
+
+/// @brief Decompress a BCL container using the codec named in its header.
+///
+/// @details The checksum is not verified, as doing so costs nearly as much as
+/// decompressing. Use @ref bcl_verify for that.
+///
+/// @param[in]  in       The container.
+/// @param[out] out      The output buffer.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns The size of the decompressed data in bytes, or a negative
+/// @ref bcl_error_t.
+extern int32_t bcl_decompress(const void *in, void *out, uint32_t out_size);
+
+/// @brief Bounds-checked variant of @ref bcl_decompress.
+///
+/// @details Neither the container nor the output buffer is ever accessed out of
+/// bounds, no matter how malformed the container is.
+///
+/// @param[in]  in       The container.
+/// @param[out] out      The output buffer.
+/// @param      in_size  The size of the container in bytes.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns The size of the decompressed data in bytes, or a negative
+/// @ref bcl_error_t.
+extern int32_t bcl_decompress_safe(const void *in, void *out, uint32_t in_size,
+    uint32_t out_size);
+
+/// @brief Check data decompressed by @ref bcl_decompress against the checksum
+/// in the container header.
+///
+/// @param[in] in  The container.
+/// @param[in] out The decompressed data.
+///
+/// @returns `true` if the checksum matches.
+extern bool bcl_verify(const void *in, const void *out);
+
 /// @brief Decompress a block of data using RLE.
 ///
 /// @param[in]  in       The input buffer.
@@ -47,6 +257,121 @@ extern void bcl_lz_decompress(uint8_t *in, uint8_t *out, uint32_t in_size);
 /// @param      in_size The size of the input buffer in bytes.
 extern void bcl_rle_decompress(uint8_t *in, uint8_t *out, uint32_t in_size);
 
+/// @brief Bounds-checked variant of @ref bcl_huffman_decompress.
+///
+/// @details The Huffman stream doesn't encode its length, so exactly
+/// @p out_size bytes are decompressed.
+///
+/// @param[in]  in       The input buffer.
+/// @param[out] out      The output buffer.
+/// @param      in_size  The size of the input buffer in bytes.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns @p out_size, or a negative @ref bcl_error_t.
+extern int32_t bcl_huffman_decompress_safe(const void *in, void *out,
+    uint32_t in_size, uint32_t out_size);
+
+/// @brief Bounds-checked variant of @ref bcl_prs_decompress.
+///
+/// @param[in]  in       The input buffer.
+/// @param[out] out      The output buffer.
+/// @param      in_size  The size of the input buffer in bytes.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns The number of bytes decompressed, or a negative @ref bcl_error_t.
+extern int32_t bcl_prs_decompress_safe(const void *in, void *out,
+    uint32_t in_size, uint32_t out_size);
+
+/// @brief Bounds-checked variant of @ref bcl_lz_decompress.
+///
+/// @param[in]  in       The input buffer.
+/// @param[out] out      The output buffer.
+/// @param      in_size  The size of the input buffer in bytes.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns The number of bytes decompressed, or a negative @ref bcl_error_t.
+extern int32_t bcl_lz_decompress_safe(const void *in, void *out,
+    uint32_t in_size, uint32_t out_size);
+
+/// @brief Bounds-checked variant of @ref bcl_rle_decompress.
+///
+/// @param[in]  in       The input buffer.
+/// @param[out] out      The output buffer.
+/// @param      in_size  The size of the input buffer in bytes.
+/// @param      out_size The size of the output buffer in bytes.
+///
+/// @returns The number of bytes decompressed, or a negative @ref bcl_error_t.
+extern int32_t bcl_rle_decompress_safe(const void *in, void *out,
+    uint32_t in_size, uint32_t out_size);
+
+/// @brief Initialize a streaming Huffman decompression context.
+///
+/// @param      huffman_stream The context.
+/// @param[out] out            The output buffer.
+/// @param      out_size       The size of the decompressed block in bytes.
+extern void bcl_huffman_stream_init(bcl_huffman_stream_t *huffman_stream,
+    uint8_t *out, uint32_t out_size);
+
+/// @brief Decompress up to @p max_size bytes of the fed Huffman input.
+///
+/// @param huffman_stream The context.
+/// @param max_size       Maximum number of bytes to decompress in this call.
+///
+/// @returns The state of the context.
+extern bcl_stream_status_t bcl_huffman_stream_drain(
+    bcl_huffman_stream_t *huffman_stream, uint32_t max_size);
+
+/// @brief Initialize a streaming PRS decompression context.
+///
+/// @param      prs_stream The context.
+/// @param[out] out        The output buffer.
+/// @param      out_size   The size of the output buffer in bytes.
+extern void bcl_prs_stream_init(bcl_prs_stream_t *prs_stream, uint8_t *out,
+    uint32_t out_size);
+
+/// @brief Decompress up to @p max_size bytes of the fed PRS input.
+///
+/// @param prs_stream The context.
+/// @param max_size   Maximum number of bytes to decompress in this call.
+///
+/// @returns The state of the context.
+extern bcl_stream_status_t bcl_prs_stream_drain(bcl_prs_stream_t *prs_stream,
+    uint32_t max_size);
+
+/// @brief Initialize a streaming LZ77 decompression context.
+///
+/// @param      lz_stream The context.
+/// @param[out] out       The output buffer.
+/// @param      out_size  The size of the decompressed block in bytes.
+extern void bcl_lz_stream_init(bcl_lz_stream_t *lz_stream, uint8_t *out,
+    uint32_t out_size);
+
+/// @brief Decompress up to @p max_size bytes of the fed LZ77 input.
+///
+/// @param lz_stream The context.
+/// @param max_size  Maximum number of bytes to decompress in this call.
+///
+/// @returns The state of the context.
+extern bcl_stream_status_t bcl_lz_stream_drain(bcl_lz_stream_t *lz_stream,
+    uint32_t max_size);
+
+/// @brief Initialize a streaming RLE decompression context.
+///
+/// @param      rle_stream The context.
+/// @param[out] out        The output buffer.
+/// @param      out_size   The size of the decompressed block in bytes.
+extern void bcl_rle_stream_init(bcl_rle_stream_t *rle_stream, uint8_t *out,
+    uint32_t out_size);
+
+/// @brief Decompress up to @p max_size bytes of the fed RLE input.
+///
+/// @param rle_stream The context.
+/// @param max_size   Maximum number of bytes to decompress in this call.
+///
+/// @returns The state of the context.
+extern bcl_stream_status_t bcl_rle_stream_drain(bcl_rle_stream_t *rle_stream,
+    uint32_t max_size);
+
 /// @}
 
 __END_DECLS
@@ -1,6 +1,7 @@
 # -*- mode: makefile -*-
 
-LIB_SRCS:= huffman.c \
+LIB_SRCS:= container.c \
+	huffman.c \
 	lz.c \
 	prs.c \
 	rle.c
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2021
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "bcl.h"
+
+#define ADLER_MODULO    (65521)
+
+/* Largest number of bytes that can be summed before the 32-bit sums can
+ * overflow */
+#define ADLER_NMAX      (5552)
+
+static inline uint32_t __always_inline
+_uint32_read(const uint8_t *p)
+{
+        return (((uint32_t)p[0] << 24) |
+                ((uint32_t)p[1] << 16) |
+                ((uint32_t)p[2] <<  8) |
+                 (uint32_t)p[3]);
+}
+
+static inline void __always_inline
+_uint32_write(uint8_t *p, uint32_t value)
+{
+        p[0] = value >> 24;
+        p[1] = value >> 16;
+        p[2] = value >>  8;
+        p[3] = value;
+}
+
+int32_t
+bcl_header_read(const void *in, bcl_header_t *header)
+{
+        const uint8_t * const p = in;
+
+        if ((p[0] != 'B') || (p[1] != 'C') || (p[2] != 'L')) {
+                return BCL_ERROR_HEADER;
+        }
+
+        if (p[3] >= BCL_CODEC_COUNT) {
+                return BCL_ERROR_HEADER;
+        }
+
+        header->codec = p[3];
+        header->in_size = _uint32_read(&p[4]);
+        header->out_size = _uint32_read(&p[8]);
+        header->checksum = _uint32_read(&p[12]);
+
+        return 0;
+}
+
+void
+bcl_header_write(const bcl_header_t *header, void *out)
+{
+        uint8_t * const p = out;
+
+        p[0] = 'B';
+        p[1] = 'C';
+        p[2] = 'L';
+        p[3] = header->codec;
+
+        _uint32_write(&p[4], header->in_size);
+        _uint32_write(&p[8], header->out_size);
+        _uint32_write(&p[12], header->checksum);
+}
+
+uint32_t
+bcl_checksum(const void *buffer, uint32_t size)
+{
+        const uint8_t *p = buffer;
+
+        uint32_t a = 1;
+        uint32_t b = 0;
+
+        while (size > 0) {
+                uint32_t count = (size < ADLER_NMAX) ? size : ADLER_NMAX;
+
+                size -= count;
+
+                for (; count > 0; count--) {
+                        a += *p++;
+                        b += a;
+                }
+
+                a %= ADLER_MODULO;
+                b %= ADLER_MODULO;
+        }
+
+        return ((b << 16) | a);
+}
+
+int32_t
+bcl_decompress(const void *in, void *out, uint32_t out_size)
+{
+        bcl_header_t header;
+
+        if ((bcl_header_read(in, &header)) != 0) {
+                return BCL_ERROR_HEADER;
+        }
+
+        if (header.out_size > out_size) {
+                return BCL_ERROR_OUT_SIZE;
+        }
+
+        /* The decompressors don't modify their input */
+        uint8_t * const payload = (uint8_t *)in + BCL_HEADER_SIZE;
+
+        switch (header.codec) {
+        case BCL_CODEC_NONE:
+                if (header.in_size != header.out_size) {
+                        return BCL_ERROR_HEADER;
+                }
+
+                (void)memcpy(out, payload, header.out_size);
+                break;
+        case BCL_CODEC_HUFFMAN:
+                bcl_huffman_decompress(payload, out, header.in_size, header.out_size);
+                break;
+        case BCL_CODEC_LZ:
+                bcl_lz_decompress(payload, out, header.in_size);
+                break;
+        case BCL_CODEC_PRS:
+                bcl_prs_decompress(payload, out);
+                break;
+        case BCL_CODEC_RLE:
+                bcl_rle_decompress(payload, out, header.in_size);
+                break;
+        default:
+                return BCL_ERROR_HEADER;
+        }
+
+        return header.out_size;
+}
+
+int32_t
+bcl_decompress_safe(const void *in, void *out, uint32_t in_size, uint32_t out_size)
+{
+        bcl_header_t header;
+
+        if ((in_size < BCL_HEADER_SIZE) || ((bcl_header_read(in, &header)) != 0)) {
+                return BCL_ERROR_HEADER;
+        }
+
+        if (header.in_size > (in_size - BCL_HEADER_SIZE)) {
+                return BCL_ERROR_IN_SIZE;
+        }
+
+        if (header.out_size > out_size) {
+                return BCL_ERROR_OUT_SIZE;
+        }
+
+        const uint8_t * const payload = (const uint8_t *)in + BCL_HEADER_SIZE;
+
+        int32_t ret;
+
+        switch (header.codec) {
+        case BCL_CODEC_NONE:
+                if (header.in_size != header.out_size) {
+                        return BCL_ERROR_HEADER;
+                }
+
+                (void)memcpy(out, payload, header.out_size);
+
+                ret = header.out_size;
+                break;
+        case BCL_CODEC_HUFFMAN:
+                ret = bcl_huffman_decompress_safe(payload, out, header.in_size, header.out_size);
+                break;
+        case BCL_CODEC_LZ:
+                ret = bcl_lz_decompress_safe(payload, out, header.in_size, header.out_size);
+                break;
+        case BCL_CODEC_PRS:
+                ret = bcl_prs_decompress_safe(payload, out, header.in_size, header.out_size);
+                break;
+        case BCL_CODEC_RLE:
+                ret = bcl_rle_decompress_safe(payload, out, header.in_size, header.out_size);
+                break;
+        default:
+                return BCL_ERROR_HEADER;
+        }
+
+        /* A stream that ends early doesn't match its header */
+        if ((ret >= 0) && ((uint32_t)ret != header.out_size)) {
+                return BCL_ERROR_CORRUPT;
+        }
+
+        return ret;
+}
+
+bool
+bcl_verify(const void *in, const void *out)
+{
+        bcl_header_t header;
+
+        if ((bcl_header_read(in, &header)) != 0) {
+                return false;
+        }
+
+        return (bcl_checksum(out, header.out_size) == header.checksum);
+}
@@ -20,10 +20,22 @@
 
 #include <sys/cdefs.h>
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "bcl-internal.h"
+
 /* The maximum number of nodes in the Huffman tree is 2^(8+1)-1 = 511 */
-#define MAX_TREE_NODES 511
+#define MAX_TREE_NODES BCL_HUFFMAN_TREE_NODES
+
+/* Maximum number of pending branches while recovering the Huffman tree */
+#define TREE_STACK_SIZE ((MAX_TREE_NODES + 1) / 2)
+
+typedef enum {
+        HUFFMAN_STATE_TREE,
+        HUFFMAN_STATE_SYMBOL
+} huffman_state_t;
 
 typedef struct {
         uint8_t *byte_ptr;
@@ -50,6 +62,9 @@ static uint32_t _bit_read(huff_bitstream_t *stream);
 static uint32_t _8bits_read(huff_bitstream_t *stream);
 static huff_decodenode_t *_tree_recover(huff_decodenode_t *nodes, huff_bitstream_t *stream, uint32_t *nodenum);
 
+static void _stream_bits_fill(bcl_huffman_stream_t *huffman_stream);
+static bcl_stream_status_t _stream_tree_recover(bcl_huffman_stream_t *huffman_stream);
+
 void
 bcl_huffman_decompress(uint8_t *in, uint8_t *out, uint32_t in_size, uint32_t out_size)
 {
@@ -91,6 +106,230 @@ bcl_huffman_decompress(uint8_t *in, uint8_t *out, uint32_t in_size, uint32_t out
         }
 }
 
+int32_t
+bcl_huffman_decompress_safe(const void *in, void *out, uint32_t in_size,
+    uint32_t out_size)
+{
+        bcl_huffman_stream_t huffman_stream;
+
+        /* Do we have anything to decompress? */
+        if (in_size < 1) {
+                return 0;
+        }
+
+        /* Recover Huffman tree, which checks both the input size and the
+         * node count */
+        bcl_huffman_stream_init(&huffman_stream, out, out_size);
+        bcl_stream_feed(&huffman_stream.stream, in, in_size);
+
+        switch (_stream_tree_recover(&huffman_stream)) {
+        case BCL_STREAM_STATUS_DONE:
+                break;
+        case BCL_STREAM_STATUS_NEED_INPUT:
+                return BCL_ERROR_IN_SIZE;
+        default:
+                return BCL_ERROR_CORRUPT;
+        }
+
+        const uint8_t *src = huffman_stream.stream.in;
+        uint32_t src_left = huffman_stream.stream.in_size;
+        uint32_t bits = huffman_stream.bits;
+        uint32_t bit_count = huffman_stream.bit_count;
+
+        uint8_t * const buffer = out;
+
+        for (uint32_t k = 0; k < out_size; k++) {
+                /* Traverse tree until we find a matching leaf node */
+                uint32_t node = 0;
+
+                while (huffman_stream.nodes[node].symbol < 0) {
+                        if (bit_count == 0) {
+                                if (src_left == 0) {
+                                        return BCL_ERROR_IN_SIZE;
+                                }
+
+                                bits = *src++;
+                                bit_count = 8;
+                                src_left--;
+                        }
+
+                        bit_count--;
+
+                        node = huffman_stream.nodes[node].children[(bits >> bit_count) & 1];
+                }
+
+                buffer[k] = (uint8_t)huffman_stream.nodes[node].symbol;
+        }
+
+        return out_size;
+}
+
+void
+bcl_huffman_stream_init(bcl_huffman_stream_t *huffman_stream, uint8_t *out,
+    uint32_t out_size)
+{
+        bcl_stream_t * const stream = &huffman_stream->stream;
+
+        stream->in = NULL;
+        stream->in_size = 0;
+        stream->out = out;
+        stream->out_pos = 0;
+        stream->out_size = out_size;
+        stream->state = HUFFMAN_STATE_TREE;
+
+        huffman_stream->bits = 0;
+        huffman_stream->bit_count = 0;
+        huffman_stream->node = 0;
+        huffman_stream->node_count = 0;
+        huffman_stream->stack_count = 0;
+}
+
+bcl_stream_status_t
+bcl_huffman_stream_drain(bcl_huffman_stream_t *huffman_stream, uint32_t max_size)
+{
+        bcl_stream_t * const stream = &huffman_stream->stream;
+
+        if (stream->state == HUFFMAN_STATE_TREE) {
+                const bcl_stream_status_t status =
+                    _stream_tree_recover(huffman_stream);
+
+                if (status != BCL_STREAM_STATUS_DONE) {
+                        return status;
+                }
+
+                huffman_stream->node = 0;
+
+                stream->state = HUFFMAN_STATE_SYMBOL;
+        }
+
+        const uint32_t out_end = __bcl_stream_out_end(stream, max_size);
+
+        uint8_t * const out = stream->out;
+        uint32_t outpos = stream->out_pos;
+        uint32_t node = huffman_stream->node;
+
+        bcl_stream_status_t status;
+
+        while (true) {
+                if (outpos == stream->out_size) {
+                        status = BCL_STREAM_STATUS_DONE;
+                        break;
+                }
+
+                /* Traverse tree until we find a matching leaf node */
+                if (huffman_stream->nodes[node].symbol >= 0) {
+                        if (outpos == out_end) {
+                                status = BCL_STREAM_STATUS_OUTPUT_FULL;
+                                break;
+                        }
+
+                        /* We found the matching leaf node and have the symbol */
+                        out[outpos++] = (uint8_t)huffman_stream->nodes[node].symbol;
+
+                        node = 0;
+
+                        continue;
+                }
+
+                if (huffman_stream->bit_count == 0) {
+                        _stream_bits_fill(huffman_stream);
+
+                        if (huffman_stream->bit_count == 0) {
+                                status = BCL_STREAM_STATUS_NEED_INPUT;
+                                break;
+                        }
+                }
+
+                huffman_stream->bit_count--;
+
+                const uint32_t bit =
+                    (huffman_stream->bits >> huffman_stream->bit_count) & 1;
+
+                node = huffman_stream->nodes[node].children[bit];
+        }
+
+        huffman_stream->node = node;
+
+        stream->out_pos = outpos;
+
+        return status;
+}
+
+/* Move as many input bytes as fit into the bit accumulator */
+static void
+_stream_bits_fill(bcl_huffman_stream_t *huffman_stream)
+{
+        bcl_stream_t * const stream = &huffman_stream->stream;
+
+        while ((huffman_stream->bit_count <= 24) && (stream->in_size > 0)) {
+                huffman_stream->bits <<= 8;
+                huffman_stream->bits |= __bcl_stream_byte_read(stream);
+                huffman_stream->bit_count += 8;
+        }
+}
+
+/* Recover the Huffman tree without recursion so that recovery can be suspended
+ * whenever the input chunk runs dry */
+static bcl_stream_status_t
+_stream_tree_recover(bcl_huffman_stream_t *huffman_stream)
+{
+        while ((huffman_stream->node_count == 0) ||
+               (huffman_stream->stack_count > 0)) {
+                _stream_bits_fill(huffman_stream);
+
+                if (huffman_stream->bit_count < 1) {
+                        return BCL_STREAM_STATUS_NEED_INPUT;
+                }
+
+                const uint32_t bit_count = huffman_stream->bit_count;
+                const bool leaf = (huffman_stream->bits >> (bit_count - 1)) & 1;
+
+                if (leaf && (bit_count < 9)) {
+                        return BCL_STREAM_STATUS_NEED_INPUT;
+                }
+
+                if (huffman_stream->node_count == MAX_TREE_NODES) {
+                        return BCL_STREAM_STATUS_ERROR;
+                }
+
+                /* Pick a node from the node array */
+                const uint16_t node = huffman_stream->node_count++;
+
+                if (node > 0) {
+                        const uint16_t slot =
+                            huffman_stream->stack[--huffman_stream->stack_count];
+
+                        huffman_stream->nodes[slot >> 1].children[slot & 1] = node;
+                }
+
+                huffman_stream->nodes[node].children[0] = 0;
+                huffman_stream->nodes[node].children[1] = 0;
+
+                if (leaf) {
+                        /* Get symbol from tree description and store in leaf
+                         * node */
+                        huffman_stream->bit_count -= 9;
+                        huffman_stream->nodes[node].symbol =
+                            (huffman_stream->bits >> huffman_stream->bit_count) & 0xFF;
+
+                        continue;
+                }
+
+                huffman_stream->bit_count--;
+                huffman_stream->nodes[node].symbol = -1;
+
+                if ((huffman_stream->stack_count + 2) > TREE_STACK_SIZE) {
+                        return BCL_STREAM_STATUS_ERROR;
+                }
+
+                /* Branch A is recovered first, then branch B */
+                huffman_stream->stack[huffman_stream->stack_count++] = (node << 1) | 1;
+                huffman_stream->stack[huffman_stream->stack_count++] = (node << 1) | 0;
+        }
+
+        return BCL_STREAM_STATUS_DONE;
+}
+
 /* Initialize a bitstream */
 static void
 _bitstream_init(huff_bitstream_t *stream, uint8_t *buffer)
@@ -18,16 +18,38 @@
  *
  * 3. This notice may not be removed or altered from any source distribution. */
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "bcl-internal.h"
+
+typedef enum {
+        LZ_STATE_MARKER,
+        LZ_STATE_SYMBOL,
+        LZ_STATE_MARKER_NEXT,
+        LZ_STATE_LENGTH,
+        LZ_STATE_OFFSET,
+        LZ_STATE_COPY
+} lz_state_t;
+
+/* Shortest copy worth going through the 32-bit copy path */
+#define LZ_WORD_COPY_MIN 8
 
 /* Read uint32_teger with variable number of bytes depending on value */
 static int _var_size_read(uint32_t *x, uint8_t *buf);
 
+static inline bool _var_size_safe_read(uint32_t *x, const uint8_t *in,
+    uint32_t *inpos, uint32_t in_size);
+
+static inline void _history_copy(uint8_t *out, uint32_t offset, uint32_t length);
+
 void
 bcl_lz_decompress(uint8_t *in, uint8_t *out, uint32_t in_size)
 {
         uint8_t marker, symbol;
-        uint32_t  i, inpos, outpos, length, offset;
+        uint32_t inpos, outpos, length, offset;
 
         /* Do we have anything to uncompress? */
         if (in_size < 1) {
@@ -42,32 +64,265 @@ bcl_lz_decompress(uint8_t *in, uint8_t *out, uint32_t in_size)
         outpos = 0;
 
         do {
-                symbol = in[ inpos ++ ];
+                symbol = in[ inpos ];
 
-                if (symbol == marker) {
-                        /* We had a marker byte */
-                        if (in[ inpos ] == 0) {
-                                /* It was a single occurrence of the marker byte */
-                                out[ outpos ++ ] = marker;
-                                ++ inpos;
-                        } else {
-                                /* Extract true length and offset */
-                                inpos += _var_size_read(&length, &in[ inpos ]);
-                                inpos += _var_size_read(&offset, &in[ inpos ]);
-
-                                /* Copy corresponding data from history window */
-                                for (i = 0; i < length; ++ i) {
-                                        out[ outpos ] = out[ outpos - offset ];
-                                        ++ outpos;
+                if (symbol != marker) {
+                        /* No marker, plain copy of every literal up to the
+                         * next marker byte */
+                        do {
+                                out[ outpos ++ ] = symbol;
+
+                                if (++ inpos == in_size) {
+                                        break;
                                 }
-                        }
+
+                                symbol = in[ inpos ];
+                        } while (symbol != marker);
+
+                        continue;
+                }
+
+                ++ inpos;
+
+                /* We had a marker byte */
+                if (in[ inpos ] == 0) {
+                        /* It was a single occurrence of the marker byte */
+                        out[ outpos ++ ] = marker;
+                        ++ inpos;
                 } else {
-                        /* No marker, plain copy */
-                        out[ outpos ++ ] = symbol;
+                        /* Extract true length and offset */
+                        inpos += _var_size_read(&length, &in[ inpos ]);
+                        inpos += _var_size_read(&offset, &in[ inpos ]);
+
+                        /* Copy corresponding data from history window */
+                        _history_copy(&out[ outpos ], offset, length);
+
+                        outpos += length;
                 }
         } while (inpos < in_size);
 }
 
+int32_t
+bcl_lz_decompress_safe(const void *in, void *out, uint32_t in_size,
+    uint32_t out_size)
+{
+        const uint8_t * const in_buffer = in;
+        uint8_t * const out_buffer = out;
+
+        uint8_t marker, symbol;
+        uint32_t inpos, outpos, length, offset;
+
+        if (in_size < 1) {
+                return 0;
+        }
+
+        marker = in_buffer[0];
+        inpos = 1;
+        outpos = 0;
+
+        while (inpos < in_size) {
+                symbol = in_buffer[inpos];
+
+                if (symbol != marker) {
+                        /* Stop the literal run at whichever of the input or
+                         * the output runs out first, so each byte is only
+                         * checked against the marker */
+                        const uint32_t in_left = in_size - inpos;
+                        const uint32_t out_left = out_size - outpos;
+                        const uint32_t run_end =
+                            (in_left <= out_left) ? in_size : (inpos + out_left);
+
+                        while ((inpos < run_end) && (symbol != marker)) {
+                                out_buffer[outpos++] = symbol;
+
+                                if (++inpos < in_size) {
+                                        symbol = in_buffer[inpos];
+                                }
+                        }
+
+                        if ((inpos < in_size) && (symbol != marker)) {
+                                return BCL_ERROR_OUT_SIZE;
+                        }
+
+                        continue;
+                }
+
+                if (++inpos == in_size) {
+                        return BCL_ERROR_IN_SIZE;
+                }
+
+                if (in_buffer[inpos] == 0) {
+                        if (outpos == out_size) {
+                                return BCL_ERROR_OUT_SIZE;
+                        }
+
+                        out_buffer[outpos++] = marker;
+                        inpos++;
+
+                        continue;
+                }
+
+                if (!_var_size_safe_read(&length, in_buffer, &inpos, in_size) ||
+                    !_var_size_safe_read(&offset, in_buffer, &inpos, in_size)) {
+                        return BCL_ERROR_IN_SIZE;
+                }
+
+                if ((offset == 0) || (offset > outpos)) {
+                        return BCL_ERROR_CORRUPT;
+                }
+
+                if (length > (out_size - outpos)) {
+                        return BCL_ERROR_OUT_SIZE;
+                }
+
+                _history_copy(&out_buffer[outpos], offset, length);
+
+                outpos += length;
+        }
+
+        return outpos;
+}
+
+void
+bcl_lz_stream_init(bcl_lz_stream_t *lz_stream, uint8_t *out, uint32_t out_size)
+{
+        bcl_stream_t * const stream = &lz_stream->stream;
+
+        stream->in = NULL;
+        stream->in_size = 0;
+        stream->out = out;
+        stream->out_pos = 0;
+        stream->out_size = out_size;
+        stream->state = LZ_STATE_MARKER;
+
+        lz_stream->length = 0;
+        lz_stream->offset = 0;
+        lz_stream->marker = 0;
+}
+
+bcl_stream_status_t
+bcl_lz_stream_drain(bcl_lz_stream_t *lz_stream, uint32_t max_size)
+{
+        bcl_stream_t * const stream = &lz_stream->stream;
+
+        const uint32_t out_end = __bcl_stream_out_end(stream, max_size);
+
+        uint8_t * const out = stream->out;
+        uint32_t outpos = stream->out_pos;
+
+        bcl_stream_status_t status;
+
+        while (true) {
+                if (outpos == stream->out_size) {
+                        status = BCL_STREAM_STATUS_DONE;
+                        break;
+                }
+
+                if (outpos == out_end) {
+                        status = BCL_STREAM_STATUS_OUTPUT_FULL;
+                        break;
+                }
+
+                if (stream->state == LZ_STATE_COPY) {
+                        if ((lz_stream->offset == 0) || (lz_stream->offset > outpos)) {
+                                status = BCL_STREAM_STATUS_ERROR;
+                                break;
+                        }
+
+                        /* Copy corresponding data from history window */
+                        uint32_t length = out_end - outpos;
+
+                        if (length > lz_stream->length) {
+                                length = lz_stream->length;
+                        }
+
+                        lz_stream->length -= length;
+
+                        _history_copy(&out[outpos], lz_stream->offset, length);
+
+                        outpos += length;
+
+                        if (lz_stream->length == 0) {
+                                stream->state = LZ_STATE_SYMBOL;
+                        }
+
+                        continue;
+                }
+
+                if (stream->in_size == 0) {
+                        status = BCL_STREAM_STATUS_NEED_INPUT;
+                        break;
+                }
+
+                const uint8_t symbol = __bcl_stream_byte_read(stream);
+
+                switch (stream->state) {
+                case LZ_STATE_MARKER:
+                        lz_stream->marker = symbol;
+                        stream->state = LZ_STATE_SYMBOL;
+                        break;
+                case LZ_STATE_SYMBOL:
+                        if (symbol == lz_stream->marker) {
+                                stream->state = LZ_STATE_MARKER_NEXT;
+                        } else {
+                                /* No marker, plain copy */
+                                out[outpos++] = symbol;
+                        }
+                        break;
+                case LZ_STATE_MARKER_NEXT:
+                        if (symbol == 0) {
+                                /* It was a single occurrence of the marker byte */
+                                out[outpos++] = lz_stream->marker;
+                                stream->state = LZ_STATE_SYMBOL;
+                                break;
+                        }
+
+                        /* The byte starts the variable sized length */
+                        lz_stream->length = 0;
+                        stream->state = LZ_STATE_LENGTH;
+                        /* Fall through */
+                case LZ_STATE_LENGTH:
+                        lz_stream->length = (lz_stream->length << 7) | (symbol & 0x7F);
+
+                        if ((symbol & 0x80) == 0x00) {
+                                lz_stream->offset = 0;
+                                stream->state = LZ_STATE_OFFSET;
+                        }
+                        break;
+                case LZ_STATE_OFFSET:
+                        lz_stream->offset = (lz_stream->offset << 7) | (symbol & 0x7F);
+
+                        if ((symbol & 0x80) == 0x00) {
+                                stream->state = LZ_STATE_COPY;
+                        }
+                        break;
+                }
+        }
+
+        stream->out_pos = outpos;
+
+        return status;
+}
+
+/* Copy a match from the history window. Matches whose source begins at least
+ * 4 bytes back never read a 32-bit word that is still being written, so they
+ * take the 32-bit copy path even when source and destination overlap */
+static inline void __always_inline
+_history_copy(uint8_t *out, uint32_t offset, uint32_t length)
+{
+        const uint8_t *src = out - offset;
+
+        if ((offset < 4) || (length < LZ_WORD_COPY_MIN)) {
+                for (; length > 0; length--) {
+                        *out++ = *src++;
+                }
+
+                return;
+        }
+
+        __bcl_block_copy(out, src, length);
+}
+
 static int
 _var_size_read(uint32_t *x, uint8_t *buf)
 {
@@ -90,3 +345,28 @@ _var_size_read(uint32_t *x, uint8_t *buf)
         /* Return number of bytes read */
         return num_bytes;
 }
+
+/* Read a variable sized integer without reading past the end of the input */
+static inline bool __always_inline
+_var_size_safe_read(uint32_t *x, const uint8_t *in, uint32_t *inpos,
+    uint32_t in_size)
+{
+        uint32_t y, b, pos;
+
+        y = 0;
+        pos = *inpos;
+
+        do {
+                if (pos == in_size) {
+                        return false;
+                }
+
+                b = in[pos++];
+                y = (y << 7) | (b & 0x0000007F);
+        } while ((b & 0x00000080) != 0x00000000);
+
+        *x = y;
+        *inpos = pos;
+
+        return true;
+}
@@ -5,8 +5,31 @@
 #include <sys/cdefs.h>
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "bcl-internal.h"
+
+typedef enum {
+        /* States that consume a control bit */
+        PRS_STATE_CMD,
+        PRS_STATE_CMD_COPY,
+        PRS_STATE_SHORT_SIZE_HIGH,
+        PRS_STATE_SHORT_SIZE_LOW,
+        /* States that consume a byte */
+        PRS_STATE_LITERAL,
+        PRS_STATE_SHORT_OFFSET,
+        PRS_STATE_LONG_LOW,
+        PRS_STATE_LONG_HIGH,
+        PRS_STATE_LONG_SIZE,
+        /* States that consume no input */
+        PRS_STATE_COPY,
+        PRS_STATE_END
+} prs_state_t;
+
+static inline int32_t _control_bit_read(uint32_t *control, const uint8_t **src,
+    const uint8_t *src_end);
+
 void
 bcl_prs_decompress(void *in, void *out)
 {
@@ -14,6 +37,7 @@ bcl_prs_decompress(void *in, void *out)
         uint32_t bitpos = 9; /* 4 named registers */
         uint8_t *src_ptr = (uint8_t *)in;
         uint8_t *dst_ptr = (uint8_t *)out;
+        const uint8_t *copy_ptr;
         uint8_t current_byte;
         bool flag;
         int offset;
@@ -75,7 +99,9 @@ bcl_prs_decompress(void *in, void *out)
                                 r3 += 2;
                         }
 
-                        r5 += (uint32_t) dst_ptr;
+                        /* Offsets are negative, so avoid going through a
+                         * 32-bit pointer to stay usable on 64-bit hosts */
+                        copy_ptr = dst_ptr + (int32_t)r5;
                 } else {
                         r3 = 0;
 
@@ -97,7 +123,7 @@ bcl_prs_decompress(void *in, void *out)
                         offset = src_ptr[0] | 0xFFFFFF00;
                         r3 += 2;
                         src_ptr++;
-                        r5 = offset + (uint32_t)dst_ptr;
+                        copy_ptr = dst_ptr + offset;
                 }
 
                 if (r3 == 0) {
@@ -107,10 +133,282 @@ bcl_prs_decompress(void *in, void *out)
                 t = r3;
 
                 for (x = 0; x < t; x++) {
-                        dst_ptr[0] = * (uint8_t *)r5;
-                        r5++;
+                        dst_ptr[0] = *copy_ptr;
+                        copy_ptr++;
                         r3++;
                         dst_ptr++;
                 }
         }
 }
+
+int32_t
+bcl_prs_decompress_safe(const void *in, void *out, uint32_t in_size,
+    uint32_t out_size)
+{
+        const uint8_t *src = (const uint8_t *)in;
+        const uint8_t * const src_end = src + in_size;
+        uint8_t * const dst_start = (uint8_t *)out;
+        uint8_t * const dst_end = dst_start + out_size;
+        uint8_t *dst = dst_start;
+
+        /* The set bit above the control bits marks when to read the next
+         * control byte */
+        uint32_t control = 1;
+
+        while (true) {
+                int32_t flag;
+
+                if ((flag = _control_bit_read(&control, &src, src_end)) < 0) {
+                        return BCL_ERROR_IN_SIZE;
+                }
+
+                if (flag) {
+                        if (src == src_end) {
+                                return BCL_ERROR_IN_SIZE;
+                        }
+
+                        if (dst == dst_end) {
+                                return BCL_ERROR_OUT_SIZE;
+                        }
+
+                        *dst++ = *src++;
+
+                        continue;
+                }
+
+                if ((flag = _control_bit_read(&control, &src, src_end)) < 0) {
+                        return BCL_ERROR_IN_SIZE;
+                }
+
+                uint32_t length;
+                int32_t offset;
+
+                if (flag) {
+                        if ((src_end - src) < 2) {
+                                return BCL_ERROR_IN_SIZE;
+                        }
+
+                        const uint32_t word = src[0] | (src[1] << 8);
+
+                        src += 2;
+
+                        if (word == 0) {
+                                break;
+                        }
+
+                        offset = (int32_t)((word >> 3) | 0xFFFFE000);
+                        length = word & 0x07;
+
+                        if (length == 0) {
+                                if (src == src_end) {
+                                        return BCL_ERROR_IN_SIZE;
+                                }
+
+                                length = *src++ + 1;
+                        } else {
+                                length += 2;
+                        }
+                } else {
+                        const int32_t high = _control_bit_read(&control, &src, src_end);
+                        const int32_t low = _control_bit_read(&control, &src, src_end);
+
+                        if ((high < 0) || (low < 0) || (src == src_end)) {
+                                return BCL_ERROR_IN_SIZE;
+                        }
+
+                        offset = (int32_t)(*src++ | 0xFFFFFF00);
+                        length = ((high << 1) | low) + 2;
+                }
+
+                if ((uint32_t)-offset > (uint32_t)(dst - dst_start)) {
+                        return BCL_ERROR_CORRUPT;
+                }
+
+                if (length > (uint32_t)(dst_end - dst)) {
+                        return BCL_ERROR_OUT_SIZE;
+                }
+
+                const uint8_t *copy_ptr = dst + offset;
+
+                for (; length > 0; length--) {
+                        *dst++ = *copy_ptr++;
+                }
+        }
+
+        return (dst - dst_start);
+}
+
+void
+bcl_prs_stream_init(bcl_prs_stream_t *prs_stream, uint8_t *out, uint32_t out_size)
+{
+        bcl_stream_t * const stream = &prs_stream->stream;
+
+        stream->in = NULL;
+        stream->in_size = 0;
+        stream->out = out;
+        stream->out_pos = 0;
+        stream->out_size = out_size;
+        stream->state = PRS_STATE_CMD;
+
+        prs_stream->length = 0;
+        prs_stream->offset = 0;
+        prs_stream->control = 0;
+        prs_stream->control_bits = 0;
+        prs_stream->offset_low = 0;
+}
+
+bcl_stream_status_t
+bcl_prs_stream_drain(bcl_prs_stream_t *prs_stream, uint32_t max_size)
+{
+        bcl_stream_t * const stream = &prs_stream->stream;
+
+        const uint32_t out_end = __bcl_stream_out_end(stream, max_size);
+
+        uint8_t * const out = stream->out;
+        uint32_t outpos = stream->out_pos;
+
+        bcl_stream_status_t status;
+
+        while (true) {
+                if ((stream->state == PRS_STATE_END) || (outpos == stream->out_size)) {
+                        status = BCL_STREAM_STATUS_DONE;
+                        break;
+                }
+
+                if (outpos == out_end) {
+                        status = BCL_STREAM_STATUS_OUTPUT_FULL;
+                        break;
+                }
+
+                if (stream->state == PRS_STATE_COPY) {
+                        if ((uint32_t)-prs_stream->offset > outpos) {
+                                status = BCL_STREAM_STATUS_ERROR;
+                                break;
+                        }
+
+                        uint32_t length = out_end - outpos;
+
+                        if (length > prs_stream->length) {
+                                length = prs_stream->length;
+                        }
+
+                        prs_stream->length -= length;
+
+                        const uint8_t *src = &out[outpos] + prs_stream->offset;
+
+                        for (; length > 0; length--) {
+                                out[outpos++] = *src++;
+                        }
+
+                        if (prs_stream->length == 0) {
+                                stream->state = PRS_STATE_CMD;
+                        }
+
+                        continue;
+                }
+
+                if (stream->state <= PRS_STATE_SHORT_SIZE_LOW) {
+                        if (prs_stream->control_bits == 0) {
+                                if (stream->in_size == 0) {
+                                        status = BCL_STREAM_STATUS_NEED_INPUT;
+                                        break;
+                                }
+
+                                prs_stream->control = __bcl_stream_byte_read(stream);
+                                prs_stream->control_bits = 8;
+                        }
+
+                        const uint32_t flag = prs_stream->control & 1;
+
+                        prs_stream->control >>= 1;
+                        prs_stream->control_bits--;
+
+                        switch (stream->state) {
+                        case PRS_STATE_CMD:
+                                stream->state = (flag) ? PRS_STATE_LITERAL : PRS_STATE_CMD_COPY;
+                                break;
+                        case PRS_STATE_CMD_COPY:
+                                stream->state = (flag) ? PRS_STATE_LONG_LOW : PRS_STATE_SHORT_SIZE_HIGH;
+                                break;
+                        case PRS_STATE_SHORT_SIZE_HIGH:
+                                prs_stream->length = flag;
+                                stream->state = PRS_STATE_SHORT_SIZE_LOW;
+                                break;
+                        case PRS_STATE_SHORT_SIZE_LOW:
+                                prs_stream->length = (prs_stream->length << 1) | flag;
+                                stream->state = PRS_STATE_SHORT_OFFSET;
+                                break;
+                        }
+
+                        continue;
+                }
+
+                if (stream->in_size == 0) {
+                        status = BCL_STREAM_STATUS_NEED_INPUT;
+                        break;
+                }
+
+                const uint8_t byte = __bcl_stream_byte_read(stream);
+
+                switch (stream->state) {
+                case PRS_STATE_LITERAL:
+                        out[outpos++] = byte;
+                        stream->state = PRS_STATE_CMD;
+                        break;
+                case PRS_STATE_SHORT_OFFSET:
+                        prs_stream->offset = (int32_t)(byte | 0xFFFFFF00);
+                        prs_stream->length += 2;
+                        stream->state = PRS_STATE_COPY;
+                        break;
+                case PRS_STATE_LONG_LOW:
+                        prs_stream->offset_low = byte;
+                        stream->state = PRS_STATE_LONG_HIGH;
+                        break;
+                case PRS_STATE_LONG_HIGH: {
+                        const uint32_t offset = (byte << 8) | prs_stream->offset_low;
+
+                        if (offset == 0) {
+                                stream->state = PRS_STATE_END;
+                                break;
+                        }
+
+                        prs_stream->offset = (int32_t)((offset >> 3) | 0xFFFFE000);
+                        prs_stream->length = prs_stream->offset_low & 0x07;
+
+                        if (prs_stream->length == 0) {
+                                stream->state = PRS_STATE_LONG_SIZE;
+                        } else {
+                                prs_stream->length += 2;
+                                stream->state = PRS_STATE_COPY;
+                        }
+                } break;
+                case PRS_STATE_LONG_SIZE:
+                        prs_stream->length = byte + 1;
+                        stream->state = PRS_STATE_COPY;
+                        break;
+                }
+        }
+
+        stream->out_pos = outpos;
+
+        return status;
+}
+
+/* Read the next control bit, or return -1 if the input has run out */
+static inline int32_t __always_inline
+_control_bit_read(uint32_t *control, const uint8_t **src, const uint8_t *src_end)
+{
+        if (*control == 1) {
+                if (*src == src_end) {
+                        return -1;
+                }
+
+                *control = *(*src)++ | 0x100;
+        }
+
+        const int32_t bit = *control & 1;
+
+        *control >>= 1;
+
+        return bit;
+}
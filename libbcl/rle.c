@@ -25,7 +25,21 @@
  *       removal of file I/O (this implementation works solely with preallocated
  *       memory buffers), and that the code is now 100% reentrant. */
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "bcl-internal.h"
+
+typedef enum {
+        RLE_STATE_MARKER,
+        RLE_STATE_SYMBOL,
+        RLE_STATE_COUNT,
+        RLE_STATE_COUNT_LOW,
+        RLE_STATE_RUN_SYMBOL,
+        RLE_STATE_RUN
+} rle_state_t;
 
 void
 bcl_rle_decompress(uint8_t *in, uint8_t *out, uint32_t in_size)
@@ -75,3 +89,187 @@ bcl_rle_decompress(uint8_t *in, uint8_t *out, uint32_t in_size)
                 }
         } while (inpos < in_size);
 }
+
+int32_t
+bcl_rle_decompress_safe(const void *in, void *out, uint32_t in_size,
+    uint32_t out_size)
+{
+        const uint8_t * const in_buffer = in;
+        uint8_t * const out_buffer = out;
+
+        uint8_t marker, symbol;
+        uint32_t inpos, outpos, count;
+
+        if (in_size < 1) {
+                return 0;
+        }
+
+        inpos = 0;
+        marker = in_buffer[inpos++];
+
+        outpos = 0;
+
+        while (inpos < in_size) {
+                symbol = in_buffer[inpos++];
+
+                if (symbol != marker) {
+                        if (outpos == out_size) {
+                                return BCL_ERROR_OUT_SIZE;
+                        }
+
+                        out_buffer[outpos++] = symbol;
+
+                        continue;
+                }
+
+                if (inpos == in_size) {
+                        return BCL_ERROR_IN_SIZE;
+                }
+
+                count = in_buffer[inpos++];
+
+                if (count <= 2) {
+                        /* Counts 0, 1 and 2 are used for marker byte
+                         * repetition only */
+                        symbol = marker;
+                } else {
+                        if ((count & 0x80) != 0x00) {
+                                if (inpos == in_size) {
+                                        return BCL_ERROR_IN_SIZE;
+                                }
+
+                                count = ((count & 0x7F) << 8) + in_buffer[inpos++];
+                        }
+
+                        if (inpos == in_size) {
+                                return BCL_ERROR_IN_SIZE;
+                        }
+
+                        symbol = in_buffer[inpos++];
+                }
+
+                count++;
+
+                if (count > (out_size - outpos)) {
+                        return BCL_ERROR_OUT_SIZE;
+                }
+
+                (void)memset(&out_buffer[outpos], symbol, count);
+
+                outpos += count;
+        }
+
+        return outpos;
+}
+
+void
+bcl_rle_stream_init(bcl_rle_stream_t *rle_stream, uint8_t *out, uint32_t out_size)
+{
+        bcl_stream_t * const stream = &rle_stream->stream;
+
+        stream->in = NULL;
+        stream->in_size = 0;
+        stream->out = out;
+        stream->out_pos = 0;
+        stream->out_size = out_size;
+        stream->state = RLE_STATE_MARKER;
+
+        rle_stream->length = 0;
+        rle_stream->marker = 0;
+        rle_stream->symbol = 0;
+}
+
+bcl_stream_status_t
+bcl_rle_stream_drain(bcl_rle_stream_t *rle_stream, uint32_t max_size)
+{
+        bcl_stream_t * const stream = &rle_stream->stream;
+
+        const uint32_t out_end = __bcl_stream_out_end(stream, max_size);
+
+        uint8_t * const out = stream->out;
+        uint32_t outpos = stream->out_pos;
+
+        bcl_stream_status_t status;
+
+        while (true) {
+                if (outpos == stream->out_size) {
+                        status = BCL_STREAM_STATUS_DONE;
+                        break;
+                }
+
+                if (outpos == out_end) {
+                        status = BCL_STREAM_STATUS_OUTPUT_FULL;
+                        break;
+                }
+
+                if (stream->state == RLE_STATE_RUN) {
+                        uint32_t length = out_end - outpos;
+
+                        if (length > rle_stream->length) {
+                                length = rle_stream->length;
+                        }
+
+                        rle_stream->length -= length;
+
+                        for (; length > 0; length--) {
+                                out[outpos++] = rle_stream->symbol;
+                        }
+
+                        if (rle_stream->length == 0) {
+                                stream->state = RLE_STATE_SYMBOL;
+                        }
+
+                        continue;
+                }
+
+                if (stream->in_size == 0) {
+                        status = BCL_STREAM_STATUS_NEED_INPUT;
+                        break;
+                }
+
+                const uint8_t symbol = __bcl_stream_byte_read(stream);
+
+                switch (stream->state) {
+                case RLE_STATE_MARKER:
+                        rle_stream->marker = symbol;
+                        stream->state = RLE_STATE_SYMBOL;
+                        break;
+                case RLE_STATE_SYMBOL:
+                        if (symbol == rle_stream->marker) {
+                                stream->state = RLE_STATE_COUNT;
+                        } else {
+                                /* No marker, plain copy */
+                                out[outpos++] = symbol;
+                        }
+                        break;
+                case RLE_STATE_COUNT:
+                        rle_stream->length = symbol;
+
+                        if (symbol <= 2) {
+                                /* Counts 0, 1 and 2 are used for marker byte
+                                 * repetition only */
+                                rle_stream->length++;
+                                rle_stream->symbol = rle_stream->marker;
+                                stream->state = RLE_STATE_RUN;
+                        } else if ((symbol & 0x80) != 0x00) {
+                                stream->state = RLE_STATE_COUNT_LOW;
+                        } else {
+                                stream->state = RLE_STATE_RUN_SYMBOL;
+                        }
+                        break;
+                case RLE_STATE_COUNT_LOW:
+                        rle_stream->length = ((rle_stream->length & 0x7F) << 8) + symbol;
+                        stream->state = RLE_STATE_RUN_SYMBOL;
+                        break;
+                case RLE_STATE_RUN_SYMBOL:
+                        rle_stream->length++;
+                        rle_stream->symbol = symbol;
+                        stream->state = RLE_STATE_RUN;
+                        break;
+                }
+        }
+
+        stream->out_pos = outpos;
+
+        return status;
+}
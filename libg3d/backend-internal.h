@@ -0,0 +1,140 @@
+/*
+ * No copyright.
+ */
+
+#ifndef _G3D_BACKEND_INTERNAL_H_
+#define _G3D_BACKEND_INTERNAL_H_
+
+#include <stdint.h>
+
+#include <cpu/instructions.h>
+#include <cpu/map.h>
+
+#include <fix16.h>
+
+#include <g3d/sgl.h>
+
+/* The SH-2 backend makes use of the MAC unit and the CPU divider directly.
+ *
+ * The reference backend is plain C that gives bit-exact results, so that it can
+ * be used on hosts, and on the target to cross-check the SH-2 backend.
+ *
+ * Only g3d/sgl.h and libyaul headers are included, so that both backends can
+ * be built on a host against models of the MAC unit and the divider
+ * (tools/g3d-backend-test) */
+#define TRANSFORM_BACKEND_SH2           (0)
+#define TRANSFORM_BACKEND_REFERENCE     (1)
+
+#ifndef TRANSFORM_BACKEND
+#if defined(__sh__)
+#define TRANSFORM_BACKEND               TRANSFORM_BACKEND_SH2
+#else
+#define TRANSFORM_BACKEND               TRANSFORM_BACKEND_REFERENCE
+#endif /* __sh__ */
+#endif /* !TRANSFORM_BACKEND */
+
+/* Offsets of the CPU divider registers from DVSR, in 32-bit words. Writing
+ * DVDNTL starts the division */
+#define BACKEND_DIVU_DVSR               (0x00)
+#define BACKEND_DIVU_DVDNTH             (0x10 / 4)
+#define BACKEND_DIVU_DVDNTL             (0x14 / 4)
+
+#if defined(__sh__)
+/* Reading DVDNTL stalls until the quotient is ready */
+static inline FIXED __always_inline
+__backend_divu_quotient_get(const uint32_t *divu_regs)
+{
+        return divu_regs[BACKEND_DIVU_DVDNTL];
+}
+#else
+/* When the SH-2 backend is built on a host, the host provides a model of the
+ * divider */
+extern FIXED __backend_divu_quotient_get(const uint32_t *divu_regs);
+#endif /* __sh__ */
+
+/* Sum of the products of two 3-component vectors, keeping the middle 32-bits
+ * of the 64-bit sum. This is three MAC.L instructions followed by XTRCT */
+static inline uint32_t __always_inline
+__backend_mac3(const FIXED *a, const FIXED *b)
+{
+#if TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2
+        cpu_instr_clrmac();
+
+        const FIXED *a_ptr = a;
+        const FIXED *b_ptr = b;
+
+        cpu_instr_macl(&a_ptr, &b_ptr);
+        cpu_instr_macl(&a_ptr, &b_ptr);
+        cpu_instr_macl(&a_ptr, &b_ptr);
+
+        register const uint32_t mach = cpu_instr_sts_mach();
+        register const uint32_t macl = cpu_instr_sts_macl();
+
+        return cpu_instr_xtrct(mach, macl);
+#else
+        /* The MAC register wraps around on overflow */
+        uint64_t mac;
+
+        mac  = (uint64_t)((int64_t)a[0] * b[0]);
+        mac += (uint64_t)((int64_t)a[1] * b[1]);
+        mac += (uint64_t)((int64_t)a[2] * b[2]);
+
+        return (uint32_t)(mac >> 16);
+#endif /* TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2 */
+}
+
+/* Same as fix16_mul(), DMULS.L followed by XTRCT */
+static inline FIXED __always_inline
+__backend_fix16_mul(FIXED a, FIXED b)
+{
+#if TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2
+        return fix16_mul(a, b);
+#else
+        return (FIXED)(uint32_t)((uint64_t)((int64_t)a * b) >> 16);
+#endif /* TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2 */
+}
+
+/* Same as fix16_int16_muls(), the lower 16-bits of MACH after DMULS.L */
+static inline int16_t __always_inline
+__backend_fix16_int16_muls(FIXED a, FIXED b)
+{
+#if TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2
+        return fix16_int16_muls(a, b);
+#else
+        return (int16_t)(uint16_t)((uint64_t)((int64_t)a * b) >> 32);
+#endif /* TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2 */
+}
+
+/* Signed 64-bit by 32-bit division. As with the CPU divider (with the overflow
+ * interrupt disabled), the quotient saturates on overflow, and on a division by
+ * zero */
+static inline FIXED __always_inline
+__backend_divs(int64_t dividend, FIXED divisor)
+{
+#if TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2
+        uint32_t * const divu_regs = (uint32_t *)CPU(DVSR);
+
+        divu_regs[BACKEND_DIVU_DVSR] = divisor;
+        divu_regs[BACKEND_DIVU_DVDNTH] = (uint32_t)((uint64_t)dividend >> 32);
+        divu_regs[BACKEND_DIVU_DVDNTL] = (uint32_t)dividend;
+
+        return __backend_divu_quotient_get(divu_regs);
+#else
+        if (divisor != 0) {
+                /* The only quotient that doesn't fit in 64-bits */
+                const int64_t quotient = ((dividend == INT64_MIN) && (divisor == -1))
+                    ? INT64_MAX
+                    : (dividend / divisor);
+
+                if ((quotient >= INT32_MIN) && (quotient <= INT32_MAX)) {
+                        return (FIXED)quotient;
+                }
+
+                return (((dividend < 0) != (divisor < 0)) ? INT32_MIN : INT32_MAX);
+        }
+
+        return ((dividend < 0) ? INT32_MIN : INT32_MAX);
+#endif /* TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2 */
+}
+
+#endif /* !_G3D_BACKEND_INTERNAL_H_ */
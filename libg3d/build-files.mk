@@ -1,22 +1,34 @@
 # -*- mode: makefile -*-
 
 LIB_SRCS:= \
+	bvh.c \
 	fog.c \
 	list.c \
+	lod.c \
 	matrix_stack.c \
+	mesh.c \
+	occlusion.c \
+	occlusion_grid.c \
 	perf.c \
 	plist.c \
 	plist.c \
+	quality.c \
 	s3d.c \
+	skeleton.c \
 	g3d.c \
 	sort.c \
+	tcache.c \
 	state.c \
 	tlist.c \
-	transform.c
+	transform.c \
+	vertex_pool.c
 
 INSTALL_HEADER_FILES:= \
+	./g3d/:bvh.h:./g3d/ \
+	./g3d/:mesh.h:./g3d/ \
 	./g3d/:perf.h:./g3d/ \
 	./g3d/:s3d.h:./g3d/ \
+	./g3d/:skeleton.h:./g3d/ \
 	./g3d/:types.h:./g3d/ \
 	./g3d/:sgl.h:./g3d/ \
 	./:g3d.h:./g3d/ \
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+/* Most objects held by a leaf node */
+#define BVH_LEAF_COUNT_MAX      (2)
+/* Deep enough for a tree of any number of objects that fits in 16 bits */
+#define BVH_STACK_SIZE          (32)
+
+#define PLANE_MASK_ALL          ((1 << CLIP_PLANE_COUNT) - 1)
+
+typedef struct {
+        uint16_t node_index;
+        uint16_t plane_mask;
+} bvh_stack_t;
+
+static void _node_build(g3d_bvh_t *bvh, uint16_t node_index, uint16_t first,
+    uint16_t count);
+static void _node_bounds_calculate(const g3d_bvh_t *bvh, g3d_bvh_node_t *node);
+static uint32_t _split_axis_get(const g3d_bvh_t *bvh, uint16_t first,
+    uint16_t count);
+static void _objects_partition(g3d_bvh_object_t *objects, uint16_t count,
+    uint16_t median, uint32_t axis);
+static bool _node_cull_test(const g3d_bvh_node_t *node, uint16_t *plane_mask);
+static void _object_transform(const g3d_bvh_object_t *bvh_object);
+
+/* The most nodes a tree over object_count objects uses. Past
+ * G3D_BVH_OBJECT_COUNT_MAX objects, this no longer fits in 16 bits */
+uint32_t
+g3d_bvh_node_count_get(uint16_t object_count)
+{
+        if (object_count == 0) {
+                return 0;
+        }
+
+        return ((2 * (uint32_t)object_count) - 1);
+}
+
+void
+g3d_bvh_build(g3d_bvh_t *bvh, g3d_bvh_object_t *objects,
+    uint16_t object_count, g3d_bvh_node_t *nodes)
+{
+        assert(bvh != NULL);
+        assert((objects != NULL) || (object_count == 0));
+        assert((nodes != NULL) || (object_count == 0));
+        assert(object_count <= G3D_BVH_OBJECT_COUNT_MAX);
+
+        bvh->objects = objects;
+        bvh->nodes = nodes;
+        bvh->object_count = object_count;
+        bvh->node_count = 0;
+
+        if (object_count == 0) {
+                return;
+        }
+
+        bvh->node_count = 1;
+
+        _node_build(bvh, 0, 0, object_count);
+}
+
+void
+g3d_bvh_transform(const g3d_bvh_t *bvh)
+{
+        assert(bvh != NULL);
+
+        if (bvh->node_count == 0) {
+                return;
+        }
+
+        g3d_results_t * const internal_results = __state->results;
+
+        bvh_stack_t stack[BVH_STACK_SIZE];
+        bvh_stack_t *stack_top = stack;
+
+        stack_top->node_index = 0;
+        stack_top->plane_mask = PLANE_MASK_ALL;
+        stack_top++;
+
+        while (stack_top != stack) {
+                stack_top--;
+
+                const g3d_bvh_node_t * const node = &bvh->nodes[stack_top->node_index];
+
+                uint16_t plane_mask = stack_top->plane_mask;
+
+                if ((_node_cull_test(node, &plane_mask))) {
+                        internal_results->bvh_culled_count += node->count;
+
+                        continue;
+                }
+
+                if (node->child == 0) {
+                        const g3d_bvh_object_t *bvh_object = &bvh->objects[node->first];
+
+                        for (uint32_t i = 0; i < node->count; i++, bvh_object++) {
+                                _object_transform(bvh_object);
+                        }
+
+                        internal_results->bvh_visible_count += node->count;
+
+                        continue;
+                }
+
+                assert((stack_top + 2) <= &stack[BVH_STACK_SIZE]);
+
+                /* Push the right child first so that the left child is visited
+                 * first */
+                stack_top->node_index = node->child + 1;
+                stack_top->plane_mask = plane_mask;
+                stack_top++;
+
+                stack_top->node_index = node->child;
+                stack_top->plane_mask = plane_mask;
+                stack_top++;
+        }
+}
+
+static void
+_node_build(g3d_bvh_t *bvh, uint16_t node_index, uint16_t first,
+    uint16_t count)
+{
+        g3d_bvh_node_t * const node = &bvh->nodes[node_index];
+
+        node->child = 0;
+        node->first = first;
+        node->count = count;
+
+        _node_bounds_calculate(bvh, node);
+
+        if (count <= BVH_LEAF_COUNT_MAX) {
+                return;
+        }
+
+        /* Split at the median object center along the axis where the centers
+         * are spread out the most */
+        const uint32_t axis = _split_axis_get(bvh, first, count);
+        const uint16_t median = count / 2;
+
+        _objects_partition(&bvh->objects[first], count, median, axis);
+
+        /* Both children are allocated next to each other */
+        const uint16_t child = bvh->node_count;
+
+        bvh->node_count += 2;
+
+        node->child = child;
+
+        _node_build(bvh, child, first, median);
+        _node_build(bvh, child + 1, first + median, count - median);
+}
+
+static void
+_node_bounds_calculate(const g3d_bvh_t *bvh, g3d_bvh_node_t *node)
+{
+        const g3d_bvh_object_t *bvh_object = &bvh->objects[node->first];
+
+        FIXED min[XYZ] = {
+                FIX16_MAX, FIX16_MAX, FIX16_MAX
+        };
+
+        FIXED max[XYZ] = {
+                FIX16_MIN, FIX16_MIN, FIX16_MIN
+        };
+
+        for (uint32_t i = 0; i < node->count; i++, bvh_object++) {
+                const g3d_cull_aabb_t * const aabb = &bvh_object->aabb;
+
+                for (uint32_t axis = 0; axis < XYZ; axis++) {
+                        const FIXED object_min = aabb->origin[axis] - aabb->length[axis];
+                        const FIXED object_max = aabb->origin[axis] + aabb->length[axis];
+
+                        min[axis] = (object_min < min[axis]) ? object_min : min[axis];
+                        max[axis] = (object_max > max[axis]) ? object_max : max[axis];
+                }
+        }
+
+        node->min.x = min[X];
+        node->min.y = min[Y];
+        node->min.z = min[Z];
+
+        node->max.x = max[X];
+        node->max.y = max[Y];
+        node->max.z = max[Z];
+}
+
+static uint32_t
+_split_axis_get(const g3d_bvh_t *bvh, uint16_t first, uint16_t count)
+{
+        const g3d_bvh_object_t *bvh_object = &bvh->objects[first];
+
+        FIXED min[XYZ] = {
+                FIX16_MAX, FIX16_MAX, FIX16_MAX
+        };
+
+        FIXED max[XYZ] = {
+                FIX16_MIN, FIX16_MIN, FIX16_MIN
+        };
+
+        for (uint32_t i = 0; i < count; i++, bvh_object++) {
+                for (uint32_t axis = 0; axis < XYZ; axis++) {
+                        const FIXED center = bvh_object->aabb.origin[axis];
+
+                        min[axis] = (center < min[axis]) ? center : min[axis];
+                        max[axis] = (center > max[axis]) ? center : max[axis];
+                }
+        }
+
+        uint32_t split_axis = X;
+
+        for (uint32_t axis = Y; axis < XYZ; axis++) {
+                if ((max[axis] - min[axis]) > (max[split_axis] - min[split_axis])) {
+                        split_axis = axis;
+                }
+        }
+
+        return split_axis;
+}
+
+/* Reorder the objects so that the object at median has every object with a
+ * smaller center along axis before it, and every object with a larger center
+ * after it */
+static void
+_objects_partition(g3d_bvh_object_t *objects, uint16_t count, uint16_t median,
+    uint32_t axis)
+{
+        int32_t left = 0;
+        int32_t right = count - 1;
+
+        while (left < right) {
+                const FIXED pivot = objects[(left + right) / 2].aabb.origin[axis];
+
+                int32_t i = left;
+                int32_t j = right;
+
+                while (i <= j) {
+                        while (objects[i].aabb.origin[axis] < pivot) {
+                                i++;
+                        }
+
+                        while (objects[j].aabb.origin[axis] > pivot) {
+                                j--;
+                        }
+
+                        if (i <= j) {
+                                const g3d_bvh_object_t swap_object = objects[i];
+
+                                objects[i] = objects[j];
+                                objects[j] = swap_object;
+
+                                i++;
+                                j--;
+                        }
+                }
+
+                if (median <= j) {
+                        right = j;
+                } else if (median >= i) {
+                        left = i;
+                } else {
+                        break;
+                }
+        }
+}
+
+/* Test the node against the clip planes that are set in plane_mask. Planes the
+ * node is entirely in front of are cleared from plane_mask, as they can't cull
+ * anything under the node either */
+static bool
+_node_cull_test(const g3d_bvh_node_t *node, uint16_t *plane_mask)
+{
+        const fix16_plane_t * const clip_planes =
+            (const fix16_plane_t *)__state->clip_planes;
+
+        for (uint32_t i = 0; i < CLIP_PLANE_COUNT; i++) {
+                if ((*plane_mask & (1 << i)) == 0) {
+                        continue;
+                }
+
+                const fix16_plane_t * const clip_plane = &clip_planes[i];
+
+                fix16_vec3_t near_point;
+                fix16_vec3_t far_point;
+
+                if (clip_plane->normal.x < FIX16(0.0f)) {
+                        near_point.x = node->min.x;
+                        far_point.x = node->max.x;
+                } else {
+                        near_point.x = node->max.x;
+                        far_point.x = node->min.x;
+                }
+
+                if (clip_plane->normal.y < FIX16(0.0f)) {
+                        near_point.y = node->min.y;
+                        far_point.y = node->max.y;
+                } else {
+                        near_point.y = node->max.y;
+                        far_point.y = node->min.y;
+                }
+
+                if (clip_plane->normal.z < FIX16(0.0f)) {
+                        near_point.z = node->min.z;
+                        far_point.z = node->max.z;
+                } else {
+                        near_point.z = node->max.z;
+                        far_point.z = node->min.z;
+                }
+
+                fix16_vec3_t cp;
+                fix16_vec3_sub(&near_point, &clip_plane->d, &cp);
+
+                if ((fix16_vec3_dot(&clip_plane->normal, &cp)) < FIX16(0.0f)) {
+                        return true;
+                }
+
+                fix16_vec3_sub(&far_point, &clip_plane->d, &cp);
+
+                if ((fix16_vec3_dot(&clip_plane->normal, &cp)) >= FIX16(0.0f)) {
+                        *plane_mask &= ~(1 << i);
+                }
+        }
+
+        return false;
+}
+
+static void
+_object_transform(const g3d_bvh_object_t *bvh_object)
+{
+        if (bvh_object->matrix == NULL) {
+                g3d_object_transform(bvh_object->object, bvh_object->xpdata_index);
+
+                return;
+        }
+
+        g3d_matrix_push(G3D_MATRIX_TYPE_MOVE_PTR); {
+                g3d_matrix_load(bvh_object->matrix);
+
+                g3d_object_transform(bvh_object->object, bvh_object->xpdata_index);
+        } g3d_matrix_pop();
+}
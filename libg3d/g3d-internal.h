@@ -8,12 +8,12 @@
 #include <stdint.h>
 
 #include "g3d.h"
+#include "vertex-pool-internal.h"
 
 #include <math.h>
 #include <vdp1/cmdt.h>
 
 #define MATRIX_STACK_MAX        (32)
-#define SORT_Z_RANGE            (256)
 #define PACKET_SIZE             (4096)
 #define VERTEX_POOL_SIZE        (1024)
 #define DISPLAY_LEVEL_COUNT     (8)
@@ -23,10 +23,34 @@
 
 #define CLIP_PLANE_COUNT        (6)
 
+/* Objects with fewer vertices than this are transformed by the master CPU
+ * alone, as splitting them across both CPUs costs more than it saves */
+#define SLAVE_VERTEX_COUNT_MIN  (64)
+
+/* Polygon sorting methods. The bucket sort only has SORT_Z_RANGE integer Z
+ * levels, while the radix sort orders on 16-bit keys holding Z in steps of
+ * 1/(2^(16 - SORT_Z_SHIFT)) */
+#define SORT_METHOD_BUCKET      (0)
+#define SORT_METHOD_RADIX       (1)
+
+#ifndef SORT_METHOD
+#define SORT_METHOD             SORT_METHOD_RADIX
+#endif /* !SORT_METHOD */
+
+#define SORT_Z_RANGE            (256)
+/* Shift that turns a 16.16 Z value into a 16-bit key, putting FAR_Z right past
+ * the largest key */
+#define SORT_Z_SHIFT            (10)
+#define SORT_RADIX_BITS         (8)
+#define SORT_RADIX_SIZE         (1 << SORT_RADIX_BITS)
+
 typedef enum {
-        FLAGS_NONE        = 0,
-        FLAGS_INITIALIZED = 1 << 0,
-        FLAGS_FOG_ENABLED = 1 << 1,
+        FLAGS_NONE          = 0,
+        FLAGS_INITIALIZED   = 1 << 0,
+        FLAGS_FOG_ENABLED   = 1 << 1,
+        FLAGS_SLAVE_ENABLED = 1 << 2,
+        FLAGS_OCCLUSION_ENABLED = 1 << 3,
+        FLAGS_TCACHE_ENABLED    = 1 << 4
 } flags_t;
 
 typedef enum {
@@ -35,25 +59,6 @@ typedef enum {
         LIST_FLAGS_ALLOCATED      = 1 << 1
 } list_flags_t;
 
-typedef enum {
-        CLIP_FLAGS_NONE   = 0,
-        CLIP_FLAGS_NEAR   = 1 << 0,
-        CLIP_FLAGS_FAR    = 1 << 1,
-        CLIP_FLAGS_LEFT   = 1 << 2,
-        CLIP_FLAGS_RIGHT  = 1 << 3,
-        CLIP_FLAGS_TOP    = 1 << 4,
-        CLIP_FLAGS_BOTTOM = 1 << 5,
-        CLIP_FLAGS_SIDE   = 1 << 6
-} clip_flags_t;
-
-typedef struct {
-        FIXED point_z;
-        int16_vec2_t screen;
-        clip_flags_t clip_flags;
-} __aligned(16) transform_proj_t;
-
-static_assert(sizeof(transform_proj_t) == 16);
-
 typedef struct {
         int16_t cached_sw_2;           /* Cached half of screen width */
         int16_t cached_sh_2;           /* Cached half of screen height */
@@ -69,9 +74,14 @@ typedef struct {
         vdp1_cmdt_orderlist_t *current_orderlist;
         vdp1_cmdt_orderlist_t *orderlist;
         vdp1_cmdt_t *current_cmdt;
+        vdp1_cmdt_t *baked_cmdts;      /* Command tables of the current XPDATA when baked */
+        FIXED object_z;                /* View space Z value of the object's cull sphere */
 } __aligned(16) transform_t;
 
+/* Hosts have larger pointers */
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(transform_t) == 64);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 typedef struct {
         /* XXX: This group of planes are output */
@@ -103,7 +113,53 @@ typedef struct {
         sort_single_t *head;
 } __aligned(4) sort_list_t;
 
-typedef void (*sort_iterate_fn_t)(const sort_single_t *);
+typedef struct {
+        /* Keys are the 16-bit Z key in the upper half, and the index of the
+         * packet in the lower half */
+        uint32_t *keys;
+        uint32_t *swap_keys;
+        void **packets;
+        /* One histogram per 8-bit digit of the Z key */
+        uint16_t (*histograms)[SORT_RADIX_SIZE];
+} sort_radix_t;
+
+typedef void (*sort_iterate_fn_t)(void *packet);
+typedef void (*sort_add_fn_t)(void *packet, FIXED z);
+
+typedef struct {
+        void *packet;
+        FIXED z;
+} __aligned(8) slave_sort_t;
+
+typedef enum {
+        SLAVE_PHASE_IDLE,
+        SLAVE_PHASE_VERTICES,   /* Vertex half transformed and clipped */
+        SLAVE_PHASE_POLYGONS    /* Polygon half processed */
+} slave_phase_t;
+
+/* Shared between both CPUs. Must only be accessed through the cache-through
+ * mirror */
+typedef struct {
+        slave_phase_t master_phase;
+        slave_phase_t slave_phase;
+        uint16_t sort_count;
+} slave_sync_t;
+
+typedef struct {
+        /* Slave CPU copy of the transform state */
+        transform_t * const transform;
+        /* Polygons the slave CPU added, to be merged into the sort by the master
+         * CPU */
+        slave_sort_t * const sort_pool;
+        volatile slave_sync_t * const sync;
+
+        MATRIX matrix;
+        const POINT *points;
+        const void *polygons;
+        uint16_t vertex_offset;
+        uint16_t polygon_offset;
+        uint16_t sort_count;
+} slave_t;
 
 typedef struct {
         list_flags_t flags;
@@ -124,10 +180,15 @@ typedef struct {
         MATRIX * const clip_camera;
         clip_planes_t * const clip_planes;
         MATRIX * const matrices;
+#if SORT_METHOD == SORT_METHOD_BUCKET
         sort_list_t * const sort_list;
         sort_single_t * const sort_single_pool;
+#else
+        sort_radix_t * const sort_radix;
+#endif /* SORT_METHOD == SORT_METHOD_BUCKET */
         list_t * const tlist;
         list_t * const plist;
+        slave_t * const slave;
 } __aligned(16) state_t;
 
 extern state_t * const __state;
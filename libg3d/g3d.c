@@ -22,6 +22,8 @@
 #include "g3d-internal.h"
 
 extern void __fog_init(void);
+extern void __lod_init(void);
+extern void __quality_init(void);
 extern void __matrix_init(void);
 extern void __plist_init(void);
 extern void __sort_init(void);
@@ -29,6 +31,7 @@ extern void __tlist_init(void);
 extern void __transform_init(void);
 
 static void _perspective_calculate(FIXED fov_angle);
+static void _far_clamp(FIXED far);
 static void _frustrum_nf_clip_planes_calculate(void);
 static void _frustum_clip_planes_calculate(FIXED fov_angle);
 
@@ -44,10 +47,14 @@ g3d_init(void)
 
         (void)memset(__state->info, 0, sizeof(g3d_info_t));
 
+        __state->info->far = FAR_Z;
+
         g3d_display_level_set(0);
         g3d_perspective_set(DEGtoANG(90.0f));
 
         __fog_init();
+        __lod_init();
+        __quality_init();
         __matrix_init();
         __plist_init();
         __sort_init();
@@ -64,7 +71,17 @@ g3d_display_level_set(uint16_t level)
 
         info->level = level & (DISPLAY_LEVEL_COUNT - 1);
         info->near = info->view_distance >> info->level;
-        info->far = FAR_Z;
+
+        /* The near plane moved, and may now be past the far plane */
+        _far_clamp(info->far);
+
+        _frustrum_nf_clip_planes_calculate();
+}
+
+void
+g3d_far_set(FIXED far)
+{
+        _far_clamp(far);
 
         _frustrum_nf_clip_planes_calculate();
 }
@@ -86,6 +103,8 @@ g3d_perspective_set(ANGLE fov)
         info->fov = fov;
 
         _perspective_calculate(fov_angle);
+        _far_clamp(info->far);
+        _frustrum_nf_clip_planes_calculate();
         _frustum_clip_planes_calculate(fov_angle);
 }
 
@@ -154,6 +173,15 @@ _perspective_calculate(FIXED fov_angle)
         info->near = info->view_distance >> info->level;
 }
 
+static void
+_far_clamp(FIXED far)
+{
+        g3d_info_t * const info = __state->info;
+
+        /* Polygons are sorted on Z values up to FAR_Z */
+        info->far = clamp(far, info->near, FAR_Z);
+}
+
 static void
 _frustrum_nf_clip_planes_calculate(void)
 {
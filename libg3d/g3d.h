@@ -18,6 +18,9 @@
 #include <g3d/sgl.h>
 #include <g3d/perf.h>
 #include <g3d/s3d.h>
+#include <g3d/bvh.h>
+#include <g3d/mesh.h>
+#include <g3d/skeleton.h>
 
 extern void g3d_init(void);
 
@@ -27,6 +30,10 @@ extern void g3d_tlist_set(TEXTURE *textures, Uint16 count);
 
 extern void g3d_plist_set(PALETTE *palettes, Uint16 count);
 
+extern void g3d_tcache_set(const g3d_texture_source_t *sources,
+    uint32_t slot_size);
+extern void g3d_tcache_stats_get(g3d_tcache_stats_t *stats);
+
 extern void g3d_matrix_identity(MATRIX *matrix);
 extern void g3d_matrix_push(g3d_matrix_type_t matrix_type);
 extern void g3d_matrix_pop(void);
@@ -44,11 +51,26 @@ extern void g3d_matrix_transpose_in(MATRIX *matrix);
 extern void g3d_matrix_transpose(void);
 
 extern void g3d_display_level_set(uint16_t level);
+extern void g3d_far_set(FIXED far);
 extern void g3d_perspective_set(ANGLE fov);
 extern void g3d_frustum_camera_set(const POINT position, const VECTOR rx,
     const VECTOR ry, const VECTOR rz);
 extern void g3d_info_get(g3d_info_t *info);
 
+extern void g3d_slave_enable(void);
+extern void g3d_slave_disable(void);
+
+extern void g3d_occlusion_enable(void);
+extern void g3d_occlusion_disable(void);
+
+extern void g3d_lod_hysteresis_set(FIXED hysteresis);
+extern void g3d_lod_bias_set(FIXED bias);
+extern FIXED g3d_lod_bias_get(void);
+extern void g3d_lod_budget_set(uint32_t ticks);
+
+extern void g3d_quality_set(const g3d_quality_t *quality);
+extern void g3d_quality_status_get(g3d_quality_status_t *status);
+
 extern void g3d_fog_set(const g3d_fog_t *fog);
 extern void g3d_fog_limits_set(FIXED start_z, FIXED end_z);
 
@@ -57,6 +79,8 @@ extern void g3d_start(vdp1_cmdt_orderlist_t *orderlist,
 extern void g3d_finish(g3d_results_t *results);
 
 extern Uint16 g3d_object_polycount_get(const g3d_object_t *object);
+extern uint16_t g3d_object_bake_count_get(const g3d_object_t *object);
+extern void g3d_object_bake(g3d_object_t *object, vdp1_cmdt_t *cmdts);
 extern void g3d_object_transform(const g3d_object_t *object,
     uint16_t xpdata_index);
 
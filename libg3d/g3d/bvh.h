@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _G3D_BVH_H_
+#define _G3D_BVH_H_
+
+#include <stdint.h>
+
+#include <fix16.h>
+
+#include <g3d/types.h>
+#include <g3d/sgl.h>
+
+typedef struct g3d_bvh_object {
+        const g3d_object_t *object;
+        uint16_t xpdata_index;
+        /* Matrix loaded onto the matrix stack before the object is
+         * transformed. When NULL, the current top matrix is used */
+        const MATRIX *matrix;
+        /* Bounds of the object in world space */
+        g3d_cull_aabb_t aabb;
+} g3d_bvh_object_t;
+
+typedef struct g3d_bvh_node {
+        fix16_vec3_t min;
+        fix16_vec3_t max;
+        /* Index of the left child node, the right child node follows it. Zero
+         * when the node is a leaf */
+        uint16_t child;
+        /* Range of objects under this node */
+        uint16_t first;
+        uint16_t count;
+} g3d_bvh_node_t;
+
+typedef struct g3d_bvh {
+        g3d_bvh_object_t *objects;
+        g3d_bvh_node_t *nodes;
+        uint16_t object_count;
+        uint16_t node_count;
+} g3d_bvh_t;
+
+/* Node indices are 16-bit, so the most objects a tree can be built over */
+#define G3D_BVH_OBJECT_COUNT_MAX        ((UINT16_MAX + 1) / 2)
+
+extern uint32_t g3d_bvh_node_count_get(uint16_t object_count);
+extern void g3d_bvh_build(g3d_bvh_t *bvh, g3d_bvh_object_t *objects,
+    uint16_t object_count, g3d_bvh_node_t *nodes);
+extern void g3d_bvh_transform(const g3d_bvh_t *bvh);
+
+#endif /* !_G3D_BVH_H_ */
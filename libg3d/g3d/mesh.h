@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _G3D_MESH_H_
+#define _G3D_MESH_H_
+
+#include <sys/cdefs.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <g3d/sgl.h>
+
+/* Size in bytes of a transformed vertex in the vertex pool */
+#define G3D_MESH_VERTEX_STRIDE  (16)
+
+/* Vertex offsets are multiples of G3D_MESH_VERTEX_STRIDE, so the lower 4 bits
+ * of each are zero. The first offset holds the polygon's Z sort method in its
+ * lower 2 bits, and has to be masked with G3D_MESH_OFFSET_MASK before use */
+#define G3D_MESH_SORT_MASK      (0x0003)
+#define G3D_MESH_OFFSET_MASK    (0xFFF0)
+
+/* Rather than per-polygon Z weights, a polygon stores the Z sort method of its
+ * ATTR (SORT_BFR, SORT_MIN, SORT_MAX, or SORT_CEN), which is all the weighting
+ * SGL polygons use: the nearest, the farthest, or the average of the four
+ * vertices. Sorting the polygon then needs no fetch of its ATTR */
+typedef struct g3d_mesh_polygon {
+        /* Byte offsets of the polygon's vertices into the vertex pool. The
+         * first also holds the Z sort method, see G3D_MESH_SORT_MASK */
+        uint16_t offsets[4];
+} g3d_mesh_polygon_t;
+
+static_assert(sizeof(g3d_mesh_polygon_t) == 8);
+
+/* Same layout as XPDATA, except for the polygons. Polygons are ordered so that
+ * neighboring polygons share vertices, and vertices are ordered by first use,
+ * so that the vertex pool is walked mostly in order. Vertices that no polygon
+ * uses are dropped.
+ *
+ * Set G3D_OBJECT_FLAGS_MESH on the object for g3d_object_transform() to treat
+ * its XPDATAs as meshes */
+typedef struct g3d_mesh {
+        POINT *points;
+        uint32_t point_count;
+        g3d_mesh_polygon_t *polygons;
+        uint32_t polygon_count;
+        ATTR *attributes;
+        /* Vertex normals, in the same order as points. NULL when the XPDATA
+         * has none */
+        VECTOR *normals;
+} __packed g3d_mesh_t;
+
+static_assert(sizeof(g3d_mesh_t) == sizeof(XPDATA));
+
+extern size_t g3d_mesh_size_get(const XPDATA *xpdata);
+extern size_t g3d_mesh_work_size_get(const XPDATA *xpdata);
+extern void g3d_mesh_build(g3d_mesh_t *mesh, const XPDATA *xpdata,
+    void *buffer, void *work);
+extern void g3d_mesh_patch(g3d_mesh_t *mesh, void *base);
+
+#endif /* !_G3D_MESH_H_ */
@@ -11,6 +11,10 @@
 
 #include <g3d/sgl.h>
 
+/* The sizes below are those of the S3D file, where pointers are 32-bit. They're
+ * only checked when pointers are 32-bit, as libg3d is also built on hosts to be
+ * tested (tools/g3d-scene-test) */
+
 typedef union g3d_s3d_texture {
         struct {
                 /* Flag to denote end of list */
@@ -21,7 +25,9 @@ typedef union g3d_s3d_texture {
         union g3d_s3d_texture *next;
 } __packed g3d_s3d_texture_t;
 
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(g3d_s3d_texture_t) == 4);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 typedef union g3d_s3d_palette {
         struct {
@@ -33,7 +39,9 @@ typedef union g3d_s3d_palette {
         union g3d_s3d_palette *next;
 } __packed g3d_s3d_palette_t;
 
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(g3d_s3d_palette_t) == 4);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 typedef struct {
         char sig[4];
@@ -53,7 +61,9 @@ typedef struct {
         void *eof;
 } __packed g3d_s3d_t;
 
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(g3d_s3d_t) == 44);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 typedef struct {
         XPDATA xpdata;
@@ -65,7 +75,9 @@ typedef struct {
         uint32_t gouraud_table_count;
 } __packed g3d_s3d_object_t;
 
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(g3d_s3d_object_t) == 40);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 typedef struct {
         void *texture;
@@ -75,7 +87,9 @@ typedef struct {
         vdp2_cram_t *cram;
 } g3d_s3d_memory_usage_t;
 
+#if UINTPTR_MAX == UINT32_MAX
 static_assert(sizeof(g3d_s3d_memory_usage_t) == 16);
+#endif /* UINTPTR_MAX == UINT32_MAX */
 
 extern void g3d_s3d_patch(g3d_s3d_t *s3d, g3d_s3d_memory_usage_t *memory_usage);
 
@@ -7,6 +7,8 @@
 
 #include <sys/cdefs.h>
 
+#include <stdint.h>
+
 /* XXX: Hack: There is a strange compilation warning with ATTRIBUTE */
 #pragma GCC diagnostic ignored "-Wpedantic"
 
@@ -148,8 +150,8 @@ typedef unsigned char Uint8;
 typedef signed char Sint8;
 typedef unsigned short Uint16;
 typedef signed short Sint16;
-typedef unsigned long Uint32;
-typedef signed long Sint32;
+typedef uint32_t Uint32;
+typedef int32_t Sint32;
 typedef int Int;
 typedef int Bool;
 
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _G3D_SKELETON_H_
+#define _G3D_SKELETON_H_
+
+#include <stdint.h>
+
+#include <fix16.h>
+
+#include <g3d/types.h>
+#include <g3d/sgl.h>
+
+/* Parent index of root bones */
+#define G3D_BONE_PARENT_NONE    (0xFFFF)
+
+typedef struct g3d_bone {
+        /* Index of the parent bone. Parent bones must come before their
+         * children */
+        uint16_t parent;
+        uint16_t xpdata_index;
+        /* Object drawn with the bone's matrix. When NULL, nothing is drawn */
+        const g3d_object_t *object;
+} g3d_bone_t;
+
+/* Pose of a bone relative to its parent. The rotation is applied in the same
+ * order as g3d_matrix_rot_load() */
+typedef struct g3d_bone_key {
+        FIXED translation[XYZ];
+        ANGLE rotation[XYZ];
+} g3d_bone_key_t;
+
+typedef struct g3d_animation {
+        /* One key per bone for each frame, the keys of frame 0 first */
+        const g3d_bone_key_t *keys;
+        uint16_t frame_count;
+} g3d_animation_t;
+
+typedef struct g3d_skeleton {
+        const g3d_bone_t *bones;
+        uint16_t bone_count;
+        /* One matrix per bone, set by g3d_skeleton_evaluate() */
+        MATRIX *matrices;
+} g3d_skeleton_t;
+
+extern void g3d_skeleton_evaluate(g3d_skeleton_t *skeleton,
+    const g3d_animation_t *animation, FIXED frame);
+extern void g3d_skeleton_transform(const g3d_skeleton_t *skeleton);
+
+#endif /* !_G3D_SKELETON_H_ */
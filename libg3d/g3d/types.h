@@ -19,6 +19,9 @@
 
 typedef struct g3d_object g3d_object_t;
 
+/* Number of levels of detail counted in g3d_results_t */
+#define G3D_LOD_LEVEL_COUNT     (8)
+
 typedef enum g3d_matrix_type {
         G3D_MATRIX_TYPE_PUSH     = 0,
         G3D_MATRIX_TYPE_MOVE_PTR = 1
@@ -39,7 +42,11 @@ typedef enum g3d_flags {
         /// Cull object using an AABB
         G3D_OBJECT_FLAGS_CULL_AABB    = 1 << 5,
         /// Exclude from fog calculation
-        G3D_OBJECT_FLAGS_FOG_EXCLUDE  = 1 << 6
+        G3D_OBJECT_FLAGS_FOG_EXCLUDE  = 1 << 6,
+        /// XPDATAs are g3d_mesh_t
+        G3D_OBJECT_FLAGS_MESH         = 1 << 7,
+        /// Hide objects behind this object when occlusion culling is enabled
+        G3D_OBJECT_FLAGS_OCCLUDER     = 1 << 8
 } g3d_flags_t;
 
 typedef struct g3d_info {
@@ -69,13 +76,36 @@ typedef struct g3d_fog {
 typedef struct g3d_results {
         uint16_t object_count;
         uint16_t polygon_count;
-
+        /* Objects submitted and rejected by g3d_bvh_transform() */
+        uint16_t bvh_visible_count;
+        uint16_t bvh_culled_count;
+        /* Objects, and their polygons, hidden behind occluders */
+        uint16_t occluded_object_count;
+        uint16_t occluded_polygon_count;
+        /* Number of objects drawn at each level of detail. Levels past the
+         * last count toward the last */
+        uint16_t lod_counts[G3D_LOD_LEVEL_COUNT];
+        /* Scale applied to view space Z values when selecting levels */
+        FIXED lod_bias;
+
+        /* From g3d_start() up to the VDP1 transfer in g3d_finish() */
+        perf_counter_t perf_frame;
         perf_counter_t perf_sort;
         perf_counter_t perf_dma;
         perf_counter_t perf_aabb_culling;
         perf_counter_t perf_transform;
         perf_counter_t perf_clipping;
         perf_counter_t perf_polygon_process;
+
+        /* Only updated when the slave CPU is enabled. The counters above are
+         * then for the master CPU's share of the work */
+        perf_counter_t perf_slave_transform;
+        perf_counter_t perf_slave_clipping;
+        perf_counter_t perf_slave_polygon_process;
+        /* Time the master CPU spent waiting on the slave CPU, and merging the
+         * slave CPU's polygons into the sort */
+        perf_counter_t perf_slave_wait;
+        perf_counter_t perf_slave_merge;
 } g3d_results_t;
 
 typedef struct g3d_cull_sphere {
@@ -88,6 +118,67 @@ typedef struct g3d_cull_aabb {
         FIXED length[XYZ];
 } g3d_cull_aabb_t;
 
+typedef struct g3d_quality {
+        /* Ticks the frame, including the VDP1 transfer, should fit in */
+        uint32_t target_ticks;
+        /* Range the far plane distance is kept in */
+        FIXED far_min;
+        FIXED far_max;
+        /* Lowest display level used */
+        uint16_t display_level_min;
+} g3d_quality_t;
+
+typedef enum g3d_quality_action {
+        G3D_QUALITY_ACTION_NONE,
+        G3D_QUALITY_ACTION_FAR_DECREASE,
+        G3D_QUALITY_ACTION_FAR_INCREASE,
+        G3D_QUALITY_ACTION_LEVEL_DECREASE,
+        G3D_QUALITY_ACTION_LEVEL_INCREASE
+} g3d_quality_action_t;
+
+typedef struct g3d_quality_status {
+        /* Ticks the last frame took, including the last VDP1 transfer */
+        uint32_t load_ticks;
+        /* Decision taken on the last frame */
+        g3d_quality_action_t action;
+        FIXED far;
+        FIXED fog_start_z;
+        uint16_t display_level;
+        /* Consecutive frames over target, and comfortably under target */
+        uint16_t over_count;
+        uint16_t under_count;
+} g3d_quality_status_t;
+
+typedef struct g3d_texture_source {
+        /* Texture data to be copied to VDP1 VRAM */
+        const void *data;
+        uint32_t size;
+} g3d_texture_source_t;
+
+typedef struct g3d_tcache_stats {
+        /* Textures used that were already resident, and that weren't */
+        uint32_t hit_count;
+        uint32_t miss_count;
+        /* Textures freed to make room. A high count compared to the miss count
+         * means textures are thrashing */
+        uint32_t eviction_count;
+        /* Textures that couldn't be made resident, as every slot was in use
+         * in the same frame */
+        uint32_t overflow_count;
+        /* Textured polygons left out, as their texture wasn't resident */
+        uint32_t skipped_polygon_count;
+        uint16_t resident_count;
+        uint16_t slot_count;
+} g3d_tcache_stats_t;
+
+typedef struct g3d_lod {
+        /* View space Z value past which each XPDATA is replaced by the next
+         * one. There are xpdata_count - 1 increasing distances */
+        const FIXED *distances;
+        /* Level selected the last time the object was transformed */
+        uint16_t level;
+} g3d_lod_t;
+
 struct g3d_object {
         g3d_flags_t flags;
 
@@ -97,6 +188,13 @@ struct g3d_object {
         void *cull_shape;
 
         void *user_data;
+
+        /* Command tables set by g3d_object_bake() */
+        vdp1_cmdt_t *baked_cmdts;
+
+        /* When set, the XPDATA is selected by distance, and the index passed
+         * to g3d_object_transform() is ignored */
+        g3d_lod_t *lod;
 };
 
 #endif /* !_G3D_TYPES_H_ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+#define LOD_HYSTERESIS_DEFAULT  FIX16(1 / 16.0f)
+#define LOD_BIAS_MIN            FIX16(1.0f)
+#define LOD_BIAS_MAX            FIX16(4.0f)
+#define LOD_BIAS_STEP           FIX16(1 / 16.0f)
+
+static struct {
+        FIXED hysteresis;
+        FIXED bias;
+        /* Ticks the frame may take before distances are scaled by the bias.
+         * Zero when the bias isn't adjusted automatically */
+        uint32_t budget_ticks;
+} _state;
+
+void
+__lod_init(void)
+{
+        _state.hysteresis = LOD_HYSTERESIS_DEFAULT;
+        _state.bias = LOD_BIAS_MIN;
+        _state.budget_ticks = 0;
+}
+
+void
+g3d_lod_hysteresis_set(FIXED hysteresis)
+{
+        _state.hysteresis = hysteresis;
+}
+
+void
+g3d_lod_bias_set(FIXED bias)
+{
+        _state.bias = clamp(bias, LOD_BIAS_MIN, LOD_BIAS_MAX);
+}
+
+FIXED
+g3d_lod_bias_get(void)
+{
+        return _state.bias;
+}
+
+void
+g3d_lod_budget_set(uint32_t ticks)
+{
+        _state.budget_ticks = ticks;
+}
+
+/* Move the bias one step toward coarser levels when the frame went over
+ * budget, and one step back once it is comfortably under budget */
+void
+__lod_update(void)
+{
+        if (_state.budget_ticks == 0) {
+                return;
+        }
+
+        const uint32_t ticks = __state->results->perf_frame.ticks;
+        const uint32_t budget_ticks = _state.budget_ticks;
+
+        if (ticks > budget_ticks) {
+                g3d_lod_bias_set(_state.bias + LOD_BIAS_STEP);
+        } else if (ticks < (budget_ticks - (budget_ticks / 8))) {
+                g3d_lod_bias_set(_state.bias - LOD_BIAS_STEP);
+        }
+}
+
+/* Select the level to use at view space Z value z. A level is only left once z
+ * is past its threshold by a fraction of the threshold, so that objects sitting
+ * right at a threshold don't switch levels every frame */
+uint16_t
+__lod_select(g3d_lod_t *lod, uint16_t level_count, FIXED z)
+{
+        assert(lod != NULL);
+        assert(level_count > 0);
+
+        const FIXED * const distances = lod->distances;
+        const FIXED biased_z = fix16_mul(z, _state.bias);
+
+        uint16_t level = lod->level;
+
+        if (level >= level_count) {
+                level = level_count - 1;
+        }
+
+        while (level < (level_count - 1)) {
+                const FIXED distance = distances[level];
+
+                if (biased_z <= (distance + fix16_mul(distance, _state.hysteresis))) {
+                        break;
+                }
+
+                level++;
+        }
+
+        while (level > 0) {
+                const FIXED distance = distances[level - 1];
+
+                if (biased_z >= (distance - fix16_mul(distance, _state.hysteresis))) {
+                        break;
+                }
+
+                level--;
+        }
+
+        lod->level = level;
+
+        return level;
+}
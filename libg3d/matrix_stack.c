@@ -131,11 +131,10 @@ g3d_matrix_trans_reset(void)
         top_matrix[M23] = 0;
 }
 
+/* Set the rotation part of the matrix, leaving the translation as is */
 void
-g3d_matrix_rot_load(const ANGLE rx, const ANGLE ry, const ANGLE rz)
+__matrix_rot_set(FIXED *matrix, const ANGLE rx, const ANGLE ry, const ANGLE rz)
 {
-        FIXED * const top_matrix = _state.top_matrix;
-
         const int32_t rx_bradians = fix16_int16_muls(rx, FIX16(FIX16_LUT_SIN_TABLE_COUNT));
         const FIXED sx = fix16_bradians_sin(rx_bradians);
         const FIXED cx = fix16_bradians_cos(rx_bradians);
@@ -151,15 +150,21 @@ g3d_matrix_rot_load(const ANGLE rx, const ANGLE ry, const ANGLE rz)
         const FIXED sxsy = fix16_mul(sx, sy);
         const FIXED cxsy = fix16_mul(cx, sy);
 
-        top_matrix[M00] = fix16_mul(   cy, cz);
-        top_matrix[M01] = fix16_mul( sxsy, cz) + fix16_mul(cx, sz);
-        top_matrix[M02] = fix16_mul(-cxsy, cz) + fix16_mul(sx, sz);
-        top_matrix[M10] = fix16_mul(  -cy, sz);
-        top_matrix[M11] = fix16_mul(-sxsy, sz) + fix16_mul(cx, cz);
-        top_matrix[M12] = fix16_mul( cxsy, sz) + fix16_mul(sx, cz);
-        top_matrix[M20] = sy;
-        top_matrix[M21] = fix16_mul(  -sx, cy);
-        top_matrix[M22] = fix16_mul(   cx, cy);
+        matrix[M00] = fix16_mul(   cy, cz);
+        matrix[M01] = fix16_mul( sxsy, cz) + fix16_mul(cx, sz);
+        matrix[M02] = fix16_mul(-cxsy, cz) + fix16_mul(sx, sz);
+        matrix[M10] = fix16_mul(  -cy, sz);
+        matrix[M11] = fix16_mul(-sxsy, sz) + fix16_mul(cx, cz);
+        matrix[M12] = fix16_mul( cxsy, sz) + fix16_mul(sx, cz);
+        matrix[M20] = sy;
+        matrix[M21] = fix16_mul(  -sx, cy);
+        matrix[M22] = fix16_mul(   cx, cy);
+}
+
+void
+g3d_matrix_rot_load(const ANGLE rx, const ANGLE ry, const ANGLE rz)
+{
+        __matrix_rot_set(_state.top_matrix, rx, ry, rz);
 }
 
 void
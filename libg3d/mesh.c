@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+#define PATCH_ADDRESS(base, x) ((void *)((uintptr_t)(base) + (uintptr_t)(x)))
+
+#define VERTEX_UNUSED           (0xFFFF)
+
+static_assert(G3D_MESH_VERTEX_STRIDE == sizeof(transform_proj_t));
+static_assert((G3D_MESH_SORT_MASK & G3D_MESH_OFFSET_MASK) == 0);
+static_assert(G3D_MESH_SORT_MASK < G3D_MESH_VERTEX_STRIDE);
+static_assert(offsetof(g3d_mesh_t, points) == offsetof(XPDATA, pntbl));
+static_assert(offsetof(g3d_mesh_t, point_count) == offsetof(XPDATA, nbPoint));
+static_assert(offsetof(g3d_mesh_t, polygon_count) == offsetof(XPDATA, nbPolygon));
+static_assert(offsetof(g3d_mesh_t, attributes) == offsetof(XPDATA, attbl));
+
+static uint16_t _vertices_first_use_order(const XPDATA *xpdata,
+    const uint16_t *polygon_order, uint16_t *remap);
+static uint16_t _polygon_key_get(const POLYGON *polygon,
+    const uint16_t *remap);
+static void _polygons_order(const XPDATA *xpdata, const uint16_t *remap,
+    uint16_t *histogram, uint16_t *polygon_order);
+
+size_t
+g3d_mesh_size_get(const XPDATA *xpdata)
+{
+        assert(xpdata != NULL);
+
+        size_t size;
+
+        size = xpdata->nbPoint * sizeof(POINT);
+        size += xpdata->nbPolygon * sizeof(ATTR);
+        size += xpdata->nbPolygon * sizeof(g3d_mesh_polygon_t);
+
+        if (xpdata->vntbl != NULL) {
+                size += xpdata->nbPoint * sizeof(VECTOR);
+        }
+
+        return size;
+}
+
+/* Size of the scratch buffer g3d_mesh_build() needs. It holds two remap
+ * tables, a histogram, and the order of the polygons */
+size_t
+g3d_mesh_work_size_get(const XPDATA *xpdata)
+{
+        assert(xpdata != NULL);
+
+        return ((3 * xpdata->nbPoint) + 1 + xpdata->nbPolygon) * sizeof(uint16_t);
+}
+
+/* The work buffer is g3d_mesh_work_size_get() bytes, 2-byte aligned, and is
+ * only used during the call */
+void
+g3d_mesh_build(g3d_mesh_t *mesh, const XPDATA *xpdata, void *buffer,
+    void *work)
+{
+        assert(mesh != NULL);
+        assert(xpdata != NULL);
+        assert(buffer != NULL);
+        assert(work != NULL);
+        assert(((uintptr_t)work & 1) == 0);
+        /* Otherwise, the byte offsets into the vertex pool don't fit */
+        assert(xpdata->nbPoint <= VERTEX_POOL_SIZE);
+        assert(xpdata->nbPolygon < PACKET_SIZE);
+
+        const uint16_t point_count = xpdata->nbPoint;
+        const uint16_t polygon_count = xpdata->nbPolygon;
+
+        /* The first remap table, the second remap table, the histogram, and
+         * the order of the polygons */
+        uint16_t * const remap = work;
+        uint16_t * const final_remap = &remap[point_count];
+        uint16_t * const histogram = &final_remap[point_count];
+        uint16_t * const polygon_order = &histogram[point_count + 1];
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                polygon_order[i] = i;
+        }
+
+        /* Number the vertices in the order they're first used, group the
+         * polygons by the first of their vertices to be used, then number the
+         * vertices again in the order the grouped polygons use them */
+        (void)_vertices_first_use_order(xpdata, polygon_order, remap);
+
+        _polygons_order(xpdata, remap, histogram, polygon_order);
+
+        const uint16_t used_count =
+            _vertices_first_use_order(xpdata, polygon_order, final_remap);
+
+        mesh->point_count = used_count;
+        mesh->polygon_count = polygon_count;
+
+        mesh->points = buffer;
+        mesh->normals = NULL;
+
+        void *next = &mesh->points[used_count];
+
+        if (xpdata->vntbl != NULL) {
+                mesh->normals = next;
+
+                next = &mesh->normals[used_count];
+        }
+
+        mesh->attributes = next;
+        mesh->polygons = (g3d_mesh_polygon_t *)&mesh->attributes[polygon_count];
+
+        for (uint32_t i = 0; i < point_count; i++) {
+                const uint16_t vertex = final_remap[i];
+
+                if (vertex == VERTEX_UNUSED) {
+                        continue;
+                }
+
+                (void)memcpy(mesh->points[vertex], xpdata->pntbl[i], sizeof(POINT));
+
+                if (mesh->normals != NULL) {
+                        (void)memcpy(mesh->normals[vertex], xpdata->vntbl[i],
+                            sizeof(VECTOR));
+                }
+        }
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                const uint16_t polygon_index = polygon_order[i];
+
+                const POLYGON * const polygon = &xpdata->pltbl[polygon_index];
+                const ATTR * const attr = &xpdata->attbl[polygon_index];
+
+                g3d_mesh_polygon_t * const mesh_polygon = &mesh->polygons[i];
+
+                for (uint32_t j = 0; j < 4; j++) {
+                        mesh_polygon->offsets[j] =
+                            final_remap[polygon->Vertices[j]] * G3D_MESH_VERTEX_STRIDE;
+                }
+
+                /* Same bits as _polygon_process() takes from the ATTR of a
+                 * polygon that isn't in a mesh */
+                mesh_polygon->offsets[0] |= attr->sort & G3D_MESH_SORT_MASK;
+
+                mesh->attributes[i] = *attr;
+        }
+}
+
+void
+g3d_mesh_patch(g3d_mesh_t *mesh, void *base)
+{
+        assert(mesh != NULL);
+
+        mesh->points = PATCH_ADDRESS(base, mesh->points);
+        mesh->polygons = PATCH_ADDRESS(base, mesh->polygons);
+        mesh->attributes = PATCH_ADDRESS(base, mesh->attributes);
+
+        if (mesh->normals != NULL) {
+                mesh->normals = PATCH_ADDRESS(base, mesh->normals);
+        }
+}
+
+/* Number the vertices in the order the polygons, in polygon_order, first use
+ * them. Vertices that aren't used are marked as such. Returns the number of
+ * vertices used */
+static uint16_t
+_vertices_first_use_order(const XPDATA *xpdata, const uint16_t *polygon_order,
+    uint16_t *remap)
+{
+        uint16_t used_count = 0;
+
+        for (uint32_t i = 0; i < xpdata->nbPoint; i++) {
+                remap[i] = VERTEX_UNUSED;
+        }
+
+        for (uint32_t i = 0; i < xpdata->nbPolygon; i++) {
+                const POLYGON * const polygon = &xpdata->pltbl[polygon_order[i]];
+
+                for (uint32_t j = 0; j < 4; j++) {
+                        const uint16_t vertex = polygon->Vertices[j];
+
+                        assert(vertex < xpdata->nbPoint);
+
+                        if (remap[vertex] == VERTEX_UNUSED) {
+                                remap[vertex] = used_count;
+
+                                used_count++;
+                        }
+                }
+        }
+
+        return used_count;
+}
+
+/* The first of the polygon's vertices to be used */
+static uint16_t
+_polygon_key_get(const POLYGON *polygon, const uint16_t *remap)
+{
+        uint16_t key = remap[polygon->Vertices[0]];
+
+        for (uint32_t i = 1; i < 4; i++) {
+                const uint16_t vertex_key = remap[polygon->Vertices[i]];
+
+                key = (vertex_key < key) ? vertex_key : key;
+        }
+
+        return key;
+}
+
+/* Stable counting sort of the polygons by the first of their vertices to be
+ * used. Polygons that share a vertex end up next to each other */
+static void
+_polygons_order(const XPDATA *xpdata, const uint16_t *remap,
+    uint16_t *histogram, uint16_t *polygon_order)
+{
+        const uint16_t point_count = xpdata->nbPoint;
+        const uint16_t polygon_count = xpdata->nbPolygon;
+
+        (void)memset(histogram, 0, (point_count + 1) * sizeof(uint16_t));
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                histogram[_polygon_key_get(&xpdata->pltbl[i], remap) + 1]++;
+        }
+
+        for (uint32_t i = 0; i < point_count; i++) {
+                histogram[i + 1] += histogram[i];
+        }
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                const uint16_t key = _polygon_key_get(&xpdata->pltbl[i], remap);
+
+                polygon_order[histogram[key]] = i;
+                histogram[key]++;
+        }
+}
@@ -0,0 +1,47 @@
+/*
+ * No copyright.
+ */
+
+#ifndef _G3D_OCCLUSION_INTERNAL_H_
+#define _G3D_OCCLUSION_INTERNAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <fix16.h>
+
+#include <g3d/sgl.h>
+
+#include "vertex-pool-internal.h"
+
+/* Kept apart from g3d-internal.h, so that the occlusion tiles can be built on
+ * their own, such as on a host */
+
+#define OCCLUSION_TILE_SHIFT    (4)
+#define OCCLUSION_TILE_SIZE     (1 << OCCLUSION_TILE_SHIFT)
+
+/* Enough tiles for a 704x512 screen */
+#define OCCLUSION_GRID_WIDTH    (704 / OCCLUSION_TILE_SIZE)
+#define OCCLUSION_GRID_HEIGHT   (512 / OCCLUSION_TILE_SIZE)
+
+/* Tiles no occluder fully covers */
+#define OCCLUSION_TILE_Z_EMPTY  (FIX16_MAX)
+
+typedef struct {
+        uint16_t width;
+        uint16_t height;
+        int16_t origin_x;
+        int16_t origin_y;
+        /* Farthest Z value of the nearest occluder polygon that fully covers
+         * each tile. Anything farther than that in the tile is hidden */
+        FIXED tiles[OCCLUSION_GRID_HEIGHT][OCCLUSION_GRID_WIDTH];
+} occlusion_grid_t;
+
+extern void __occlusion_grid_clear(occlusion_grid_t *grid, int16_t sw_2,
+    int16_t sh_2);
+extern void __occlusion_grid_polygon_add(occlusion_grid_t *grid,
+    const transform_proj_t * const *polygon);
+extern bool __occlusion_grid_test(const occlusion_grid_t *grid,
+    const int16_t *min, const int16_t *max, FIXED near_z);
+
+#endif /* !_G3D_OCCLUSION_INTERNAL_H_ */
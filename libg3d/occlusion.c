@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+
+#include <cpu/divu.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+#include "occlusion-internal.h"
+
+static occlusion_grid_t _grid;
+
+static bool _screen_bounds_calculate(const transform_t * const trans,
+    int16_t *min, int16_t *max, FIXED *near_z);
+
+void
+g3d_occlusion_enable(void)
+{
+        __state->flags |= FLAGS_OCCLUSION_ENABLED;
+}
+
+void
+g3d_occlusion_disable(void)
+{
+        __state->flags &= ~FLAGS_OCCLUSION_ENABLED;
+}
+
+/* Clear the tiles that cover the screen */
+void
+__occlusion_clear(void)
+{
+        const transform_t * const trans = __state->transform;
+
+        __occlusion_grid_clear(&_grid, trans->cached_sw_2, trans->cached_sh_2);
+}
+
+/* Rasterize the polygons of the current object, whose vertices have been
+ * transformed. The polygon count is passed in, as the transform state only
+ * holds the master CPU's share when the object is split across both CPUs */
+void
+__occlusion_occluder_add(const transform_t * const trans,
+    uint16_t polygon_count)
+{
+        const transform_proj_t * const transform_proj_pool =
+            &__state->transform_proj_pool[0];
+
+        const bool mesh =
+            ((trans->object->flags & G3D_OBJECT_FLAGS_MESH) != G3D_OBJECT_FLAGS_NONE);
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                const transform_proj_t *polygon[4];
+
+                if (mesh) {
+                        const g3d_mesh_t * const object_mesh = trans->xpdata;
+                        const uint16_t * const offsets = object_mesh->polygons[i].offsets;
+                        const uintptr_t pool = (uintptr_t)transform_proj_pool;
+
+                        polygon[0] = (const transform_proj_t *)(pool + (offsets[0] & G3D_MESH_OFFSET_MASK));
+                        polygon[1] = (const transform_proj_t *)(pool + offsets[1]);
+                        polygon[2] = (const transform_proj_t *)(pool + offsets[2]);
+                        polygon[3] = (const transform_proj_t *)(pool + offsets[3]);
+                } else {
+                        const XPDATA * const xpdata = trans->xpdata;
+                        const uint16_t * const vertices = xpdata->pltbl[i].Vertices;
+
+                        polygon[0] = &transform_proj_pool[vertices[0]];
+                        polygon[1] = &transform_proj_pool[vertices[1]];
+                        polygon[2] = &transform_proj_pool[vertices[2]];
+                        polygon[3] = &transform_proj_pool[vertices[3]];
+                }
+
+                __occlusion_grid_polygon_add(&_grid, polygon);
+        }
+}
+
+/* Determine if the current object is entirely hidden behind occluders. The
+ * object's cull sphere, or AABB, is used as its bounds. Objects without either
+ * are never hidden */
+bool
+__occlusion_test(const transform_t * const trans)
+{
+        int16_t min[2];
+        int16_t max[2];
+        FIXED near_z;
+
+        if (!(_screen_bounds_calculate(trans, min, max, &near_z))) {
+                return false;
+        }
+
+        return __occlusion_grid_test(&_grid, min, max, near_z);
+}
+
+/* Project the box around the object's cull shape. Returns false when the box
+ * crosses the near plane */
+static bool
+_screen_bounds_calculate(const transform_t * const trans, int16_t *min,
+    int16_t *max, FIXED *near_z)
+{
+        const g3d_object_t * const object = trans->object;
+        const g3d_info_t * const info = __state->info;
+
+        fix16_vec3_t origin;
+        fix16_vec3_t extent;
+
+        if ((object->flags & G3D_OBJECT_FLAGS_CULL_SPHERE) != G3D_OBJECT_FLAGS_NONE) {
+                const g3d_cull_sphere_t * const sphere = object->cull_shape;
+
+                origin.x = sphere->origin[X];
+                origin.y = sphere->origin[Y];
+                origin.z = sphere->origin[Z];
+
+                extent.x = sphere->radius;
+                extent.y = sphere->radius;
+                extent.z = sphere->radius;
+        } else if ((object->flags & G3D_OBJECT_FLAGS_CULL_AABB) != G3D_OBJECT_FLAGS_NONE) {
+                const g3d_cull_aabb_t * const aabb = object->cull_shape;
+
+                origin.x = aabb->origin[X];
+                origin.y = aabb->origin[Y];
+                origin.z = aabb->origin[Z];
+
+                /* The box can be rotated, so use the sphere around it */
+                const FIXED radius = aabb->length[X] + aabb->length[Y] + aabb->length[Z];
+
+                extent.x = radius;
+                extent.y = radius;
+                extent.z = radius;
+        } else {
+                return false;
+        }
+
+        /* Same transform as the vertices go through */
+        const FIXED * const top_matrix = (const FIXED *)g3d_matrix_top();
+
+        const FIXED view_x = fix16_vec3_dot(&origin, (const fix16_vec3_t *)&top_matrix[M00]) + top_matrix[M03];
+        const FIXED view_y = fix16_vec3_dot(&origin, (const fix16_vec3_t *)&top_matrix[M10]) + top_matrix[M13];
+        const FIXED view_z = fix16_vec3_dot(&origin, (const fix16_vec3_t *)&top_matrix[M20]) + top_matrix[M23];
+
+        const FIXED z_min = view_z - extent.z;
+        const FIXED z_max = view_z + extent.z;
+
+        if (z_min <= info->near) {
+                return false;
+        }
+
+        /* Keep the projected bounds from overflowing. Objects reaching this
+         * far out to the side are simply treated as visible */
+        const FIXED extent_max = z_min << 2;
+
+        if ((fix16_abs(view_x) + extent.x) > extent_max) {
+                return false;
+        }
+
+        if ((fix16_abs(view_y) + extent.y) > extent_max) {
+                return false;
+        }
+
+        *near_z = z_min;
+
+        cpu_divu_fix16_set(info->view_distance, z_min);
+        const FIXED inv_z_min = cpu_divu_quotient_get();
+
+        cpu_divu_fix16_set(info->view_distance, z_max);
+        const FIXED inv_z_max = cpu_divu_quotient_get();
+
+        const FIXED bounds[2][2] = {
+                { view_x - extent.x, view_x + extent.x },
+                { view_y - extent.y, view_y + extent.y }
+        };
+
+        const FIXED ratios[2] = {
+                FIX16(1.0f),
+                info->ratio
+        };
+
+        /* Each side of the box is farthest out on screen either at its near or
+         * its far end */
+        for (uint32_t axis = X; axis <= Y; axis++) {
+                const FIXED inv_z_near = fix16_mul(ratios[axis], inv_z_min);
+                const FIXED inv_z_far = fix16_mul(ratios[axis], inv_z_max);
+
+                const int16_t low_near = fix16_int16_muls(bounds[axis][0], inv_z_near);
+                const int16_t low_far = fix16_int16_muls(bounds[axis][0], inv_z_far);
+                const int16_t high_near = fix16_int16_muls(bounds[axis][1], inv_z_near);
+                const int16_t high_far = fix16_int16_muls(bounds[axis][1], inv_z_far);
+
+                min[axis] = (low_near < low_far) ? low_near : low_far;
+                max[axis] = (high_near > high_far) ? high_near : high_far;
+        }
+
+        return true;
+}
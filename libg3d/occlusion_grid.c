@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include "occlusion-internal.h"
+
+static bool _tile_covered(const int16_vec2_t *screens, int32_t winding,
+    int32_t x0, int32_t y0);
+static int32_t _edge_calculate(const int16_vec2_t *a, const int16_vec2_t *b,
+    int32_t x, int32_t y);
+
+/* Clear the tiles that cover a screen of (2 * sw_2) by (2 * sh_2) pixels,
+ * centered on the origin */
+void
+__occlusion_grid_clear(occlusion_grid_t *grid, int16_t sw_2, int16_t sh_2)
+{
+        grid->origin_x = -sw_2;
+        grid->origin_y = -sh_2;
+
+        grid->width = ((2 * sw_2) + OCCLUSION_TILE_SIZE - 1) >> OCCLUSION_TILE_SHIFT;
+        grid->height = ((2 * sh_2) + OCCLUSION_TILE_SIZE - 1) >> OCCLUSION_TILE_SHIFT;
+
+        grid->width = (grid->width < OCCLUSION_GRID_WIDTH) ? grid->width : OCCLUSION_GRID_WIDTH;
+        grid->height = (grid->height < OCCLUSION_GRID_HEIGHT) ? grid->height : OCCLUSION_GRID_HEIGHT;
+
+        for (uint32_t y = 0; y < grid->height; y++) {
+                for (uint32_t x = 0; x < grid->width; x++) {
+                        grid->tiles[y][x] = OCCLUSION_TILE_Z_EMPTY;
+                }
+        }
+}
+
+/* Only polygons entirely on screen and in front of the near plane are
+ * rasterized, and only tiles the polygon fully covers are updated. Polygons are
+ * expected to be convex */
+void
+__occlusion_grid_polygon_add(occlusion_grid_t *grid,
+    const transform_proj_t * const *polygon)
+{
+        const clip_flags_t or_clip_flags = (polygon[0]->clip_flags |
+                                            polygon[1]->clip_flags |
+                                            polygon[2]->clip_flags |
+                                            polygon[3]->clip_flags);
+
+        if (or_clip_flags != CLIP_FLAGS_NONE) {
+                return;
+        }
+
+        const int16_vec2_t screens[4] = {
+                polygon[0]->screen,
+                polygon[1]->screen,
+                polygon[2]->screen,
+                polygon[3]->screen
+        };
+
+        /* Twice the signed area, to determine the winding order */
+        int32_t area = 0;
+
+        for (uint32_t i = 0; i < 4; i++) {
+                const int16_vec2_t * const a = &screens[i];
+                const int16_vec2_t * const b = &screens[(i + 1) & 3];
+
+                area += (a->x * b->y) - (b->x * a->y);
+        }
+
+        if (area == 0) {
+                return;
+        }
+
+        const int32_t winding = (area > 0) ? 1 : -1;
+
+        FIXED max_z = polygon[0]->point_z;
+        int16_t min_x = screens[0].x;
+        int16_t min_y = screens[0].y;
+        int16_t max_x = screens[0].x;
+        int16_t max_y = screens[0].y;
+
+        for (uint32_t i = 1; i < 4; i++) {
+                max_z = (polygon[i]->point_z > max_z) ? polygon[i]->point_z : max_z;
+
+                min_x = (screens[i].x < min_x) ? screens[i].x : min_x;
+                min_y = (screens[i].y < min_y) ? screens[i].y : min_y;
+                max_x = (screens[i].x > max_x) ? screens[i].x : max_x;
+                max_y = (screens[i].y > max_y) ? screens[i].y : max_y;
+        }
+
+        /* Tiles that lie entirely within the polygon's bounds */
+        int32_t x0 = (min_x - grid->origin_x + OCCLUSION_TILE_SIZE - 1) >> OCCLUSION_TILE_SHIFT;
+        int32_t y0 = (min_y - grid->origin_y + OCCLUSION_TILE_SIZE - 1) >> OCCLUSION_TILE_SHIFT;
+        int32_t x1 = ((max_x - grid->origin_x + 1) >> OCCLUSION_TILE_SHIFT) - 1;
+        int32_t y1 = ((max_y - grid->origin_y + 1) >> OCCLUSION_TILE_SHIFT) - 1;
+
+        x0 = (x0 < 0) ? 0 : x0;
+        y0 = (y0 < 0) ? 0 : y0;
+        x1 = (x1 >= grid->width) ? (grid->width - 1) : x1;
+        y1 = (y1 >= grid->height) ? (grid->height - 1) : y1;
+
+        for (int32_t y = y0; y <= y1; y++) {
+                for (int32_t x = x0; x <= x1; x++) {
+                        if (grid->tiles[y][x] <= max_z) {
+                                continue;
+                        }
+
+                        const int32_t tile_x = grid->origin_x + (x << OCCLUSION_TILE_SHIFT);
+                        const int32_t tile_y = grid->origin_y + (y << OCCLUSION_TILE_SHIFT);
+
+                        if ((_tile_covered(screens, winding, tile_x, tile_y))) {
+                                grid->tiles[y][x] = max_z;
+                        }
+                }
+        }
+}
+
+/* Determine if the screen bounds [min, max], whose nearest point is at near_z,
+ * are entirely behind the tiles. Bounds that are entirely off the grid are
+ * never hidden */
+bool
+__occlusion_grid_test(const occlusion_grid_t *grid, const int16_t *min,
+    const int16_t *max, FIXED near_z)
+{
+        int32_t x0 = (min[X] - grid->origin_x) >> OCCLUSION_TILE_SHIFT;
+        int32_t y0 = (min[Y] - grid->origin_y) >> OCCLUSION_TILE_SHIFT;
+        int32_t x1 = (max[X] - grid->origin_x) >> OCCLUSION_TILE_SHIFT;
+        int32_t y1 = (max[Y] - grid->origin_y) >> OCCLUSION_TILE_SHIFT;
+
+        x0 = (x0 < 0) ? 0 : x0;
+        y0 = (y0 < 0) ? 0 : y0;
+        x1 = (x1 >= grid->width) ? (grid->width - 1) : x1;
+        y1 = (y1 >= grid->height) ? (grid->height - 1) : y1;
+
+        if ((x0 > x1) || (y0 > y1)) {
+                return false;
+        }
+
+        for (int32_t y = y0; y <= y1; y++) {
+                for (int32_t x = x0; x <= x1; x++) {
+                        if (grid->tiles[y][x] >= near_z) {
+                                return false;
+                        }
+                }
+        }
+
+        return true;
+}
+
+/* A tile is covered by a convex polygon when all four of its corners are on
+ * the inner side of every edge */
+static bool
+_tile_covered(const int16_vec2_t *screens, int32_t winding, int32_t x0,
+    int32_t y0)
+{
+        const int32_t x1 = x0 + OCCLUSION_TILE_SIZE - 1;
+        const int32_t y1 = y0 + OCCLUSION_TILE_SIZE - 1;
+
+        for (uint32_t i = 0; i < 4; i++) {
+                const int16_vec2_t * const a = &screens[i];
+                const int16_vec2_t * const b = &screens[(i + 1) & 3];
+
+                if (((winding * _edge_calculate(a, b, x0, y0)) < 0) ||
+                    ((winding * _edge_calculate(a, b, x1, y0)) < 0) ||
+                    ((winding * _edge_calculate(a, b, x0, y1)) < 0) ||
+                    ((winding * _edge_calculate(a, b, x1, y1)) < 0)) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+static int32_t
+_edge_calculate(const int16_vec2_t *a, const int16_vec2_t *b, int32_t x,
+    int32_t y)
+{
+        return (((b->x - a->x) * (y - a->y)) - ((b->y - a->y) * (x - a->x)));
+}
@@ -1,5 +1,6 @@
 #include <math.h>
 
+#include <cpu/dual.h>
 #include <cpu/frt.h>
 
 #include <g3d/perf.h>
@@ -44,6 +45,11 @@ perf_counter_end(perf_counter_t *perf_counter)
         perf_counter->end_tick = _absolute_ticks_get();
         perf_counter->ticks = perf_counter->end_tick - perf_counter->start_tick;
 
+        /* The slave CPU has no overflow count, so its ticks wrap at 16-bits */
+        if (cpu_dual_executor_get() == CPU_SLAVE) {
+                perf_counter->ticks &= 0xFFFF;
+        }
+
         perf_counter->max_ticks = max(perf_counter->ticks, perf_counter->max_ticks);
 }
 
@@ -51,6 +57,12 @@ static uint32_t
 _absolute_ticks_get(void)
 {
         const uint32_t ticks_remaining = cpu_frt_count_get();
+
+        /* The overflow interrupt only fires on the master CPU */
+        if (cpu_dual_executor_get() == CPU_SLAVE) {
+                return ticks_remaining;
+        }
+
         const uint32_t overflow_ticks = _state.overflow_count * 65536;
 
         const uint32_t ticks = (ticks_remaining + overflow_ticks);
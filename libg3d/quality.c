@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <cpu/divu.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+/* Frames in a row over target before quality is lowered */
+#define QUALITY_LOWER_FRAME_COUNT       (2)
+/* Frames in a row comfortably under target before quality is raised again.
+ * Raising is much slower than lowering to avoid oscillating */
+#define QUALITY_RAISE_FRAME_COUNT       (30)
+
+static struct {
+        bool enabled;
+        g3d_quality_t quality;
+        /* Values set by the user, which quality is raised back toward */
+        uint16_t display_level;
+        FIXED fog_start_z;
+        g3d_quality_status_t status;
+} _state;
+
+static void _quality_lower(void);
+static void _quality_raise(void);
+static void _fog_start_update(void);
+
+void
+__quality_init(void)
+{
+        (void)memset(&_state, 0, sizeof(_state));
+}
+
+void
+g3d_quality_set(const g3d_quality_t *quality)
+{
+        const g3d_info_t * const info = __state->info;
+
+        if (_state.enabled) {
+                /* Restore what the controller changed */
+                g3d_display_level_set(_state.display_level);
+                g3d_far_set(_state.quality.far_max);
+
+                __state->fog->start_z = _state.fog_start_z;
+        }
+
+        (void)memset(&_state.status, 0, sizeof(g3d_quality_status_t));
+
+        _state.enabled = false;
+
+        if (quality == NULL) {
+                return;
+        }
+
+        assert(quality->far_min <= quality->far_max);
+
+        _state.enabled = true;
+        _state.quality = *quality;
+        _state.display_level = info->level;
+        _state.fog_start_z = __state->fog->start_z;
+
+        g3d_far_set(quality->far_max);
+
+        /* The far plane distance may have been clamped */
+        _state.quality.far_max = info->far;
+        _state.quality.far_min = min(quality->far_min, info->far);
+
+        _state.status.far = info->far;
+        _state.status.fog_start_z = _state.fog_start_z;
+        _state.status.display_level = info->level;
+}
+
+void
+g3d_quality_status_get(g3d_quality_status_t *status)
+{
+        assert(status != NULL);
+
+        (void)memcpy(status, &_state.status, sizeof(g3d_quality_status_t));
+}
+
+/* The load is the time spent from g3d_start() to g3d_finish(), plus the last
+ * VDP1 transfer, which ends asynchronously */
+void
+__quality_update(void)
+{
+        if (!_state.enabled) {
+                return;
+        }
+
+        const g3d_results_t * const internal_results = __state->results;
+        g3d_quality_status_t * const status = &_state.status;
+
+        const uint32_t target_ticks = _state.quality.target_ticks;
+
+        status->load_ticks = internal_results->perf_frame.ticks +
+                             internal_results->perf_dma.ticks;
+        status->action = G3D_QUALITY_ACTION_NONE;
+
+        if (status->load_ticks > target_ticks) {
+                status->over_count++;
+                status->under_count = 0;
+
+                if (status->over_count >= QUALITY_LOWER_FRAME_COUNT) {
+                        status->over_count = 0;
+
+                        _quality_lower();
+                }
+        } else if (status->load_ticks < (target_ticks - (target_ticks / 4))) {
+                status->under_count++;
+                status->over_count = 0;
+
+                if (status->under_count >= QUALITY_RAISE_FRAME_COUNT) {
+                        status->under_count = 0;
+
+                        _quality_raise();
+                }
+        } else {
+                status->over_count = 0;
+                status->under_count = 0;
+        }
+
+        const g3d_info_t * const info = __state->info;
+
+        status->far = info->far;
+        status->fog_start_z = __state->fog->start_z;
+        status->display_level = info->level;
+}
+
+/* Bring the far plane in first, then lower the display level once the far
+ * plane can't be brought in any further */
+static void
+_quality_lower(void)
+{
+        const g3d_info_t * const info = __state->info;
+        g3d_quality_status_t * const status = &_state.status;
+
+        if (info->far > _state.quality.far_min) {
+                g3d_far_set(max(info->far - (info->far / 8), _state.quality.far_min));
+                _fog_start_update();
+
+                status->action = G3D_QUALITY_ACTION_FAR_DECREASE;
+        } else if (info->level > _state.quality.display_level_min) {
+                g3d_display_level_set(info->level - 1);
+                /* Raising the near plane may have pushed the far plane out */
+                _fog_start_update();
+
+                status->action = G3D_QUALITY_ACTION_LEVEL_DECREASE;
+        }
+}
+
+/* Undo in the reverse order of _quality_lower() */
+static void
+_quality_raise(void)
+{
+        const g3d_info_t * const info = __state->info;
+        g3d_quality_status_t * const status = &_state.status;
+
+        if (info->level < _state.display_level) {
+                g3d_display_level_set(info->level + 1);
+
+                status->action = G3D_QUALITY_ACTION_LEVEL_INCREASE;
+        } else if (info->far < _state.quality.far_max) {
+                g3d_far_set(min(info->far + (info->far / 8), _state.quality.far_max));
+                _fog_start_update();
+
+                status->action = G3D_QUALITY_ACTION_FAR_INCREASE;
+        }
+}
+
+/* Pull the start of the fog in along with the far plane, so that objects
+ * culled by the far plane are hidden by fog first */
+static void
+_fog_start_update(void)
+{
+        const g3d_info_t * const info = __state->info;
+        const FIXED far_max = _state.quality.far_max;
+
+        FIXED start_z = _state.fog_start_z;
+
+        if ((far_max > 0) && (info->far < far_max)) {
+                cpu_divu_fix16_set(info->far, far_max);
+
+                start_z = fix16_mul(start_z, cpu_divu_quotient_get());
+        }
+
+        __state->fog->start_z = start_z;
+}
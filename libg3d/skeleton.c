@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+extern void __matrix_rot_set(FIXED *matrix, const ANGLE rx, const ANGLE ry,
+    const ANGLE rz);
+
+static void _bone_local_calculate(const g3d_bone_key_t *key,
+    const g3d_bone_key_t *next_key, FIXED t, FIXED *matrix);
+static void _matrix_multiply(const FIXED *parent_matrix,
+    const FIXED *local_matrix, FIXED *matrix);
+
+static inline FIXED __always_inline
+_fixed_lerp(FIXED a, FIXED b, FIXED t)
+{
+        return (a + fix16_mul(b - a, t));
+}
+
+/* Interpolate along the shortest way around */
+static inline ANGLE __always_inline
+_angle_lerp(ANGLE a, ANGLE b, FIXED t)
+{
+        const int32_t delta = (int16_t)(b - a);
+
+        return (ANGLE)(a + ((delta * (t >> 1)) >> 15));
+}
+
+/* Calculate the matrix of every bone at the given frame, in one pass. The root
+ * bones are relative to the top matrix at the time of the call */
+void
+g3d_skeleton_evaluate(g3d_skeleton_t *skeleton,
+    const g3d_animation_t *animation, FIXED frame)
+{
+        assert(skeleton != NULL);
+        assert(skeleton->matrices != NULL);
+        assert(animation != NULL);
+        assert(animation->frame_count > 0);
+        assert(frame >= FIX16(0.0f));
+
+        const uint16_t bone_count = skeleton->bone_count;
+        const uint16_t last_frame = animation->frame_count - 1;
+
+        uint16_t frame_index = fix16_int32_to(frame);
+        FIXED t = fix16_fractional(frame);
+
+        if (frame_index >= last_frame) {
+                frame_index = last_frame;
+                t = FIX16(0.0f);
+        }
+
+        const uint16_t next_frame_index =
+            (frame_index < last_frame) ? (frame_index + 1) : last_frame;
+
+        const g3d_bone_key_t * const keys = &animation->keys[frame_index * bone_count];
+        const g3d_bone_key_t * const next_keys = &animation->keys[next_frame_index * bone_count];
+
+        const FIXED * const top_matrix = (const FIXED *)g3d_matrix_top();
+
+        for (uint32_t i = 0; i < bone_count; i++) {
+                const g3d_bone_t * const bone = &skeleton->bones[i];
+
+                MATRIX local_matrix;
+
+                _bone_local_calculate(&keys[i], &next_keys[i], t,
+                    (FIXED *)local_matrix);
+
+                const FIXED *parent_matrix;
+
+                if (bone->parent == G3D_BONE_PARENT_NONE) {
+                        parent_matrix = top_matrix;
+                } else {
+                        assert(bone->parent < i);
+
+                        parent_matrix = (const FIXED *)skeleton->matrices[bone->parent];
+                }
+
+                _matrix_multiply(parent_matrix, (const FIXED *)local_matrix,
+                    (FIXED *)skeleton->matrices[i]);
+        }
+}
+
+/* Transform the object of each bone with the bone's matrix */
+void
+g3d_skeleton_transform(const g3d_skeleton_t *skeleton)
+{
+        assert(skeleton != NULL);
+
+        g3d_matrix_push(G3D_MATRIX_TYPE_MOVE_PTR); {
+                for (uint32_t i = 0; i < skeleton->bone_count; i++) {
+                        const g3d_bone_t * const bone = &skeleton->bones[i];
+
+                        if (bone->object == NULL) {
+                                continue;
+                        }
+
+                        g3d_matrix_load(&skeleton->matrices[i]);
+
+                        g3d_object_transform(bone->object, bone->xpdata_index);
+                }
+        } g3d_matrix_pop();
+}
+
+static void
+_bone_local_calculate(const g3d_bone_key_t *key,
+    const g3d_bone_key_t *next_key, FIXED t, FIXED *matrix)
+{
+        if (t == FIX16(0.0f)) {
+                __matrix_rot_set(matrix, key->rotation[X], key->rotation[Y],
+                    key->rotation[Z]);
+
+                matrix[M03] = key->translation[X];
+                matrix[M13] = key->translation[Y];
+                matrix[M23] = key->translation[Z];
+
+                return;
+        }
+
+        __matrix_rot_set(matrix,
+            _angle_lerp(key->rotation[X], next_key->rotation[X], t),
+            _angle_lerp(key->rotation[Y], next_key->rotation[Y], t),
+            _angle_lerp(key->rotation[Z], next_key->rotation[Z], t));
+
+        matrix[M03] = _fixed_lerp(key->translation[X], next_key->translation[X], t);
+        matrix[M13] = _fixed_lerp(key->translation[Y], next_key->translation[Y], t);
+        matrix[M23] = _fixed_lerp(key->translation[Z], next_key->translation[Z], t);
+}
+
+static void
+_matrix_multiply(const FIXED *parent_matrix, const FIXED *local_matrix,
+    FIXED *matrix)
+{
+        for (uint32_t row = 0; row < 3; row++) {
+                const FIXED * const p = &parent_matrix[row * 4];
+                FIXED * const m = &matrix[row * 4];
+
+                for (uint32_t column = 0; column < 4; column++) {
+                        m[column] = fix16_mul(p[0], local_matrix[M00 + column]) +
+                                    fix16_mul(p[1], local_matrix[M10 + column]) +
+                                    fix16_mul(p[2], local_matrix[M20 + column]);
+                }
+
+                m[3] += p[3];
+        }
+}
@@ -13,6 +13,7 @@
 
 #include "g3d-internal.h"
 
+#if SORT_METHOD == SORT_METHOD_BUCKET
 static struct {
         /* Top pointer to the pool of singles */
         sort_single_t *pool_free_top;
@@ -53,9 +54,9 @@ __sort_init(void)
 }
 
 void
-__sort_add(void *packet, int32_t pz)
+__sort_add(void *packet, FIXED z)
 {
-        pz = clamp(pz, 0, SORT_Z_RANGE - 1);
+        const int32_t pz = clamp(fix16_int32_to(z), 0, SORT_Z_RANGE - 1);
 
         _state.max_z = max(pz, _state.max_z);
 
@@ -82,7 +83,7 @@ __sort_iterate(sort_iterate_fn_t iterate_fn)
                 single = list_head->head;
 
                 while (single != NULL) {
-                        iterate_fn(single);
+                        iterate_fn(single->packet);
 
                         single = single->next_single;
                 }
@@ -92,3 +93,101 @@ __sort_iterate(sort_iterate_fn_t iterate_fn)
 
         _state_reset();
 }
+#else
+static struct {
+        /* Number of packets added */
+        uint32_t count;
+} _state;
+
+static inline void __always_inline
+_state_reset(void)
+{
+        _state.count = 0;
+
+        (void)memset(__state->sort_radix->histograms, 0,
+            sizeof(uint16_t) * SORT_RADIX_SIZE * 2);
+}
+
+/* Stable counting sort pass over the 8-bit digit of each key at shift. Returns
+ * the buffer holding the keys after the pass */
+static inline uint32_t * __always_inline
+_radix_pass(uint32_t *keys, uint32_t *swap_keys, uint16_t *histogram,
+    uint32_t shift)
+{
+        const uint32_t count = _state.count;
+
+        /* No need to move anything when every key has the same digit */
+        if (histogram[(keys[0] >> shift) & (SORT_RADIX_SIZE - 1)] == count) {
+                return keys;
+        }
+
+        uint32_t offset = 0;
+
+        for (uint32_t i = 0; i < SORT_RADIX_SIZE; i++) {
+                const uint32_t digit_count = histogram[i];
+
+                histogram[i] = offset;
+
+                offset += digit_count;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+                const uint32_t key = keys[i];
+
+                swap_keys[histogram[(key >> shift) & (SORT_RADIX_SIZE - 1)]++] = key;
+        }
+
+        return swap_keys;
+}
+
+void
+__sort_init(void)
+{
+        _state_reset();
+}
+
+void
+__sort_add(void *packet, FIXED z)
+{
+        sort_radix_t * const radix = __state->sort_radix;
+
+        const uint32_t index = _state.count;
+        const uint32_t depth = clamp(z >> SORT_Z_SHIFT, 0, 0xFFFF);
+
+        radix->packets[index] = packet;
+        radix->keys[index] = (depth << 16) | index;
+
+        /* Build the histograms as the keys come in, to save a pass over the
+         * keys when sorting */
+        radix->histograms[0][depth & 0xFF]++;
+        radix->histograms[1][depth >> 8]++;
+
+        _state.count++;
+}
+
+void
+__sort_iterate(sort_iterate_fn_t iterate_fn)
+{
+        assert(iterate_fn != NULL);
+
+        sort_radix_t * const radix = __state->sort_radix;
+
+        if (_state.count > 0) {
+                uint32_t *keys;
+                uint32_t *swap_keys;
+
+                keys = _radix_pass(radix->keys, radix->swap_keys,
+                    radix->histograms[0], 16);
+                swap_keys = (keys == radix->keys) ? radix->swap_keys : radix->keys;
+                keys = _radix_pass(keys, swap_keys, radix->histograms[1], 24);
+
+                /* Farthest first. Packets of equal depth come out in reverse
+                 * order of being added, the same as the bucket sort */
+                for (int32_t i = _state.count - 1; i >= 0; i--) {
+                        iterate_fn(radix->packets[keys[i] & 0xFFFF]);
+                }
+        }
+
+        _state_reset();
+}
+#endif /* SORT_METHOD == SORT_METHOD_BUCKET */
@@ -5,6 +5,8 @@
  * Israel Jacquez <mrkotfw@gmail.com>
  */
 
+#include <cpu/cache.h>
+
 #include "g3d-internal.h"
 
 static g3d_results_t _results;
@@ -18,8 +20,31 @@ static MATRIX _matrices[MATRIX_STACK_MAX] __aligned(16);
 static transform_proj_t _transform_proj_pool[VERTEX_POOL_SIZE];
 static transform_t _transform;
 
+static transform_t _slave_transform;
+static slave_sort_t _slave_sort_pool[PACKET_SIZE] __aligned(16);
+static slave_sync_t _slave_sync __uncached;
+
+static slave_t _slave = {
+        .transform = &_slave_transform,
+        .sort_pool = _slave_sort_pool,
+        .sync      = &_slave_sync
+};
+
+#if SORT_METHOD == SORT_METHOD_BUCKET
 static sort_list_t _sort_list[SORT_Z_RANGE] __aligned(16);
 static sort_single_t _sort_single_pool[PACKET_SIZE] __aligned(16);
+#else
+static uint32_t _sort_keys[2][PACKET_SIZE] __aligned(16);
+static void *_sort_packets[PACKET_SIZE] __aligned(16);
+static uint16_t _sort_histograms[2][SORT_RADIX_SIZE] __aligned(16);
+
+static sort_radix_t _sort_radix = {
+        .keys       = _sort_keys[0],
+        .swap_keys  = _sort_keys[1],
+        .packets    = _sort_packets,
+        .histograms = _sort_histograms
+};
+#endif /* SORT_METHOD == SORT_METHOD_BUCKET */
 
 static MATRIX _clip_camera __aligned(16);
 static clip_planes_t _clip_planes __aligned(16);
@@ -37,10 +62,15 @@ static state_t _state = {
         .clip_camera         = &_clip_camera,
         .clip_planes         = &_clip_planes,
         .matrices            = _matrices,
+#if SORT_METHOD == SORT_METHOD_BUCKET
         .sort_list           = _sort_list,
         .sort_single_pool    = _sort_single_pool,
+#else
+        .sort_radix          = &_sort_radix,
+#endif /* SORT_METHOD == SORT_METHOD_BUCKET */
         .tlist               = &_tlist,
-        .plist               = &_plist
+        .plist               = &_plist,
+        .slave               = &_slave
 };
 
 state_t * const __state = &_state;
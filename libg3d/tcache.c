@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <vdp.h>
+
+#include "g3d.h"
+
+#include "g3d-internal.h"
+
+#define TCACHE_SLOT_COUNT_MAX   (256)
+
+#define SLOT_TEXNO_NONE         (0xFFFF)
+
+typedef struct {
+        uint16_t texno;
+        /* Frame the texture was last used on */
+        uint32_t frame;
+        /* Increases with each use, to find the least recently used slot */
+        uint32_t use;
+} tcache_slot_t;
+
+static struct {
+        const g3d_texture_source_t *sources;
+        uint16_t source_count;
+
+        uintptr_t base;
+        uint32_t slot_shift;
+        uint16_t slot_count;
+
+        uint32_t frame;
+        uint32_t use;
+
+        g3d_tcache_stats_t stats;
+
+        tcache_slot_t slots[TCACHE_SLOT_COUNT_MAX];
+} _state;
+
+static bool _texture_resident(const TEXTURE *texture);
+static uint16_t _texture_slot_get(const TEXTURE *texture);
+static bool _texture_load(uint16_t texno, TEXTURE *texture);
+static int32_t _slot_evict(void);
+
+/* The textures in the texture list are streamed into fixed size slots of the
+ * VDP1 texture partition as they're used. The texture list must be set first,
+ * and sources has one entry for each of its textures. The size of each slot is
+ * a power of two that fits the largest texture */
+void
+g3d_tcache_set(const g3d_texture_source_t *sources, uint32_t slot_size)
+{
+        __state->flags &= ~FLAGS_TCACHE_ENABLED;
+
+        if (sources == NULL) {
+                return;
+        }
+
+        assert(slot_size >= 8);
+        assert((slot_size & (slot_size - 1)) == 0);
+
+        vdp1_vram_partitions_t vram_partitions;
+
+        vdp1_vram_partitions_get(&vram_partitions);
+
+        _state.sources = sources;
+        _state.source_count = __state->tlist->count;
+
+        _state.base = (uintptr_t)vram_partitions.texture_base;
+        _state.slot_shift = __builtin_ctz(slot_size);
+        _state.slot_count = vram_partitions.texture_size >> _state.slot_shift;
+
+        if (_state.slot_count > TCACHE_SLOT_COUNT_MAX) {
+                _state.slot_count = TCACHE_SLOT_COUNT_MAX;
+        }
+
+        assert(_state.slot_count > 0);
+        /* Otherwise, a texture in the first slot looks like it isn't
+         * resident */
+        assert(_state.base != VDP1_VRAM(0));
+
+        _state.frame = 0;
+        _state.use = 0;
+
+        (void)memset(&_state.stats, 0, sizeof(g3d_tcache_stats_t));
+
+        _state.stats.slot_count = _state.slot_count;
+
+        for (uint32_t i = 0; i < _state.slot_count; i++) {
+                _state.slots[i].texno = SLOT_TEXNO_NONE;
+                _state.slots[i].frame = 0;
+                _state.slots[i].use = 0;
+        }
+
+        TEXTURE * const textures = __state->tlist->list;
+
+        for (uint32_t i = 0; i < _state.source_count; i++) {
+                assert(sources[i].size <= slot_size);
+
+                textures[i].CGadr = 0x0000;
+        }
+
+        __state->flags |= FLAGS_TCACHE_ENABLED;
+}
+
+void
+g3d_tcache_stats_get(g3d_tcache_stats_t *stats)
+{
+        assert(stats != NULL);
+
+        (void)memcpy(stats, &_state.stats, sizeof(g3d_tcache_stats_t));
+}
+
+void
+__tcache_frame_start(void)
+{
+        _state.frame++;
+}
+
+/* Make every texture the object's polygons use resident. This is done up front
+ * by the master CPU, so that the polygon processing, which may run on the slave
+ * CPU, only reads the texture list. Polygons whose texture couldn't be made
+ * resident are left out when they're processed */
+void
+__tcache_object_use(const transform_t * const trans, uint16_t polygon_count)
+{
+        const g3d_object_t * const object = trans->object;
+
+        const g3d_flags_t debug_flags =
+            (G3D_OBJECT_FLAGS_WIREFRAME | G3D_OBJECT_FLAGS_NON_TEXTURED);
+
+        if ((object->flags & debug_flags) != G3D_OBJECT_FLAGS_NONE) {
+                return;
+        }
+
+        const XPDATA * const xpdata = trans->xpdata;
+        TEXTURE * const textures = __state->tlist->list;
+
+        uint16_t last_texno = SLOT_TEXNO_NONE;
+        bool last_resident = true;
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                const ATTR * const attr = &xpdata->attbl[i];
+
+                if ((attr->sort & UseTexture) != UseTexture) {
+                        continue;
+                }
+
+                /* Neighboring polygons tend to share textures */
+                if (attr->texno == last_texno) {
+                        if (!last_resident) {
+                                _state.stats.skipped_polygon_count++;
+                        }
+
+                        continue;
+                }
+
+                last_texno = attr->texno;
+
+                assert(attr->texno < _state.source_count);
+
+                TEXTURE * const texture = &textures[attr->texno];
+
+                if ((_texture_resident(texture))) {
+                        tcache_slot_t * const slot = &_state.slots[_texture_slot_get(texture)];
+
+                        slot->frame = _state.frame;
+                        slot->use = ++_state.use;
+
+                        _state.stats.hit_count++;
+
+                        last_resident = true;
+
+                        continue;
+                }
+
+                _state.stats.miss_count++;
+
+                last_resident = _texture_load(attr->texno, texture);
+
+                if (!last_resident) {
+                        _state.stats.skipped_polygon_count++;
+                }
+        }
+}
+
+static bool
+_texture_resident(const TEXTURE *texture)
+{
+        return (texture->CGadr != 0x0000);
+}
+
+static uint16_t
+_texture_slot_get(const TEXTURE *texture)
+{
+        const uintptr_t address = VDP1_VRAM((uintptr_t)texture->CGadr << 3);
+
+        return ((address - _state.base) >> _state.slot_shift);
+}
+
+/* Returns false when the texture couldn't be made resident */
+static bool
+_texture_load(uint16_t texno, TEXTURE *texture)
+{
+        const int32_t slot_index = _slot_evict();
+
+        if (slot_index < 0) {
+                /* Every slot is in use this frame. The texture stays
+                 * without VRAM until a slot frees up on a later frame */
+                _state.stats.overflow_count++;
+
+                return false;
+        }
+
+        tcache_slot_t * const slot = &_state.slots[slot_index];
+
+        slot->texno = texno;
+        slot->frame = _state.frame;
+        slot->use = ++_state.use;
+
+        const g3d_texture_source_t * const source = &_state.sources[texno];
+
+        void * const slot_address =
+            (void *)(_state.base + ((uintptr_t)slot_index << _state.slot_shift));
+
+        vdp_dma_enqueue(slot_address, source->data, source->size);
+
+        texture->CGadr = ((uintptr_t)slot_address - VDP1_VRAM(0)) >> 3;
+
+        _state.stats.resident_count++;
+
+        return true;
+}
+
+/* Find a free slot, or else free the least recently used slot. Slots used this
+ * frame are referenced by command tables that haven't been drawn yet, so they
+ * can't be freed */
+static int32_t
+_slot_evict(void)
+{
+        int32_t lru_index = -1;
+        uint32_t lru_use = UINT32_MAX;
+
+        for (uint32_t i = 0; i < _state.slot_count; i++) {
+                const tcache_slot_t * const slot = &_state.slots[i];
+
+                if (slot->texno == SLOT_TEXNO_NONE) {
+                        return i;
+                }
+
+                if ((slot->frame != _state.frame) && (slot->use < lru_use)) {
+                        lru_index = i;
+                        lru_use = slot->use;
+                }
+        }
+
+        if (lru_index >= 0) {
+                TEXTURE * const textures = __state->tlist->list;
+
+                textures[_state.slots[lru_index].texno].CGadr = 0x0000;
+
+                _state.slots[lru_index].texno = SLOT_TEXNO_NONE;
+
+                _state.stats.eviction_count++;
+                _state.stats.resident_count--;
+        }
+
+        return lru_index;
+}
@@ -5,47 +5,79 @@
  * Israel Jacquez <mrkotfw@gmail.com>
  */
 
+#include <string.h>
+
+#include <cpu/cache.h>
 #include <cpu/divu.h>
+#include <cpu/dual.h>
 #include <vdp.h>
 
 #include <dbgio/dbgio.h>
 
 #include "g3d-internal.h"
+#include "backend-internal.h"
 
-extern void __sort_add(void *packet, int32_t pz);
+extern void __sort_add(void *packet, FIXED z);
 extern void __sort_iterate(sort_iterate_fn_t fn);
 
+extern void __occlusion_clear(void);
+extern void __occlusion_occluder_add(const transform_t * const trans,
+    uint16_t polygon_count);
+extern bool __occlusion_test(const transform_t * const trans);
+
+extern void __tcache_frame_start(void);
+extern void __tcache_object_use(const transform_t * const trans,
+    uint16_t polygon_count);
+
+extern void __lod_update(void);
+extern void __quality_update(void);
+extern uint16_t __lod_select(g3d_lod_t *lod, uint16_t level_count, FIXED z);
+
 static bool _object_aabb_cull_test(const transform_t * const trans) __unused;
-static bool _object_sphere_cull_test(const transform_t * const trans);
+static bool _object_sphere_cull_test(transform_t * const trans);
+static FIXED _object_z_calculate(void);
 static bool _screen_cull_test(const transform_t * const trans);
 static void _camera_world_transform(void);
 static void _cmdt_prepare(const transform_t * const trans);
-static void _fog_calculate(const transform_t * const trans);
-static void _polygon_process(transform_t * const trans, POLYGON const *polygons);
-static void _sort_iterate(const sort_single_t *single);
-static void _vertex_pool_clipping(const transform_t * const trans);
-static void _vertex_pool_transform(const transform_t * const trans, const POINT * const points);
-static void _z_calculate(transform_t * const trans);
+static void _cmdt_attributes_set(const g3d_object_t * const object,
+    const ATTR * const attr, vdp1_cmdt_t * const cmdt);
+static void _cmdt_vertices_set(const transform_t * const trans,
+    vdp1_cmdt_t * const cmdt);
+static void _cmdt_texture_set(const transform_t * const trans,
+    const ATTR * const attr, vdp1_cmdt_t * const cmdt);
+static bool _polygon_texture_missing(const transform_t * const trans,
+    const ATTR * const attr);
+static void _fog_calculate(const transform_t * const trans,
+    vdp1_cmdt_t * const cmdt);
+static inline void _polygon_process(transform_t * const trans,
+    const void *polygons, sort_add_fn_t sort_add, bool mesh) __always_inline;
+static inline void _polygons_process(transform_t * const trans,
+    const void *polygons, sort_add_fn_t sort_add) __always_inline;
+static const void *_polygons_get(const transform_t * const trans,
+    uint16_t offset);
+static void _sort_iterate(void *packet);
+static void _vertex_pool_clipping(const transform_t * const trans,
+    transform_proj_t *trans_proj);
+static void _vertex_pool_transform(const transform_t * const trans,
+    const POINT * const points, transform_proj_t *trans_proj,
+    const FIXED * const top_matrix);
+static void _z_calculate(transform_t * const trans, uint32_t sort);
+
+static uint16_t _xpdata_polygon_count_get(const XPDATA * const xpdata);
+static vdp1_cmdt_t *_baked_cmdts_get(const g3d_object_t *object,
+    uint16_t xpdata_index);
+
+static void _object_single_transform(transform_t * const trans);
+static void _object_dual_transform(transform_t * const trans);
+static void _slave_entry(void);
+static void _slave_sort_add(void *packet, FIXED z);
 
 static void _put_set_handler(void *work);
 
 static inline FIXED __always_inline __unused
 _point_component_transform(const fix16_vec3_t *p, const FIXED *matrix)
 {
-        cpu_instr_clrmac();
-
-        const fix16_vec3_t *p_ptr = p;
-        const FIXED *matrix_ptr = matrix;
-
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-
-        register const uint32_t mach = cpu_instr_sts_mach();
-        register const uint32_t macl = cpu_instr_sts_macl();
-        register const uint32_t xtrct = cpu_instr_xtrct(mach, macl);
-
-        return (xtrct + (*matrix_ptr));
+        return (__backend_mac3((const FIXED *)p, matrix) + matrix[3]);
 }
 
 static inline fix16_vec3_t __always_inline __unused
@@ -63,20 +95,7 @@ _point_transform(const fix16_vec3_t *p, const FIXED *matrix)
 static inline FIXED __always_inline __unused
 _normal_component_rotate(const fix16_vec3_t *p, const FIXED *matrix)
 {
-        cpu_instr_clrmac();
-
-        const fix16_vec3_t *p_ptr = p;
-        const FIXED *matrix_ptr = matrix;
-
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-        cpu_instr_macl(&p_ptr, &matrix_ptr);
-
-        register const uint32_t mach = cpu_instr_sts_mach();
-        register const uint32_t macl = cpu_instr_sts_macl();
-        register const uint32_t xtrct = cpu_instr_xtrct(mach, macl);
-
-        return xtrct;
+        return __backend_mac3((const FIXED *)p, matrix);
 }
 
 static inline fix16_vec3_t __always_inline __unused
@@ -102,16 +121,38 @@ __transform_init(void)
 
         g3d_results_t * const internal_results = __state->results;
 
+        perf_counter_init(&internal_results->perf_frame);
         perf_counter_init(&internal_results->perf_sort);
         perf_counter_init(&internal_results->perf_dma);
         perf_counter_init(&internal_results->perf_aabb_culling);
         perf_counter_init(&internal_results->perf_transform);
         perf_counter_init(&internal_results->perf_clipping);
         perf_counter_init(&internal_results->perf_polygon_process);
+        perf_counter_init(&internal_results->perf_slave_transform);
+        perf_counter_init(&internal_results->perf_slave_clipping);
+        perf_counter_init(&internal_results->perf_slave_polygon_process);
+        perf_counter_init(&internal_results->perf_slave_wait);
+        perf_counter_init(&internal_results->perf_slave_merge);
 
         vdp1_sync_put_set(_put_set_handler, &internal_results->perf_dma);
 }
 
+void
+g3d_slave_enable(void)
+{
+        __state->flags |= FLAGS_SLAVE_ENABLED;
+
+        cpu_dual_slave_set(_slave_entry);
+}
+
+void
+g3d_slave_disable(void)
+{
+        __state->flags &= ~FLAGS_SLAVE_ENABLED;
+
+        cpu_dual_slave_clear();
+}
+
 void
 g3d_start(vdp1_cmdt_orderlist_t *orderlist, uint16_t orderlist_offset, vdp1_cmdt_t *cmdts)
 {
@@ -127,6 +168,24 @@ g3d_start(vdp1_cmdt_orderlist_t *orderlist, uint16_t orderlist_offset, vdp1_cmdt
 
         internal_results->object_count = 0;
         internal_results->polygon_count = 0;
+        internal_results->bvh_visible_count = 0;
+        internal_results->bvh_culled_count = 0;
+        internal_results->occluded_object_count = 0;
+        internal_results->occluded_polygon_count = 0;
+
+        for (uint32_t i = 0; i < G3D_LOD_LEVEL_COUNT; i++) {
+                internal_results->lod_counts[i] = 0;
+        }
+
+        perf_counter_start(&internal_results->perf_frame);
+
+        if ((__state->flags & FLAGS_OCCLUSION_ENABLED) != FLAGS_NONE) {
+                __occlusion_clear();
+        }
+
+        if ((__state->flags & FLAGS_TCACHE_ENABLED) != FLAGS_NONE) {
+                __tcache_frame_start();
+        }
 
         const FIXED * const camera_matrix =
             (const FIXED *)__state->clip_camera;
@@ -174,6 +233,14 @@ g3d_finish(g3d_results_t *results)
         __sort_iterate(_sort_iterate);
         perf_counter_end(&internal_results->perf_sort);
 
+        perf_counter_end(&internal_results->perf_frame);
+
+        /* Both act on the next frame */
+        __lod_update();
+        __quality_update();
+
+        internal_results->lod_bias = g3d_lod_bias_get();
+
         transform_t * const trans = __state->transform;
 
         /* Fetch the last command table pointer before setting the indirect mode
@@ -188,40 +255,48 @@ g3d_finish(g3d_results_t *results)
 
         if (results != NULL) {
                 results->object_count = internal_results->object_count;
+                results->lod_bias = internal_results->lod_bias;
                 results->polygon_count = trans->current_orderlist - trans->orderlist;
+                results->bvh_visible_count = internal_results->bvh_visible_count;
+                results->bvh_culled_count = internal_results->bvh_culled_count;
+                results->occluded_object_count = internal_results->occluded_object_count;
+                results->occluded_polygon_count = internal_results->occluded_polygon_count;
 
+                for (uint32_t i = 0; i < G3D_LOD_LEVEL_COUNT; i++) {
+                        results->lod_counts[i] = internal_results->lod_counts[i];
+                }
+
+                results->perf_frame = internal_results->perf_frame;
                 results->perf_sort = internal_results->perf_sort;
                 results->perf_dma = internal_results->perf_dma;
                 results->perf_aabb_culling = internal_results->perf_aabb_culling;
                 results->perf_transform = internal_results->perf_transform;
                 results->perf_clipping = internal_results->perf_clipping;
                 results->perf_polygon_process = internal_results->perf_polygon_process;
+
+                if ((__state->flags & FLAGS_SLAVE_ENABLED) != FLAGS_NONE) {
+                        /* The slave CPU updated its counters behind the master
+                         * CPU's cache */
+                        cpu_cache_area_purge(&internal_results->perf_slave_transform,
+                            3 * sizeof(perf_counter_t));
+
+                        results->perf_slave_transform = internal_results->perf_slave_transform;
+                        results->perf_slave_clipping = internal_results->perf_slave_clipping;
+                        results->perf_slave_polygon_process = internal_results->perf_slave_polygon_process;
+                        results->perf_slave_wait = internal_results->perf_slave_wait;
+                        results->perf_slave_merge = internal_results->perf_slave_merge;
+                }
         }
 }
 
 void
 g3d_object_transform(const g3d_object_t *object, uint16_t xpdata_index)
 {
-        const XPDATA * const object_xpdata = object->xpdatas;
-        const XPDATA * const xpdata = &object_xpdata[xpdata_index];
-
-        const uint16_t polygon_count =
-            (xpdata->nbPolygon < (PACKET_SIZE - 1)) ? xpdata->nbPolygon : (PACKET_SIZE - 1);
-        const uint16_t vertex_count =
-            (xpdata->nbPoint < VERTEX_POOL_SIZE) ? xpdata->nbPoint : VERTEX_POOL_SIZE;
-
-        if ((vertex_count == 0) || (polygon_count == 0)) {
-                return;
-        }
-
         g3d_results_t * const internal_results = __state->results;
 
         transform_t * const trans = __state->transform;
 
         trans->object = object;
-        trans->xpdata = xpdata;
-        trans->vertex_count = vertex_count;
-        trans->polygon_count = polygon_count;
 
         perf_counter_start(&internal_results->perf_aabb_culling);
         if ((object->flags & G3D_OBJECT_FLAGS_CULL_AABB) != G3D_OBJECT_FLAGS_NONE) {
@@ -235,155 +310,383 @@ g3d_object_transform(const g3d_object_t *object, uint16_t xpdata_index)
         }
         perf_counter_end(&internal_results->perf_aabb_culling);
 
+        if (object->lod != NULL) {
+                const g3d_flags_t cull_flags =
+                    (G3D_OBJECT_FLAGS_CULL_AABB | G3D_OBJECT_FLAGS_CULL_SPHERE);
+
+                /* Otherwise, the sphere culling test has the Z value */
+                if ((object->flags & cull_flags) != G3D_OBJECT_FLAGS_CULL_SPHERE) {
+                        trans->object_z = _object_z_calculate();
+                }
+
+                xpdata_index = __lod_select(object->lod, object->xpdata_count,
+                    trans->object_z);
+        }
+
+        const XPDATA * const object_xpdata = object->xpdatas;
+        const XPDATA * const xpdata = &object_xpdata[xpdata_index];
+
+        const uint16_t polygon_count = _xpdata_polygon_count_get(xpdata);
+        const uint16_t vertex_count =
+            (xpdata->nbPoint < VERTEX_POOL_SIZE) ? xpdata->nbPoint : VERTEX_POOL_SIZE;
+
+        if ((vertex_count == 0) || (polygon_count == 0)) {
+                return;
+        }
+
+        trans->xpdata = xpdata;
+        trans->vertex_count = vertex_count;
+        trans->polygon_count = polygon_count;
+        trans->baked_cmdts = _baked_cmdts_get(object, xpdata_index);
+
+        const bool occlusion_enabled =
+            ((__state->flags & FLAGS_OCCLUSION_ENABLED) != FLAGS_NONE);
+        const bool occluder =
+            ((object->flags & G3D_OBJECT_FLAGS_OCCLUDER) != G3D_OBJECT_FLAGS_NONE);
+
+        bool occluded = false;
+
         g3d_matrix_push(G3D_MATRIX_TYPE_PUSH); {
                 _camera_world_transform();
 
-                perf_counter_start(&internal_results->perf_transform);
-                _vertex_pool_transform(trans, xpdata->pntbl);
-                perf_counter_end(&internal_results->perf_transform);
+                if (occlusion_enabled && !occluder) {
+                        occluded = __occlusion_test(trans);
+                }
 
-                perf_counter_start(&internal_results->perf_clipping);
-                _vertex_pool_clipping(trans);
-                perf_counter_end(&internal_results->perf_clipping);
+                if (!occluded) {
+                        if ((__state->flags & FLAGS_TCACHE_ENABLED) != FLAGS_NONE) {
+                                __tcache_object_use(trans, polygon_count);
+                        }
 
-                perf_counter_start(&internal_results->perf_polygon_process);
-                _polygon_process(trans, xpdata->pltbl);
-                perf_counter_end(&internal_results->perf_polygon_process);
+                        if (((__state->flags & FLAGS_SLAVE_ENABLED) != FLAGS_NONE) &&
+                            (vertex_count >= SLAVE_VERTEX_COUNT_MIN)) {
+                                _object_dual_transform(trans);
+                        } else {
+                                _object_single_transform(trans);
+                        }
+
+                        /* Occluders must be transformed before the objects
+                         * they hide */
+                        if (occlusion_enabled && occluder) {
+                                __occlusion_occluder_add(trans, polygon_count);
+                        }
+                }
         } g3d_matrix_pop();
 
+        if (occluded) {
+                internal_results->occluded_object_count++;
+                internal_results->occluded_polygon_count += polygon_count;
+
+                return;
+        }
+
+        /* Only objects that are drawn count toward their level of detail */
+        if (object->lod != NULL) {
+                const uint16_t level = (xpdata_index < G3D_LOD_LEVEL_COUNT)
+                    ? xpdata_index
+                    : (G3D_LOD_LEVEL_COUNT - 1);
+
+                internal_results->lod_counts[level]++;
+        }
+
         g3d_results_t * const results = __state->results;
 
         results->object_count++;
 }
 
-static void
-_camera_world_transform(void)
+uint16_t
+g3d_object_bake_count_get(const g3d_object_t *object)
 {
-        FIXED * const top_matrix = (FIXED *)g3d_matrix_top();
-        const FIXED * const camera_matrix =
-            (const FIXED *)__state->clip_camera;
+        const XPDATA * const xpdatas = object->xpdatas;
 
-        top_matrix[M03] += -camera_matrix[M03];
-        top_matrix[M13] += -camera_matrix[M13];
-        top_matrix[M23] += -camera_matrix[M23];
+        uint16_t cmdt_count = 0;
+
+        for (uint32_t i = 0; i < object->xpdata_count; i++) {
+                cmdt_count += _xpdata_polygon_count_get(&xpdatas[i]);
+        }
+
+        return cmdt_count;
+}
+
+void
+g3d_object_bake(g3d_object_t *object, vdp1_cmdt_t *cmdts)
+{
+        assert(object != NULL);
+
+        object->baked_cmdts = cmdts;
+
+        if (cmdts == NULL) {
+                return;
+        }
+
+        const XPDATA *xpdata = object->xpdatas;
+
+        vdp1_cmdt_t *cmdt = cmdts;
+
+        for (uint32_t i = 0; i < object->xpdata_count; i++, xpdata++) {
+                const uint16_t polygon_count = _xpdata_polygon_count_get(xpdata);
+
+                for (uint32_t j = 0; j < polygon_count; j++, cmdt++) {
+                        _cmdt_attributes_set(object, &xpdata->attbl[j], cmdt);
+                }
+        }
+}
+
+static uint16_t
+_xpdata_polygon_count_get(const XPDATA * const xpdata)
+{
+        return ((xpdata->nbPolygon < (PACKET_SIZE - 1)) ? xpdata->nbPolygon : (PACKET_SIZE - 1));
+}
+
+static vdp1_cmdt_t *
+_baked_cmdts_get(const g3d_object_t *object, uint16_t xpdata_index)
+{
+        vdp1_cmdt_t *cmdts = object->baked_cmdts;
+
+        if (cmdts == NULL) {
+                return NULL;
+        }
+
+        const XPDATA * const xpdatas = object->xpdatas;
+
+        for (uint32_t i = 0; i < xpdata_index; i++) {
+                cmdts += _xpdata_polygon_count_get(&xpdatas[i]);
+        }
+
+        return cmdts;
 }
 
 static void
-_vertex_pool_transform(const transform_t * const trans, const POINT * const points)
+_object_single_transform(transform_t * const trans)
 {
-#define OFFSET_CPU_DVSR         (0x00)
-#define OFFSET_CPU_DVDNTH       (0x10 / 4)
-#define OFFSET_CPU_DVDNTL       (0x14 / 4)
+        g3d_results_t * const internal_results = __state->results;
 
-        const g3d_info_t * const info = __state->info;
+        const XPDATA * const xpdata = trans->xpdata;
+
+        transform_proj_t * const transform_proj_pool =
+            &__state->transform_proj_pool[0];
 
-        const FIXED *current_point = (const FIXED *)points;
-        const FIXED * const last_point = (const FIXED * const)&points[trans->vertex_count];
+        const FIXED * const top_matrix = (const FIXED *)g3d_matrix_top();
+
+        perf_counter_start(&internal_results->perf_transform);
+        _vertex_pool_transform(trans, xpdata->pntbl, transform_proj_pool, top_matrix);
+        perf_counter_end(&internal_results->perf_transform);
+
+        perf_counter_start(&internal_results->perf_clipping);
+        _vertex_pool_clipping(trans, transform_proj_pool);
+        perf_counter_end(&internal_results->perf_clipping);
 
-        transform_proj_t *trans_proj;
-        trans_proj = &__state->transform_proj_pool[0];
+        trans->index = 0;
+
+        perf_counter_start(&internal_results->perf_polygon_process);
+        _polygons_process(trans, _polygons_get(trans, 0), __sort_add);
+        perf_counter_end(&internal_results->perf_polygon_process);
+}
 
-        const FIXED view_distance = info->view_distance;
-        const FIXED view_distance_16 = view_distance << 16;
-        const FIXED z_near = info->near;
-        const FIXED ratio = info->ratio;
+/* Wait for the other CPU to reach the phase. It may already be past it, as the
+ * slave CPU can go on to process its polygons as soon as it sees the master
+ * CPU's vertices are ready */
+static inline void __always_inline
+_slave_phase_wait(volatile slave_phase_t *phase, slave_phase_t wait_phase)
+{
+        while (*phase < wait_phase) {
+        }
+}
+
+/* Split the vertices and polygons of the object in half. The slave CPU takes
+ * the second half of each.
+ *
+ * The slave CPU's command tables are written right after the most the master
+ * CPU could write, and its polygons are kept aside. Once both CPUs are done,
+ * the master CPU merges them into the sort */
+static void
+_object_dual_transform(transform_t * const trans)
+{
+        g3d_results_t * const internal_results = __state->results;
+
+        slave_t * const slave = __state->slave;
+        transform_t * const slave_trans = slave->transform;
+        volatile slave_sync_t * const sync = slave->sync;
+
+        const XPDATA * const xpdata = trans->xpdata;
+
+        transform_proj_t * const transform_proj_pool =
+            &__state->transform_proj_pool[0];
 
         const FIXED * const top_matrix = (const FIXED *)g3d_matrix_top();
-        const FIXED * const matrix = &top_matrix[M20];
 
-        register uint32_t * const cpu_divu_regs = (uint32_t *)CPU(DVSR);
+        const uint16_t vertex_half = trans->vertex_count / 2;
+        const uint16_t polygon_half = trans->polygon_count / 2;
 
-        do {
-                cpu_instr_clrmac();
+        vdp1_cmdt_t * const slave_cmdt = trans->current_cmdt + polygon_half;
 
-                const FIXED *matrix_ptr = matrix;
+        *slave_trans = *trans;
 
-                trans_proj->clip_flags = CLIP_FLAGS_NONE;
+        slave_trans->vertex_count = trans->vertex_count - vertex_half;
+        slave_trans->index = polygon_half;
+        slave_trans->current_cmdt = slave_cmdt;
 
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                const uint32_t dh1 = cpu_instr_swapw(view_distance);
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                const uint32_t dh2 = cpu_instr_extsw(dh1);
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                cpu_divu_regs[OFFSET_CPU_DVDNTH] = dh2;
+        (void)memcpy(slave->matrix, top_matrix, sizeof(MATRIX));
 
-                register const uint32_t z_mach = cpu_instr_sts_mach();
+        slave->points = &xpdata->pntbl[vertex_half];
+        slave->polygons = _polygons_get(trans, polygon_half);
+        slave->vertex_offset = vertex_half;
+        slave->sort_count = 0;
 
-                const uint32_t tz = *matrix_ptr;
+        sync->master_phase = SLAVE_PHASE_IDLE;
+        sync->slave_phase = SLAVE_PHASE_IDLE;
+        sync->sort_count = 0;
 
-                const uint32_t z_macl = cpu_instr_sts_macl();
-                current_point -= XYZ;
-                const uint32_t z_xtrct = cpu_instr_xtrct(z_mach, z_macl);
+        cpu_dual_slave_notify();
 
-                trans_proj->point_z = (z_xtrct + tz);
+        trans->vertex_count = vertex_half;
+        trans->polygon_count = polygon_half;
 
-                /* In case the projected Z value is on or behind the near plane */
-                if (trans_proj->point_z < z_near) {
-                        trans_proj->clip_flags |= CLIP_FLAGS_NEAR;
+        perf_counter_start(&internal_results->perf_transform);
+        _vertex_pool_transform(trans, xpdata->pntbl, transform_proj_pool, top_matrix);
+        perf_counter_end(&internal_results->perf_transform);
 
-                        trans_proj->point_z = z_near;
-                }
+        perf_counter_start(&internal_results->perf_clipping);
+        _vertex_pool_clipping(trans, transform_proj_pool);
+        perf_counter_end(&internal_results->perf_clipping);
 
-                cpu_instr_clrmac();
+        sync->master_phase = SLAVE_PHASE_VERTICES;
 
-                matrix_ptr -= M23; /* Move back to start of matrix */
+        /* Polygons from either half can reference vertices from the other */
+        _slave_phase_wait(&sync->slave_phase, SLAVE_PHASE_VERTICES);
 
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                cpu_divu_regs[OFFSET_CPU_DVSR] = trans_proj->point_z;
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                cpu_divu_regs[OFFSET_CPU_DVDNTL] = view_distance_16;
-                cpu_instr_macl(&current_point, &matrix_ptr);
+        cpu_cache_area_purge(&transform_proj_pool[vertex_half],
+            slave_trans->vertex_count * sizeof(transform_proj_t));
 
-                const uint32_t x_mach = cpu_instr_sts_mach();
-                const uint32_t tx = *matrix_ptr;
-                const uint32_t x_macl = cpu_instr_sts_macl();
-                matrix_ptr++;
+        trans->index = 0;
 
-                const uint32_t x_xtrct = cpu_instr_xtrct(x_mach, x_macl);
+        perf_counter_start(&internal_results->perf_polygon_process);
+        _polygons_process(trans, _polygons_get(trans, 0), __sort_add);
+        perf_counter_end(&internal_results->perf_polygon_process);
 
-                cpu_instr_clrmac();
+        perf_counter_start(&internal_results->perf_slave_wait);
+        _slave_phase_wait(&sync->slave_phase, SLAVE_PHASE_POLYGONS);
+        perf_counter_end(&internal_results->perf_slave_wait);
 
-                current_point -= XYZ;
+        const uint16_t sort_count = sync->sort_count;
 
-                const FIXED point_x = (x_xtrct + tx);
+        perf_counter_start(&internal_results->perf_slave_merge);
+        cpu_cache_area_purge(slave->sort_pool, sort_count * sizeof(slave_sort_t));
 
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                cpu_instr_macl(&current_point, &matrix_ptr);
-                cpu_instr_macl(&current_point, &matrix_ptr);
+        for (uint32_t i = 0; i < sort_count; i++) {
+                const slave_sort_t * const slave_sort = &slave->sort_pool[i];
 
-                const uint32_t y_mach = cpu_instr_sts_mach();
-                const uint32_t y_macl = cpu_instr_sts_macl();
-                const uint32_t ty = *matrix_ptr;
-                const uint32_t y_xtrct = cpu_instr_xtrct(y_mach, y_macl);
+                __sort_add(slave_sort->packet, slave_sort->z);
+        }
+        perf_counter_end(&internal_results->perf_slave_merge);
 
-                const FIXED point_y = (y_xtrct + ty);
+        /* Each polygon the slave CPU added took up one command table, unless
+         * the object is baked */
+        if (trans->baked_cmdts == NULL) {
+                trans->current_cmdt = slave_cmdt + sort_count;
+        }
+}
 
-                const FIXED inv_z = cpu_divu_regs[OFFSET_CPU_DVDNTL];
+static void
+_slave_entry(void)
+{
+        /* The master CPU's writes went straight through to memory, so any line
+         * cached by the slave CPU may be stale */
+        cpu_cache_purge();
+
+        g3d_results_t * const internal_results = __state->results;
 
-                trans_proj->screen.x = fix16_int16_muls(point_x, inv_z);
-                trans_proj->screen.y = fix16_int16_muls(point_y, fix16_mul(ratio, inv_z));
+        slave_t * const slave = __state->slave;
+        transform_t * const trans = slave->transform;
+        volatile slave_sync_t * const sync = slave->sync;
 
-                trans_proj++;
-        } while (current_point <= last_point);
+        transform_proj_t * const transform_proj_pool =
+            &__state->transform_proj_pool[0];
+        transform_proj_t * const trans_proj =
+            &transform_proj_pool[slave->vertex_offset];
+
+        perf_counter_start(&internal_results->perf_slave_transform);
+        _vertex_pool_transform(trans, slave->points, trans_proj,
+            (const FIXED *)slave->matrix);
+        perf_counter_end(&internal_results->perf_slave_transform);
+
+        perf_counter_start(&internal_results->perf_slave_clipping);
+        _vertex_pool_clipping(trans, trans_proj);
+        perf_counter_end(&internal_results->perf_slave_clipping);
+
+        sync->slave_phase = SLAVE_PHASE_VERTICES;
+
+        _slave_phase_wait(&sync->master_phase, SLAVE_PHASE_VERTICES);
+
+        cpu_cache_area_purge(transform_proj_pool,
+            slave->vertex_offset * sizeof(transform_proj_t));
+
+        perf_counter_start(&internal_results->perf_slave_polygon_process);
+        _polygons_process(trans, slave->polygons, _slave_sort_add);
+        perf_counter_end(&internal_results->perf_slave_polygon_process);
+
+        sync->sort_count = slave->sort_count;
+        sync->slave_phase = SLAVE_PHASE_POLYGONS;
+}
+
+static void
+_slave_sort_add(void *packet, FIXED z)
+{
+        slave_t * const slave = __state->slave;
+
+        slave_sort_t * const slave_sort = &slave->sort_pool[slave->sort_count];
+
+        slave_sort->packet = packet;
+        slave_sort->z = z;
+
+        slave->sort_count++;
 }
 
 static void
-_sort_iterate(const sort_single_t *single)
+_camera_world_transform(void)
+{
+        FIXED * const top_matrix = (FIXED *)g3d_matrix_top();
+        const FIXED * const camera_matrix =
+            (const FIXED *)__state->clip_camera;
+
+        top_matrix[M03] += -camera_matrix[M03];
+        top_matrix[M13] += -camera_matrix[M13];
+        top_matrix[M23] += -camera_matrix[M23];
+}
+
+/* The vertex pool transform is built on its own, in vertex_pool.c */
+static void
+_vertex_pool_transform(const transform_t * const trans,
+    const POINT * const points, transform_proj_t *trans_proj,
+    const FIXED * const top_matrix)
+{
+        const g3d_info_t * const info = __state->info;
+
+        const vertex_pool_view_t view = {
+                .view_distance = info->view_distance,
+                .near = info->near,
+                .ratio = info->ratio
+        };
+
+        __vertex_pool_transform(points, trans->vertex_count, trans_proj,
+            top_matrix, &view);
+}
+
+static void
+_sort_iterate(void *packet)
 {
         transform_t * const trans = __state->transform;
 
         /* No need to clear the end bit, as setting the "source" clobbers the
          * bit */
-        trans->current_orderlist->cmdt = single->packet;
+        trans->current_orderlist->cmdt = packet;
         trans->current_orderlist++;
 }
 
 static void
-_vertex_pool_clipping(const transform_t * const trans)
+_vertex_pool_clipping(const transform_t * const trans,
+    transform_proj_t *trans_proj)
 {
-        transform_proj_t *trans_proj;
-        trans_proj = &__state->transform_proj_pool[0];
-
         const int16_t sw_2 = trans->cached_sw_2;
         const int16_t sw_n2 = -trans->cached_sw_2;
         const int16_t sh_2 = trans->cached_sh_2;
@@ -408,22 +711,70 @@ _vertex_pool_clipping(const transform_t * const trans)
         } while (vertex_count != 0);
 }
 
-static void
-_polygon_process(transform_t * const trans, POLYGON const *polygons)
+/* The XPDATA of the object is a g3d_mesh_t when G3D_OBJECT_FLAGS_MESH is set.
+ * Both have the same layout, except for the polygons */
+static const void *
+_polygons_get(const transform_t * const trans, uint16_t offset)
+{
+        if ((trans->object->flags & G3D_OBJECT_FLAGS_MESH) != G3D_OBJECT_FLAGS_NONE) {
+                const g3d_mesh_t * const mesh = trans->xpdata;
+
+                return &mesh->polygons[offset];
+        }
+
+        const XPDATA * const xpdata = trans->xpdata;
+
+        return &xpdata->pltbl[offset];
+}
+
+static inline void __always_inline
+_polygons_process(transform_t * const trans, const void *polygons,
+    sort_add_fn_t sort_add)
+{
+        if ((trans->object->flags & G3D_OBJECT_FLAGS_MESH) != G3D_OBJECT_FLAGS_NONE) {
+                _polygon_process(trans, polygons, sort_add, true);
+        } else {
+                _polygon_process(trans, polygons, sort_add, false);
+        }
+}
+
+/* Process the polygons from trans->index up to trans->polygon_count */
+static inline void __always_inline
+_polygon_process(transform_t * const trans, const void *polygons,
+    sort_add_fn_t sort_add, bool mesh)
 {
         transform_proj_t * const transform_proj_pool =
             &__state->transform_proj_pool[0];
 
         const g3d_object_t * const object = trans->object;
+        const XPDATA * const xpdata = trans->xpdata;
         const uint16_t polygon_count = trans->polygon_count;
 
-        for (trans->index = 0; trans->index < polygon_count; trans->index++, polygons++) {
-                const uint16_t * vertices = &polygons->Vertices[0];
+        const POLYGON *polygon = polygons;
+        const g3d_mesh_polygon_t *mesh_polygon = polygons;
+
+        for (; trans->index < polygon_count; trans->index++, polygon++, mesh_polygon++) {
+                uint32_t mesh_sort = 0;
+
+                if (mesh) {
+                        /* The vertex offsets are already in bytes */
+                        const uintptr_t pool = (uintptr_t)transform_proj_pool;
+                        const uint16_t * const offsets = &mesh_polygon->offsets[0];
 
-                trans->polygon[0] = &transform_proj_pool[*(vertices++)];
-                trans->polygon[1] = &transform_proj_pool[*(vertices++)];
-                trans->polygon[2] = &transform_proj_pool[*(vertices++)];
-                trans->polygon[3] = &transform_proj_pool[*vertices];
+                        trans->polygon[0] = (const transform_proj_t *)(pool + (offsets[0] & G3D_MESH_OFFSET_MASK));
+                        trans->polygon[1] = (const transform_proj_t *)(pool + offsets[1]);
+                        trans->polygon[2] = (const transform_proj_t *)(pool + offsets[2]);
+                        trans->polygon[3] = (const transform_proj_t *)(pool + offsets[3]);
+
+                        mesh_sort = offsets[0] & G3D_MESH_SORT_MASK;
+                } else {
+                        const uint16_t * vertices = &polygon->Vertices[0];
+
+                        trans->polygon[0] = &transform_proj_pool[*(vertices++)];
+                        trans->polygon[1] = &transform_proj_pool[*(vertices++)];
+                        trans->polygon[2] = &transform_proj_pool[*(vertices++)];
+                        trans->polygon[3] = &transform_proj_pool[*vertices];
+                }
 
                 const clip_flags_t and_clip_flags = (trans->polygon[0]->clip_flags &
                                                      trans->polygon[1]->clip_flags &
@@ -440,24 +791,55 @@ _polygon_process(transform_t * const trans, POLYGON const *polygons)
                         }
                 }
 
-                _z_calculate(trans);
+                /* The texture cache ran out of slots for the polygon's
+                 * texture this frame */
+                if ((__state->flags & FLAGS_TCACHE_ENABLED) != FLAGS_NONE) {
+                        if ((_polygon_texture_missing(trans, &xpdata->attbl[trans->index]))) {
+                                continue;
+                        }
+                }
+
+                if (mesh) {
+                        _z_calculate(trans, mesh_sort);
+                } else {
+                        _z_calculate(trans, xpdata->attbl[trans->index].sort & 0x03);
+                }
+
+                if (trans->baked_cmdts != NULL) {
+                        /* Only what changes from frame to frame needs to be
+                         * updated */
+                        vdp1_cmdt_t * const cmdt = &trans->baked_cmdts[trans->index];
+                        const ATTR * const attr = &xpdata->attbl[trans->index];
+
+                        /* Undo last frame's fog color and pre-clipping, unless
+                         * pre-clipping is disabled by the polygon's attribute */
+                        cmdt->cmd_colr = cmdt->reserved;
+                        cmdt->cmd_pmod &= ~VDP1_CMDT_PMOD_PRE_CLIPPING_DISABLE | attr->atrb;
+
+                        /* The texture may have moved in VRAM since the
+                         * command table was baked */
+                        if ((__state->flags & FLAGS_TCACHE_ENABLED) != FLAGS_NONE) {
+                                _cmdt_texture_set(trans, attr, cmdt);
+                        }
+
+                        _cmdt_vertices_set(trans, cmdt);
+
+                        sort_add(cmdt, trans->z_value);
+
+                        continue;
+                }
 
                 _cmdt_prepare(trans);
 
-                __sort_add(trans->current_cmdt, fix16_int32_to(trans->z_value));
+                sort_add(trans->current_cmdt, trans->z_value);
 
                 trans->current_cmdt++;
         }
 }
 
 static void
-_z_calculate(transform_t * const trans)
+_z_calculate(transform_t * const trans, uint32_t sort)
 {
-        const XPDATA * const xpdata = trans->xpdata;
-        const ATTR * const attr = &xpdata->attbl[trans->index];
-
-        const uint32_t sort = attr->sort & 0x03;
-
         if (sort == SORT_CEN) {
                 const FIXED z_avg = trans->polygon[0]->point_z +
                                     trans->polygon[1]->point_z +
@@ -498,13 +880,20 @@ _z_calculate(transform_t * const trans)
 static void
 _cmdt_prepare(const transform_t * const trans)
 {
-        const g3d_object_t * const object = trans->object;
         const XPDATA * const xpdata = trans->xpdata;
 
         vdp1_cmdt_t * const cmdt = trans->current_cmdt;
 
-        const ATTR * const attr = &xpdata->attbl[trans->index];
+        _cmdt_attributes_set(trans->object, &xpdata->attbl[trans->index], cmdt);
+        _cmdt_vertices_set(trans, cmdt);
+}
 
+/* Set the parts of the command table that only depend on the polygon's
+ * attributes, and not where it ends up on screen */
+static void
+_cmdt_attributes_set(const g3d_object_t * const object, const ATTR * const attr,
+    vdp1_cmdt_t * const cmdt)
+{
         cmdt->cmd_ctrl = attr->dir; /* We care about (Dir) and (Comm) bits */
         cmdt->cmd_link = 0x0000;
         cmdt->cmd_pmod = attr->atrb;
@@ -515,17 +904,6 @@ _cmdt_prepare(const transform_t * const trans)
 
         /* For debugging */
         if ((object->flags & debug_flags) == G3D_OBJECT_FLAGS_NONE) {
-                const clip_flags_t or_clip_flags = (trans->polygon[0]->clip_flags |
-                                                    trans->polygon[1]->clip_flags |
-                                                    trans->polygon[2]->clip_flags |
-                                                    trans->polygon[3]->clip_flags);
-
-                if (or_clip_flags == CLIP_FLAGS_NONE) {
-                        /* Since no clip flags are set, disable pre-clipping.
-                         * This should help with performance */
-                        cmdt->cmd_pmod |= VDP1_CMDT_PMOD_PRE_CLIPPING_DISABLE;
-                }
-
                 /* Even when there is not texture list, there is the default
                  * texture that zeroes out CMDSRCA and CMDSIZE */
                 const TEXTURE * const textures = __state->tlist->list;
@@ -557,6 +935,80 @@ _cmdt_prepare(const transform_t * const trans)
                 cmdt->cmd_colr = 0xFFFF;
         }
 
+        cmdt->cmd_grda = attr->gstb;
+
+        /* Not read by VDP1. Keep the color around so that baked command tables
+         * can restore it when fog no longer applies */
+        cmdt->reserved = cmdt->cmd_colr;
+}
+
+/* Set the texture of a baked command table to where the texture currently is
+ * in VRAM */
+static void
+_cmdt_texture_set(const transform_t * const trans, const ATTR * const attr,
+    vdp1_cmdt_t * const cmdt)
+{
+        const g3d_flags_t debug_flags =
+            (G3D_OBJECT_FLAGS_WIREFRAME | G3D_OBJECT_FLAGS_NON_TEXTURED);
+
+        if ((trans->object->flags & debug_flags) != G3D_OBJECT_FLAGS_NONE) {
+                return;
+        }
+
+        if ((attr->sort & UseTexture) != UseTexture) {
+                return;
+        }
+
+        const TEXTURE * const textures = __state->tlist->list;
+        const TEXTURE * const texture = &textures[attr->texno];
+
+        cmdt->cmd_srca = texture->CGadr;
+        cmdt->cmd_size = texture->HVsize;
+}
+
+/* A textured polygon whose texture isn't in VRAM would be drawn with CMDSRCA
+ * pointing at the start of VDP1 VRAM, which holds command tables */
+static bool
+_polygon_texture_missing(const transform_t * const trans, const ATTR * const attr)
+{
+        const g3d_flags_t debug_flags =
+            (G3D_OBJECT_FLAGS_WIREFRAME | G3D_OBJECT_FLAGS_NON_TEXTURED);
+
+        if ((trans->object->flags & debug_flags) != G3D_OBJECT_FLAGS_NONE) {
+                return false;
+        }
+
+        if ((attr->sort & UseTexture) != UseTexture) {
+                return false;
+        }
+
+        const TEXTURE * const textures = __state->tlist->list;
+
+        return (textures[attr->texno].CGadr == 0x0000);
+}
+
+/* Set the parts of the command table that change from frame to frame */
+static void
+_cmdt_vertices_set(const transform_t * const trans, vdp1_cmdt_t * const cmdt)
+{
+        const g3d_object_t * const object = trans->object;
+
+        const g3d_flags_t debug_flags =
+            (G3D_OBJECT_FLAGS_WIREFRAME | G3D_OBJECT_FLAGS_NON_TEXTURED);
+
+        if ((object->flags & debug_flags) == G3D_OBJECT_FLAGS_NONE) {
+                const clip_flags_t or_clip_flags = (trans->polygon[0]->clip_flags |
+                                                    trans->polygon[1]->clip_flags |
+                                                    trans->polygon[2]->clip_flags |
+                                                    trans->polygon[3]->clip_flags);
+
+                if (or_clip_flags == CLIP_FLAGS_NONE) {
+                        /* Since no clip flags are set, disable pre-clipping.
+                         * This should help with performance */
+                        cmdt->cmd_pmod |= VDP1_CMDT_PMOD_PRE_CLIPPING_DISABLE;
+                }
+        }
+
         int16_vec2_t *cmd_vertex;
         cmd_vertex = (int16_vec2_t *)(&cmdt->cmd_xa);
 
@@ -576,20 +1028,16 @@ _cmdt_prepare(const transform_t * const trans)
         cmd_vertex->y = trans->polygon[3]->screen.y;
         cmd_vertex++;
 
-        cmdt->cmd_grda = attr->gstb;
-
         if ((__state->flags & FLAGS_FOG_ENABLED) != FLAGS_NONE) {
                 if ((object->flags & G3D_OBJECT_FLAGS_FOG_EXCLUDE) == G3D_OBJECT_FLAGS_NONE) {
-                        _fog_calculate(trans);
+                        _fog_calculate(trans, cmdt);
                 }
         }
 }
 
 static void
-_fog_calculate(const transform_t * const trans)
+_fog_calculate(const transform_t * const trans, vdp1_cmdt_t * const cmdt)
 {
-        vdp1_cmdt_t * const cmdt = trans->current_cmdt;
-
         if (trans->z_value < __state->fog->start_z) {
                 cmdt->cmd_colr = __state->fog->near_ambient_color.raw;
 
@@ -603,7 +1051,7 @@ _fog_calculate(const transform_t * const trans)
         }
 
         int32_t int_z_depth;
-        int_z_depth = fix16_int16_muls(trans->z_value, __state->fog->step);
+        int_z_depth = __backend_fix16_int16_muls(trans->z_value, __state->fog->step);
 
         if (int_z_depth < 0) {
                 int_z_depth = 0;
@@ -663,7 +1111,7 @@ _screen_cull_test(const transform_t * const trans)
 }
 
 static bool
-_object_sphere_cull_test(const transform_t * const trans)
+_object_sphere_cull_test(transform_t * const trans)
 {
         const fix16_plane_t * const clip_planes =
             (fix16_plane_t *)__state->clip_planes;
@@ -690,6 +1138,12 @@ _object_sphere_cull_test(const transform_t * const trans)
 
                 const fix16_t side = fix16_vec3_dot(&clip_plane->normal, &cp);
 
+                /* The distance to the near plane is needed to select the level
+                 * of detail */
+                if (i == 0) {
+                        trans->object_z = side + __state->info->near - sphere->radius;
+                }
+
                 /* Test for intersection */
                 if (((side <= -sphere->radius) || (side >= sphere->radius)) && (side < FIX16(0.0f))) {
                         return true;
@@ -699,6 +1153,26 @@ _object_sphere_cull_test(const transform_t * const trans)
         return false;
 }
 
+/* View space Z value of the object's origin */
+static FIXED
+_object_z_calculate(void)
+{
+        const fix16_plane_t * const near_plane = &__state->clip_planes->near_plane;
+
+        const FIXED * const world_matrix = (const FIXED *)g3d_matrix_top();
+
+        const fix16_vec3_t origin = {
+                .x = world_matrix[M03],
+                .y = world_matrix[M13],
+                .z = world_matrix[M23]
+        };
+
+        fix16_vec3_t cp;
+        fix16_vec3_sub(&origin, &near_plane->d, &cp);
+
+        return (fix16_vec3_dot(&near_plane->normal, &cp) + __state->info->near);
+}
+
 static bool
 _object_aabb_cull_test(const transform_t * const trans)
 {
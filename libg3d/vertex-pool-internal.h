@@ -0,0 +1,50 @@
+/*
+ * No copyright.
+ */
+
+#ifndef _G3D_VERTEX_POOL_INTERNAL_H_
+#define _G3D_VERTEX_POOL_INTERNAL_H_
+
+#include <sys/cdefs.h>
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <int16.h>
+
+#include <g3d/sgl.h>
+
+/* Kept apart from g3d-internal.h, so that the vertex pool transform can be
+ * built on its own, such as on a host */
+
+typedef enum {
+        CLIP_FLAGS_NONE   = 0,
+        CLIP_FLAGS_NEAR   = 1 << 0,
+        CLIP_FLAGS_FAR    = 1 << 1,
+        CLIP_FLAGS_LEFT   = 1 << 2,
+        CLIP_FLAGS_RIGHT  = 1 << 3,
+        CLIP_FLAGS_TOP    = 1 << 4,
+        CLIP_FLAGS_BOTTOM = 1 << 5,
+        CLIP_FLAGS_SIDE   = 1 << 6
+} clip_flags_t;
+
+typedef struct {
+        FIXED point_z;
+        int16_vec2_t screen;
+        clip_flags_t clip_flags;
+} __aligned(16) transform_proj_t;
+
+static_assert(sizeof(transform_proj_t) == 16);
+
+/* What the vertex pool transform reads from g3d_info_t */
+typedef struct {
+        FIXED view_distance;
+        FIXED near;
+        FIXED ratio;
+} vertex_pool_view_t;
+
+extern void __vertex_pool_transform(const POINT *points, uint16_t vertex_count,
+    transform_proj_t *trans_proj, const FIXED *top_matrix,
+    const vertex_pool_view_t *view);
+
+#endif /* !_G3D_VERTEX_POOL_INTERNAL_H_ */
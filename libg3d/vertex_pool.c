@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <cpu/instructions.h>
+#include <cpu/map.h>
+
+#include <fix16.h>
+
+#include "backend-internal.h"
+#include "vertex-pool-internal.h"
+
+#if TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2
+void
+__vertex_pool_transform(const POINT *points, uint16_t vertex_count,
+    transform_proj_t *trans_proj, const FIXED *top_matrix,
+    const vertex_pool_view_t *view)
+{
+        const FIXED *current_point = (const FIXED *)points;
+        const FIXED * const last_point = (const FIXED * const)&points[vertex_count];
+
+        const FIXED view_distance = view->view_distance;
+        const FIXED view_distance_16 = view_distance << 16;
+        const FIXED z_near = view->near;
+        const FIXED ratio = view->ratio;
+
+        const FIXED * const matrix = &top_matrix[M20];
+
+        register uint32_t * const cpu_divu_regs = (uint32_t *)CPU(DVSR);
+
+        do {
+                cpu_instr_clrmac();
+
+                const FIXED *matrix_ptr = matrix;
+
+                trans_proj->clip_flags = CLIP_FLAGS_NONE;
+
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                const uint32_t dh1 = cpu_instr_swapw(view_distance);
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                const uint32_t dh2 = cpu_instr_extsw(dh1);
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                cpu_divu_regs[BACKEND_DIVU_DVDNTH] = dh2;
+
+                register const uint32_t z_mach = cpu_instr_sts_mach();
+
+                const uint32_t tz = *matrix_ptr;
+
+                const uint32_t z_macl = cpu_instr_sts_macl();
+                current_point -= XYZ;
+                const uint32_t z_xtrct = cpu_instr_xtrct(z_mach, z_macl);
+
+                trans_proj->point_z = (z_xtrct + tz);
+
+                /* In case the projected Z value is on or behind the near plane */
+                if (trans_proj->point_z < z_near) {
+                        trans_proj->clip_flags |= CLIP_FLAGS_NEAR;
+
+                        trans_proj->point_z = z_near;
+                }
+
+                cpu_instr_clrmac();
+
+                matrix_ptr -= M23; /* Move back to start of matrix */
+
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                cpu_divu_regs[BACKEND_DIVU_DVSR] = trans_proj->point_z;
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                cpu_divu_regs[BACKEND_DIVU_DVDNTL] = view_distance_16;
+                cpu_instr_macl(&current_point, &matrix_ptr);
+
+                const uint32_t x_mach = cpu_instr_sts_mach();
+                const uint32_t tx = *matrix_ptr;
+                const uint32_t x_macl = cpu_instr_sts_macl();
+                matrix_ptr++;
+
+                const uint32_t x_xtrct = cpu_instr_xtrct(x_mach, x_macl);
+
+                cpu_instr_clrmac();
+
+                current_point -= XYZ;
+
+                const FIXED point_x = (x_xtrct + tx);
+
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                cpu_instr_macl(&current_point, &matrix_ptr);
+                cpu_instr_macl(&current_point, &matrix_ptr);
+
+                const uint32_t y_mach = cpu_instr_sts_mach();
+                const uint32_t y_macl = cpu_instr_sts_macl();
+                const uint32_t ty = *matrix_ptr;
+                const uint32_t y_xtrct = cpu_instr_xtrct(y_mach, y_macl);
+
+                const FIXED point_y = (y_xtrct + ty);
+
+                const FIXED inv_z = __backend_divu_quotient_get(cpu_divu_regs);
+
+                trans_proj->screen.x = fix16_int16_muls(point_x, inv_z);
+                trans_proj->screen.y = fix16_int16_muls(point_y, fix16_mul(ratio, inv_z));
+
+                trans_proj++;
+        } while (current_point < last_point);
+}
+#else
+/* Must give the same results as the SH-2 version above */
+void
+__vertex_pool_transform(const POINT *points, uint16_t vertex_count,
+    transform_proj_t *trans_proj, const FIXED *top_matrix,
+    const vertex_pool_view_t *view)
+{
+        const FIXED view_distance = view->view_distance;
+        const FIXED z_near = view->near;
+        const FIXED ratio = view->ratio;
+
+        /* Same as the dividend written to the DVDNTH and DVDNTL registers */
+        const int64_t view_distance_16 = (int64_t)view_distance * 65536;
+
+        for (uint32_t i = 0; i < vertex_count; i++, trans_proj++) {
+                const FIXED * const point = points[i];
+
+                trans_proj->clip_flags = CLIP_FLAGS_NONE;
+                trans_proj->point_z =
+                    __backend_mac3(point, &top_matrix[M20]) + (uint32_t)top_matrix[M23];
+
+                /* In case the projected Z value is on or behind the near plane */
+                if (trans_proj->point_z < z_near) {
+                        trans_proj->clip_flags |= CLIP_FLAGS_NEAR;
+
+                        trans_proj->point_z = z_near;
+                }
+
+                const FIXED inv_z = __backend_divs(view_distance_16, trans_proj->point_z);
+
+                const FIXED point_x =
+                    __backend_mac3(point, &top_matrix[M00]) + (uint32_t)top_matrix[M03];
+                const FIXED point_y =
+                    __backend_mac3(point, &top_matrix[M10]) + (uint32_t)top_matrix[M13];
+
+                trans_proj->screen.x = __backend_fix16_int16_muls(point_x, inv_z);
+                trans_proj->screen.y = __backend_fix16_int16_muls(point_y,
+                    __backend_fix16_mul(ratio, inv_z));
+        }
+}
+#endif /* TRANSFORM_BACKEND == TRANSFORM_BACKEND_SH2 */
@@ -63,9 +63,11 @@ LIB_SRCS+= \
 	kernel/sys/callback-list.c \
 	kernel/sys/callback-list-internal.c \
 	\
+	kernel/mm/arena.c \
 	kernel/mm/memb.c \
 	kernel/mm/memb-internal.c \
-	kernel/mm/mm_stats.c
+	kernel/mm/mm_stats.c \
+	kernel/mm/mm_stats_track.c
 
 # TLSF is required
 LIB_SRCS+= \
@@ -193,6 +195,8 @@ LIB_SRCS+= \
 
 LIB_SRCS+= \
 	kernel/fs/cd/cdfs.c \
+	kernel/fs/cd/cdfs_cache.c \
+	kernel/fs/cd/cdfs_path.c \
 	kernel/fs/cd/cdfs_sector_read.c
 
 LIB_SRCS+= \
@@ -223,6 +227,7 @@ LIB_SRCS+= \
 	scu/bus/a/cs2/cd-block/cd-block_cmds.c \
 	scu/bus/a/cs2/cd-block/cd-block_execute.c \
 	scu/bus/a/cs2/cd-block/cd-block_init.c \
+	scu/bus/a/cs2/cd-block/cd-block_read.c \
 	\
 	scu/bus/b/scsp/scsp_init.c \
 	\
@@ -340,6 +345,7 @@ INSTALL_HEADER_FILES+= \
 	./kernel/dbgio/:dbgio.h:yaul/dbgio/
 
 INSTALL_HEADER_FILES+= \
+	./kernel/mm/:arena.h:yaul/mm/ \
 	./kernel/mm/:memb.h:yaul/mm/ \
 	./kernel/mm/:mm_stats.h:yaul/mm/
 
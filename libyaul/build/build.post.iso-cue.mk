@@ -10,6 +10,9 @@ include $(YAUL_INSTALL_ROOT)/share/ip.bin.mk
 
 IMAGE_DIRECTORY?= cd
 IMAGE_1ST_READ_BIN?= A.BIN
+# Optional file of "weight path" lines to order the files on the disc, as
+# written by cdfs_layout
+IMAGE_SORT_WEIGHT_LIST?=
 
 OUTPUT_FILES= $(SH_PROGRAM).iso $(SH_PROGRAM).cue
 CLEAN_OUTPUT_FILES= $(OUTPUT_FILES) $(SH_BUILD_PATH)/IP.BIN $(SH_BUILD_PATH)/IP.BIN.map
@@ -28,7 +31,8 @@ $(SH_PROGRAM).iso: $(SH_BUILD_PATH)/$(SH_PROGRAM).bin $(SH_BUILD_PATH)/IP.BIN
 		printf -- "empty\n" > $(IMAGE_DIRECTORY)/$$txt; \
 	    fi \
 	done
-	$(ECHO)$(YAUL_INSTALL_ROOT)/share/wrap-error $(YAUL_INSTALL_ROOT)/bin/make-iso $(IMAGE_DIRECTORY) $(SH_BUILD_PATH)/IP.BIN $(SH_PROGRAM)
+	$(ECHO)MAKE_ISO_SORT_WEIGHT_LIST="$(IMAGE_SORT_WEIGHT_LIST)" \
+	    $(YAUL_INSTALL_ROOT)/share/wrap-error $(YAUL_INSTALL_ROOT)/bin/make-iso $(IMAGE_DIRECTORY) $(SH_BUILD_PATH)/IP.BIN $(SH_PROGRAM)
 	$(ECHO)$(MAKE) --no-print-directory $$([ -z "$(SILENT)" ] || printf -- "-s") -f $(THIS_FILE) post-build-iso
 
 $(SH_PROGRAM).cue: | $(SH_PROGRAM).iso
@@ -92,6 +92,7 @@ SH_BUILD_DIR?= build
 # Customizable variables (must be overwritten in user's Makefile)
 # IMAGE_DIRECTORY      ISO/CUE
 # IMAGE_1ST_READ_BIN   ISO/CUE
+# IMAGE_SORT_WEIGHT_LIST ISO/CUE
 # IP_VERSION					 ISO/CUE, SS
 # IP_RELEASE_DATE			 ISO/CUE, SS
 # IP_AREAS						 ISO/CUE, SS
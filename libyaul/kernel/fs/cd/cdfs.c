@@ -19,6 +19,8 @@
 
 #include "cdfs.h"
 
+extern void __cdfs_cache_volume_set(uint32_t sector_count);
+
 static struct {
         cdfs_pvd_t pvd;
 } _state;
@@ -126,6 +128,10 @@ cdfs_filelist_walk(cdfs_filelist_t *filelist,
                 /* Logical block size must be CDFS_SECTOR_SIZE bytes */
                 assert(isonum_723(_state.pvd.logical_block_size) == CDFS_SECTOR_SIZE);
 
+                /* Keep the sector cache from reading ahead past the end of
+                 * the volume */
+                __cdfs_cache_volume_set(isonum_733(_state.pvd.volume_space_size));
+
                 _dirent_root_walk(filelist, walker, args);
         } else {
                 const uint32_t sector = FAD2LBA(root_entry->starting_fad);
@@ -190,12 +196,16 @@ _dirent_walk(cdfs_filelist_t *filelist, cdfs_filelist_walk_t walker,
         dirent_offset = 0;
 
         while (true) {
+                /* A directory record may end right at the end of the
+                 * sector */
                 uint8_t dirent_length =
-                    (dirent != NULL) ? isonum_711(dirent->length) : 0;
+                    ((dirent != NULL) && (dirent_offset < CDFS_SECTOR_SIZE))
+                        ? isonum_711(dirent->length)
+                        : 0;
 
                 if ((dirent == NULL) ||
                     (dirent_length == 0) ||
-                    ((dirent_offset + dirent_length) >= CDFS_SECTOR_SIZE)) {
+                    ((dirent_offset + dirent_length) > CDFS_SECTOR_SIZE)) {
                         dirent_sectors--;
 
                         if (dirent_sectors == 0) {
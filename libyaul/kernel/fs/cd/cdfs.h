@@ -24,6 +24,12 @@ __BEGIN_DECLS
 /* The maximum number of file list entries to read */
 #define CDFS_FILELIST_ENTRIES_COUNT (4096)
 
+/* The maximum number of lines in the sector cache */
+#define CDFS_CACHE_LINE_COUNT_MAX (32)
+
+/* Parent index of the entries in the directory that was read first */
+#define CDFS_PATH_PARENT_NONE   (0xFFFF)
+
 /* CDFS limitations */
 #define ISO_DIR_LEVEL_MAX       8
 #define ISO_FILENAME_MAX_LENGTH 11
@@ -31,6 +37,8 @@ __BEGIN_DECLS
 typedef uint32_t sector_t;
 
 typedef void (*cdfs_sector_read_t)(sector_t sector, void *ptr);
+typedef void (*cdfs_sectors_read_t)(sector_t sector, void *ptr, uint32_t count);
+typedef void (*cdfs_trace_t)(fad_t fad, uint32_t sector_count);
 
 typedef enum cdfs_entry_type {
         CDFS_ENTRY_TYPE_INVALID   = 0,
@@ -42,7 +50,7 @@ typedef struct {
         cdfs_entry_type_t type;
         char name[ISO_FILENAME_MAX_LENGTH + 1];
         fad_t starting_fad;
-        size_t size;
+        uint32_t size;
         uint16_t sector_count;
 } __aligned(32) cdfs_filelist_entry_t;
 
@@ -55,6 +63,30 @@ typedef struct {
         uint32_t entries_count;
 } cdfs_filelist_t;
 
+typedef struct {
+        uint32_t hit_count;
+        uint32_t miss_count;
+        /* Number of reads made to fill the cache, and the sectors read */
+        uint32_t read_count;
+        uint32_t read_sector_count;
+} cdfs_cache_stats_t;
+
+typedef struct {
+        /* Hash of the full path */
+        uint32_t hash;
+        /* Index into the file list, or CDFS_PATH_PARENT_NONE when empty */
+        uint16_t entry_index;
+} cdfs_path_slot_t;
+
+typedef struct {
+        const cdfs_filelist_t *filelist;
+        /* Index of the directory entry each entry is in. When NULL, every
+         * entry is in the same directory */
+        const uint16_t *parents;
+        cdfs_path_slot_t *slots;
+        uint32_t slot_count;
+} cdfs_path_index_t;
+
 typedef void (*cdfs_filelist_walk_t)(cdfs_filelist_t *filelist,
     const cdfs_filelist_entry_t *entry, void *args);
 
@@ -83,7 +115,29 @@ extern void cdfs_filelist_walk(cdfs_filelist_t *filelist,
     cdfs_filelist_walk_t walker,
     void *args);
 
+extern void cdfs_filelist_tree_read(cdfs_filelist_t *filelist,
+    uint16_t *parents);
+
+extern void cdfs_path_index_build(cdfs_path_index_t *index,
+    const cdfs_filelist_t *filelist, const uint16_t *parents,
+    cdfs_path_slot_t *slots, uint32_t slot_count);
+extern const cdfs_filelist_entry_t *cdfs_path_lookup(
+    const cdfs_path_index_t *index, const char *path);
+
+extern void cdfs_cache_init(void *buffer, uint32_t sector_count,
+    uint32_t readahead_count, cdfs_sectors_read_t sectors_read);
+extern void cdfs_cache_flush(void);
+extern void cdfs_cache_stats_get(cdfs_cache_stats_t *stats);
+extern void cdfs_cache_sector_read(sector_t sector, void *ptr);
+extern void cdfs_cache_prefetch(sector_t sector);
+
 void cdfs_sector_read(sector_t sector, void *ptr);
+void cdfs_sectors_read(sector_t sector, void *ptr, uint32_t count);
+
+/* Called on each read made by cdfs_sector_read() and cdfs_sectors_read(). The
+ * reads, one "FAD sector-count" pair per line, make up the access trace used
+ * by cdfs_layout to lay out the disc */
+void cdfs_trace_set(cdfs_trace_t trace);
 
 __END_DECLS
 
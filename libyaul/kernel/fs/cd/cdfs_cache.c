@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cdfs.h"
+
+#define SECTOR_NONE     (0xFFFFFFFF)
+
+/* Each line holds a run of sectors that was read in one go */
+typedef struct {
+        sector_t sector;
+        uint32_t count;
+        /* Increases with each use, to find the least recently used line */
+        uint32_t use;
+} cache_line_t;
+
+static struct {
+        cdfs_sectors_read_t sectors_read;
+
+        uint8_t *buffer;
+        uint32_t line_sector_count;
+        uint32_t line_count;
+
+        /* Sectors past the end of the volume are never read ahead */
+        sector_t sector_end;
+
+        uint32_t use;
+
+        cdfs_cache_stats_t stats;
+
+        cache_line_t lines[CDFS_CACHE_LINE_COUNT_MAX];
+} _state = {
+        .sector_end = SECTOR_NONE
+};
+
+static const uint8_t *_line_sector_get(sector_t sector);
+static cache_line_t *_line_find(sector_t sector);
+static cache_line_t *_line_evict(void);
+static void _line_fill(cache_line_t *line, sector_t sector);
+
+/* The buffer holds sector_count sectors. It's split into lines of
+ * readahead_count sectors, and each miss reads a whole line starting at the
+ * missed sector, so sequential reads only miss once per line. When
+ * sectors_read is NULL, sectors are read from the disc */
+void
+cdfs_cache_init(void *buffer, uint32_t sector_count, uint32_t readahead_count,
+    cdfs_sectors_read_t sectors_read)
+{
+        assert(buffer != NULL);
+        assert(readahead_count > 0);
+        assert(sector_count >= readahead_count);
+
+        _state.sectors_read = (sectors_read != NULL) ? sectors_read : cdfs_sectors_read;
+
+        _state.buffer = buffer;
+        _state.line_sector_count = readahead_count;
+        _state.line_count = sector_count / readahead_count;
+
+        if (_state.line_count > CDFS_CACHE_LINE_COUNT_MAX) {
+                _state.line_count = CDFS_CACHE_LINE_COUNT_MAX;
+        }
+
+        (void)memset(&_state.stats, 0, sizeof(cdfs_cache_stats_t));
+
+        cdfs_cache_flush();
+}
+
+void
+cdfs_cache_flush(void)
+{
+        _state.use = 0;
+
+        for (uint32_t i = 0; i < _state.line_count; i++) {
+                _state.lines[i].sector = SECTOR_NONE;
+                _state.lines[i].count = 0;
+                _state.lines[i].use = 0;
+        }
+}
+
+void
+cdfs_cache_stats_get(cdfs_cache_stats_t *stats)
+{
+        assert(stats != NULL);
+
+        (void)memcpy(stats, &_state.stats, sizeof(cdfs_cache_stats_t));
+}
+
+/* Can be used as the sector read function of a file list */
+void
+cdfs_cache_sector_read(sector_t sector, void *ptr)
+{
+        assert(_state.buffer != NULL);
+        assert(ptr != NULL);
+
+        (void)memcpy(ptr, _line_sector_get(sector), CDFS_SECTOR_SIZE);
+}
+
+/* Read the sectors ahead of time, so that reading them later hits */
+void
+cdfs_cache_prefetch(sector_t sector)
+{
+        assert(_state.buffer != NULL);
+
+        if ((_line_find(sector)) != NULL) {
+                return;
+        }
+
+        _line_fill(_line_evict(), sector);
+}
+
+void
+__cdfs_cache_volume_set(uint32_t sector_count)
+{
+        _state.sector_end = sector_count;
+}
+
+static const uint8_t *
+_line_sector_get(sector_t sector)
+{
+        cache_line_t *line;
+
+        line = _line_find(sector);
+
+        if (line != NULL) {
+                _state.stats.hit_count++;
+        } else {
+                _state.stats.miss_count++;
+
+                line = _line_evict();
+
+                _line_fill(line, sector);
+        }
+
+        line->use = ++_state.use;
+
+        const uint32_t line_index = line - _state.lines;
+        const uint32_t sector_index =
+            (line_index * _state.line_sector_count) + (sector - line->sector);
+
+        return &_state.buffer[sector_index * CDFS_SECTOR_SIZE];
+}
+
+static cache_line_t *
+_line_find(sector_t sector)
+{
+        for (uint32_t i = 0; i < _state.line_count; i++) {
+                cache_line_t * const line = &_state.lines[i];
+
+                /* Unsigned, so sectors before the line wrap around */
+                if ((sector - line->sector) < line->count) {
+                        return line;
+                }
+        }
+
+        return NULL;
+}
+
+static cache_line_t *
+_line_evict(void)
+{
+        cache_line_t *lru_line;
+        lru_line = &_state.lines[0];
+
+        for (uint32_t i = 1; i < _state.line_count; i++) {
+                cache_line_t * const line = &_state.lines[i];
+
+                if (line->use < lru_line->use) {
+                        lru_line = line;
+                }
+        }
+
+        return lru_line;
+}
+
+static void
+_line_fill(cache_line_t *line, sector_t sector)
+{
+        uint32_t count;
+        count = _state.line_sector_count;
+
+        if ((sector < _state.sector_end) && ((_state.sector_end - sector) < count)) {
+                count = _state.sector_end - sector;
+        }
+
+        /* Another line may already hold some of the sectors. As the disc is
+         * read-only, both copies stay the same */
+        const uint32_t line_index = line - _state.lines;
+        uint8_t * const ptr =
+            &_state.buffer[line_index * _state.line_sector_count * CDFS_SECTOR_SIZE];
+
+        _state.sectors_read(sector, ptr, count);
+
+        _state.stats.read_count++;
+        _state.stats.read_sector_count += count;
+
+        line->sector = sector;
+        line->count = count;
+        line->use = ++_state.use;
+}
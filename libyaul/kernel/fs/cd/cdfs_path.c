@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cdfs.h"
+
+/* 32-bit FNV-1a */
+#define HASH_BASIS      (0x811C9DC5UL)
+#define HASH_PRIME      (0x01000193UL)
+
+static uint32_t _hash_bytes(uint32_t hash, const char *s, size_t length);
+static uint32_t _entry_hash(const cdfs_path_index_t *index, uint16_t entry_index);
+static bool _entry_path_match(const cdfs_path_index_t *index,
+    uint16_t entry_index, const char *path, size_t length);
+
+static inline uint16_t __always_inline
+_entry_parent_get(const cdfs_path_index_t *index, uint16_t entry_index)
+{
+        if (index->parents == NULL) {
+                return CDFS_PATH_PARENT_NONE;
+        }
+
+        return index->parents[entry_index];
+}
+
+/* Read the entire directory tree, starting from the root directory. The
+ * directory each entry is in is written to parents, which has as many entries
+ * as the file list can hold */
+void
+cdfs_filelist_tree_read(cdfs_filelist_t *filelist, uint16_t *parents)
+{
+        assert(filelist != NULL);
+        assert(parents != NULL);
+
+        filelist->entries_count = 0;
+
+        cdfs_filelist_root_read(filelist);
+
+        for (uint32_t i = 0; i < filelist->entries_count; i++) {
+                parents[i] = CDFS_PATH_PARENT_NONE;
+        }
+
+        /* The entries of each directory read are appended, so the loop
+         * reaches them too */
+        for (uint32_t i = 0; i < filelist->entries_count; i++) {
+                const cdfs_filelist_entry_t * const entry = &filelist->entries[i];
+
+                if (entry->type != CDFS_ENTRY_TYPE_DIRECTORY) {
+                        continue;
+                }
+
+                const uint32_t first_index = filelist->entries_count;
+
+                cdfs_filelist_read(filelist, *entry);
+
+                for (uint32_t j = first_index; j < filelist->entries_count; j++) {
+                        parents[j] = i;
+                }
+        }
+}
+
+/* Build an index over the paths of the file list. Use the parents written by
+ * cdfs_filelist_tree_read() to look up full paths, or NULL to look up the names
+ * of a single directory read by cdfs_filelist_read(). The number of slots is a
+ * power of two, and should be about twice the number of entries */
+void
+cdfs_path_index_build(cdfs_path_index_t *index,
+    const cdfs_filelist_t *filelist, const uint16_t *parents,
+    cdfs_path_slot_t *slots, uint32_t slot_count)
+{
+        assert(index != NULL);
+        assert(filelist != NULL);
+        assert(slots != NULL);
+        assert((slot_count & (slot_count - 1)) == 0);
+        assert(slot_count > filelist->entries_count);
+
+        index->filelist = filelist;
+        index->parents = parents;
+        index->slots = slots;
+        index->slot_count = slot_count;
+
+        for (uint32_t i = 0; i < slot_count; i++) {
+                slots[i].entry_index = CDFS_PATH_PARENT_NONE;
+        }
+
+        const uint32_t mask = slot_count - 1;
+
+        for (uint32_t i = 0; i < filelist->entries_count; i++) {
+                const uint32_t hash = _entry_hash(index, i);
+
+                uint32_t slot_index;
+                slot_index = hash & mask;
+
+                while (slots[slot_index].entry_index != CDFS_PATH_PARENT_NONE) {
+                        slot_index = (slot_index + 1) & mask;
+                }
+
+                slots[slot_index].hash = hash;
+                slots[slot_index].entry_index = i;
+        }
+}
+
+/* Look up a path such as "DATA/LEVEL1.BIN". Returns NULL when the path isn't
+ * in the file list */
+const cdfs_filelist_entry_t *
+cdfs_path_lookup(const cdfs_path_index_t *index, const char *path)
+{
+        assert(index != NULL);
+        assert(path != NULL);
+
+        while (*path == '/') {
+                path++;
+        }
+
+        const size_t length = strlen(path);
+        const uint32_t hash = _hash_bytes(HASH_BASIS, path, length);
+        const uint32_t mask = index->slot_count - 1;
+
+        uint32_t slot_index;
+        slot_index = hash & mask;
+
+        while (true) {
+                const cdfs_path_slot_t * const slot = &index->slots[slot_index];
+
+                if (slot->entry_index == CDFS_PATH_PARENT_NONE) {
+                        return NULL;
+                }
+
+                if ((slot->hash == hash) &&
+                    (_entry_path_match(index, slot->entry_index, path, length))) {
+                        return &index->filelist->entries[slot->entry_index];
+                }
+
+                slot_index = (slot_index + 1) & mask;
+        }
+}
+
+static uint32_t
+_hash_bytes(uint32_t hash, const char *s, size_t length)
+{
+        for (uint32_t i = 0; i < length; i++) {
+                hash = (hash ^ (uint8_t)s[i]) * HASH_PRIME;
+        }
+
+        return hash;
+}
+
+/* The hash of a path is built up from the hash of its parent directory */
+static uint32_t
+_entry_hash(const cdfs_path_index_t *index, uint16_t entry_index)
+{
+        const char * const name = index->filelist->entries[entry_index].name;
+        const uint16_t parent_index = _entry_parent_get(index, entry_index);
+
+        uint32_t hash;
+        hash = HASH_BASIS;
+
+        if (parent_index != CDFS_PATH_PARENT_NONE) {
+                hash = _hash_bytes(_entry_hash(index, parent_index), "/", 1);
+        }
+
+        return _hash_bytes(hash, name, strlen(name));
+}
+
+/* Match the path one name at a time, from the last name to the first */
+static bool
+_entry_path_match(const cdfs_path_index_t *index, uint16_t entry_index,
+    const char *path, size_t length)
+{
+        const char *end;
+        end = path + length;
+
+        while (true) {
+                const char * const name = index->filelist->entries[entry_index].name;
+                const size_t name_length = strlen(name);
+
+                if ((size_t)(end - path) < name_length) {
+                        return false;
+                }
+
+                const char * const path_name = end - name_length;
+
+                if ((memcmp(path_name, name, name_length)) != 0) {
+                        return false;
+                }
+
+                entry_index = _entry_parent_get(index, entry_index);
+
+                if (entry_index == CDFS_PATH_PARENT_NONE) {
+                        return (path_name == path);
+                }
+
+                if ((path_name == path) || (path_name[-1] != '/')) {
+                        return false;
+                }
+
+                end = path_name - 1;
+        }
+}
@@ -12,8 +12,30 @@
 
 #include "cdfs.h"
 
+static cdfs_trace_t _trace = NULL;
+
+void
+cdfs_trace_set(cdfs_trace_t trace)
+{
+        _trace = trace;
+}
+
 void
 cdfs_sector_read(sector_t sector, void *ptr)
 {
+        if (_trace != NULL) {
+                _trace(LBA2FAD(sector), 1);
+        }
+
         cd_block_sector_read(LBA2FAD(sector), ptr);
 }
+
+void
+cdfs_sectors_read(sector_t sector, void *ptr, uint32_t count)
+{
+        if (_trace != NULL) {
+                _trace(LBA2FAD(sector), count);
+        }
+
+        cd_block_sectors_read(LBA2FAD(sector), ptr, count * CDFS_SECTOR_SIZE);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2012-2019 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <sys/cdefs.h>
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <mm/arena.h>
+
+static inline uintptr_t __always_inline
+_align_up(uintptr_t address, size_t align)
+{
+        return ((address + (align - 1)) & ~(uintptr_t)(align - 1));
+}
+
+void
+arena_init(arena_t *arena, void *pool, size_t size)
+{
+        assert(arena != NULL);
+        assert(pool != NULL);
+
+        arena->base = _align_up((uintptr_t)pool, ARENA_ALIGN);
+        arena->end = (uintptr_t)pool + size;
+
+        assert(arena->base <= arena->end);
+
+        arena->peak_size = 0;
+        arena->alloc_count = 0;
+        arena->failed_count = 0;
+
+        arena_clear(arena);
+}
+
+void
+arena_clear(arena_t *arena)
+{
+        assert(arena != NULL);
+
+        arena->top = arena->base;
+        arena->scope = 0;
+        arena->scope_depth = 0;
+}
+
+void *
+arena_alloc(arena_t *arena, size_t size)
+{
+        return arena_memalign(arena, size, ARENA_ALIGN);
+}
+
+void *
+arena_memalign(arena_t *arena, size_t size, size_t align)
+{
+        assert(arena != NULL);
+        assert(align > 0);
+        assert((align & (align - 1)) == 0);
+
+        const uintptr_t address = _align_up(arena->top, align);
+
+        /* Written so that it can't overflow */
+        if ((address > arena->end) || (size > (arena->end - address))) {
+                arena->failed_count++;
+
+                return NULL;
+        }
+
+        arena->top = address + _align_up(size, ARENA_ALIGN);
+
+        if (arena->top > arena->end) {
+                arena->top = arena->end;
+        }
+
+        arena->alloc_count++;
+
+        const size_t used_size = arena->top - arena->base;
+
+        if (used_size > arena->peak_size) {
+                arena->peak_size = used_size;
+        }
+
+        return (void *)address;
+}
+
+arena_mark_t
+arena_mark(const arena_t *arena)
+{
+        assert(arena != NULL);
+
+        return arena->top;
+}
+
+/* Free everything allocated since the mark was taken. The mark can't be older
+ * than the innermost scope */
+void
+arena_reset(arena_t *arena, arena_mark_t mark)
+{
+        assert(arena != NULL);
+        assert((mark >= arena->base) && (mark <= arena->top));
+        assert((arena->scope == 0) || (mark > arena->scope));
+
+        arena->top = mark;
+}
+
+/* The state of the enclosing scope is saved in the arena itself, so scopes can
+ * nest as deep as the arena has room for. Returns false when the arena is full,
+ * in which case no scope is pushed, and arena_scope_pop() must not be called */
+bool
+arena_scope_push(arena_t *arena)
+{
+        uintptr_t * const scope = arena_alloc(arena, sizeof(uintptr_t));
+
+        if (scope == NULL) {
+                return false;
+        }
+
+        *scope = arena->scope;
+
+        arena->scope = (uintptr_t)scope;
+        arena->scope_depth++;
+
+        return true;
+}
+
+/* Free everything allocated since the matching arena_scope_push() */
+void
+arena_scope_pop(arena_t *arena)
+{
+        assert(arena != NULL);
+        assert(arena->scope_depth > 0);
+
+        const uintptr_t * const scope = (const uintptr_t *)arena->scope;
+
+        arena->top = (uintptr_t)scope;
+        arena->scope = *scope;
+        arena->scope_depth--;
+}
+
+size_t
+arena_used_size(const arena_t *arena)
+{
+        return (arena->top - arena->base);
+}
+
+size_t
+arena_free_size(const arena_t *arena)
+{
+        return (arena->end - arena->top);
+}
+
+void
+arena_walk(const arena_t *arena, mm_stats_walker_t walker, void *work)
+{
+        assert(arena != NULL);
+        assert(walker != NULL);
+
+        mm_stats_walk_entry_t walk_entry = {
+                .work = work
+        };
+
+        if (arena->top > arena->base) {
+                walk_entry.address = arena->base;
+                walk_entry.size = arena->top - arena->base;
+                walk_entry.used = true;
+
+                walker(&walk_entry);
+        }
+
+        if (arena->end > arena->top) {
+                walk_entry.address = arena->top;
+                walk_entry.size = arena->end - arena->top;
+                walk_entry.used = false;
+
+                walker(&walk_entry);
+        }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2012-2019 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _YAUL_KERNEL_MM_ARENA_H_
+#define _YAUL_KERNEL_MM_ARENA_H_
+
+#include <sys/cdefs.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/mm_stats.h>
+
+__BEGIN_DECLS
+
+/* Alignment of arena_alloc() */
+#define ARENA_ALIGN             (4)
+
+/*
+ * Bump pointer allocator over a caller-provided region, such as
+ * HWRAM(0x...), LWRAM(0) or dram_cart_area_get(). Allocations are only freed
+ * all at once, by resetting the arena to a mark, or by popping a scope.
+ */
+typedef struct arena {
+        uintptr_t base;
+        uintptr_t end;
+        uintptr_t top;
+        /* Link to the state saved by the innermost scope, or 0 */
+        uintptr_t scope;
+        uint16_t scope_depth;
+
+        /* High-water mark of the used size */
+        size_t peak_size;
+        uint32_t alloc_count;
+        /* Allocations that didn't fit */
+        uint32_t failed_count;
+} arena_t;
+
+typedef uintptr_t arena_mark_t;
+
+void arena_init(arena_t *arena, void *pool, size_t size);
+void arena_clear(arena_t *arena);
+
+void *arena_alloc(arena_t *arena, size_t size);
+void *arena_memalign(arena_t *arena, size_t size, size_t align);
+
+arena_mark_t arena_mark(const arena_t *arena);
+void arena_reset(arena_t *arena, arena_mark_t mark);
+
+bool arena_scope_push(arena_t *arena);
+void arena_scope_pop(arena_t *arena);
+
+size_t arena_used_size(const arena_t *arena);
+size_t arena_free_size(const arena_t *arena);
+
+/* Walks the used and the free part of the arena, each as one block */
+void arena_walk(const arena_t *arena, mm_stats_walker_t walker, void *work);
+
+__END_DECLS
+
+#endif /* _YAUL_KERNEL_MM_ARENA_H_ */
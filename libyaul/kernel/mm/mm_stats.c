@@ -1,5 +1,7 @@
 #include <sys/cdefs.h>
 
+#include <string.h>
+
 #include <mm/mm_stats.h>
 
 void __weak
@@ -17,3 +19,19 @@ mm_stats_yaul_walk(mm_stats_walker_t walker, void *work)
 
         __mm_stats_private_walk(walker, work);
 }
+
+void
+mm_stats_heap_get(mm_stats_heap_t *heap)
+{
+        (void)memset(heap, 0, sizeof(mm_stats_heap_t));
+
+        mm_stats_walk(mm_stats_heap_walker, heap);
+}
+
+void
+mm_stats_yaul_heap_get(mm_stats_heap_t *heap)
+{
+        (void)memset(heap, 0, sizeof(mm_stats_heap_t));
+
+        mm_stats_yaul_walk(mm_stats_heap_walker, heap);
+}
@@ -3,6 +3,7 @@
 
 #include <sys/cdefs.h>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -17,9 +18,72 @@ typedef struct mm_stats_walk_entry {
 
 typedef void (*mm_stats_walker_t)(const mm_stats_walk_entry_t *walk_entry);
 
+/* Totals of a heap, gathered by passing mm_stats_heap_walker() to a walk with
+ * a zeroed mm_stats_heap_t as the work */
+typedef struct mm_stats_heap {
+        size_t used_size;
+        size_t free_size;
+        /* When much smaller than free_size, the heap is fragmented */
+        size_t largest_free_size;
+        uint32_t used_count;
+        uint32_t free_count;
+} mm_stats_heap_t;
+
+/* A live allocation */
+typedef struct mm_stats_allocation {
+        uintptr_t address;
+        size_t size;
+        uint16_t site_index;
+        /* Value of the allocation sequence when allocated */
+        uint32_t sequence;
+} mm_stats_allocation_t;
+
+/* Allocations made from one call site */
+typedef struct mm_stats_site {
+        uintptr_t site;
+        uint32_t alloc_count;
+        uint32_t free_count;
+        size_t live_size;
+        size_t peak_size;
+        /* Sum of the lifetimes of the freed allocations. A lifetime is the
+         * number of allocations made between allocating and freeing */
+        uint32_t lifetime_total;
+} mm_stats_site_t;
+
+/* The caller provides the storage. The number of allocations is a power of
+ * two, and should be well above the most allocations live at once */
+typedef struct mm_stats_track {
+        mm_stats_allocation_t *allocations;
+        uint32_t allocation_count;
+        mm_stats_site_t *sites;
+        uint16_t site_count;
+
+        /* Set by the tracker */
+        uint16_t site_used_count;
+        uint32_t allocation_used_count;
+        uint32_t sequence;
+        size_t live_size;
+        /* High-water mark of live_size */
+        size_t peak_size;
+        /* Allocations not tracked because either table was full */
+        uint32_t dropped_count;
+} mm_stats_track_t;
+
 void mm_stats_walk(mm_stats_walker_t walker, void *work);
 void mm_stats_yaul_walk(mm_stats_walker_t walker, void *work);
 
+void mm_stats_heap_walker(const mm_stats_walk_entry_t *walk_entry);
+void mm_stats_heap_get(mm_stats_heap_t *heap);
+void mm_stats_yaul_heap_get(mm_stats_heap_t *heap);
+uint8_t mm_stats_heap_fragmentation_get(const mm_stats_heap_t *heap);
+
+void mm_stats_track_start(mm_stats_track_t *track);
+void mm_stats_track_stop(void);
+void mm_stats_track_alloc(void *address, size_t size, const void *site);
+void mm_stats_track_free(void *address);
+void mm_stats_track_realloc(void *old, void *address, size_t size,
+    const void *site);
+
 __END_DECLS
 
 #endif /* _YAUL_KERNEL_MM_MM_STATS_H_ */
@@ -0,0 +1,263 @@
+/* Nothing here depends on the rest of libyaul, so that the tracker can also be
+ * built and run on the host */
+
+#include <sys/cdefs.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <mm/mm_stats.h>
+
+#define SITE_INDEX_NONE         (0xFFFF)
+
+static mm_stats_track_t *_track = NULL;
+
+static uint32_t _allocation_hash(uintptr_t address);
+static mm_stats_allocation_t *_allocation_find(uintptr_t address);
+static void _allocation_remove(mm_stats_allocation_t *allocation);
+static uint16_t _site_get(uintptr_t site);
+
+void
+mm_stats_heap_walker(const mm_stats_walk_entry_t *walk_entry)
+{
+        mm_stats_heap_t * const heap = walk_entry->work;
+
+        if (walk_entry->used) {
+                heap->used_size += walk_entry->size;
+                heap->used_count++;
+
+                return;
+        }
+
+        heap->free_size += walk_entry->size;
+        heap->free_count++;
+
+        if (walk_entry->size > heap->largest_free_size) {
+                heap->largest_free_size = walk_entry->size;
+        }
+}
+
+/* Percentage of the free memory that lies outside of the largest free block */
+uint8_t
+mm_stats_heap_fragmentation_get(const mm_stats_heap_t *heap)
+{
+        if (heap->free_size == 0) {
+                return 0;
+        }
+
+        const size_t scattered_size = heap->free_size - heap->largest_free_size;
+
+        return (uint8_t)(((uint64_t)scattered_size * 100) / heap->free_size);
+}
+
+void
+mm_stats_track_start(mm_stats_track_t *track)
+{
+        assert(track != NULL);
+        assert(track->allocations != NULL);
+        assert(track->allocation_count > 0);
+        assert((track->allocation_count & (track->allocation_count - 1)) == 0);
+        assert(track->sites != NULL);
+        assert(track->site_count > 0);
+
+        (void)memset(track->allocations, 0,
+            track->allocation_count * sizeof(mm_stats_allocation_t));
+        (void)memset(track->sites, 0, track->site_count * sizeof(mm_stats_site_t));
+
+        track->site_used_count = 0;
+        track->allocation_used_count = 0;
+        track->sequence = 0;
+        track->live_size = 0;
+        track->peak_size = 0;
+        track->dropped_count = 0;
+
+        _track = track;
+}
+
+void
+mm_stats_track_stop(void)
+{
+        _track = NULL;
+}
+
+void
+mm_stats_track_alloc(void *address, size_t size, const void *site)
+{
+        mm_stats_track_t * const track = _track;
+
+        if ((track == NULL) || (address == NULL)) {
+                return;
+        }
+
+        track->sequence++;
+
+        /* Keep at least one empty entry so that lookups always end */
+        if ((track->allocation_used_count + 1) >= track->allocation_count) {
+                track->dropped_count++;
+
+                return;
+        }
+
+        const uint16_t site_index = _site_get((uintptr_t)site);
+
+        if (site_index == SITE_INDEX_NONE) {
+                track->dropped_count++;
+
+                return;
+        }
+
+        const uint32_t mask = track->allocation_count - 1;
+
+        uint32_t index = _allocation_hash((uintptr_t)address) & mask;
+
+        while (track->allocations[index].address != 0) {
+                index = (index + 1) & mask;
+        }
+
+        mm_stats_allocation_t * const allocation = &track->allocations[index];
+
+        allocation->address = (uintptr_t)address;
+        allocation->size = size;
+        allocation->site_index = site_index;
+        allocation->sequence = track->sequence;
+
+        track->allocation_used_count++;
+
+        mm_stats_site_t * const track_site = &track->sites[site_index];
+
+        track_site->alloc_count++;
+        track_site->live_size += size;
+
+        if (track_site->live_size > track_site->peak_size) {
+                track_site->peak_size = track_site->live_size;
+        }
+
+        track->live_size += size;
+
+        if (track->live_size > track->peak_size) {
+                track->peak_size = track->live_size;
+        }
+}
+
+void
+mm_stats_track_free(void *address)
+{
+        mm_stats_track_t * const track = _track;
+
+        if ((track == NULL) || (address == NULL)) {
+                return;
+        }
+
+        mm_stats_allocation_t * const allocation = _allocation_find((uintptr_t)address);
+
+        /* Allocated before tracking started, or dropped */
+        if (allocation == NULL) {
+                return;
+        }
+
+        mm_stats_site_t * const track_site = &track->sites[allocation->site_index];
+
+        track_site->free_count++;
+        track_site->live_size -= allocation->size;
+        track_site->lifetime_total += track->sequence - allocation->sequence;
+
+        track->live_size -= allocation->size;
+
+        _allocation_remove(allocation);
+}
+
+/* Track realloc(old, size) having returned address. On failure, the old
+ * allocation is left untouched */
+void
+mm_stats_track_realloc(void *old, void *address, size_t size, const void *site)
+{
+        if ((address == NULL) && (size != 0)) {
+                return;
+        }
+
+        mm_stats_track_free(old);
+        mm_stats_track_alloc(address, size, site);
+}
+
+static uint32_t
+_allocation_hash(uintptr_t address)
+{
+        /* Allocations are at least 4-byte aligned */
+        return (uint32_t)((address >> 2) * 2654435761UL);
+}
+
+static mm_stats_allocation_t *
+_allocation_find(uintptr_t address)
+{
+        const uint32_t mask = _track->allocation_count - 1;
+
+        uint32_t index = _allocation_hash(address) & mask;
+
+        while (_track->allocations[index].address != 0) {
+                if (_track->allocations[index].address == address) {
+                        return &_track->allocations[index];
+                }
+
+                index = (index + 1) & mask;
+        }
+
+        return NULL;
+}
+
+/* Shift back the entries that follow the removed entry, so that lookups don't
+ * stop early at the emptied entry */
+static void
+_allocation_remove(mm_stats_allocation_t *allocation)
+{
+        mm_stats_allocation_t * const allocations = _track->allocations;
+        const uint32_t mask = _track->allocation_count - 1;
+
+        uint32_t empty_index = allocation - allocations;
+        uint32_t index = empty_index;
+
+        while (true) {
+                index = (index + 1) & mask;
+
+                if (allocations[index].address == 0) {
+                        break;
+                }
+
+                const uint32_t home_index = _allocation_hash(allocations[index].address) & mask;
+
+                /* Only move the entry if its home isn't between the emptied
+                 * entry and where it is now */
+                if (((index - home_index) & mask) >= ((index - empty_index) & mask)) {
+                        allocations[empty_index] = allocations[index];
+
+                        empty_index = index;
+                }
+        }
+
+        allocations[empty_index].address = 0;
+
+        _track->allocation_used_count--;
+}
+
+static uint16_t
+_site_get(uintptr_t site)
+{
+        mm_stats_site_t * const sites = _track->sites;
+
+        for (uint32_t i = 0; i < _track->site_used_count; i++) {
+                if (sites[i].site == site) {
+                        return i;
+                }
+        }
+
+        if (_track->site_used_count == _track->site_count) {
+                return SITE_INDEX_NONE;
+        }
+
+        const uint16_t site_index = _track->site_used_count;
+
+        sites[site_index].site = site;
+
+        _track->site_used_count++;
+
+        return site_index;
+}
@@ -1,5 +1,7 @@
 #include <sys/cdefs.h>
 
+#include <mm/mm_stats.h>
+
 #include <internal.h>
 
 void __weak
@@ -7,5 +9,7 @@ free(void *addr)
 {
         void __user_free(void *addr);
 
+        mm_stats_track_free(addr);
+
         __user_free(addr);
 }
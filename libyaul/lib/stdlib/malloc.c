@@ -4,6 +4,8 @@
 #include <mm/tlsf.h>
 #endif /* MALLOC_IMPL_TLSF */
 
+#include <mm/mm_stats.h>
+
 #include <internal.h>
 
 void * __weak
@@ -11,5 +13,9 @@ malloc(size_t n)
 {
         extern void *__user_malloc(size_t n);
 
-        return __user_malloc(n);
+        void * const ptr = __user_malloc(n);
+
+        mm_stats_track_alloc(ptr, n, __builtin_return_address(0));
+
+        return ptr;
 }
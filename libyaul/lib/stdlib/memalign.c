@@ -1,5 +1,7 @@
 #include <sys/cdefs.h>
 
+#include <mm/mm_stats.h>
+
 #include <internal.h>
 
 void * __weak
@@ -7,5 +9,9 @@ memalign(size_t n, size_t align)
 {
         extern void *__user_memalign(size_t n, size_t align);
 
-        return __user_memalign(n, align);
+        void * const ptr = __user_memalign(n, align);
+
+        mm_stats_track_alloc(ptr, n, __builtin_return_address(0));
+
+        return ptr;
 }
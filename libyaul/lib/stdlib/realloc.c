@@ -1,5 +1,7 @@
 #include <sys/cdefs.h>
 
+#include <mm/mm_stats.h>
+
 #include <internal.h>
 
 void * __weak
@@ -7,5 +9,9 @@ realloc(void *old, size_t new_len)
 {
         extern void *__user_realloc(void *old, size_t new_len);
 
-        return __user_realloc(old, new_len);
+        void * const ptr = __user_realloc(old, new_len);
+
+        mm_stats_track_realloc(old, ptr, new_len, __builtin_return_address(0));
+
+        return ptr;
 }
@@ -9,14 +9,47 @@
 #ifndef _YAUL_CD_BLOCK_H_
 #define _YAUL_CD_BLOCK_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <scu/dma.h>
+
 #include <cd-block/cmd.h>
 
 #define CDFS_SECTOR_SIZE (2048U)
 
 __BEGIN_DECLS
 
+typedef enum cd_block_read_status {
+        CD_BLOCK_READ_STATUS_QUEUED,
+        CD_BLOCK_READ_STATUS_READING,
+        CD_BLOCK_READ_STATUS_DONE,
+        CD_BLOCK_READ_STATUS_ERROR
+} cd_block_read_status_t;
+
+struct cd_block_read;
+
+typedef void (*cd_block_read_callback_t)(struct cd_block_read *read);
+
+/**
+ * An asynchronous read request. The request is owned by the caller, and must
+ * stay valid until it's done.
+ */
+typedef struct cd_block_read {
+        fad_t fad;
+        uint32_t sector_count;
+        /* Holds sector_count sectors, and is 4-byte aligned */
+        void *buffer;
+        /* Called once the request is done, or has failed. May be NULL */
+        cd_block_read_callback_t callback;
+        void *work;
+
+        /* Set by the read pipeline */
+        volatile cd_block_read_status_t status;
+        volatile uint32_t sector_read_count;
+        struct cd_block_read *next;
+} cd_block_read_t;
+
 /**
  * Initialize the cd block subsystem.
  *
@@ -59,6 +92,37 @@ extern int cd_block_sector_read(fad_t fad, void *output_buffer);
  */
 extern int cd_block_sectors_read(fad_t fad, void *output_buffer, uint32_t length);
 
+/**
+ * Set the SCU-DMA level used to transfer the sectors of asynchronous reads,
+ * and set the CD-block interrupt handler.
+ *
+ * @param level SCU-DMA level.
+ */
+extern void cd_block_read_init(scu_dma_level_t level);
+
+/**
+ * Queue a read. The read starts right away if nothing else is being read.
+ *
+ * Reads are moved along by the CD-block and SCU-DMA end interrupts, so the
+ * completion callbacks are called from interrupt handlers, with interrupts
+ * disabled. They may also be called from this function, or from
+ * @ref cd_block_read_poll.
+ *
+ * @param read The read request.
+ */
+extern void cd_block_read_submit(cd_block_read_t *read);
+
+/**
+ * Advance the queued reads without waiting for the disc. Calling it isn't
+ * needed, as the reads are advanced from interrupts.
+ */
+extern void cd_block_read_poll(void);
+
+/**
+ * Check if any read is still queued or in progress.
+ */
+extern bool cd_block_read_busy(void);
+
 __END_DECLS
 
 #endif /* !_YAUL_CD_BLOCK_H_ */
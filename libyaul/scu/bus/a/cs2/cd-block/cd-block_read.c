@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2012-2019 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <cd-block.h>
+
+#include <cpu/cache.h>
+#include <cpu/intc.h>
+
+#include <scu/dma.h>
+#include <scu/ic.h>
+
+#include "cd-block-internal.h"
+
+typedef enum {
+        /* Nothing is being read */
+        READ_STATE_IDLE,
+        /* Waiting for sectors to be in the CD-block buffer */
+        READ_STATE_SECTORS_WAIT,
+        /* Waiting for the CD-block to have the sectors ready to transfer */
+        READ_STATE_DRDY_WAIT,
+        /* Waiting for the SCU-DMA transfer to end */
+        READ_STATE_TRANSFER_WAIT
+} read_state_t;
+
+/* Levels 1 and 2 can only transfer 4KiB at a time */
+#define TRANSFER_SECTOR_COUNT_MAX(level)                                       \
+        (((level) == 0) ? UINT32_MAX : (4096 / CDFS_SECTOR_SIZE))
+
+static struct {
+        scu_dma_level_t dma_level;
+
+        read_state_t state;
+
+        cd_block_read_t * volatile head;
+        cd_block_read_t *tail;
+
+        /* Sectors in the current transfer */
+        uint32_t transfer_sector_count;
+        volatile bool transfer_done;
+} _state = {
+        .dma_level = 0,
+        .state = READ_STATE_IDLE,
+        .head = NULL,
+        .tail = NULL
+};
+
+static void _read_advance(void);
+static bool _read_step(void);
+static bool _read_start(cd_block_read_t *read);
+static void _read_end(cd_block_read_status_t status);
+static void _transfer_start(cd_block_read_t *read);
+static void _transfer_end(void *work);
+static bool _hirq_wait(uint16_t bits);
+static void _cd_block_handler(void);
+
+static inline uint16_t __always_inline
+_hirq_get(void)
+{
+        return MEMORY_READ(16, CD_BLOCK(HIRQ));
+}
+
+void
+cd_block_read_init(scu_dma_level_t level)
+{
+        assert(level <= 2);
+        assert(!(cd_block_read_busy()));
+
+        _state.dma_level = level;
+
+        /* The CD-block interrupts once any of the HIRQ bits enabled in the
+         * HIRQ mask are set. The bits are enabled only while waiting on
+         * them */
+        scu_ic_mask_chg(SCU_IC_MASK_ALL, SCU_IC_MASK_A_BUS);
+
+        MEMORY_WRITE(16, CD_BLOCK(HIRQ_MASK), 0x0000);
+
+        scu_ic_ihr_set(SCU_IC_INTERRUPT_CD_BLOCK, _cd_block_handler);
+        scu_ic_mask_chg(~SCU_IC_MASK_A_BUS, SCU_IC_MASK_NONE);
+}
+
+void
+cd_block_read_submit(cd_block_read_t *read)
+{
+        assert(read != NULL);
+        assert(read->fad >= 150);
+        assert(read->sector_count > 0);
+        assert(read->buffer != NULL);
+        assert(((uintptr_t)read->buffer & 3) == 0);
+
+        read->status = CD_BLOCK_READ_STATUS_QUEUED;
+        read->sector_read_count = 0;
+        read->next = NULL;
+
+        const uint8_t sr_mask = cpu_intc_mask_get();
+
+        cpu_intc_mask_set(15);
+
+        if (_state.tail == NULL) {
+                _state.head = read;
+        } else {
+                _state.tail->next = read;
+        }
+
+        _state.tail = read;
+
+        cpu_intc_mask_set(sr_mask);
+
+        /* Start the read if nothing else is being read */
+        _read_advance();
+}
+
+void
+cd_block_read_poll(void)
+{
+        _read_advance();
+}
+
+bool
+cd_block_read_busy(void)
+{
+        return (_state.head != NULL);
+}
+
+/* Move the current read along as far as it can go without waiting. Only the
+ * CD-block commands themselves are waited on, which is short.
+ *
+ * Reads are advanced from the caller, and from interrupt handlers of different
+ * levels, so interrupts are disabled throughout */
+static void
+_read_advance(void)
+{
+        const uint8_t sr_mask = cpu_intc_mask_get();
+
+        cpu_intc_mask_set(15);
+
+        while ((_read_step())) {
+        }
+
+        cpu_intc_mask_set(sr_mask);
+}
+
+/* Take one step. Returns false when waiting on the CD-block, or the SCU-DMA
+ * transfer */
+static bool
+_read_step(void)
+{
+        cd_block_read_t * const read = _state.head;
+
+        switch (_state.state) {
+        case READ_STATE_IDLE:
+                if (read == NULL) {
+                        return false;
+                }
+
+                if (!(_read_start(read))) {
+                        _read_end(CD_BLOCK_READ_STATUS_ERROR);
+
+                        return true;
+                }
+
+                _state.state = READ_STATE_SECTORS_WAIT;
+
+                return true;
+        case READ_STATE_SECTORS_WAIT: {
+                /* Clear CSCT before counting, so that a sector reaching the
+                 * buffer after the count still interrupts */
+                MEMORY_WRITE_AND(16, CD_BLOCK(HIRQ), ~CSCT);
+
+                const int sector_count = cd_block_cmd_sector_number_get(0);
+
+                if (sector_count < 0) {
+                        _read_end(CD_BLOCK_READ_STATUS_ERROR);
+
+                        return true;
+                }
+
+                /* No sectors have reached the buffer yet */
+                if (sector_count == 0) {
+                        return !(_hirq_wait(CSCT));
+                }
+
+                const uint32_t sector_left_count =
+                    read->sector_count - read->sector_read_count;
+                const uint32_t transfer_max_count =
+                    TRANSFER_SECTOR_COUNT_MAX(_state.dma_level);
+
+                _state.transfer_sector_count = sector_count;
+
+                if (_state.transfer_sector_count > sector_left_count) {
+                        _state.transfer_sector_count = sector_left_count;
+                }
+
+                if (_state.transfer_sector_count > transfer_max_count) {
+                        _state.transfer_sector_count = transfer_max_count;
+                }
+
+                if ((cd_block_cmd_sector_data_get_delete(0, 0,
+                            _state.transfer_sector_count)) != 0) {
+                        _read_end(CD_BLOCK_READ_STATUS_ERROR);
+
+                        return true;
+                }
+
+                _state.state = READ_STATE_DRDY_WAIT;
+
+                return true;
+        }
+        case READ_STATE_DRDY_WAIT:
+                if (((_hirq_get() & DRDY) == 0x0000) && (_hirq_wait(DRDY))) {
+                        return false;
+                }
+
+                _transfer_start(read);
+
+                _state.state = READ_STATE_TRANSFER_WAIT;
+
+                return true;
+        case READ_STATE_TRANSFER_WAIT:
+                /* The SCU-DMA end interrupt advances the read */
+                if (!_state.transfer_done) {
+                        return false;
+                }
+
+                if ((cd_block_cmd_data_transfer_end()) != 0) {
+                        _read_end(CD_BLOCK_READ_STATUS_ERROR);
+
+                        return true;
+                }
+
+                read->sector_read_count += _state.transfer_sector_count;
+
+                if (read->sector_read_count == read->sector_count) {
+                        _read_end(CD_BLOCK_READ_STATUS_DONE);
+
+                        return true;
+                }
+
+                _state.state = READ_STATE_SECTORS_WAIT;
+
+                return true;
+        }
+
+        return false;
+}
+
+static bool
+_read_start(cd_block_read_t *read)
+{
+        read->status = CD_BLOCK_READ_STATUS_READING;
+
+        if ((cd_block_cmd_sector_length_set(SECTOR_LENGTH_2048)) != 0) {
+                return false;
+        }
+
+        if ((cd_block_cmd_selector_reset(0, 0)) != 0) {
+                return false;
+        }
+
+        if ((cd_block_cmd_cd_dev_connection_set(0)) != 0) {
+                return false;
+        }
+
+        if ((cd_block_cmd_disk_play(0, read->fad, read->sector_count)) != 0) {
+                return false;
+        }
+
+        return true;
+}
+
+static void
+_read_end(cd_block_read_status_t status)
+{
+        cd_block_read_t * const read = _state.head;
+
+        _state.head = read->next;
+
+        if (_state.head == NULL) {
+                _state.tail = NULL;
+        }
+
+        _state.state = READ_STATE_IDLE;
+
+        read->next = NULL;
+        read->status = status;
+
+        if (read->callback != NULL) {
+                read->callback(read);
+        }
+}
+
+static void
+_transfer_start(cd_block_read_t *read)
+{
+        uint8_t * const buffer = read->buffer;
+        void * const dst = &buffer[read->sector_read_count * CDFS_SECTOR_SIZE];
+        const uint32_t len = _state.transfer_sector_count * CDFS_SECTOR_SIZE;
+
+        /* The data transfer register doesn't move, so the read address isn't
+         * incremented */
+        const scu_dma_level_cfg_t dma_cfg = {
+                .space = SCU_DMA_SPACE_BUS_A,
+                .mode = SCU_DMA_MODE_DIRECT,
+                .stride = SCU_DMA_STRIDE_2_BYTES,
+                .update = SCU_DMA_UPDATE_NONE,
+                .xfer.direct.len = len,
+                .xfer.direct.dst = (uint32_t)dst,
+                .xfer.direct.src = CD_BLOCK(DTR)
+        };
+
+        scu_dma_handle_t dma_handle = {
+                .dnmd = 0x00000000
+        };
+
+        scu_dma_config_buffer(&dma_handle, &dma_cfg);
+
+        _state.transfer_done = false;
+
+        scu_dma_config_set(_state.dma_level, SCU_DMA_START_FACTOR_ENABLE,
+            &dma_handle, NULL);
+        scu_dma_level_end_set(_state.dma_level, _transfer_end, dst);
+        scu_dma_level_fast_start(_state.dma_level);
+}
+
+static void
+_transfer_end(void *work)
+{
+        /* The transfer bypassed the cache */
+        cpu_cache_area_purge(work,
+            _state.transfer_sector_count * CDFS_SECTOR_SIZE);
+
+        _state.transfer_done = true;
+
+        _read_advance();
+}
+
+/* Enable the CD-block interrupt for the HIRQ bits. Returns false if any of them
+ * were set before the interrupt was enabled, in which case there's no waiting */
+static bool
+_hirq_wait(uint16_t bits)
+{
+        MEMORY_WRITE_OR(16, CD_BLOCK(HIRQ_MASK), bits);
+
+        if ((_hirq_get() & bits) == 0x0000) {
+                return true;
+        }
+
+        MEMORY_WRITE_AND(16, CD_BLOCK(HIRQ_MASK), ~bits);
+
+        return false;
+}
+
+static void
+_cd_block_handler(void)
+{
+        const uint16_t hirq_mask = MEMORY_READ(16, CD_BLOCK(HIRQ_MASK));
+        const uint16_t hirq = _hirq_get() & hirq_mask;
+
+        /* Stop interrupting on the bits that are set. Each wait enables its
+         * bit again */
+        MEMORY_WRITE(16, CD_BLOCK(HIRQ_MASK), hirq_mask & ~hirq);
+
+        /* Accept the next A-Bus interrupt */
+        MEMORY_WRITE(32, SCU(AIACK), 0x00000001);
+
+        _read_advance();
+}
@@ -48,6 +48,7 @@
 
 #include <math.h>
 
+#include <mm/arena.h>
 #include <mm/memb.h>
 #include <mm/mm_stats.h>
 
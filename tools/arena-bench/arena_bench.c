@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "arena_bench"
+
+/* Number of frames simulated by default */
+#define BENCH_FRAMES_DEFAULT    20000
+
+/* Allocations made each frame, and the range of their sizes */
+#define BENCH_ALLOC_COUNT       200
+#define BENCH_ALLOC_SIZE_MIN    16
+#define BENCH_ALLOC_SIZE_RANGE  256
+
+#define BENCH_POOL_SIZE         (1024 * 1024)
+
+/* Sizes of the allocation tracker's tables */
+#define TRACK_ALLOCATION_COUNT  64
+#define TRACK_SITE_COUNT        4
+
+/* Addresses handed to the tracker. They're never dereferenced. In a table of
+ * 64 entries, addresses 256 bytes apart share a home entry, so each of the 8
+ * lanes is 16 colliding addresses */
+#define TRACK_ADDRESS_COUNT     128
+#define TRACK_ADDRESS(i)                                                       \
+        ((void *)(uintptr_t)(0x06000000 + (((i) & 7) * 4) + (((i) >> 3) * 256)))
+#define TRACK_SITE(i)           ((const void *)(uintptr_t)(0x06100000 + ((i) * 4)))
+
+/* Most allocations live at once, and the steps taken in the collision check */
+#define TRACK_LIVE_COUNT_MAX    48
+#define TRACK_STEP_COUNT        20000
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <mm/arena.h>
+#include <mm/mm_stats.h>
+
+#include "tlsf.h"
+
+static uint8_t _tlsf_pool[BENCH_POOL_SIZE] __attribute__ ((aligned(16)));
+static uint8_t _arena_pool[BENCH_POOL_SIZE] __attribute__ ((aligned(16)));
+
+static void *_allocations[BENCH_ALLOC_COUNT];
+
+static mm_stats_allocation_t _track_allocations[TRACK_ALLOCATION_COUNT];
+static mm_stats_site_t _track_sites[TRACK_SITE_COUNT];
+
+static uint32_t _error_count;
+
+static void _usage_print(void);
+
+static void _tlsf_bench(uint32_t frames);
+static void _arena_bench(uint32_t frames);
+static void _arena_check(void);
+static void _track_check(void);
+static void _track_collision_check(mm_stats_track_t *track);
+static void _track_full_check(mm_stats_track_t *track);
+static void _check(bool condition, const char *message);
+
+static uint32_t _size_get(uint32_t *seed);
+static double _time_get(void);
+
+int
+main(int argc, char *argv[])
+{
+        uint32_t frames = BENCH_FRAMES_DEFAULT;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        frames = strtoul(optarg, NULL, 0);
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if ((frames == 0) || (argc != optind)) {
+                _usage_print();
+
+                return 1;
+        }
+
+        _arena_check();
+        _track_check();
+
+        (void)printf("%" PRIu32 " frames of %u allocations of %u..%u bytes\n\n",
+            frames, BENCH_ALLOC_COUNT, BENCH_ALLOC_SIZE_MIN,
+            BENCH_ALLOC_SIZE_MIN + BENCH_ALLOC_SIZE_RANGE - 1);
+
+        (void)printf("Allocator  ns/allocation\n");
+
+        _tlsf_bench(frames);
+        _arena_bench(frames);
+
+        if (_error_count > 0) {
+                (void)fprintf(stderr, "\n%" PRIu32 " errors\n", _error_count);
+
+                return 1;
+        }
+
+        return 0;
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-n frames]\n", PROGNAME);
+        (void)fprintf(stderr, "Check the arena allocator and the allocation tracker, then compare the cost of per-frame scratch\n"
+                              "allocations from TLSF against an arena scope\n");
+}
+
+/* Each frame allocates its scratch blocks, then frees every one of them */
+static void
+_tlsf_bench(uint32_t frames)
+{
+        const tlsf_t tlsf = tlsf_pool_create(_tlsf_pool, sizeof(_tlsf_pool));
+
+        uint32_t seed = 1;
+
+        const double start_time = _time_get();
+
+        for (uint32_t frame = 0; frame < frames; frame++) {
+                for (uint32_t i = 0; i < BENCH_ALLOC_COUNT; i++) {
+                        _allocations[i] = tlsf_malloc(tlsf, _size_get(&seed));
+
+                        _check(_allocations[i] != NULL, "TLSF allocation failed");
+                }
+
+                for (uint32_t i = 0; i < BENCH_ALLOC_COUNT; i++) {
+                        tlsf_free(tlsf, _allocations[i]);
+                }
+        }
+
+        const double time = _time_get() - start_time;
+
+        (void)printf("TLSF       %13.1f\n",
+            (time * 1000000000.0) / ((double)frames * BENCH_ALLOC_COUNT));
+}
+
+/* Each frame pushes a scope, allocates its scratch blocks, then frees them all
+ * at once by popping the scope */
+static void
+_arena_bench(uint32_t frames)
+{
+        arena_t arena;
+
+        arena_init(&arena, _arena_pool, sizeof(_arena_pool));
+
+        uint32_t seed = 1;
+
+        const double start_time = _time_get();
+
+        for (uint32_t frame = 0; frame < frames; frame++) {
+                if (!(arena_scope_push(&arena))) {
+                        _check(false, "Arena scope push failed");
+
+                        return;
+                }
+
+                for (uint32_t i = 0; i < BENCH_ALLOC_COUNT; i++) {
+                        _allocations[i] = arena_alloc(&arena, _size_get(&seed));
+
+                        _check(_allocations[i] != NULL, "Arena allocation failed");
+                }
+
+                arena_scope_pop(&arena);
+        }
+
+        const double time = _time_get() - start_time;
+
+        (void)printf("Arena      %13.1f\n",
+            (time * 1000000000.0) / ((double)frames * BENCH_ALLOC_COUNT));
+
+        _check(arena_used_size(&arena) == 0, "Arena isn't empty after the last frame");
+}
+
+static void
+_arena_check(void)
+{
+        arena_t arena;
+
+        arena_init(&arena, _arena_pool, 256);
+
+        /* Marks and nested scopes */
+        void * const block = arena_alloc(&arena, 10);
+
+        _check(block != NULL, "Allocation failed");
+        _check(arena_used_size(&arena) == 12, "Size isn't rounded up to ARENA_ALIGN");
+
+        _check(arena_scope_push(&arena), "Scope push failed");
+        (void)arena_alloc(&arena, 100);
+        _check(arena_scope_push(&arena), "Nested scope push failed");
+
+        const arena_mark_t mark = arena_mark(&arena);
+
+        (void)arena_alloc(&arena, 50);
+        arena_reset(&arena, mark);
+
+        _check(arena_mark(&arena) == mark, "Reset doesn't return to the mark");
+
+        arena_scope_pop(&arena);
+        arena_scope_pop(&arena);
+
+        _check(arena_used_size(&arena) == 12, "Scopes don't free their allocations");
+        _check(arena.scope_depth == 0, "Scope depth isn't restored");
+
+        void * const aligned = arena_memalign(&arena, 8, 64);
+
+        _check(((uintptr_t)aligned & 63) == 0, "arena_memalign() isn't aligned");
+
+        /* An allocation that doesn't fit fails without changing the arena */
+        const size_t used_size = arena_used_size(&arena);
+
+        _check(arena_alloc(&arena, 1024) == NULL, "Oversized allocation didn't fail");
+        _check(arena_used_size(&arena) == used_size, "Failed allocation used space");
+        _check(arena.failed_count == 1, "Failed allocation isn't counted");
+
+        /* A full arena has no room to push a scope */
+        while ((arena_alloc(&arena, ARENA_ALIGN)) != NULL) {
+        }
+
+        _check(!arena_scope_push(&arena), "Scope push on a full arena didn't fail");
+        _check(arena.scope_depth == 0, "Failed scope push changed the depth");
+
+        mm_stats_heap_t heap;
+
+        (void)memset(&heap, 0, sizeof(heap));
+
+        arena_walk(&arena, mm_stats_heap_walker, &heap);
+
+        _check(heap.used_size == arena_used_size(&arena), "Walk reports the wrong used size");
+        _check(heap.free_size == arena_free_size(&arena), "Walk reports the wrong free size");
+}
+
+static void
+_track_check(void)
+{
+        mm_stats_track_t track = {
+                .allocations = _track_allocations,
+                .allocation_count = TRACK_ALLOCATION_COUNT,
+                .sites = _track_sites,
+                .site_count = TRACK_SITE_COUNT
+        };
+
+        mm_stats_track_start(&track);
+
+        /* Live and peak sizes of each site */
+        mm_stats_track_alloc(TRACK_ADDRESS(0), 100, TRACK_SITE(0));
+        mm_stats_track_alloc(TRACK_ADDRESS(1), 50, TRACK_SITE(0));
+        mm_stats_track_alloc(TRACK_ADDRESS(2), 30, TRACK_SITE(1));
+        mm_stats_track_free(TRACK_ADDRESS(0));
+        mm_stats_track_alloc(TRACK_ADDRESS(3), 20, TRACK_SITE(0));
+
+        _check(track.site_used_count == 2, "Sites aren't shared between allocations");
+        _check(_track_sites[0].live_size == 70, "Site live size is wrong");
+        _check(_track_sites[0].peak_size == 150, "Site peak size is wrong");
+        _check(_track_sites[0].alloc_count == 3, "Site allocation count is wrong");
+        _check(_track_sites[0].free_count == 1, "Site free count is wrong");
+        _check(_track_sites[0].lifetime_total == 2, "Site lifetime is wrong");
+        _check(_track_sites[1].live_size == 30, "Site live size is wrong");
+        _check(_track_sites[1].peak_size == 30, "Site peak size is wrong");
+        _check(track.live_size == 100, "Live size is wrong");
+        _check(track.peak_size == 180, "Peak size is wrong");
+
+        /* Frees of NULL and of untracked addresses are ignored */
+        mm_stats_track_free(NULL);
+        mm_stats_track_free(TRACK_ADDRESS(4));
+        mm_stats_track_alloc(NULL, 10, TRACK_SITE(0));
+
+        _check(track.live_size == 100, "Untracked free changed the live size");
+        _check(track.allocation_used_count == 3, "Untracked free changed the table");
+
+        /* realloc(NULL, size) allocates, and realloc(old, 0) frees. A failed
+         * realloc() leaves the old allocation */
+        mm_stats_track_realloc(NULL, TRACK_ADDRESS(5), 40, TRACK_SITE(1));
+
+        _check(_track_sites[1].live_size == 70, "realloc(NULL) isn't an allocation");
+
+        mm_stats_track_realloc(TRACK_ADDRESS(5), TRACK_ADDRESS(6), 60, TRACK_SITE(1));
+
+        _check(_track_sites[1].live_size == 90, "realloc() doesn't replace the allocation");
+        _check(_track_sites[1].peak_size == 90, "realloc() peak size is wrong");
+
+        mm_stats_track_realloc(TRACK_ADDRESS(6), NULL, 80, TRACK_SITE(1));
+
+        _check(_track_sites[1].live_size == 90, "Failed realloc() changed the allocation");
+
+        mm_stats_track_realloc(TRACK_ADDRESS(6), NULL, 0, TRACK_SITE(1));
+
+        _check(_track_sites[1].live_size == 30, "realloc() to size 0 isn't a free");
+        _check(_track_sites[1].free_count == 2, "realloc() frees aren't counted");
+
+        mm_stats_track_free(TRACK_ADDRESS(1));
+        mm_stats_track_free(TRACK_ADDRESS(2));
+        mm_stats_track_free(TRACK_ADDRESS(3));
+
+        _check(track.live_size == 0, "Live size isn't zero after freeing everything");
+        _check(track.allocation_used_count == 0, "Table isn't empty after freeing everything");
+        _check(track.dropped_count == 0, "Allocations were dropped");
+
+        _track_collision_check(&track);
+        _track_full_check(&track);
+
+        mm_stats_track_stop();
+}
+
+/* Allocate and free colliding addresses at random, then make sure that every
+ * live allocation can still be found */
+static void
+_track_collision_check(mm_stats_track_t *track)
+{
+        size_t sizes[TRACK_ADDRESS_COUNT];
+        size_t site_live_sizes[TRACK_SITE_COUNT];
+        size_t live_size = 0;
+        uint32_t live_count = 0;
+        uint32_t seed = 1;
+
+        (void)memset(sizes, 0, sizeof(sizes));
+        (void)memset(site_live_sizes, 0, sizeof(site_live_sizes));
+
+        mm_stats_track_start(track);
+
+        for (uint32_t step = 0; step < TRACK_STEP_COUNT; step++) {
+                seed = (seed * 1103515245) + 12345;
+
+                const uint32_t i = (seed >> 16) % TRACK_ADDRESS_COUNT;
+                const uint32_t site_index = i % TRACK_SITE_COUNT;
+
+                if (sizes[i] != 0) {
+                        mm_stats_track_free(TRACK_ADDRESS(i));
+
+                        live_size -= sizes[i];
+                        site_live_sizes[site_index] -= sizes[i];
+                        sizes[i] = 0;
+                        live_count--;
+                } else if (live_count < TRACK_LIVE_COUNT_MAX) {
+                        sizes[i] = (i + 1) * 4;
+
+                        mm_stats_track_alloc(TRACK_ADDRESS(i), sizes[i],
+                            TRACK_SITE(site_index));
+
+                        live_size += sizes[i];
+                        site_live_sizes[site_index] += sizes[i];
+                        live_count++;
+                }
+
+                /* A free that misses its allocation leaves its size live */
+                if ((track->live_size != live_size) ||
+                    (track->allocation_used_count != live_count)) {
+                        _check(false, "Colliding allocation was lost");
+
+                        return;
+                }
+        }
+
+        /* Sites are in the table in the order they were first seen */
+        for (uint32_t i = 0; i < track->site_used_count; i++) {
+                const mm_stats_site_t * const site = &_track_sites[i];
+                const uint32_t site_index =
+                    (site->site - (uintptr_t)TRACK_SITE(0)) / 4;
+
+                _check(site->live_size == site_live_sizes[site_index],
+                    "Site live size is wrong after collisions");
+        }
+
+        for (uint32_t i = 0; i < TRACK_ADDRESS_COUNT; i++) {
+                if (sizes[i] == 0) {
+                        continue;
+                }
+
+                const size_t track_live_size = track->live_size;
+
+                mm_stats_track_free(TRACK_ADDRESS(i));
+
+                if ((track_live_size - track->live_size) != sizes[i]) {
+                        _check(false, "Live allocation isn't found");
+
+                        return;
+                }
+        }
+
+        _check(track->allocation_used_count == 0, "Table isn't empty after collisions");
+        _check(track->dropped_count == 0, "Colliding allocations were dropped");
+}
+
+/* Allocations are dropped, not tracked, once either table is full */
+static void
+_track_full_check(mm_stats_track_t *track)
+{
+        track->allocation_count = 8;
+        track->site_count = 2;
+
+        mm_stats_track_start(track);
+
+        /* One entry is always left empty */
+        for (uint32_t i = 0; i < track->allocation_count; i++) {
+                mm_stats_track_alloc(TRACK_ADDRESS(i), 4, TRACK_SITE(0));
+        }
+
+        _check(track->allocation_used_count == 7, "Allocation table isn't full");
+        _check(track->dropped_count == 1, "Allocation past a full table isn't dropped");
+        _check(track->live_size == 28, "Dropped allocation is counted as live");
+
+        mm_stats_track_free(TRACK_ADDRESS(7));
+
+        _check(track->live_size == 28, "Dropped allocation was freed");
+
+        mm_stats_track_free(TRACK_ADDRESS(0));
+        mm_stats_track_free(TRACK_ADDRESS(1));
+        mm_stats_track_alloc(TRACK_ADDRESS(0), 4, TRACK_SITE(1));
+        mm_stats_track_alloc(TRACK_ADDRESS(1), 4, TRACK_SITE(2));
+
+        _check(track->site_used_count == 2, "Site table isn't full");
+        _check(track->dropped_count == 2, "Allocation past a full site table isn't dropped");
+        _check(track->allocation_used_count == 6, "Dropped allocation is in the table");
+
+        for (uint32_t i = 0; i < track->allocation_count; i++) {
+                const mm_stats_allocation_t * const allocation =
+                    &_track_allocations[i];
+
+                if (allocation->address == 0) {
+                        continue;
+                }
+
+                _check(allocation->site_index < track->site_used_count,
+                    "Allocation refers to a site that isn't in the table");
+        }
+
+        mm_stats_track_free(TRACK_ADDRESS(1));
+
+        _check(track->live_size == 24, "Dropped allocation was freed");
+
+        track->allocation_count = TRACK_ALLOCATION_COUNT;
+        track->site_count = TRACK_SITE_COUNT;
+}
+
+static void
+_check(bool condition, const char *message)
+{
+        if (condition) {
+                return;
+        }
+
+        (void)fprintf(stderr, "Error: %s: %s\n", PROGNAME, message);
+
+        _error_count++;
+}
+
+static uint32_t
+_size_get(uint32_t *seed)
+{
+        *seed = (*seed * 1103515245) + 12345;
+
+        return BENCH_ALLOC_SIZE_MIN + ((*seed >> 16) % BENCH_ALLOC_SIZE_RANGE);
+}
+
+static double
+_time_get(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what the mm sources expect from libyaul's <sys/cdefs.h> */
+
+#ifndef _ARENA_BENCH_HOST_SYS_CDEFS_H_
+#define _ARENA_BENCH_HOST_SYS_CDEFS_H_
+
+#include_next <sys/cdefs.h>
+
+#ifndef __aligned
+#define __aligned(x)    __attribute__ ((aligned(x)))
+#endif /* !__aligned */
+
+#ifndef __packed
+#define __packed        __attribute__ ((packed))
+#endif /* !__packed */
+
+#ifndef __unused
+#define __unused        __attribute__ ((unused))
+#endif /* !__unused */
+
+#endif /* !_ARENA_BENCH_HOST_SYS_CDEFS_H_ */
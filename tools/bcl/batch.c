@@ -0,0 +1,684 @@
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "batch.h"
+
+#define BATCH_JOBS_MAX  (64)
+#define BATCH_LINE_SIZE (4096)
+
+typedef struct {
+        char *in_filename;
+        char *out_filename;
+
+        uint64_t hash;
+        size_t in_size;
+        size_t out_size;
+        double time;
+        bool skipped;
+        int error;
+} batch_entry_t;
+
+typedef struct {
+        uint64_t hash;
+        char *out_filename;
+} batch_cache_entry_t;
+
+typedef struct {
+        const tool_codec_t *codec;
+        const batch_options_t *options;
+
+        batch_entry_t *entries;
+        size_t entry_count;
+        size_t entry_capacity;
+
+        batch_cache_entry_t *cache;
+        size_t cache_count;
+
+        size_t next_entry;
+        pthread_mutex_t mutex;
+} batch_t;
+
+static int _entry_add(batch_t *batch, const char *in_filename,
+    const char *out_filename);
+static int _manifest_read(batch_t *batch, const char *filename);
+static int _directory_read(batch_t *batch, const char *dirname,
+    const char *relative_dirname);
+
+static void _cache_read(batch_t *batch, const char *filename);
+static int _cache_write(const batch_t *batch, const char *filename);
+static const batch_cache_entry_t *_cache_find(const batch_t *batch,
+    const char *out_filename);
+
+static void *_worker(void *arg);
+static void _entry_compress(batch_t *batch, batch_entry_t *entry);
+
+static int _path_dirs_create(const char *filename);
+static char *_path_join(const char *a, const char *b, const char *c);
+static uint64_t _hash_calculate(const void *buffer, size_t len, const char *variant);
+static double _time_get(void);
+
+int
+batch_run(const tool_codec_t *codec, const batch_options_t *options)
+{
+        batch_t batch = {
+                .codec   = codec,
+                .options = options
+        };
+
+        struct stat path_stat;
+
+        if ((stat(options->path, &path_stat)) != 0) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        char *cache_filename;
+        int ret;
+
+        if (S_ISDIR(path_stat.st_mode)) {
+                ret = _directory_read(&batch, options->path, NULL);
+        } else {
+                ret = _manifest_read(&batch, options->path);
+        }
+
+        /* The cache goes with the output, so that compressing to an output
+         * directory doesn't write into the input */
+        if (options->out_dir != NULL) {
+                cache_filename = _path_join(options->out_dir, "/.", codec->progname);
+        } else if (S_ISDIR(path_stat.st_mode)) {
+                cache_filename = _path_join(options->path, "/.", codec->progname);
+        } else {
+                cache_filename = _path_join(options->path, ".", codec->progname);
+        }
+
+        if (cache_filename != NULL) {
+                char * const filename = _path_join(cache_filename, ".cache", "");
+
+                free(cache_filename);
+
+                cache_filename = filename;
+        }
+
+        if (ret != 0) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        if (options->cache_filename != NULL) {
+                free(cache_filename);
+
+                cache_filename = strdup(options->cache_filename);
+        }
+
+        if (cache_filename == NULL) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        _cache_read(&batch, cache_filename);
+
+        uint32_t job_count = options->job_count;
+
+        if (job_count > BATCH_JOBS_MAX) {
+                job_count = BATCH_JOBS_MAX;
+        }
+
+        if (job_count > batch.entry_count) {
+                job_count = batch.entry_count;
+        }
+
+        const double time = _time_get();
+
+        pthread_t threads[BATCH_JOBS_MAX];
+        uint32_t thread_count;
+
+        (void)pthread_mutex_init(&batch.mutex, NULL);
+
+        for (thread_count = 0; thread_count < job_count; thread_count++) {
+                if ((pthread_create(&threads[thread_count], NULL, _worker, &batch)) != 0) {
+                        break;
+                }
+        }
+
+        /* Compress on this thread should no thread be created */
+        if (thread_count == 0) {
+                (void)_worker(&batch);
+        }
+
+        for (uint32_t i = 0; i < thread_count; i++) {
+                (void)pthread_join(threads[i], NULL);
+        }
+
+        (void)pthread_mutex_destroy(&batch.mutex);
+
+        size_t total_in_size = 0;
+        size_t total_out_size = 0;
+        size_t compressed_count = 0;
+        size_t skipped_count = 0;
+        size_t error_count = 0;
+
+        for (size_t i = 0; i < batch.entry_count; i++) {
+                const batch_entry_t * const entry = &batch.entries[i];
+
+                if (entry->error != 0) {
+                        (void)fprintf(stderr, "Error: %s: %s: %s\n", codec->progname,
+                            entry->in_filename, strerror(entry->error));
+
+                        error_count++;
+
+                        continue;
+                }
+
+                if (entry->skipped) {
+                        (void)printf("%s: unchanged\n", entry->in_filename);
+
+                        skipped_count++;
+
+                        continue;
+                }
+
+                (void)printf("%s -> %s: %zu -> %zu (%.1f%%), %.2f ms\n",
+                    entry->in_filename, entry->out_filename,
+                    entry->in_size, entry->out_size,
+                    (entry->in_size > 0) ? ((100.0 * entry->out_size) / entry->in_size) : 0.0,
+                    entry->time * 1000.0);
+
+                total_in_size += entry->in_size;
+                total_out_size += entry->out_size;
+                compressed_count++;
+        }
+
+        (void)printf("%zu compressed, %zu unchanged, %zu failed: %zu -> %zu (%.1f%%), %.2f s\n",
+            compressed_count, skipped_count, error_count,
+            total_in_size, total_out_size,
+            (total_in_size > 0) ? ((100.0 * total_out_size) / total_in_size) : 0.0,
+            _time_get() - time);
+
+        /* The output directory may not exist when nothing was written */
+        if (((_path_dirs_create(cache_filename)) != 0) ||
+            ((_cache_write(&batch, cache_filename)) != 0)) {
+                print_errno(codec->progname);
+
+                error_count++;
+        }
+
+        free(cache_filename);
+
+        for (size_t i = 0; i < batch.entry_count; i++) {
+                free(batch.entries[i].in_filename);
+                free(batch.entries[i].out_filename);
+        }
+
+        free(batch.entries);
+
+        for (size_t i = 0; i < batch.cache_count; i++) {
+                free(batch.cache[i].out_filename);
+        }
+
+        free(batch.cache);
+
+        return ((error_count == 0) ? 0 : 1);
+}
+
+static int
+_entry_add(batch_t *batch, const char *in_filename, const char *out_filename)
+{
+        if (batch->entry_count == batch->entry_capacity) {
+                const size_t capacity =
+                    (batch->entry_capacity == 0) ? 64 : (2 * batch->entry_capacity);
+
+                batch_entry_t * const entries =
+                    realloc(batch->entries, capacity * sizeof(batch_entry_t));
+
+                if (entries == NULL) {
+                        return -1;
+                }
+
+                batch->entries = entries;
+                batch->entry_capacity = capacity;
+        }
+
+        batch_entry_t * const entry = &batch->entries[batch->entry_count];
+
+        (void)memset(entry, 0, sizeof(batch_entry_t));
+
+        const batch_options_t * const options = batch->options;
+
+        entry->in_filename = strdup(in_filename);
+
+        if (out_filename != NULL) {
+                entry->out_filename = strdup(out_filename);
+        } else if (options->out_dir != NULL) {
+                /* Keep the input's path under the output directory */
+                while ((in_filename[0] == '/') || (strncmp(in_filename, "./", 2) == 0)) {
+                        in_filename += (in_filename[0] == '/') ? 1 : 2;
+                }
+
+                char * const filename = _path_join(options->out_dir, "/", in_filename);
+
+                entry->out_filename = _path_join(filename, batch->codec->extension, "");
+
+                free(filename);
+        } else {
+                entry->out_filename = _path_join(in_filename, batch->codec->extension, "");
+        }
+
+        if ((entry->in_filename == NULL) || (entry->out_filename == NULL)) {
+                free(entry->in_filename);
+                free(entry->out_filename);
+
+                return -1;
+        }
+
+        batch->entry_count++;
+
+        return 0;
+}
+
+static int
+_manifest_read(batch_t *batch, const char *filename)
+{
+        FILE *fp;
+
+        if ((fp = fopen(filename, "r")) == NULL) {
+                return -1;
+        }
+
+        char line[BATCH_LINE_SIZE];
+        int ret = 0;
+
+        while ((fgets(line, sizeof(line), fp)) != NULL) {
+                const char * const delim = " \t\r\n";
+
+                char *save_ptr;
+                char * const in_filename = strtok_r(line, delim, &save_ptr);
+
+                /* Skip empty lines and comments */
+                if ((in_filename == NULL) || (in_filename[0] == '#')) {
+                        continue;
+                }
+
+                char * const out_filename = strtok_r(NULL, delim, &save_ptr);
+
+                if ((ret = _entry_add(batch, in_filename, out_filename)) != 0) {
+                        break;
+                }
+        }
+
+        (void)fclose(fp);
+
+        return ret;
+}
+
+static int
+_directory_read(batch_t *batch, const char *dirname, const char *relative_dirname)
+{
+        DIR *dir;
+
+        if ((dir = opendir(dirname)) == NULL) {
+                return -1;
+        }
+
+        const char * const extension = batch->codec->extension;
+        const size_t extension_len = strlen(extension);
+
+        int ret = 0;
+        struct dirent *dirent;
+
+        while ((dirent = readdir(dir)) != NULL) {
+                const char * const name = dirent->d_name;
+                const size_t name_len = strlen(name);
+
+                /* Skip hidden files (including the cache), and anything that
+                 * looks like it has already been compressed */
+                if (name[0] == '.') {
+                        continue;
+                }
+
+                if ((name_len > extension_len) &&
+                    ((strcmp(&name[name_len - extension_len], extension)) == 0)) {
+                        continue;
+                }
+
+                char * const filename = _path_join(dirname, "/", name);
+                char * const relative_filename = (relative_dirname != NULL)
+                    ? _path_join(relative_dirname, "/", name)
+                    : strdup(name);
+
+                if ((filename == NULL) || (relative_filename == NULL)) {
+                        ret = -1;
+                }
+
+                struct stat file_stat;
+
+                if ((ret == 0) && ((ret = stat(filename, &file_stat)) == 0)) {
+                        if (S_ISDIR(file_stat.st_mode)) {
+                                ret = _directory_read(batch, filename, relative_filename);
+                        } else if (S_ISREG(file_stat.st_mode)) {
+                                char *out_filename = NULL;
+
+                                if (batch->options->out_dir != NULL) {
+                                        char * const joined = _path_join(batch->options->out_dir,
+                                            "/", relative_filename);
+
+                                        out_filename = _path_join(joined, extension, "");
+
+                                        free(joined);
+                                }
+
+                                ret = _entry_add(batch, filename, out_filename);
+
+                                free(out_filename);
+                        }
+                }
+
+                free(filename);
+                free(relative_filename);
+
+                if (ret != 0) {
+                        break;
+                }
+        }
+
+        (void)closedir(dir);
+
+        return ret;
+}
+
+static int
+_cache_entry_compare(const void *a, const void *b)
+{
+        const batch_cache_entry_t * const entry_a = a;
+        const batch_cache_entry_t * const entry_b = b;
+
+        return strcmp(entry_a->out_filename, entry_b->out_filename);
+}
+
+/* A missing or unreadable cache simply means everything is compressed */
+static void
+_cache_read(batch_t *batch, const char *filename)
+{
+        FILE *fp;
+
+        if ((fp = fopen(filename, "r")) == NULL) {
+                return;
+        }
+
+        char line[BATCH_LINE_SIZE];
+        size_t capacity = 0;
+
+        while ((fgets(line, sizeof(line), fp)) != NULL) {
+                char *out_filename;
+                const uint64_t hash = strtoull(line, &out_filename, 16);
+
+                if (*out_filename != '\t') {
+                        continue;
+                }
+
+                out_filename++;
+                out_filename[strcspn(out_filename, "\r\n")] = '\0';
+
+                if (batch->cache_count == capacity) {
+                        capacity = (capacity == 0) ? 64 : (2 * capacity);
+
+                        batch_cache_entry_t * const cache =
+                            realloc(batch->cache, capacity * sizeof(batch_cache_entry_t));
+
+                        if (cache == NULL) {
+                                break;
+                        }
+
+                        batch->cache = cache;
+                }
+
+                batch_cache_entry_t * const entry = &batch->cache[batch->cache_count];
+
+                if ((entry->out_filename = strdup(out_filename)) == NULL) {
+                        break;
+                }
+
+                entry->hash = hash;
+
+                batch->cache_count++;
+        }
+
+        (void)fclose(fp);
+
+        qsort(batch->cache, batch->cache_count, sizeof(batch_cache_entry_t),
+            _cache_entry_compare);
+}
+
+/* Rewrite the cache with every entry that is up to date, keeping entries for
+ * files that were not part of this batch */
+static int
+_cache_write(const batch_t *batch, const char *filename)
+{
+        FILE *fp;
+
+        if ((fp = fopen(filename, "w")) == NULL) {
+                return -1;
+        }
+
+        for (size_t i = 0; i < batch->entry_count; i++) {
+                const batch_entry_t * const entry = &batch->entries[i];
+
+                if (entry->error == 0) {
+                        (void)fprintf(fp, "%016"PRIx64"\t%s\n", entry->hash, entry->out_filename);
+                }
+        }
+
+        for (size_t i = 0; i < batch->cache_count; i++) {
+                const batch_cache_entry_t * const cache_entry = &batch->cache[i];
+
+                bool found = false;
+
+                for (size_t j = 0; j < batch->entry_count; j++) {
+                        if ((strcmp(batch->entries[j].out_filename, cache_entry->out_filename)) == 0) {
+                                found = true;
+                                break;
+                        }
+                }
+
+                if (!found) {
+                        (void)fprintf(fp, "%016"PRIx64"\t%s\n", cache_entry->hash,
+                            cache_entry->out_filename);
+                }
+        }
+
+        return fclose(fp);
+}
+
+static const batch_cache_entry_t *
+_cache_find(const batch_t *batch, const char *out_filename)
+{
+        const batch_cache_entry_t key = {
+                .out_filename = (char *)out_filename
+        };
+
+        return bsearch(&key, batch->cache, batch->cache_count,
+            sizeof(batch_cache_entry_t), _cache_entry_compare);
+}
+
+static void *
+_worker(void *arg)
+{
+        batch_t * const batch = arg;
+
+        while (true) {
+                (void)pthread_mutex_lock(&batch->mutex);
+
+                const size_t entry_index = batch->next_entry++;
+
+                (void)pthread_mutex_unlock(&batch->mutex);
+
+                if (entry_index >= batch->entry_count) {
+                        break;
+                }
+
+                _entry_compress(batch, &batch->entries[entry_index]);
+        }
+
+        return NULL;
+}
+
+static void
+_entry_compress(batch_t *batch, batch_entry_t *entry)
+{
+        const tool_codec_t * const codec = batch->codec;
+
+        input_file_t input_file;
+
+        errno = 0;
+
+        if ((input_file_open(entry->in_filename, &input_file)) != 0) {
+                entry->error = errno;
+
+                return;
+        }
+
+        entry->in_size = input_file.buffer_len;
+        entry->hash = _hash_calculate(input_file.buffer, input_file.buffer_len,
+            batch->options->variant);
+
+        const batch_cache_entry_t * const cache_entry =
+            _cache_find(batch, entry->out_filename);
+
+        struct stat out_stat;
+
+        if ((cache_entry != NULL) && (cache_entry->hash == entry->hash) &&
+            ((stat(entry->out_filename, &out_stat)) == 0)) {
+                entry->skipped = true;
+
+                input_file_close(&input_file);
+
+                return;
+        }
+
+        void *out_buffer;
+
+        if ((out_buffer = malloc(codec->out_size_get(input_file.buffer_len))) == NULL) {
+                entry->error = ENOMEM;
+
+                input_file_close(&input_file);
+
+                return;
+        }
+
+        const double time = _time_get();
+
+        /* Parallelism comes from compressing several files at once */
+        const uint32_t out_size =
+            codec->compress(input_file.buffer, out_buffer, input_file.buffer_len, 1);
+
+        entry->time = _time_get() - time;
+        entry->out_size = out_size;
+
+        if (out_size == 0) {
+                entry->error = EINVAL;
+        } else if ((_path_dirs_create(entry->out_filename)) != 0) {
+                entry->error = errno;
+        } else {
+                errno = 0;
+
+                if ((output_file_write(entry->out_filename, out_buffer, out_size)) != 0) {
+                        entry->error = errno;
+                }
+        }
+
+        free(out_buffer);
+
+        input_file_close(&input_file);
+}
+
+/* Create every missing parent directory of filename */
+static int
+_path_dirs_create(const char *filename)
+{
+        char * const path = strdup(filename);
+
+        if (path == NULL) {
+                return -1;
+        }
+
+        int ret = 0;
+
+        for (char *p = path + 1; *p != '\0'; p++) {
+                if (*p != '/') {
+                        continue;
+                }
+
+                *p = '\0';
+
+                if (((mkdir(path, 0755)) != 0) && (errno != EEXIST)) {
+                        ret = -1;
+                }
+
+                *p = '/';
+
+                if (ret != 0) {
+                        break;
+                }
+        }
+
+        free(path);
+
+        return ret;
+}
+
+static char *
+_path_join(const char *a, const char *b, const char *c)
+{
+        const size_t len = strlen(a) + strlen(b) + strlen(c) + 1;
+
+        char * const path = malloc(len);
+
+        if (path != NULL) {
+                (void)snprintf(path, len, "%s%s%s", a, b, c);
+        }
+
+        return path;
+}
+
+/* 64-bit FNV-1a over the input, followed by the options that affect the
+ * output */
+static uint64_t
+_hash_calculate(const void *buffer, size_t len, const char *variant)
+{
+        const uint8_t *p = buffer;
+        uint64_t hash = UINT64_C(0xCBF29CE484222325);
+
+        for (size_t i = 0; i < len; i++) {
+                hash ^= p[i];
+                hash *= UINT64_C(0x00000100000001B3);
+        }
+
+        for (; *variant != '\0'; variant++) {
+                hash ^= (uint8_t)*variant;
+                hash *= UINT64_C(0x00000100000001B3);
+        }
+
+        return hash;
+}
+
+static double
+_time_get(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
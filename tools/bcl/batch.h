@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+#include "shared.h"
+
+typedef struct batch_options {
+        /* Manifest file or directory to compress */
+        const char *path;
+        /* Directory to write compressed files to, or NULL to write them next
+         * to their input */
+        const char *out_dir;
+        /* Content hash cache, or NULL to use the default path, which is in
+         * out_dir when set */
+        const char *cache_filename;
+        /* Codec specific options that affect the output */
+        const char *variant;
+        uint32_t job_count;
+} batch_options_t;
+
+int batch_run(const tool_codec_t *codec, const batch_options_t *options);
+
+#endif /* !BATCH_H */
@@ -14,14 +14,22 @@ CFLAGS:= -O2 \
 	-Wshadow \
 	-Wno-unused \
 	-Wno-parentheses \
-	-Wno-sign-compare
+	-Wno-sign-compare \
+	-Wno-old-style-declaration
 
 LDFLAGS?= -lm
 
-INCLUDES:=
+INCLUDES:= ../../libbcl
 
-OBJS:= $(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/,$(SRCS:.c=.o))
-DEPS:= $(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/,$(SRCS:.c=.d))
+DEFINES?=
+
+# Sources from libbcl that are built for the host
+LIBBCL_SRCS?=
+
+OBJS:= $(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/,$(SRCS:.c=.o)) \
+	$(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/libbcl/,$(LIBBCL_SRCS:.c=.o))
+DEPS:= $(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/,$(SRCS:.c=.d)) \
+	$(addprefix $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/libbcl/,$(LIBBCL_SRCS:.c=.d))
 
 .PHONY: all clean distclean install
 
@@ -40,9 +48,18 @@ $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/%.o: %.c
 	$(ECHO)mkdir -p $(@D)
 	$(ECHO)$(CC) -Wp,-MMD,$(YAUL_BUILD_ROOT)/$(SUB_BUILD)/$*.d $(CFLAGS) \
 		$(foreach DIR,$(INCLUDES),-I$(DIR)) \
+		$(foreach DEFINE,$(DEFINES),-D$(DEFINE)) \
 		-c -o $@ $<
 	$(ECHO)$(SED) -i -e '1s/^\(.*\)$$/$(subst /,\/,$(dir $@))\1/' $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/$*.d
 
+$(YAUL_BUILD_ROOT)/$(SUB_BUILD)/libbcl/%.o: ../../libbcl/%.c
+	@printf -- "$(V_BEGIN_YELLOW)$(shell v="$@"; printf -- "$${v#$(YAUL_BUILD_ROOT)/}")$(V_END)\n"
+	$(ECHO)mkdir -p $(@D)
+	$(ECHO)$(CC) -Wp,-MMD,$(YAUL_BUILD_ROOT)/$(SUB_BUILD)/libbcl/$*.d $(CFLAGS) \
+		$(foreach DIR,$(INCLUDES),-I$(DIR)) \
+		-c -o $@ $<
+	$(ECHO)$(SED) -i -e '1s/^\(.*\)$$/$(subst /,\/,$(dir $@))\1/' $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/libbcl/$*.d
+
 clean:
 	$(ECHO)$(RM) $(OBJS) $(DEPS) $(YAUL_BUILD_ROOT)/$(SUB_BUILD)/$(PROGRAM)
 
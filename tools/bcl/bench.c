@@ -0,0 +1,868 @@
+/*
+ * Copyright (c) 2021
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "bcl_bench"
+
+/* Number of times each file is decompressed by default */
+#define BENCH_ITERATIONS_DEFAULT 100
+
+/* Input chunk sizes used to round-trip the streaming decoders */
+#define BENCH_STREAM_CHUNK_SIZES { 1, 13, 4096 }
+
+/* Only the start of each corpus entry is fuzzed, to keep each case short */
+#define BENCH_FUZZ_SAMPLE_SIZE  (16 * 1024)
+
+/* Unmapped space left in front of the output buffer while fuzzing. Matches
+ * that reach further back than this are not caught */
+#define BENCH_FUZZ_GUARD_SIZE   (1024 * 1024)
+
+/* Number of seconds a fuzz case may run for before it's considered hung */
+#define BENCH_FUZZ_TIMEOUT      (2)
+
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <bcl.h>
+
+#include "shared.h"
+
+typedef union {
+        bcl_huffman_stream_t huffman;
+        bcl_lz_stream_t lz;
+        bcl_prs_stream_t prs;
+        bcl_rle_stream_t rle;
+} bench_stream_t;
+
+typedef struct {
+        const char *name;
+        const tool_codec_t *tool_codec;
+
+        void (*decompress)(uint8_t *in, uint8_t *out, uint32_t in_size,
+            uint32_t out_size);
+        int32_t (*decompress_safe)(const void *in, void *out, uint32_t in_size,
+            uint32_t out_size);
+
+        void (*stream_init)(bench_stream_t *ctx, uint8_t *out, uint32_t out_size);
+        bcl_stream_status_t (*stream_drain)(bench_stream_t *ctx, uint32_t max_size);
+} bench_codec_t;
+
+typedef struct {
+        char *name;
+        uint8_t *buffer;
+        size_t size;
+} bench_entry_t;
+
+typedef enum {
+        BENCH_DECODER_ONESHOT,
+        BENCH_DECODER_SAFE,
+        BENCH_DECODER_STREAM,
+        BENCH_DECODER_COUNT
+} bench_decoder_t;
+
+typedef enum {
+        BENCH_FUZZ_ACCEPTED,
+        BENCH_FUZZ_REJECTED,
+        BENCH_FUZZ_CRASHED,
+        BENCH_FUZZ_HUNG,
+        BENCH_FUZZ_RESULT_COUNT
+} bench_fuzz_result_t;
+
+/* Guarded buffers used while fuzzing. Both the input and output end right
+ * before an unmapped page */
+typedef struct {
+        uint8_t *in_region;
+        size_t in_region_size;
+        uint8_t *out_region;
+        size_t out_region_size;
+        size_t page_size;
+} bench_fuzz_buffers_t;
+
+static void _huffman_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size);
+static void _lz_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size);
+static void _prs_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size);
+static void _rle_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size);
+
+#define BENCH_STREAM_WRAPPERS(codec)                                           \
+static void                                                                    \
+_##codec##_stream_init(bench_stream_t *ctx, uint8_t *out, uint32_t out_size)   \
+{                                                                              \
+        bcl_##codec##_stream_init(&ctx->codec, out, out_size);                 \
+}                                                                              \
+                                                                               \
+static bcl_stream_status_t                                                     \
+_##codec##_stream_drain(bench_stream_t *ctx, uint32_t max_size)                \
+{                                                                              \
+        return bcl_##codec##_stream_drain(&ctx->codec, max_size);              \
+}
+
+BENCH_STREAM_WRAPPERS(huffman)
+BENCH_STREAM_WRAPPERS(lz)
+BENCH_STREAM_WRAPPERS(prs)
+BENCH_STREAM_WRAPPERS(rle)
+
+#define BENCH_CODEC(codec) {                                                   \
+        .name            = #codec,                                             \
+        .tool_codec      = &tool_codec_##codec,                                \
+        .decompress      = _##codec##_decompress,                              \
+        .decompress_safe = bcl_##codec##_decompress_safe,                      \
+        .stream_init     = _##codec##_stream_init,                             \
+        .stream_drain    = _##codec##_stream_drain                             \
+}
+
+static const bench_codec_t _codecs[] = {
+        BENCH_CODEC(huffman),
+        BENCH_CODEC(lz),
+        BENCH_CODEC(prs),
+        BENCH_CODEC(rle)
+};
+
+#define BENCH_CODEC_COUNT (sizeof(_codecs) / sizeof(*_codecs))
+
+static const char * const _decoder_names[] = {
+        "oneshot",
+        "safe",
+        "stream"
+};
+
+static uint32_t _random_state = 0x2545F491;
+
+static void _usage_print(void);
+
+static const bench_codec_t *_codec_find(const char *name);
+
+static int _corpus_files_read(bench_entry_t *entries, char *filenames[],
+    uint32_t count);
+static void _corpus_generate(bench_entry_t *entries, uint32_t *count);
+static void _corpus_free(bench_entry_t *entries, uint32_t count);
+
+static int _codec_bench(const bench_codec_t *codec, const bench_entry_t *entries,
+    uint32_t entry_count, uint32_t iterations);
+static bcl_stream_status_t _stream_decompress(const bench_codec_t *codec,
+    const uint8_t *in, uint32_t in_size, uint8_t *out, uint32_t out_size,
+    uint32_t chunk_size);
+
+static int _codec_fuzz(const bench_codec_t *codec, const bench_entry_t *entries,
+    uint32_t entry_count, uint32_t case_count);
+static void _fuzz_mutate(uint8_t *buffer, uint32_t *size);
+static bench_fuzz_result_t _fuzz_case_run(const bench_codec_t *codec,
+    bench_decoder_t decoder, const bench_fuzz_buffers_t *buffers,
+    const uint8_t *in, uint32_t in_size, uint32_t out_size);
+
+static uint32_t _random(void);
+static double _time_get(void);
+
+int
+main(int argc, char *argv[])
+{
+        const bench_codec_t *selected_codec = NULL;
+        uint32_t iterations = BENCH_ITERATIONS_DEFAULT;
+        uint32_t fuzz_case_count = 0;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "c:f:n:s:O")) != -1) {
+                switch (opt) {
+                case 'c':
+                        if ((selected_codec = _codec_find(optarg)) == NULL) {
+                                (void)fprintf(stderr, "Error: %s: Unknown codec \"%s\"\n",
+                                    PROGNAME, optarg);
+
+                                return 1;
+                        }
+                        break;
+                case 'f':
+                        fuzz_case_count = strtoul(optarg, NULL, 0);
+                        break;
+                case 'n':
+                        iterations = strtoul(optarg, NULL, 0);
+                        break;
+                case 's':
+                        _random_state = strtoul(optarg, NULL, 0);
+
+                        if (_random_state == 0) {
+                                _random_state = 1;
+                        }
+                        break;
+                case 'O':
+                        (void)tool_codec_lz.option_parse(opt, optarg);
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if (iterations == 0) {
+                _usage_print();
+
+                return 1;
+        }
+
+        const uint32_t file_count = argc - optind;
+
+        bench_entry_t *entries;
+        uint32_t entry_count;
+
+        if ((entries = calloc((file_count > 0) ? file_count : 16, sizeof(bench_entry_t))) == NULL) {
+                print_errno(PROGNAME);
+
+                return 1;
+        }
+
+        if (file_count > 0) {
+                if ((_corpus_files_read(entries, &argv[optind], file_count)) != 0) {
+                        return 1;
+                }
+
+                entry_count = file_count;
+        } else {
+                _corpus_generate(entries, &entry_count);
+        }
+
+        int ret = 0;
+
+        for (uint32_t i = 0; i < BENCH_CODEC_COUNT; i++) {
+                const bench_codec_t * const codec = &_codecs[i];
+
+                if ((selected_codec != NULL) && (selected_codec != codec)) {
+                        continue;
+                }
+
+                ret |= _codec_bench(codec, entries, entry_count, iterations);
+
+                if (fuzz_case_count > 0) {
+                        ret |= _codec_fuzz(codec, entries, entry_count, fuzz_case_count);
+                }
+        }
+
+        _corpus_free(entries, entry_count);
+
+        return ret;
+}
+
+static void
+_huffman_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size)
+{
+        bcl_huffman_decompress(in, out, in_size, out_size);
+}
+
+static void
+_lz_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size __attribute__ ((unused)))
+{
+        bcl_lz_decompress(in, out, in_size);
+}
+
+static void
+_prs_decompress(uint8_t *in, uint8_t *out,
+    uint32_t in_size __attribute__ ((unused)),
+    uint32_t out_size __attribute__ ((unused)))
+{
+        bcl_prs_decompress(in, out);
+}
+
+static void
+_rle_decompress(uint8_t *in, uint8_t *out, uint32_t in_size,
+    uint32_t out_size __attribute__ ((unused)))
+{
+        bcl_rle_decompress(in, out, in_size);
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-c codec] [-n iterations] [-f cases] [-s seed] [-O] [file ...]\n",
+            PROGNAME);
+        (void)fprintf(stderr, "Round-trip each file (or a built-in corpus) through every codec, and\n"
+                              "measure how fast libbcl decompresses it\n");
+        (void)fprintf(stderr, "  -c codec       Only test codec:");
+
+        for (size_t i = 0; i < BENCH_CODEC_COUNT; i++) {
+                (void)fprintf(stderr, " %s", _codecs[i].name);
+        }
+
+        (void)fprintf(stderr, "\n");
+        (void)fprintf(stderr, "  -n iterations  Number of times each file is decompressed (default: %i)\n",
+            BENCH_ITERATIONS_DEFAULT);
+        (void)fprintf(stderr, "  -f cases       Feed each decoder this many malformed streams\n");
+        (void)fprintf(stderr, "  -s seed        Seed used to generate malformed streams\n");
+        (void)fprintf(stderr, "  -O             Use the optimal LZ77 parse\n");
+}
+
+static const bench_codec_t *
+_codec_find(const char *name)
+{
+        for (size_t i = 0; i < BENCH_CODEC_COUNT; i++) {
+                if ((strcmp(_codecs[i].name, name)) == 0) {
+                        return &_codecs[i];
+                }
+        }
+
+        return NULL;
+}
+
+static int
+_corpus_files_read(bench_entry_t *entries, char *filenames[], uint32_t count)
+{
+        for (uint32_t i = 0; i < count; i++) {
+                input_file_t input_file;
+
+                errno = 0;
+
+                if ((input_file_open(filenames[i], &input_file)) != 0) {
+                        (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME,
+                            filenames[i], strerror(errno));
+
+                        return -1;
+                }
+
+                entries[i].name = strdup(filenames[i]);
+                entries[i].buffer = input_file.buffer;
+                entries[i].size = input_file.buffer_len;
+        }
+
+        return 0;
+}
+
+/* Generate a fixed corpus loosely modelled on typical assets, so results can
+ * be compared across runs and machines */
+static void
+_corpus_generate(bench_entry_t *entries, uint32_t *count)
+{
+        static const char * const words[] = {
+                "the", "sprite", "plane", "vertex", "cell", "character",
+                "pattern", "palette", "scroll", "polygon", "of", "and", "to",
+                "texture", "a", "is", "frame", "buffer", "with", "color"
+        };
+
+        const uint32_t random_state = _random_state;
+
+        _random_state = 0x2545F491;
+
+        uint32_t n = 0;
+
+        bench_entry_t *entry;
+
+        /* Uncompressible data */
+        entry = &entries[n++];
+        entry->name = strdup("random");
+        entry->size = 64 * 1024;
+        entry->buffer = malloc(entry->size);
+
+        for (size_t i = 0; i < entry->size; i++) {
+                entry->buffer[i] = _random();
+        }
+
+        /* Runs of bytes */
+        entry = &entries[n++];
+        entry->name = strdup("runs");
+        entry->size = 128 * 1024;
+        entry->buffer = malloc(entry->size);
+
+        for (size_t i = 0; i < entry->size; ) {
+                const uint8_t value = _random();
+
+                for (uint32_t length = 1 + (_random() % 64); (length > 0) && (i < entry->size); length--) {
+                        entry->buffer[i++] = value;
+                }
+        }
+
+        /* Text */
+        entry = &entries[n++];
+        entry->name = strdup("text");
+        entry->size = 256 * 1024;
+        entry->buffer = malloc(entry->size);
+
+        for (size_t i = 0; i < entry->size; ) {
+                const char *word = words[_random() % (sizeof(words) / sizeof(*words))];
+
+                for (; (*word != '\0') && (i < entry->size); word++) {
+                        entry->buffer[i++] = *word;
+                }
+
+                if (i < entry->size) {
+                        entry->buffer[i++] = ((_random() % 12) == 0) ? '\n' : ' ';
+                }
+        }
+
+        /* 4-bpp 8x8 character patterns, picked from a small set of tiles with
+         * the odd pixel changed */
+        entry = &entries[n++];
+        entry->name = strdup("cells");
+        entry->size = 256 * 1024;
+        entry->buffer = malloc(entry->size);
+
+        uint8_t tiles[16][32];
+
+        for (uint32_t t = 0; t < 16; t++) {
+                for (uint32_t i = 0; i < 32; i++) {
+                        tiles[t][i] = ((_random() % 4) == 0) ? _random() : 0x00;
+                }
+        }
+
+        for (size_t i = 0; i < entry->size; i += 32) {
+                (void)memcpy(&entry->buffer[i], tiles[_random() % 16], 32);
+
+                if ((_random() % 4) == 0) {
+                        entry->buffer[i + (_random() % 32)] ^= 0x0F;
+                }
+        }
+
+        /* Big-endian 16.16 fixed point vertices on a smooth surface */
+        entry = &entries[n++];
+        entry->name = strdup("vertices");
+        entry->size = 96 * 1024;
+        entry->buffer = malloc(entry->size);
+
+        for (size_t i = 0; i < entry->size; i += 4) {
+                const size_t vertex = i / 12;
+                const size_t component = (i / 4) % 3;
+
+                int32_t value = ((vertex % 64) << 16) * (component == 0);
+
+                value += ((vertex / 64) << 16) * (component == 2);
+                value += (int32_t)((_random() % 0x4000) << 4) * (component == 1);
+
+                entry->buffer[i]     = value >> 24;
+                entry->buffer[i + 1] = value >> 16;
+                entry->buffer[i + 2] = value >> 8;
+                entry->buffer[i + 3] = value;
+        }
+
+        /* Nothing but zeros */
+        entry = &entries[n++];
+        entry->name = strdup("zeros");
+        entry->size = 64 * 1024;
+        entry->buffer = calloc(entry->size, 1);
+
+        *count = n;
+
+        _random_state = random_state;
+}
+
+static void
+_corpus_free(bench_entry_t *entries, uint32_t count)
+{
+        for (uint32_t i = 0; i < count; i++) {
+                free(entries[i].name);
+                free(entries[i].buffer);
+        }
+
+        free(entries);
+}
+
+/* Compress every entry, then check and time its decompression */
+static int
+_codec_bench(const bench_codec_t *codec, const bench_entry_t *entries,
+    uint32_t entry_count, uint32_t iterations)
+{
+        static const uint32_t chunk_sizes[] = BENCH_STREAM_CHUNK_SIZES;
+
+        const tool_codec_t * const tool_codec = codec->tool_codec;
+
+        size_t total_size = 0;
+        size_t total_cmp_size = 0;
+        double total_time = 0.0;
+        double total_safe_time = 0.0;
+        int ret = 0;
+
+        for (uint32_t i = 0; i < entry_count; i++) {
+                const bench_entry_t * const entry = &entries[i];
+
+                uint8_t *cmp_buffer;
+                uint8_t *out_buffer;
+
+                cmp_buffer = malloc(tool_codec->out_size_get(entry->size));
+                out_buffer = malloc(entry->size + 1);
+
+                if ((cmp_buffer == NULL) || (out_buffer == NULL)) {
+                        print_errno(PROGNAME);
+
+                        exit(1);
+                }
+
+                const double cmp_time = _time_get();
+
+                const uint32_t cmp_size =
+                    tool_codec->compress(entry->buffer, cmp_buffer, entry->size, 1);
+
+                const double cmp_mb_per_sec =
+                    (double)entry->size / ((_time_get() - cmp_time) * 1000000.0);
+
+                bool verified = (cmp_size > 0);
+
+                double time = _time_get();
+
+                for (uint32_t j = 0; verified && (j < iterations); j++) {
+                        codec->decompress(cmp_buffer, out_buffer, cmp_size, entry->size);
+                }
+
+                time = _time_get() - time;
+
+                if (verified) {
+                        verified = ((memcmp(out_buffer, entry->buffer, entry->size)) == 0);
+                }
+
+                double safe_time = _time_get();
+
+                for (uint32_t j = 0; verified && (j < iterations); j++) {
+                        (void)memset(out_buffer, 0, 1);
+
+                        const int32_t size = codec->decompress_safe(cmp_buffer,
+                            out_buffer, cmp_size, entry->size);
+
+                        verified = (size == (int32_t)entry->size);
+                }
+
+                safe_time = _time_get() - safe_time;
+
+                if (verified) {
+                        verified = ((memcmp(out_buffer, entry->buffer, entry->size)) == 0);
+                }
+
+                /* The streaming decoders must produce the same output no
+                 * matter how the input is split */
+                for (uint32_t j = 0; verified && (j < (sizeof(chunk_sizes) / sizeof(*chunk_sizes))); j++) {
+                        (void)memset(out_buffer, 0, entry->size);
+
+                        const bcl_stream_status_t status = _stream_decompress(codec,
+                            cmp_buffer, cmp_size, out_buffer, entry->size, chunk_sizes[j]);
+
+                        verified = (status == BCL_STREAM_STATUS_DONE) &&
+                                   ((memcmp(out_buffer, entry->buffer, entry->size)) == 0);
+                }
+
+                if (!verified) {
+                        (void)fprintf(stderr, "Error: %s: %s: %s: Round trip failed\n",
+                            PROGNAME, codec->name, entry->name);
+
+                        ret = 1;
+                } else {
+                        const double mb_per_sec =
+                            ((double)entry->size * iterations) / (time * 1000000.0);
+                        const double safe_mb_per_sec =
+                            ((double)entry->size * iterations) / (safe_time * 1000000.0);
+
+                        (void)printf("%-8s %-12s %8zu -> %8"PRIu32" (%5.1f%%), compress %7.2f MB/s, decompress %8.2f MB/s, safe %8.2f MB/s\n",
+                            codec->name, entry->name, entry->size, cmp_size,
+                            (entry->size > 0) ? ((100.0 * cmp_size) / entry->size) : 0.0,
+                            cmp_mb_per_sec, mb_per_sec, safe_mb_per_sec);
+
+                        total_size += entry->size;
+                        total_cmp_size += cmp_size;
+                        total_time += time / iterations;
+                        total_safe_time += safe_time / iterations;
+                }
+
+                free(cmp_buffer);
+                free(out_buffer);
+        }
+
+        if (total_time > 0.0) {
+                (void)printf("%-8s %-12s %8zu -> %8zu (%5.1f%%), decompress %8.2f MB/s, safe %8.2f MB/s\n",
+                    codec->name, "total", total_size, total_cmp_size,
+                    (100.0 * total_cmp_size) / total_size,
+                    (double)total_size / (total_time * 1000000.0),
+                    (double)total_size / (total_safe_time * 1000000.0));
+        }
+
+        return ret;
+}
+
+static bcl_stream_status_t
+_stream_decompress(const bench_codec_t *codec, const uint8_t *in,
+    uint32_t in_size, uint8_t *out, uint32_t out_size, uint32_t chunk_size)
+{
+        bench_stream_t ctx;
+
+        /* Every context starts with a bcl_stream_t */
+        bcl_stream_t * const stream = (bcl_stream_t *)&ctx;
+
+        codec->stream_init(&ctx, out, out_size);
+
+        uint32_t in_pos = 0;
+
+        while (true) {
+                const bcl_stream_status_t status = codec->stream_drain(&ctx, chunk_size);
+
+                switch (status) {
+                case BCL_STREAM_STATUS_NEED_INPUT:
+                        if (in_pos == in_size) {
+                                return BCL_STREAM_STATUS_ERROR;
+                        }
+
+                        const uint32_t size =
+                            ((in_size - in_pos) < chunk_size) ? (in_size - in_pos) : chunk_size;
+
+                        bcl_stream_feed(stream, &in[in_pos], size);
+
+                        in_pos += size;
+                        break;
+                case BCL_STREAM_STATUS_OUTPUT_FULL:
+                        break;
+                default:
+                        return status;
+                }
+        }
+}
+
+/* Feed each decoder malformed streams derived from valid ones, and count how
+ * many of them cause it to crash or hang. Only the unchecked one-shot decoders
+ * are allowed to */
+static int
+_codec_fuzz(const bench_codec_t *codec, const bench_entry_t *entries,
+    uint32_t entry_count, uint32_t case_count)
+{
+        const tool_codec_t * const tool_codec = codec->tool_codec;
+
+        uint8_t *cmp_buffers[entry_count];
+        uint32_t cmp_sizes[entry_count];
+        uint32_t out_sizes[entry_count];
+
+        uint32_t max_cmp_size = 0;
+
+        for (uint32_t i = 0; i < entry_count; i++) {
+                out_sizes[i] = (entries[i].size < BENCH_FUZZ_SAMPLE_SIZE)
+                    ? entries[i].size
+                    : BENCH_FUZZ_SAMPLE_SIZE;
+
+                if ((cmp_buffers[i] = malloc(tool_codec->out_size_get(out_sizes[i]))) == NULL) {
+                        print_errno(PROGNAME);
+
+                        exit(1);
+                }
+
+                cmp_sizes[i] = tool_codec->compress(entries[i].buffer, cmp_buffers[i],
+                    out_sizes[i], 1);
+
+                if (cmp_sizes[i] > max_cmp_size) {
+                        max_cmp_size = cmp_sizes[i];
+                }
+        }
+
+        bench_fuzz_buffers_t buffers;
+
+        buffers.page_size = sysconf(_SC_PAGESIZE);
+
+        const size_t page_mask = buffers.page_size - 1;
+
+        buffers.in_region_size = ((max_cmp_size + page_mask) & ~page_mask) + buffers.page_size;
+        buffers.out_region_size = BENCH_FUZZ_GUARD_SIZE +
+            ((BENCH_FUZZ_SAMPLE_SIZE + page_mask) & ~page_mask) + buffers.page_size;
+
+        buffers.in_region = mmap(NULL, buffers.in_region_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        buffers.out_region = mmap(NULL, buffers.out_region_size, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if ((buffers.in_region == MAP_FAILED) || (buffers.out_region == MAP_FAILED)) {
+                print_errno(PROGNAME);
+
+                exit(1);
+        }
+
+        (void)mprotect(&buffers.in_region[buffers.in_region_size - buffers.page_size],
+            buffers.page_size, PROT_NONE);
+        (void)mprotect(&buffers.out_region[BENCH_FUZZ_GUARD_SIZE],
+            buffers.out_region_size - BENCH_FUZZ_GUARD_SIZE - buffers.page_size,
+            PROT_READ | PROT_WRITE);
+
+        uint8_t *case_buffer;
+
+        if ((case_buffer = malloc(max_cmp_size + 1)) == NULL) {
+                print_errno(PROGNAME);
+
+                exit(1);
+        }
+
+        uint32_t results[BENCH_DECODER_COUNT][BENCH_FUZZ_RESULT_COUNT];
+
+        (void)memset(results, 0, sizeof(results));
+
+        for (uint32_t i = 0; i < case_count; i++) {
+                const uint32_t entry_index = i % entry_count;
+
+                uint32_t case_size = cmp_sizes[entry_index];
+
+                (void)memcpy(case_buffer, cmp_buffers[entry_index], case_size);
+
+                _fuzz_mutate(case_buffer, &case_size);
+
+                for (uint32_t decoder = 0; decoder < BENCH_DECODER_COUNT; decoder++) {
+                        const bench_fuzz_result_t result = _fuzz_case_run(codec, decoder,
+                            &buffers, case_buffer, case_size, out_sizes[entry_index]);
+
+                        results[decoder][result]++;
+                }
+        }
+
+        int ret = 0;
+
+        for (uint32_t decoder = 0; decoder < BENCH_DECODER_COUNT; decoder++) {
+                const uint32_t * const counts = results[decoder];
+
+                if ((decoder != BENCH_DECODER_ONESHOT) &&
+                    ((counts[BENCH_FUZZ_CRASHED] + counts[BENCH_FUZZ_HUNG]) > 0)) {
+                        (void)fprintf(stderr, "Error: %s: %s: The %s decoder crashed or hung\n",
+                            PROGNAME, codec->name, _decoder_names[decoder]);
+
+                        ret = 1;
+                }
+
+                (void)printf("%-8s fuzz %-8s %6"PRIu32" cases: %6"PRIu32" accepted, %6"PRIu32" rejected, %6"PRIu32" crashed, %6"PRIu32" hung\n",
+                    codec->name, _decoder_names[decoder], case_count,
+                    counts[BENCH_FUZZ_ACCEPTED], counts[BENCH_FUZZ_REJECTED],
+                    counts[BENCH_FUZZ_CRASHED], counts[BENCH_FUZZ_HUNG]);
+        }
+
+        free(case_buffer);
+
+        (void)munmap(buffers.in_region, buffers.in_region_size);
+        (void)munmap(buffers.out_region, buffers.out_region_size);
+
+        for (uint32_t i = 0; i < entry_count; i++) {
+                free(cmp_buffers[i]);
+        }
+
+        return ret;
+}
+
+static void
+_fuzz_mutate(uint8_t *buffer, uint32_t *size)
+{
+        const uint32_t in_size = *size;
+
+        if (in_size == 0) {
+                return;
+        }
+
+        switch (_random() % 4) {
+        case 0:
+                /* Flip a few bits */
+                for (uint32_t count = 1 + (_random() % 8); count > 0; count--) {
+                        buffer[_random() % in_size] ^= 1 << (_random() % 8);
+                }
+                break;
+        case 1:
+                /* Overwrite a few bytes */
+                for (uint32_t count = 1 + (_random() % 8); count > 0; count--) {
+                        buffer[_random() % in_size] = _random();
+                }
+                break;
+        case 2:
+                /* Truncate */
+                *size = _random() % in_size;
+                break;
+        default:
+                /* Replace everything after the start of the stream */
+                for (uint32_t i = _random() % in_size; i < in_size; i++) {
+                        buffer[i] = _random();
+                }
+                break;
+        }
+}
+
+/* Run a single decoder in a child process, with the input and output placed
+ * right in front of unmapped pages so overruns fault */
+static bench_fuzz_result_t
+_fuzz_case_run(const bench_codec_t *codec, bench_decoder_t decoder,
+    const bench_fuzz_buffers_t *buffers, const uint8_t *in, uint32_t in_size,
+    uint32_t out_size)
+{
+        uint8_t * const guarded_in =
+            &buffers->in_region[buffers->in_region_size - buffers->page_size - in_size];
+        uint8_t * const guarded_out =
+            &buffers->out_region[buffers->out_region_size - buffers->page_size - out_size];
+
+        (void)memcpy(guarded_in, in, in_size);
+
+        (void)fflush(stdout);
+        (void)fflush(stderr);
+
+        const pid_t pid = fork();
+
+        if (pid < 0) {
+                print_errno(PROGNAME);
+
+                exit(1);
+        }
+
+        if (pid == 0) {
+                (void)alarm(BENCH_FUZZ_TIMEOUT);
+
+                if (decoder == BENCH_DECODER_ONESHOT) {
+                        codec->decompress(guarded_in, guarded_out, in_size, out_size);
+
+                        _exit(0);
+                }
+
+                if (decoder == BENCH_DECODER_SAFE) {
+                        const int32_t size = codec->decompress_safe(guarded_in,
+                            guarded_out, in_size, out_size);
+
+                        _exit((size >= 0) ? 0 : 2);
+                }
+
+                const bcl_stream_status_t status = _stream_decompress(codec, guarded_in,
+                    in_size, guarded_out, out_size, 4096);
+
+                _exit((status == BCL_STREAM_STATUS_DONE) ? 0 : 2);
+        }
+
+        int wstatus;
+
+        while ((waitpid(pid, &wstatus, 0)) < 0) {
+                if (errno != EINTR) {
+                        print_errno(PROGNAME);
+
+                        exit(1);
+                }
+        }
+
+        if (WIFSIGNALED(wstatus)) {
+                return (WTERMSIG(wstatus) == SIGALRM) ? BENCH_FUZZ_HUNG : BENCH_FUZZ_CRASHED;
+        }
+
+        return (WEXITSTATUS(wstatus) == 0) ? BENCH_FUZZ_ACCEPTED : BENCH_FUZZ_REJECTED;
+}
+
+/* xorshift32, so the corpus and fuzz cases are the same on every host */
+static uint32_t
+_random(void)
+{
+        _random_state ^= _random_state << 13;
+        _random_state ^= _random_state >> 17;
+        _random_state ^= _random_state << 5;
+
+        return _random_state;
+}
+
+static double
+_time_get(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
@@ -60,62 +60,40 @@ struct huff_decodenode {
 
 int _huffman_compress(uint8_t *in, uint8_t *out, uint32_t in_size);
 
+static size_t _huffman_out_size_get(size_t in_size);
+static uint32_t _huffman_tool_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count);
+
+const tool_codec_t tool_codec_huffman = {
+        .progname     = PROGNAME,
+        .extension    = ".huf",
+        .out_size_get = _huffman_out_size_get,
+        .compress     = _huffman_tool_compress
+};
+
+#ifndef TOOL_CODEC_ONLY
 int
 main(int argc, char *argv[])
 {
-        if (argc != 3) {
-                print_usage(PROGNAME);
-
-                return 0;
-        }
-
-        const char *const in_filename = argv[1];
-        const char *const out_filename = argv[2];
-
-        input_file_t input_file;
-
-        if ((input_file_open(in_filename, &input_file)) != 0) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
-
-        /* Allocate a buffer of equal to twice the size since we don't know how
-         * big the out file size will be */
-        void *out_buffer;
-
-        /* According to the original sources, the output buffer must be 0.4%
-         * larger plus 1 byte */
-        size_t out_size = (size_t)floor(1.004f * (float)input_file.buffer_len) + 1;
-
-        if ((out_buffer = malloc(out_size)) == NULL) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
-
-        const uint32_t out_file_size =
-                _huffman_compress(input_file.buffer, out_buffer, input_file.buffer_len);
-
-        (void)printf("%zu -> %"PRIu32"\n", input_file.buffer_len, out_file_size);
-
-        if (out_file_size == 0) {
-                fprintf(stderr, "Error: %s: RLE compression failed\n", PROGNAME);
-
-                return 1;
-        }
-
-        if ((output_file_write(out_filename, out_buffer, out_file_size)) != 0) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
+        return tool_main(argc, argv, &tool_codec_huffman);
+}
+#endif /* !TOOL_CODEC_ONLY */
 
-        input_file_close(&input_file);
+/* According to the original sources, the output buffer must be 1% larger plus
+ * 320 bytes to hold the tree and any expansion */
+static size_t
+_huffman_out_size_get(size_t in_size)
+{
+        return ((in_size * 101) / 100) + 320;
+}
 
-        free(out_buffer);
+static uint32_t
+_huffman_tool_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count)
+{
+        (void)thread_count;
 
-        return 0;
+        return _huffman_compress((uint8_t *)in, out, in_size);
 }
 
 /* Initialize a bitstream */
@@ -20,87 +20,181 @@
 
 #define PROGNAME "bcl_lz"
 
-/* Maximum offset (can be any size < 2^31). Lower values give faster
- * compression, while higher values gives better compression. The default value
- * of 100000 is quite high. Experiment to see what works best for you. */
-#define LZ_MAX_OFFSET 2147483648
+/* Maximum offset. Lower values give faster compression, while higher values
+ * give better compression. Offsets past 2^21 need a 4-byte encoding, which is
+ * rarely worth it */
+#define LZ_MAX_OFFSET           (1 << 21)
 
+/* Shortest match the format can pay off */
+#define LZ_MIN_LENGTH           (4)
+
+#define LZ_HASH_BITS            (16)
+#define LZ_HASH_SIZE            (1 << LZ_HASH_BITS)
+
+/* Number of hash chain links followed per position */
+#define LZ_CHAIN_DEPTH_GREEDY   (256)
+#define LZ_CHAIN_DEPTH_OPTIMAL  (512)
+
+/* Matches at least this long are taken as-is by the optimal parse */
+#define LZ_NICE_LENGTH          (128)
+
+/* Maximum number of matches of increasing length found per position */
+#define LZ_MATCHES_MAX          (64)
+
+/* Input is split into blocks of this size that are compressed in parallel.
+ * Matches may still reference data in previous blocks, so the only loss is
+ * that a parse can't cross a block boundary */
+#define LZ_BLOCK_SIZE           (1024 * 1024)
+
+#define LZ_THREADS_MAX          (64)
+
+#include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include <unistd.h>
 
-#include "shared.h"
+#include <bcl.h>
 
-static int _lz_compress(uint8_t *in, uint8_t *out, uint32_t insize, uint32_t max_offset);
+#include "shared.h"
 
+typedef enum {
+        LZ_PARSE_GREEDY,
+        LZ_PARSE_OPTIMAL
+} lz_parse_t;
+
+typedef struct {
+        uint32_t length;
+        uint32_t offset;
+} lz_match_t;
+
+typedef struct {
+        const uint8_t *in;
+        uint32_t base;          /* Position of prev[0] */
+        uint32_t chain_depth;
+        int32_t head[LZ_HASH_SIZE];
+        int32_t *prev;
+} lz_matcher_t;
+
+typedef struct {
+        const uint8_t *in;
+        uint32_t start;
+        uint32_t end;
+        uint8_t marker;
+        lz_parse_t parse;
+
+        uint8_t *out;
+        uint32_t out_size;
+        int error;
+} lz_block_t;
+
+typedef struct {
+        lz_block_t *blocks;
+        uint32_t block_count;
+        uint32_t next_block;
+        pthread_mutex_t mutex;
+} lz_job_t;
+
+static uint32_t _lz_compress(const uint8_t *in, uint8_t *out, uint32_t in_size,
+    lz_parse_t parse, uint32_t thread_count);
+
+static int _lz_option_parse(int opt, const char *arg);
+static size_t _lz_out_size_get(size_t in_size);
+static uint32_t _lz_verified_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count);
+
+static lz_parse_t _parse = LZ_PARSE_GREEDY;
+
+const tool_codec_t tool_codec_lz = {
+        .progname      = PROGNAME,
+        .extension     = ".lz",
+        .options       = "O",
+        .options_usage = "  -O          Use the (slower) optimal parse\n",
+        .option_parse  = _lz_option_parse,
+        .out_size_get  = _lz_out_size_get,
+        .compress      = _lz_verified_compress
+};
+
+#ifndef TOOL_CODEC_ONLY
 int
 main(int argc, char *argv[])
 {
-        if (argc != 3) {
-                print_usage(PROGNAME);
+        return tool_main(argc, argv, &tool_codec_lz);
+}
+#endif /* !TOOL_CODEC_ONLY */
 
+static int
+_lz_option_parse(int opt, const char *arg)
+{
+        (void)arg;
+
+        switch (opt) {
+        case 'O':
+                _parse = LZ_PARSE_OPTIMAL;
                 return 0;
+        default:
+                return -1;
         }
+}
 
-        const char * const in_filename = argv[1];
-        const char * const out_filename = argv[2];
-
-        input_file_t input_file;
-
-        if ((input_file_open(in_filename, &input_file)) != 0) {
-                print_errno(PROGNAME);
+/* The marker byte is the least common byte, so it can make up at most 1/256th
+ * of the input, and each occurrence costs one extra byte */
+static size_t
+_lz_out_size_get(size_t in_size)
+{
+        return in_size + (in_size / 256) + 1;
+}
 
-                return 1;
+static uint32_t
+_lz_verified_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count)
+{
+        if (thread_count > LZ_THREADS_MAX) {
+                thread_count = LZ_THREADS_MAX;
         }
 
-        /* Allocate a buffer of equal to twice the size since we don't know how
-         * big the out file size will be */
-        void *out_buffer;
+        const uint32_t out_size = _lz_compress(in, out, in_size, _parse, thread_count);
 
-        /* According to the original sources, the output buffer must be 0.4%
-         * larger plus 1 byte */
-        size_t out_size = (size_t)floor(1.004f * (float)input_file.buffer_len) + 1;
+        if (out_size == 0) {
+                return 0;
+        }
 
-        if ((out_buffer = malloc(out_size)) == NULL) {
-                print_errno(PROGNAME);
+        /* Make sure the stream decompresses back to the input */
+        uint8_t *check_buffer;
 
-                return 1;
+        if ((check_buffer = malloc(in_size + 1)) == NULL) {
+                return 0;
         }
 
-        const uint32_t out_file_size =
-            _lz_compress(input_file.buffer, out_buffer, input_file.buffer_len, LZ_MAX_OFFSET);
+        bcl_lz_decompress(out, check_buffer, out_size);
 
-        (void)printf("%zu -> %"PRIu32"\n", input_file.buffer_len, out_file_size);
+        const bool verified = ((memcmp(check_buffer, in, in_size)) == 0);
 
-        if (out_file_size == 0) {
-                fprintf(stderr, "Error: %s: RLE compression failed\n", PROGNAME);
-
-                return 1;
-        }
+        free(check_buffer);
 
-        if ((output_file_write(out_filename, out_buffer, out_file_size)) != 0) {
-                print_errno(PROGNAME);
+        if (!verified) {
+                (void)fprintf(stderr, "Error: %s: Compressed stream failed to verify\n", PROGNAME);
 
-                return 1;
+                return 0;
         }
 
-        input_file_close(&input_file);
-
-        free(out_buffer);
-
-        return 0;
+        return out_size;
 }
 
-/* Return maximum length string match */
+/* Number of bytes needed to store the integer x */
 static uint32_t
-_lz_string_compare(uint8_t *str1, uint8_t *str2, uint32_t minlen, uint32_t maxlen)
+_lz_var_size_get(uint32_t x)
 {
-        uint32_t len;
+        uint32_t num_bytes;
 
-        for (len = minlen; (len < maxlen) && (str1[len] == str2[len]); ++len);
+        for (num_bytes = 1; x >= 0x00000080; x >>= 7) {
+                ++num_bytes;
+        }
 
-        return len;
+        return num_bytes;
 }
 
 /* Write integer with variable number of bytes depending on value */
@@ -136,20 +230,384 @@ static int _lz_var_size_write(uint32_t x, uint8_t *buf)
         return num_bytes;
 }
 
+static inline uint32_t
+_lz_literal_cost(uint8_t symbol, uint8_t marker)
+{
+        return ((symbol == marker) ? 2 : 1);
+}
+
+static inline uint32_t
+_lz_match_cost(uint32_t length, uint32_t offset)
+{
+        return (1 + _lz_var_size_get(length) + _lz_var_size_get(offset));
+}
+
+static inline uint32_t
+_lz_hash(const uint8_t *p)
+{
+        const uint32_t x = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+                           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+
+        return ((x * 2654435761U) >> (32 - LZ_HASH_BITS));
+}
+
 static int
-_lz_compress(uint8_t *in, uint8_t *out, uint32_t in_size, uint32_t max_offset)
+_lz_matcher_init(lz_matcher_t *matcher, const uint8_t *in, uint32_t base,
+    uint32_t end, uint32_t chain_depth)
 {
-        uint8_t marker, symbol;
-        uint32_t inpos, outpos, bytesleft, i;
-        uint32_t maxoffset, offset, bestoffset;
-        uint32_t maxlength, length, bestlength;
-        uint32_t histogram[256];
-        uint8_t *ptr1, *ptr2;
+        matcher->in = in;
+        matcher->base = base;
+        matcher->chain_depth = chain_depth;
+
+        for (uint32_t i = 0; i < LZ_HASH_SIZE; i++) {
+                matcher->head[i] = -1;
+        }
+
+        if ((matcher->prev = malloc(sizeof(int32_t) * ((end - base) + 1))) == NULL) {
+                return -1;
+        }
+
+        return 0;
+}
+
+static void
+_lz_matcher_deinit(lz_matcher_t *matcher)
+{
+        free(matcher->prev);
+}
+
+/* Link the string at pos into the hash chains. The caller guarantees that 4
+ * bytes can be read at pos */
+static inline void
+_lz_matcher_insert(lz_matcher_t *matcher, uint32_t pos)
+{
+        const uint32_t hash = _lz_hash(&matcher->in[pos]);
+
+        matcher->prev[pos - matcher->base] = matcher->head[hash];
+        matcher->head[hash] = pos;
+}
+
+/* Find matches of strictly increasing length for the string at pos, without
+ * reading past end. Returns the number of matches written, the last being the
+ * longest */
+static uint32_t
+_lz_matcher_find(const lz_matcher_t *matcher, uint32_t pos, uint32_t end,
+    lz_match_t *matches)
+{
+        const uint8_t * const in = matcher->in;
+        const uint8_t * const str = &in[pos];
+        const uint32_t max_length = end - pos;
+
+        uint32_t match_count = 0;
+        uint32_t best_length = LZ_MIN_LENGTH - 1;
+
+        if (max_length < LZ_MIN_LENGTH) {
+                return 0;
+        }
+
+        int32_t candidate = matcher->head[_lz_hash(str)];
+
+        for (uint32_t depth = matcher->chain_depth; (depth > 0) && (candidate >= 0); depth--) {
+                const uint32_t offset = pos - (uint32_t)candidate;
+
+                if (offset > LZ_MAX_OFFSET) {
+                        break;
+                }
+
+                const uint8_t * const match = &in[candidate];
+
+                /* Quickly determine if this is a candidate */
+                if ((match[best_length] == str[best_length]) && (match[0] == str[0])) {
+                        uint32_t length;
+
+                        for (length = 0; (length < max_length) && (match[length] == str[length]); length++) {
+                        }
+
+                        if (length > best_length) {
+                                best_length = length;
+
+                                matches[match_count].length = length;
+                                matches[match_count].offset = offset;
+                                match_count++;
+
+                                if ((length == max_length) ||
+                                    (match_count == LZ_MATCHES_MAX)) {
+                                        break;
+                                }
+                        }
+                }
+
+                candidate = matcher->prev[candidate - matcher->base];
+        }
+
+        return match_count;
+}
+
+static uint32_t
+_lz_literal_write(uint8_t *out, uint8_t symbol, uint8_t marker)
+{
+        out[0] = symbol;
+
+        if (symbol == marker) {
+                out[1] = 0;
+
+                return 2;
+        }
+
+        return 1;
+}
+
+static uint32_t
+_lz_match_write(uint8_t *out, uint8_t marker, uint32_t length, uint32_t offset)
+{
+        uint32_t outpos = 0;
+
+        out[outpos++] = marker;
+        outpos += _lz_var_size_write(length, &out[outpos]);
+        outpos += _lz_var_size_write(offset, &out[outpos]);
+
+        return outpos;
+}
+
+/* Insert every position in [pos, end) that has 4 bytes left to hash */
+static inline void
+_lz_matcher_range_insert(lz_matcher_t *matcher, uint32_t pos, uint32_t end,
+    uint32_t in_size)
+{
+        for (; (pos < end) && ((pos + LZ_MIN_LENGTH) <= in_size); pos++) {
+                _lz_matcher_insert(matcher, pos);
+        }
+}
+
+static void
+_lz_block_greedy_parse(lz_block_t *block, lz_matcher_t *matcher, uint32_t in_size)
+{
+        const uint8_t * const in = block->in;
+        lz_match_t matches[LZ_MATCHES_MAX];
+
+        uint32_t inpos = block->start;
+        uint32_t outpos = 0;
+
+        while (inpos < block->end) {
+                const uint32_t match_count =
+                    _lz_matcher_find(matcher, inpos, block->end, matches);
+
+                if (match_count > 0) {
+                        const lz_match_t * const match = &matches[match_count - 1];
+
+                        /* Was there a good enough match? */
+                        if (_lz_match_cost(match->length, match->offset) < match->length) {
+                                outpos += _lz_match_write(&block->out[outpos],
+                                    block->marker, match->length, match->offset);
+
+                                _lz_matcher_range_insert(matcher, inpos,
+                                    inpos + match->length, in_size);
+
+                                inpos += match->length;
+
+                                continue;
+                        }
+                }
 
-        if (max_offset >= LZ_MAX_OFFSET) {
-                max_offset = LZ_MAX_OFFSET;
+                /* Output single byte (or two bytes if marker byte) */
+                outpos += _lz_literal_write(&block->out[outpos], in[inpos], block->marker);
+
+                _lz_matcher_range_insert(matcher, inpos, inpos + 1, in_size);
+
+                inpos++;
+        }
+
+        block->out_size = outpos;
+}
+
+/* Price based parse. The cheapest encoding of every prefix of the block is
+ * found front to back, then the token chain is followed back from the end */
+static int
+_lz_block_optimal_parse(lz_block_t *block, lz_matcher_t *matcher, uint32_t in_size)
+{
+        const uint8_t * const in = block->in;
+        const uint32_t start = block->start;
+        const uint32_t length = block->end - start;
+
+        lz_match_t matches[LZ_MATCHES_MAX];
+
+        uint32_t * const price = malloc(sizeof(uint32_t) * (length + 1));
+        lz_match_t * const from = malloc(sizeof(lz_match_t) * (length + 1));
+
+        if ((price == NULL) || (from == NULL)) {
+                free(price);
+                free(from);
+
+                return -1;
+        }
+
+        price[0] = 0;
+
+        for (uint32_t i = 1; i <= length; i++) {
+                price[i] = UINT32_MAX;
+        }
+
+        for (uint32_t i = 0; i < length; i++) {
+                const uint32_t inpos = start + i;
+                const uint32_t literal_price =
+                    price[i] + _lz_literal_cost(in[inpos], block->marker);
+
+                if (literal_price < price[i + 1]) {
+                        price[i + 1] = literal_price;
+                        from[i + 1].length = 1;
+                        from[i + 1].offset = 0;
+                }
+
+                const uint32_t match_count =
+                    _lz_matcher_find(matcher, inpos, block->end, matches);
+
+                _lz_matcher_range_insert(matcher, inpos, inpos + 1, in_size);
+
+                uint32_t match_length = LZ_MIN_LENGTH;
+
+                for (uint32_t m = 0; m < match_count; m++) {
+                        const lz_match_t * const match = &matches[m];
+
+                        /* Shorter lengths are best served by the closer
+                         * offsets found earlier in the chain */
+                        for (; match_length <= match->length; match_length++) {
+                                const uint32_t match_price = price[i] +
+                                    _lz_match_cost(match_length, match->offset);
+
+                                if (match_price < price[i + match_length]) {
+                                        price[i + match_length] = match_price;
+                                        from[i + match_length].length = match_length;
+                                        from[i + match_length].offset = match->offset;
+                                }
+                        }
+                }
+
+                /* Skip over long matches instead of pricing every position
+                 * inside of them */
+                if ((match_count > 0) &&
+                    (matches[match_count - 1].length >= LZ_NICE_LENGTH)) {
+                        const uint32_t skip = matches[match_count - 1].length;
+
+                        _lz_matcher_range_insert(matcher, inpos + 1, inpos + skip, in_size);
+
+                        i += skip - 1;
+                }
+        }
+
+        /* Walk the token chain back from the end, reversing it in place by
+         * storing the length of the next token at each token start */
+        uint32_t i = length;
+        uint32_t next_length = 0;
+        uint32_t next_offset = 0;
+
+        while (i > 0) {
+                const lz_match_t token = from[i];
+
+                from[i].length = next_length;
+                from[i].offset = next_offset;
+
+                next_length = token.length;
+                next_offset = token.offset;
+
+                i -= token.length;
+        }
+
+        from[0].length = next_length;
+        from[0].offset = next_offset;
+
+        uint32_t outpos = 0;
+
+        for (i = 0; i < length; i += from[i].length) {
+                if (from[i].length == 1) {
+                        outpos += _lz_literal_write(&block->out[outpos],
+                            in[start + i], block->marker);
+                } else {
+                        outpos += _lz_match_write(&block->out[outpos],
+                            block->marker, from[i].length, from[i].offset);
+                }
+        }
+
+        block->out_size = outpos;
+
+        free(price);
+        free(from);
+
+        return 0;
+}
+
+static int
+_lz_block_compress(lz_block_t *block, uint32_t in_size)
+{
+        lz_matcher_t *matcher;
+
+        if ((matcher = malloc(sizeof(lz_matcher_t))) == NULL) {
+                return -1;
+        }
+
+        const uint32_t base =
+            (block->start > LZ_MAX_OFFSET) ? (block->start - LZ_MAX_OFFSET) : 0;
+
+        const uint32_t chain_depth = (block->parse == LZ_PARSE_OPTIMAL)
+            ? LZ_CHAIN_DEPTH_OPTIMAL
+            : LZ_CHAIN_DEPTH_GREEDY;
+
+        if ((_lz_matcher_init(matcher, block->in, base, block->end, chain_depth)) < 0) {
+                free(matcher);
+
+                return -1;
+        }
+
+        /* Prime the hash chains with the history preceding the block */
+        _lz_matcher_range_insert(matcher, base, block->start, in_size);
+
+        int ret = 0;
+
+        if (block->parse == LZ_PARSE_OPTIMAL) {
+                ret = _lz_block_optimal_parse(block, matcher, in_size);
+        } else {
+                _lz_block_greedy_parse(block, matcher, in_size);
+        }
+
+        _lz_matcher_deinit(matcher);
+
+        free(matcher);
+
+        return ret;
+}
+
+static void *
+_lz_worker(void *arg)
+{
+        lz_job_t * const job = arg;
+
+        while (true) {
+                (void)pthread_mutex_lock(&job->mutex);
+
+                const uint32_t block_index = job->next_block++;
+
+                (void)pthread_mutex_unlock(&job->mutex);
+
+                if (block_index >= job->block_count) {
+                        break;
+                }
+
+                lz_block_t * const block = &job->blocks[block_index];
+                const uint32_t in_size = job->blocks[job->block_count - 1].end;
+
+                block->error = _lz_block_compress(block, in_size);
         }
 
+        return NULL;
+}
+
+static uint32_t
+_lz_compress(const uint8_t *in, uint8_t *out, uint32_t in_size,
+    lz_parse_t parse, uint32_t thread_count)
+{
+        uint32_t histogram[256];
+        uint8_t marker;
+        uint32_t i;
+
         /* Do we have anything to compress? */
         if (in_size < 1) {
                 return 0;
@@ -168,92 +626,89 @@ _lz_compress(uint8_t *in, uint8_t *out, uint32_t in_size, uint32_t max_offset)
         marker = 0;
 
         for (i = 1; i < 256; ++i) {
-                if (histogram[i ] < histogram[marker]) {
+                if (histogram[i] < histogram[marker]) {
                         marker = i;
                 }
         }
 
-        /* Remember the marker symbol for the decoder */
-        out[0] = marker;
+        const uint32_t block_count = (in_size + LZ_BLOCK_SIZE - 1) / LZ_BLOCK_SIZE;
 
-        /* Start of compression */
-        inpos = 0;
-        outpos = 1;
+        lz_job_t job = {
+                .blocks      = calloc(block_count, sizeof(lz_block_t)),
+                .block_count = block_count,
+                .next_block  = 0
+        };
 
-        /* Main compression loop */
-        bytesleft = in_size;
+        if (job.blocks == NULL) {
+                return 0;
+        }
 
-        do {
-                /* Determine most distant position */
-                if (inpos > max_offset) {
-                        maxoffset = max_offset;
-                } else {
-                        maxoffset = inpos;
-                }
+        for (i = 0; i < block_count; i++) {
+                lz_block_t * const block = &job.blocks[i];
+
+                block->in = in;
+                block->start = i * LZ_BLOCK_SIZE;
+                block->end = (i == (block_count - 1)) ? in_size : (block->start + LZ_BLOCK_SIZE);
+                block->marker = marker;
+                block->parse = parse;
+                block->error = -1;
 
-                /* Get pointer to current position */
-                ptr1 = &in[inpos];
+                /* A block can't grow past two bytes per input byte */
+                block->out = malloc(2 * (block->end - block->start));
 
-                /* Search history window for maximum length string match */
-                bestlength = 3;
-                bestoffset = 0;
+                if (block->out == NULL) {
+                        return 0;
+                }
+        }
 
-                for (offset = 3; offset <= maxoffset; ++offset) {
-                        /* Get pointer to candidate string */
-                        ptr2 = &ptr1[- (int) offset];
+        if (thread_count > block_count) {
+                thread_count = block_count;
+        }
 
-                        /* Quickly determine if this is a candidate (for speed) */
-                        if ((ptr1[0 ] == ptr2[0]) &&
-                                        (ptr1[bestlength ] == ptr2[bestlength])) {
-                                /* Determine maximum length for this offset */
-                                maxlength = (bytesleft < offset ? bytesleft : offset);
+        pthread_t threads[LZ_THREADS_MAX];
 
-                                /* Count maximum length match at this offset */
-                                length = _lz_string_compare(ptr1, ptr2, 0, maxlength);
+        (void)pthread_mutex_init(&job.mutex, NULL);
 
-                                /* Better match than any previous match? */
-                                if (length > bestlength) {
-                                        bestlength = length;
-                                        bestoffset = offset;
-                                }
-                        }
+        for (i = 0; i < thread_count; i++) {
+                if ((pthread_create(&threads[i], NULL, _lz_worker, &job)) != 0) {
+                        break;
                 }
+        }
 
-                /* Was there a good enough match? */
-                if ((bestlength >= 8) ||
-                    ((bestlength == 4) && (bestoffset <= 0x0000007f)) ||
-                    ((bestlength == 5) && (bestoffset <= 0x00003fff)) ||
-                    ((bestlength == 6) && (bestoffset <= 0x001fffff)) ||
-                    ((bestlength == 7) && (bestoffset <= 0x0fffffff))) {
-                        out[outpos++] = (uint8_t) marker;
-                        outpos += _lz_var_size_write(bestlength, &out[outpos]);
-                        outpos += _lz_var_size_write(bestoffset, &out[outpos]);
-                        inpos += bestlength;
-                        bytesleft -= bestlength;
-                } else {
-                        /* Output single byte (or two bytes if marker byte) */
-                        symbol = in[inpos++];
-                        out[outpos++] = symbol;
+        /* Compress whatever is left over on this thread should a thread fail
+         * to be created */
+        if (i == 0) {
+                (void)_lz_worker(&job);
+        }
 
-                        if (symbol == marker) {
-                                out[outpos++] = 0;
-                        }
+        thread_count = i;
 
-                        --bytesleft;
-                }
-        } while (bytesleft > 3);
+        for (i = 0; i < thread_count; i++) {
+                (void)pthread_join(threads[i], NULL);
+        }
 
-        /* Dump remaining bytes, if any */
-        while (inpos < in_size) {
-                if (in[inpos] == marker) {
-                        out[outpos++] = marker;
-                        out[outpos++] = 0;
-                } else {
-                        out[outpos++] = in[inpos];
+        (void)pthread_mutex_destroy(&job.mutex);
+
+        /* Remember the marker symbol for the decoder */
+        out[0] = marker;
+
+        uint32_t outpos = 1;
+
+        for (i = 0; i < block_count; i++) {
+                lz_block_t * const block = &job.blocks[i];
+
+                if (block->error != 0) {
+                        outpos = 0;
+                } else if (outpos > 0) {
+                        (void)memcpy(&out[outpos], block->out, block->out_size);
+
+                        outpos += block->out_size;
                 }
 
-                ++inpos;
+                free(block->out);
         }
 
+        free(job.blocks);
+
         return outpos;
 }
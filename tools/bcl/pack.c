@@ -0,0 +1,269 @@
+#define PROGNAME "bcl_pack"
+
+/* Minimum amount of time spent decompressing each candidate when measuring
+ * its decompression speed */
+#define PACK_TIME_MIN   (0.002)
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bcl.h>
+
+#include "shared.h"
+
+typedef enum {
+        PACK_SELECT_SMALLEST,
+        PACK_SELECT_FASTEST
+} pack_select_t;
+
+typedef struct {
+        bcl_codec_t codec;
+        const tool_codec_t *tool_codec;
+} pack_codec_t;
+
+typedef struct {
+        bcl_codec_t codec;
+        uint8_t *buffer;
+        uint32_t size;
+        double time;
+} pack_candidate_t;
+
+static int _pack_option_parse(int opt, const char *arg);
+static size_t _pack_out_size_get(size_t in_size);
+static uint32_t _pack_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count);
+
+static double _decompress_time_get(const void *in, uint8_t *out,
+    const uint8_t *container, size_t in_size);
+static double _time_get(void);
+
+static const pack_codec_t _pack_codecs[] = {
+        { BCL_CODEC_HUFFMAN, &tool_codec_huffman },
+        { BCL_CODEC_LZ,      &tool_codec_lz      },
+        { BCL_CODEC_PRS,     &tool_codec_prs     },
+        { BCL_CODEC_RLE,     &tool_codec_rle     }
+};
+
+#define PACK_CODEC_COUNT (sizeof(_pack_codecs) / sizeof(*_pack_codecs))
+
+static pack_select_t _select = PACK_SELECT_SMALLEST;
+/* Percentage the selected candidate may be larger than the smallest one */
+static uint32_t _tolerance = 0;
+
+static const tool_codec_t _codec = {
+        .progname      = PROGNAME,
+        .extension     = ".bcl",
+        .options       = "Oft:",
+        .options_usage = "  -O          Use the (slower) optimal LZ77 parse\n"
+                         "  -f          Keep the compressed result that is fastest to decompress\n"
+                         "  -t percent  Keep the result that is fastest to decompress among those\n"
+                         "              at most percent larger than the smallest one\n",
+        .option_parse  = _pack_option_parse,
+        .out_size_get  = _pack_out_size_get,
+        .compress      = _pack_compress
+};
+
+int
+main(int argc, char *argv[])
+{
+        return tool_main(argc, argv, &_codec);
+}
+
+static int
+_pack_option_parse(int opt, const char *arg)
+{
+        switch (opt) {
+        case 'O':
+                return tool_codec_lz.option_parse(opt, arg);
+        case 'f':
+                _select = PACK_SELECT_FASTEST;
+                return 0;
+        case 't':
+                _tolerance = strtoul(arg, NULL, 0);
+                return 0;
+        default:
+                return -1;
+        }
+}
+
+static size_t
+_pack_out_size_get(size_t in_size)
+{
+        /* Storing the input as-is is always an option */
+        size_t out_size = in_size;
+
+        for (uint32_t i = 0; i < PACK_CODEC_COUNT; i++) {
+                const size_t codec_out_size = _pack_codecs[i].tool_codec->out_size_get(in_size);
+
+                if (codec_out_size > out_size) {
+                        out_size = codec_out_size;
+                }
+        }
+
+        return (BCL_HEADER_SIZE + out_size);
+}
+
+/* Compress the input with every codec, decompress each result with libbcl to
+ * both verify it and measure how long it takes, then keep one of them */
+static uint32_t
+_pack_compress(const void *in, void *out, size_t in_size, uint32_t thread_count)
+{
+        pack_candidate_t candidates[PACK_CODEC_COUNT + 1];
+        uint32_t candidate_count = 0;
+
+        uint8_t * const container = out;
+        uint8_t *check_buffer;
+
+        if ((check_buffer = malloc(in_size + 1)) == NULL) {
+                return 0;
+        }
+
+        for (uint32_t i = 0; i < PACK_CODEC_COUNT; i++) {
+                const tool_codec_t * const tool_codec = _pack_codecs[i].tool_codec;
+
+                pack_candidate_t * const candidate = &candidates[candidate_count];
+
+                candidate->codec = _pack_codecs[i].codec;
+
+                if ((candidate->buffer = malloc(tool_codec->out_size_get(in_size))) == NULL) {
+                        continue;
+                }
+
+                candidate->size = tool_codec->compress(in, candidate->buffer, in_size,
+                    thread_count);
+
+                if (candidate->size == 0) {
+                        free(candidate->buffer);
+
+                        continue;
+                }
+
+                const bcl_header_t header = {
+                        .codec    = candidate->codec,
+                        .in_size  = candidate->size,
+                        .out_size = in_size
+                };
+
+                bcl_header_write(&header, container);
+                (void)memcpy(&container[BCL_HEADER_SIZE], candidate->buffer, candidate->size);
+
+                candidate->time =
+                    _decompress_time_get(in, check_buffer, container, in_size);
+
+                if (candidate->time < 0.0) {
+                        (void)fprintf(stderr, "Error: %s: %s stream failed to verify\n",
+                            PROGNAME, tool_codec->progname);
+
+                        free(candidate->buffer);
+
+                        continue;
+                }
+
+                candidate_count++;
+        }
+
+        pack_candidate_t * const none_candidate = &candidates[candidate_count];
+
+        none_candidate->codec = BCL_CODEC_NONE;
+        none_candidate->buffer = NULL;
+        none_candidate->size = in_size;
+        none_candidate->time = 0.0;
+
+        candidate_count++;
+
+        free(check_buffer);
+
+        uint32_t smallest = 0;
+
+        for (uint32_t i = 1; i < candidate_count; i++) {
+                if (candidates[i].size < candidates[smallest].size) {
+                        smallest = i;
+                }
+        }
+
+        /* Candidates no larger than max_size are considered when picking by
+         * decompression speed */
+        uint64_t max_size;
+
+        if (_select == PACK_SELECT_FASTEST) {
+                max_size = (in_size > 0) ? (in_size - 1) : 0;
+        } else {
+                max_size = candidates[smallest].size +
+                    (((uint64_t)candidates[smallest].size * _tolerance) / 100);
+        }
+
+        uint32_t selected = smallest;
+
+        for (uint32_t i = 0; i < candidate_count; i++) {
+                if ((candidates[i].size <= max_size) &&
+                    (candidates[i].time < candidates[selected].time)) {
+                        selected = i;
+                }
+        }
+
+        const pack_candidate_t * const candidate = &candidates[selected];
+
+        const bcl_header_t header = {
+                .codec    = candidate->codec,
+                .in_size  = candidate->size,
+                .out_size = in_size,
+                .checksum = bcl_checksum(in, in_size)
+        };
+
+        bcl_header_write(&header, container);
+
+        if (candidate->codec == BCL_CODEC_NONE) {
+                (void)memcpy(&container[BCL_HEADER_SIZE], in, in_size);
+        } else {
+                (void)memcpy(&container[BCL_HEADER_SIZE], candidate->buffer, candidate->size);
+        }
+
+        for (uint32_t i = 0; i < candidate_count; i++) {
+                free(candidates[i].buffer);
+        }
+
+        return (BCL_HEADER_SIZE + candidate->size);
+}
+
+/* Returns the time in seconds taken to decompress the container once, or a
+ * negative value if the output doesn't match the input */
+static double
+_decompress_time_get(const void *in, uint8_t *out, const uint8_t *container,
+    size_t in_size)
+{
+        uint32_t iterations = 0;
+        double time = 0.0;
+
+        const double time_start = _time_get();
+
+        do {
+                if ((bcl_decompress(container, out, in_size)) != (int32_t)in_size) {
+                        return -1.0;
+                }
+
+                iterations++;
+
+                time = _time_get() - time_start;
+        } while (time < PACK_TIME_MIN);
+
+        if ((memcmp(out, in, in_size)) != 0) {
+                return -1.0;
+        }
+
+        return (time / iterations);
+}
+
+static double
+_time_get(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
@@ -24,62 +24,40 @@ typedef struct {
 
 static uint32_t _prs_compress(void *in, void *dest, uint32_t size);
 
+static size_t _prs_out_size_get(size_t in_size);
+static uint32_t _prs_tool_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count);
+
+const tool_codec_t tool_codec_prs = {
+        .progname     = PROGNAME,
+        .extension    = ".prs",
+        .out_size_get = _prs_out_size_get,
+        .compress     = _prs_tool_compress
+};
+
+#ifndef TOOL_CODEC_ONLY
 int
 main(int argc, char *argv[])
 {
-        if (argc != 3) {
-                print_usage(PROGNAME);
-
-                return 0;
-        }
-
-        const char *const in_filename = argv[1];
-        const char *const out_filename = argv[2];
-
-        input_file_t input_file;
-
-        if ((input_file_open(in_filename, &input_file)) != 0) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
-
-        /* Allocate a buffer of equal to twice the size since we don't know how
-         * big the out file size will be */
-        void *out_buffer;
-
-        /* According to the original sources, the output buffer must be 0.4%
-         * larger plus 1 byte */
-        size_t out_size = (size_t)floor(1.004f * (float)input_file.buffer_len) + 1;
-
-        if ((out_buffer = malloc(out_size)) == NULL) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
-
-        const uint32_t out_file_size =
-                _prs_compress(input_file.buffer, out_buffer, input_file.buffer_len);
-
-        (void)printf("%zu -> %"PRIu32"\n", input_file.buffer_len, out_file_size);
-
-        if (out_file_size == 0) {
-                fprintf(stderr, "Error: %s: RLE compression failed\n", PROGNAME);
-
-                return 1;
-        }
-
-        if ((output_file_write(out_filename, out_buffer, out_file_size)) != 0) {
-                print_errno(PROGNAME);
-
-                return 1;
-        }
+        return tool_main(argc, argv, &tool_codec_prs);
+}
+#endif /* !TOOL_CODEC_ONLY */
 
-        input_file_close(&input_file);
+/* Every literal costs a control bit on top of its byte, and the stream ends
+ * with a 2-byte end marker plus its control bits */
+static size_t
+_prs_out_size_get(size_t in_size)
+{
+        return in_size + (in_size / 8) + 4;
+}
 
-        free(out_buffer);
+static uint32_t
+_prs_tool_compress(const void *in, void *out, size_t in_size,
+    uint32_t thread_count)
+{
+        (void)thread_count;
 
-        return 0;
+        return _prs_compress((void *)in, out, in_size);
 }
 
 static void
@@ -144,8 +122,10 @@ _prs_init(prs_compressor_t *pc, void *src, void *dst)
 static void
 _prs_finish(prs_compressor_t *pc)
 {
+        /* Don't reserve a new control byte once the last one is full, as it
+         * would end up between the final control bits and the end marker */
         _prs_put_control_bit(pc, 0);
-        _prs_put_control_bit(pc, 1);
+        _prs_put_control_bit_nosave(pc, 1);
 
         if (pc->bit_pos != 0) {
                 *pc->control_byte_ptr = ((*pc->control_byte_ptr << pc->bit_pos) >> 8);
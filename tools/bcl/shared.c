@@ -1,12 +1,17 @@
 #include <sys/stat.h>
 
 #include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "batch.h"
 #include "shared.h"
 
+#define VARIANT_SIZE 256
+
 int
 input_file_open(const char *file_name, input_file_t *input_file)
 {
@@ -79,7 +84,14 @@ _error:
 void
 print_usage(const char *progname)
 {
-        (void)fprintf(stderr, "Usage: %s [in-file] [out-file]\n", progname);
+        (void)fprintf(stderr, "Usage: %s [options] [in-file] [out-file]\n", progname);
+        (void)fprintf(stderr, "       %s [options] -b manifest|directory\n", progname);
+        (void)fprintf(stderr, "  -b path     Compress every file listed in a manifest, or found under a\n"
+                              "              directory. Manifest lines are \"in-file [out-file]\"\n");
+        (void)fprintf(stderr, "  -o out-dir  Write batch output under out-dir instead of next to the input\n");
+        (void)fprintf(stderr, "  -c cache    Content hash cache used to skip unchanged input in batch mode.\n"
+                              "              Defaults to a hidden file in out-dir, or next to the input\n");
+        (void)fprintf(stderr, "  -j jobs     Number of files (batch mode) or threads compressed in parallel\n");
 }
 
 void
@@ -89,3 +101,136 @@ print_errno(const char *progname)
 
         (void)fprintf(stderr, "Error: %s: %s\n", progname, errno_string);
 }
+
+static void
+_tool_usage_print(const tool_codec_t *codec)
+{
+        print_usage(codec->progname);
+
+        if (codec->options_usage != NULL) {
+                (void)fprintf(stderr, "%s", codec->options_usage);
+        }
+}
+
+int
+tool_main(int argc, char *argv[], const tool_codec_t *codec)
+{
+        char optstring[64];
+        char variant[VARIANT_SIZE];
+
+        const char * const codec_options = (codec->options != NULL) ? codec->options : "";
+
+        (void)snprintf(optstring, sizeof(optstring), "b:c:j:o:%s", codec_options);
+
+        variant[0] = '\0';
+
+        long job_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+        batch_options_t batch_options = {
+                .path           = NULL,
+                .out_dir        = NULL,
+                .cache_filename = NULL,
+                .variant        = variant
+        };
+
+        int opt;
+
+        while ((opt = getopt(argc, argv, optstring)) != -1) {
+                switch (opt) {
+                case 'b':
+                        batch_options.path = optarg;
+                        break;
+                case 'c':
+                        batch_options.cache_filename = optarg;
+                        break;
+                case 'j':
+                        job_count = strtol(optarg, NULL, 0);
+                        break;
+                case 'o':
+                        batch_options.out_dir = optarg;
+                        break;
+                case '?':
+                        _tool_usage_print(codec);
+
+                        return 1;
+                default:
+                        if ((codec->option_parse(opt, optarg)) != 0) {
+                                _tool_usage_print(codec);
+
+                                return 1;
+                        }
+
+                        /* Options that change the output are part of the
+                         * cache key */
+                        const size_t len = strlen(variant);
+
+                        (void)snprintf(&variant[len], sizeof(variant) - len, "-%c%s",
+                            opt, (optarg != NULL) ? optarg : "");
+                        break;
+                }
+        }
+
+        if (job_count < 1) {
+                job_count = 1;
+        }
+
+        batch_options.job_count = job_count;
+
+        if (batch_options.path != NULL) {
+                if (optind != argc) {
+                        _tool_usage_print(codec);
+
+                        return 1;
+                }
+
+                return batch_run(codec, &batch_options);
+        }
+
+        if ((argc - optind) != 2) {
+                _tool_usage_print(codec);
+
+                return 0;
+        }
+
+        const char * const in_filename = argv[optind];
+        const char * const out_filename = argv[optind + 1];
+
+        input_file_t input_file;
+
+        if ((input_file_open(in_filename, &input_file)) != 0) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        void *out_buffer;
+
+        if ((out_buffer = malloc(codec->out_size_get(input_file.buffer_len))) == NULL) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        const uint32_t out_file_size = codec->compress(input_file.buffer,
+            out_buffer, input_file.buffer_len, job_count);
+
+        (void)printf("%zu -> %"PRIu32"\n", input_file.buffer_len, out_file_size);
+
+        if (out_file_size == 0) {
+                (void)fprintf(stderr, "Error: %s: Compression failed\n", codec->progname);
+
+                return 1;
+        }
+
+        if ((output_file_write(out_filename, out_buffer, out_file_size)) != 0) {
+                print_errno(codec->progname);
+
+                return 1;
+        }
+
+        input_file_close(&input_file);
+
+        free(out_buffer);
+
+        return 0;
+}
@@ -2,12 +2,33 @@
 #define SHARED_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct input_file {
         void * const buffer;
         size_t buffer_len;
 } input_file_t;
 
+typedef struct tool_codec {
+        const char *progname;
+        /* Extension appended to output file names in batch mode */
+        const char *extension;
+        /* Codec specific options in getopt(3) format, and their usage */
+        const char *options;
+        const char *options_usage;
+        int (*option_parse)(int opt, const char *arg);
+        /* Worst case size of the compressed data */
+        size_t (*out_size_get)(size_t in_size);
+        /* Returns the compressed size, or 0 on failure */
+        uint32_t (*compress)(const void *in, void *out, size_t in_size,
+            uint32_t thread_count);
+} tool_codec_t;
+
+extern const tool_codec_t tool_codec_huffman;
+extern const tool_codec_t tool_codec_lz;
+extern const tool_codec_t tool_codec_prs;
+extern const tool_codec_t tool_codec_rle;
+
 int input_file_open(const char *file_name, input_file_t *input_file);
 void input_file_close(input_file_t *input_file);
 
@@ -16,4 +37,6 @@ int output_file_write(const char *filename, void *buffer, size_t len);
 void print_usage(const char *progname);
 void print_errno(const char *progname);
 
+int tool_main(int argc, char *argv[], const tool_codec_t *codec);
+
 #endif /* !SHARED_H */
@@ -0,0 +1,539 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* A simulated CD-block. It stands in for the CD-block commands, the HIRQ
+ * register, the CD-block interrupt and the SCU-DMA transfer from the data
+ * transfer register, and checks that they're used the way the hardware
+ * allows */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cd-block.h>
+
+#include <cpu/cache.h>
+#include <cpu/intc.h>
+
+#include <scu/dma.h>
+#include <scu/ic.h>
+
+#include "cd-block-internal.h"
+
+#include "cd_block_model.h"
+
+/* Sectors the CD-block buffer holds */
+#define BUFFER_SECTOR_COUNT     (200)
+
+/* Interrupt levels the handlers run at */
+#define DMA_END_LEVEL           (5)
+#define CD_BLOCK_LEVEL          (7)
+
+uint16_t __host_cd_block_regs[CD_BLOCK_REGS_SIZE / 2];
+uint32_t __host_scu_regs[SCU_REGS_SIZE / 4];
+
+static struct {
+        cd_block_model_cfg_t cfg;
+        cd_block_model_stats_t stats;
+
+        uint32_t call_counts[CD_BLOCK_MODEL_COMMAND_COUNT];
+
+        /* Sectors being played, and the ticks left until they start to reach
+         * the buffer */
+        fad_t play_fad;
+        uint32_t play_count;
+        uint32_t seek_ticks;
+
+        /* Sectors in the buffer */
+        fad_t buffer_fad;
+        uint32_t buffer_count;
+
+        /* Sectors asked for by Get Then Delete Sector Data */
+        bool transfer_requested;
+        fad_t transfer_fad;
+        uint32_t transfer_count;
+        uint32_t drdy_ticks;
+
+        /* SCU-DMA transfer */
+        scu_dma_level_cfg_t dma_cfg;
+        scu_dma_callback_t dma_callback;
+        void *dma_work;
+        bool dma_started;
+        bool dma_done;
+
+        /* Area purged from the cache by the end callback */
+        void *purge_address;
+        uint32_t purge_len;
+
+        /* CPU interrupt level, SCU interrupt mask, and the CD-block interrupt
+         * handler */
+        uint8_t cpu_mask;
+        uint32_t scu_mask;
+        scu_ic_ihr_t cd_block_ihr;
+} _model;
+
+static void _dma_end(void);
+static void _cd_block_interrupt(void);
+static bool _command_fail(cd_block_model_command_t command, int *ret);
+static void _violation(const char *message);
+
+static inline uint16_t
+_hirq_get(void)
+{
+        return __host_cd_block_regs[HIRQ / 2];
+}
+
+static inline void
+_hirq_set(uint16_t hirq)
+{
+        __host_cd_block_regs[HIRQ / 2] = hirq;
+}
+
+void
+cd_block_model_reset(const cd_block_model_cfg_t *cfg)
+{
+        (void)memset(&_model, 0, sizeof(_model));
+        (void)memset(__host_cd_block_regs, 0, sizeof(__host_cd_block_regs));
+
+        (void)memset(__host_scu_regs, 0, sizeof(__host_scu_regs));
+
+        _model.cfg = *cfg;
+        _model.scu_mask = SCU_IC_MASK_ALL;
+
+        _hirq_set(CMOK);
+
+        __host_scu_regs[AIACK / 4] = 0x00000001;
+}
+
+void
+cd_block_model_tick(void)
+{
+        if (_model.cpu_mask != 0) {
+                _violation("Interrupts were left disabled");
+
+                _model.cpu_mask = 0;
+        }
+
+        if (_model.play_count > 0) {
+                if (_model.seek_ticks > 0) {
+                        _model.seek_ticks--;
+                } else {
+                        uint32_t count = _model.cfg.sectors_per_tick;
+
+                        if (count > _model.play_count) {
+                                count = _model.play_count;
+                        }
+
+                        /* Playing pauses while the buffer is full */
+                        if (count > (BUFFER_SECTOR_COUNT - _model.buffer_count)) {
+                                count = BUFFER_SECTOR_COUNT - _model.buffer_count;
+                        }
+
+                        _model.buffer_count += count;
+                        _model.play_fad += count;
+                        _model.play_count -= count;
+
+                        if (count > 0) {
+                                _hirq_set(_hirq_get() | CSCT);
+                        }
+                }
+        }
+
+        if (_model.transfer_requested && ((_hirq_get() & DRDY) == 0x0000)) {
+                if (_model.drdy_ticks > 0) {
+                        _model.drdy_ticks--;
+                }
+
+                if (_model.drdy_ticks == 0) {
+                        _hirq_set(_hirq_get() | DRDY);
+                }
+        }
+
+        if (_model.dma_started) {
+                _dma_end();
+        }
+
+        _cd_block_interrupt();
+}
+
+void
+cd_block_model_stats_get(cd_block_model_stats_t *stats)
+{
+        *stats = _model.stats;
+}
+
+void
+cd_block_model_sector_fill(fad_t fad, void *buffer)
+{
+        uint32_t * const words = buffer;
+
+        for (uint32_t i = 0; i < (CDFS_SECTOR_SIZE / sizeof(uint32_t)); i++) {
+                words[i] = (fad << 12) ^ i;
+        }
+}
+
+/* End the started SCU-DMA transfer, and call its end callback as the SCU-DMA
+ * end interrupt would */
+static void
+_dma_end(void)
+{
+        const scu_dma_level_cfg_t * const dma_cfg = &_model.dma_cfg;
+
+        _model.dma_started = false;
+
+        if ((dma_cfg->xfer.direct.src != CD_BLOCK(DTR)) ||
+            (dma_cfg->update != SCU_DMA_UPDATE_NONE) ||
+            (dma_cfg->space != SCU_DMA_SPACE_BUS_A) ||
+            (dma_cfg->stride != SCU_DMA_STRIDE_2_BYTES) ||
+            (dma_cfg->mode != SCU_DMA_MODE_DIRECT)) {
+                _violation("SCU-DMA isn't set up to read the data transfer register");
+
+                return;
+        }
+
+        if (dma_cfg->xfer.direct.len != (_model.transfer_count * CDFS_SECTOR_SIZE)) {
+                _violation("SCU-DMA length isn't the sectors asked for");
+
+                return;
+        }
+
+        uint8_t * const dst = _model.dma_work;
+
+        for (uint32_t i = 0; i < _model.transfer_count; i++) {
+                cd_block_model_sector_fill(_model.transfer_fad + i,
+                    &dst[i * CDFS_SECTOR_SIZE]);
+        }
+
+        _model.stats.transfer_count++;
+
+        if (_model.transfer_count > _model.stats.transfer_sector_max) {
+                _model.stats.transfer_sector_max = _model.transfer_count;
+        }
+
+        _model.dma_done = true;
+
+        _model.purge_address = NULL;
+        _model.purge_len = 0;
+
+        /* The transfer length is checked before the callback, as the
+         * callback may start the next transfer */
+        const uint32_t len = dma_cfg->xfer.direct.len;
+
+        if (_model.dma_callback != NULL) {
+                _model.cpu_mask = DMA_END_LEVEL;
+
+                _model.dma_callback(_model.dma_work);
+
+                if (_model.cpu_mask != DMA_END_LEVEL) {
+                        _violation("SCU-DMA end handler changed the interrupt level");
+                }
+
+                _model.cpu_mask = 0;
+        }
+
+        if ((_model.purge_address != dst) || (_model.purge_len < len)) {
+                _violation("Transferred area isn't purged from the cache");
+        }
+}
+
+/* The CD-block interrupts while any of the HIRQ bits enabled in the HIRQ mask
+ * are set. Once taken, the A-Bus interrupt isn't taken again until it's
+ * acknowledged */
+static void
+_cd_block_interrupt(void)
+{
+        const uint16_t hirq_mask = __host_cd_block_regs[HIRQ_MASK / 2];
+
+        if ((_hirq_get() & hirq_mask) == 0x0000) {
+                return;
+        }
+
+        if ((_model.scu_mask & SCU_IC_MASK_A_BUS) != 0x00000000) {
+                return;
+        }
+
+        if (__host_scu_regs[AIACK / 4] == 0x00000000) {
+                return;
+        }
+
+        if (_model.cd_block_ihr == NULL) {
+                _violation("CD-block interrupt has no handler");
+
+                return;
+        }
+
+        __host_scu_regs[AIACK / 4] = 0x00000000;
+
+        _model.stats.interrupt_count++;
+        _model.cpu_mask = CD_BLOCK_LEVEL;
+
+        _model.cd_block_ihr();
+
+        if (_model.cpu_mask != CD_BLOCK_LEVEL) {
+                _violation("CD-block interrupt handler changed the interrupt level");
+        }
+
+        _model.cpu_mask = 0;
+}
+
+int
+cd_block_cmd_sector_length_set(uint8_t size)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_SECTOR_LENGTH_SET, &ret)) {
+                return ret;
+        }
+
+        if (size != SECTOR_LENGTH_2048) {
+                _violation("Sector length isn't 2048 bytes");
+        }
+
+        return 0;
+}
+
+int
+cd_block_cmd_selector_reset(uint8_t flags, uint8_t sel_num)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_SELECTOR_RESET, &ret)) {
+                return ret;
+        }
+
+        if ((flags != 0) || (sel_num != 0)) {
+                _violation("Unexpected selector reset");
+        }
+
+        /* Empty the buffer, and drop any sectors asked for */
+        _model.buffer_count = 0;
+        _model.transfer_requested = false;
+
+        _hirq_set(_hirq_get() & ~DRDY);
+
+        return 0;
+}
+
+int
+cd_block_cmd_cd_dev_connection_set(uint8_t filter)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_CD_DEV_CONNECTION_SET, &ret)) {
+                return ret;
+        }
+
+        if (filter != 0) {
+                _violation("CD device isn't connected to filter 0");
+        }
+
+        return 0;
+}
+
+int
+cd_block_cmd_disk_play(int32_t mode, fad_t start_fad, int32_t num_sectors)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_DISK_PLAY, &ret)) {
+                return ret;
+        }
+
+        if ((mode != 0) || (start_fad < 150) || (num_sectors <= 0)) {
+                _violation("Invalid play range");
+
+                return -1;
+        }
+
+        _model.play_fad = start_fad;
+        _model.play_count = num_sectors;
+        _model.seek_ticks = _model.cfg.seek_ticks;
+
+        _model.buffer_fad = start_fad;
+        _model.buffer_count = 0;
+
+        return 0;
+}
+
+int
+cd_block_cmd_sector_number_get(uint8_t buffer_number)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_SECTOR_NUMBER_GET, &ret)) {
+                return ret;
+        }
+
+        if (buffer_number != 0) {
+                _violation("Unexpected buffer partition");
+        }
+
+        return _model.buffer_count;
+}
+
+int
+cd_block_cmd_sector_data_get_delete(uint16_t offset, uint8_t buffer_number,
+    uint16_t sec_number)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_SECTOR_DATA_GET_DELETE, &ret)) {
+                return ret;
+        }
+
+        if (_model.transfer_requested) {
+                _violation("Sectors asked for before the last transfer ended");
+
+                return -1;
+        }
+
+        if ((offset != 0) || (buffer_number != 0) || (sec_number == 0) ||
+            (sec_number > _model.buffer_count)) {
+                _violation("Asked for sectors that aren't in the buffer");
+
+                return -1;
+        }
+
+        _model.transfer_requested = true;
+        _model.transfer_fad = _model.buffer_fad;
+        _model.transfer_count = sec_number;
+        _model.drdy_ticks = _model.cfg.drdy_ticks;
+
+        _model.buffer_fad += sec_number;
+        _model.buffer_count -= sec_number;
+
+        _model.dma_done = false;
+
+        if (_model.drdy_ticks == 0) {
+                _hirq_set(_hirq_get() | DRDY);
+        }
+
+        return 0;
+}
+
+int
+cd_block_cmd_data_transfer_end(void)
+{
+        int ret;
+
+        if (_command_fail(CD_BLOCK_MODEL_COMMAND_DATA_TRANSFER_END, &ret)) {
+                return ret;
+        }
+
+        if (!_model.transfer_requested || !_model.dma_done) {
+                _violation("Transfer ended before the SCU-DMA transfer");
+        }
+
+        _model.transfer_requested = false;
+
+        _hirq_set((_hirq_get() & ~DRDY) | CMOK);
+
+        return 0;
+}
+
+void
+scu_dma_config_buffer(scu_dma_handle_t *handle, const scu_dma_level_cfg_t *cfg)
+{
+        handle->cfg = *cfg;
+}
+
+void
+scu_dma_config_set(scu_dma_level_t level,
+    scu_dma_start_factor_t start_factor, const scu_dma_handle_t *handle,
+    scu_dma_callback_t callback)
+{
+        if ((level < 0) || (level > 2) ||
+            (start_factor != SCU_DMA_START_FACTOR_ENABLE)) {
+                _violation("Invalid SCU-DMA level set up");
+        }
+
+        _model.dma_cfg = handle->cfg;
+        _model.dma_callback = callback;
+        _model.dma_work = NULL;
+}
+
+void
+scu_dma_level_end_set(scu_dma_level_t level __unused,
+    scu_dma_callback_t callback, void *work)
+{
+        _model.dma_callback = callback;
+        _model.dma_work = work;
+}
+
+void
+scu_dma_level_fast_start(scu_dma_level_t level __unused)
+{
+        if ((_hirq_get() & DRDY) == 0x0000) {
+                _violation("SCU-DMA started before DRDY");
+        }
+
+        if (_model.dma_started) {
+                _violation("SCU-DMA started twice");
+        }
+
+        _model.dma_started = true;
+}
+
+void
+cpu_cache_area_purge(void *address, uint32_t len)
+{
+        _model.purge_address = address;
+        _model.purge_len = len;
+}
+
+uint8_t
+cpu_intc_mask_get(void)
+{
+        return _model.cpu_mask;
+}
+
+void
+cpu_intc_mask_set(uint8_t mask)
+{
+        _model.cpu_mask = mask;
+}
+
+void
+scu_ic_ihr_set(scu_ic_interrupt_t vector, scu_ic_ihr_t ihr)
+{
+        if (vector != SCU_IC_INTERRUPT_CD_BLOCK) {
+                _violation("Unexpected interrupt handler set");
+
+                return;
+        }
+
+        _model.cd_block_ihr = ihr;
+}
+
+void
+scu_ic_mask_chg(scu_ic_mask_t and_mask, scu_ic_mask_t or_mask)
+{
+        _model.scu_mask = (_model.scu_mask & and_mask) | or_mask;
+}
+
+static bool
+_command_fail(cd_block_model_command_t command, int *ret)
+{
+        _model.call_counts[command]++;
+
+        if ((_model.cfg.fail_command != command) ||
+            (_model.cfg.fail_call != _model.call_counts[command])) {
+                return false;
+        }
+
+        *ret = _model.cfg.fail_ret;
+
+        return true;
+}
+
+static void
+_violation(const char *message)
+{
+        (void)fprintf(stderr, "Error: cd_block_model: %s\n", message);
+
+        _model.stats.violation_count++;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _CD_BLOCK_READ_TEST_CD_BLOCK_MODEL_H_
+#define _CD_BLOCK_READ_TEST_CD_BLOCK_MODEL_H_
+
+#include <stdint.h>
+
+#include <cd-block.h>
+
+typedef enum {
+        CD_BLOCK_MODEL_COMMAND_NONE,
+        CD_BLOCK_MODEL_COMMAND_SECTOR_LENGTH_SET,
+        CD_BLOCK_MODEL_COMMAND_SELECTOR_RESET,
+        CD_BLOCK_MODEL_COMMAND_CD_DEV_CONNECTION_SET,
+        CD_BLOCK_MODEL_COMMAND_DISK_PLAY,
+        CD_BLOCK_MODEL_COMMAND_SECTOR_NUMBER_GET,
+        CD_BLOCK_MODEL_COMMAND_SECTOR_DATA_GET_DELETE,
+        CD_BLOCK_MODEL_COMMAND_DATA_TRANSFER_END,
+        CD_BLOCK_MODEL_COMMAND_COUNT
+} cd_block_model_command_t;
+
+typedef struct {
+        /* Ticks before the first played sector reaches the buffer */
+        uint32_t seek_ticks;
+        /* Sectors that reach the buffer each tick */
+        uint32_t sectors_per_tick;
+        /* Ticks between asking for sectors and DRDY being set */
+        uint32_t drdy_ticks;
+
+        /* The command that fails, which of its calls fails (starting at 1),
+         * and the value it returns */
+        cd_block_model_command_t fail_command;
+        uint32_t fail_call;
+        int fail_ret;
+} cd_block_model_cfg_t;
+
+typedef struct {
+        /* SCU-DMA transfers made, and the most sectors in one of them */
+        uint32_t transfer_count;
+        uint32_t transfer_sector_max;
+        /* CD-block interrupts taken */
+        uint32_t interrupt_count;
+        /* Uses of the CD-block that the hardware wouldn't allow */
+        uint32_t violation_count;
+} cd_block_model_stats_t;
+
+extern void cd_block_model_reset(const cd_block_model_cfg_t *cfg);
+
+/* Moves the simulated CD-block along by one tick, e.g. one frame. Ends any
+ * started SCU-DMA transfer, calling its end callback, then takes the CD-block
+ * interrupt if it's raised */
+extern void cd_block_model_tick(void);
+
+extern void cd_block_model_stats_get(cd_block_model_stats_t *stats);
+
+/* Fills the buffer with what the simulated disc holds at the FAD */
+extern void cd_block_model_sector_fill(fad_t fad, void *buffer);
+
+#endif /* !_CD_BLOCK_READ_TEST_CD_BLOCK_MODEL_H_ */
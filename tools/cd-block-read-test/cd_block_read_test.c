@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "cd_block_read_test"
+
+/* Ticks before a read is considered stalled */
+#define TEST_TICK_COUNT_MAX     (10000)
+
+#define TEST_READ_COUNT_MAX     (3)
+#define TEST_SECTOR_COUNT_MAX   (32)
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cd-block.h>
+
+#include "cd_block_model.h"
+
+typedef struct {
+        const char *name;
+        scu_dma_level_t dma_level;
+        /* Reads are moved along by interrupts alone, unless also polled */
+        bool poll;
+        cd_block_model_cfg_t cfg;
+        uint32_t read_count;
+        uint32_t sector_counts[TEST_READ_COUNT_MAX];
+        /* Status each read is expected to end with */
+        cd_block_read_status_t statuses[TEST_READ_COUNT_MAX];
+} test_t;
+
+static const test_t _tests[] = {
+        {
+                .name = "One read",
+                .dma_level = 0,
+                .cfg = {
+                        .seek_ticks = 3,
+                        .sectors_per_tick = 4,
+                        .drdy_ticks = 1
+                },
+                .read_count = 1,
+                .sector_counts = { 20 },
+                .statuses = { CD_BLOCK_READ_STATUS_DONE }
+        }, {
+                .name = "4KiB transfers",
+                .dma_level = 1,
+                .cfg = {
+                        .seek_ticks = 0,
+                        .sectors_per_tick = 5,
+                        .drdy_ticks = 0
+                },
+                .read_count = 1,
+                .sector_counts = { 9 },
+                .statuses = { CD_BLOCK_READ_STATUS_DONE }
+        }, {
+                .name = "Queued reads",
+                .dma_level = 2,
+                .cfg = {
+                        .seek_ticks = 2,
+                        .sectors_per_tick = 3,
+                        .drdy_ticks = 2
+                },
+                .read_count = 3,
+                .sector_counts = { 1, 7, 16 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_DONE,
+                        CD_BLOCK_READ_STATUS_DONE,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }, {
+                .name = "Polled reads",
+                .dma_level = 2,
+                .poll = true,
+                .cfg = {
+                        .seek_ticks = 2,
+                        .sectors_per_tick = 3,
+                        .drdy_ticks = 2
+                },
+                .read_count = 3,
+                .sector_counts = { 1, 7, 16 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_DONE,
+                        CD_BLOCK_READ_STATUS_DONE,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }, {
+                .name = "Slow seek",
+                .dma_level = 0,
+                .cfg = {
+                        .seek_ticks = 200,
+                        .sectors_per_tick = 1,
+                        .drdy_ticks = 3
+                },
+                .read_count = 1,
+                .sector_counts = { TEST_SECTOR_COUNT_MAX },
+                .statuses = { CD_BLOCK_READ_STATUS_DONE }
+        }, {
+                .name = "Sector count error",
+                .dma_level = 0,
+                .cfg = {
+                        .seek_ticks = 1,
+                        .sectors_per_tick = 2,
+                        .drdy_ticks = 1,
+                        .fail_command = CD_BLOCK_MODEL_COMMAND_SECTOR_NUMBER_GET,
+                        .fail_call = 4,
+                        .fail_ret = -1
+                },
+                .read_count = 2,
+                .sector_counts = { 8, 8 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_ERROR,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }, {
+                .name = "Play error",
+                .dma_level = 0,
+                .cfg = {
+                        .seek_ticks = 1,
+                        .sectors_per_tick = 2,
+                        .drdy_ticks = 1,
+                        .fail_command = CD_BLOCK_MODEL_COMMAND_DISK_PLAY,
+                        .fail_call = 1,
+                        .fail_ret = -1
+                },
+                .read_count = 2,
+                .sector_counts = { 4, 4 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_ERROR,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }, {
+                .name = "Sector data error",
+                .dma_level = 1,
+                .cfg = {
+                        .seek_ticks = 1,
+                        .sectors_per_tick = 2,
+                        .drdy_ticks = 1,
+                        .fail_command = CD_BLOCK_MODEL_COMMAND_SECTOR_DATA_GET_DELETE,
+                        .fail_call = 2,
+                        .fail_ret = -1
+                },
+                .read_count = 2,
+                .sector_counts = { 6, 6 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_ERROR,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }, {
+                .name = "Transfer end error",
+                .dma_level = 0,
+                .cfg = {
+                        .seek_ticks = 1,
+                        .sectors_per_tick = 2,
+                        .drdy_ticks = 1,
+                        .fail_command = CD_BLOCK_MODEL_COMMAND_DATA_TRANSFER_END,
+                        .fail_call = 2,
+                        .fail_ret = -1
+                },
+                .read_count = 2,
+                .sector_counts = { 10, 3 },
+                .statuses = {
+                        CD_BLOCK_READ_STATUS_ERROR,
+                        CD_BLOCK_READ_STATUS_DONE
+                }
+        }
+};
+
+#define TEST_COUNT (sizeof(_tests) / sizeof(*_tests))
+
+static uint8_t _buffers[TEST_READ_COUNT_MAX][TEST_SECTOR_COUNT_MAX * CDFS_SECTOR_SIZE]
+    __attribute__ ((aligned(4)));
+static uint8_t _sector[CDFS_SECTOR_SIZE] __attribute__ ((aligned(4)));
+
+static cd_block_read_t _reads[TEST_READ_COUNT_MAX];
+
+/* Reads in the order their callbacks were called */
+static cd_block_read_t *_callback_reads[TEST_READ_COUNT_MAX + 1];
+static uint32_t _callback_count;
+
+static uint32_t _error_count;
+
+static bool _test_run(const test_t *test, uint32_t *tick_count);
+static void _read_callback(cd_block_read_t *read);
+static void _error_print(const test_t *test, const char *message);
+
+int
+main(int argc, char *argv[] __unused)
+{
+        if (argc != 1) {
+                (void)fprintf(stderr, "Usage: %s\n", PROGNAME);
+                (void)fprintf(stderr, "Run the asynchronous CD-block read pipeline against a simulated\n"
+                                      "CD-block\n");
+
+                return 1;
+        }
+
+        (void)printf("Test                  Ticks  Result\n");
+
+        for (uint32_t i = 0; i < TEST_COUNT; i++) {
+                const test_t * const test = &_tests[i];
+
+                uint32_t tick_count;
+
+                const bool passed = _test_run(test, &tick_count);
+
+                (void)printf("%-20s %6" PRIu32 "  %s\n", test->name, tick_count,
+                    (passed ? "Pass" : "Fail"));
+        }
+
+        if (_error_count > 0) {
+                (void)fprintf(stderr, "\n%" PRIu32 " errors\n", _error_count);
+
+                return 1;
+        }
+
+        return 0;
+}
+
+static bool
+_test_run(const test_t *test, uint32_t *tick_count)
+{
+        const uint32_t error_count = _error_count;
+
+        cd_block_model_reset(&test->cfg);
+        cd_block_read_init(test->dma_level);
+
+        (void)memset(_buffers, 0, sizeof(_buffers));
+        (void)memset(_callback_reads, 0, sizeof(_callback_reads));
+
+        _callback_count = 0;
+
+        for (uint32_t i = 0; i < test->read_count; i++) {
+                cd_block_read_t * const read = &_reads[i];
+
+                read->fad = 150 + (i * 1000);
+                read->sector_count = test->sector_counts[i];
+                read->buffer = _buffers[i];
+                read->callback = _read_callback;
+                read->work = NULL;
+
+                /* A read starts right away, unless another is being read */
+                const bool busy = cd_block_read_busy();
+
+                cd_block_read_submit(read);
+
+                if (busy && (read->status != CD_BLOCK_READ_STATUS_QUEUED)) {
+                        _error_print(test, "Read submitted behind another isn't queued");
+                }
+
+                if (!busy && (read->status == CD_BLOCK_READ_STATUS_QUEUED)) {
+                        _error_print(test, "Read submitted while idle didn't start");
+                }
+        }
+
+        *tick_count = 0;
+
+        while (cd_block_read_busy()) {
+                if (*tick_count == TEST_TICK_COUNT_MAX) {
+                        _error_print(test, "Read stalled");
+
+                        return false;
+                }
+
+                if (test->poll) {
+                        cd_block_read_poll();
+                }
+
+                cd_block_model_tick();
+
+                (*tick_count)++;
+        }
+
+        if (_callback_count != test->read_count) {
+                _error_print(test, "Callbacks weren't called once for each read");
+        }
+
+        for (uint32_t i = 0; i < test->read_count; i++) {
+                const cd_block_read_t * const read = &_reads[i];
+
+                if (_callback_reads[i] != read) {
+                        _error_print(test, "Reads didn't end in the order submitted");
+                }
+
+                if (read->status != test->statuses[i]) {
+                        _error_print(test, "Read ended with the wrong status");
+
+                        continue;
+                }
+
+                if (read->status != CD_BLOCK_READ_STATUS_DONE) {
+                        continue;
+                }
+
+                if (read->sector_read_count != read->sector_count) {
+                        _error_print(test, "Read didn't read every sector");
+                }
+
+                const uint8_t * const buffer = read->buffer;
+
+                for (uint32_t j = 0; j < read->sector_count; j++) {
+                        cd_block_model_sector_fill(read->fad + j, _sector);
+
+                        if ((memcmp(&buffer[j * CDFS_SECTOR_SIZE], _sector,
+                                    CDFS_SECTOR_SIZE)) != 0) {
+                                _error_print(test, "Sector data doesn't match the disc");
+
+                                break;
+                        }
+                }
+        }
+
+        cd_block_model_stats_t stats;
+
+        cd_block_model_stats_get(&stats);
+
+        if (stats.violation_count > 0) {
+                _error_print(test, "CD-block was used in a way the hardware doesn't allow");
+        }
+
+        /* Levels 1 and 2 transfer at most 4KiB at a time */
+        if ((test->dma_level > 0) &&
+            (stats.transfer_sector_max > (4096 / CDFS_SECTOR_SIZE))) {
+                _error_print(test, "SCU-DMA transfer is larger than 4KiB");
+        }
+
+        return (_error_count == error_count);
+}
+
+static void
+_read_callback(cd_block_read_t *read)
+{
+        if (read->next != NULL) {
+                (void)fprintf(stderr, "Error: %s: Ended read is still linked\n",
+                    PROGNAME);
+
+                _error_count++;
+        }
+
+        if (_callback_count < TEST_READ_COUNT_MAX) {
+                _callback_reads[_callback_count] = read;
+        }
+
+        _callback_count++;
+}
+
+static void
+_error_print(const test_t *test, const char *message)
+{
+        (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, test->name,
+            message);
+
+        _error_count++;
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* There is no cache to purge on the host. The simulated CD-block checks that
+ * each transferred area is purged */
+
+#ifndef _CD_BLOCK_READ_TEST_HOST_CPU_CACHE_H_
+#define _CD_BLOCK_READ_TEST_HOST_CPU_CACHE_H_
+
+#include <stdint.h>
+
+extern void cpu_cache_area_purge(void *address, uint32_t len);
+
+#endif /* !_CD_BLOCK_READ_TEST_HOST_CPU_CACHE_H_ */
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Stands in for the CPU interrupt level. The simulated CD-block only
+ * interrupts while interrupts are enabled */
+
+#ifndef _CD_BLOCK_READ_TEST_HOST_CPU_INTC_H_
+#define _CD_BLOCK_READ_TEST_HOST_CPU_INTC_H_
+
+#include <stdint.h>
+
+extern uint8_t cpu_intc_mask_get(void);
+extern void cpu_intc_mask_set(uint8_t mask);
+
+#endif /* !_CD_BLOCK_READ_TEST_HOST_CPU_INTC_H_ */
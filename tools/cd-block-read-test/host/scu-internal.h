@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The CD-block and SCU registers are backed by memory owned by the simulated
+ * CD-block */
+
+#ifndef _CD_BLOCK_READ_TEST_HOST_SCU_INTERNAL_H_
+#define _CD_BLOCK_READ_TEST_HOST_SCU_INTERNAL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <scu/dma.h>
+
+#define CD_BLOCK_REGS_SIZE      (0x28)
+#define SCU_REGS_SIZE           (0xD0)
+
+#define CD_BLOCK(x)             ((uintptr_t)&__host_cd_block_regs[0] + (x))
+#define SCU(x)                  ((uintptr_t)&__host_scu_regs[0] + (x))
+
+#define AIACK                   0x00A8UL
+
+#define MEMORY_READ(t, x)                                                      \
+    (*(volatile uint ## t ## _t *)(x))
+
+#define MEMORY_WRITE(t, x, y)                                                  \
+do {                                                                           \
+        (*(volatile uint ## t ## _t *)(x) = (y));                              \
+} while (false)
+
+#define MEMORY_WRITE_AND(t, x, y)                                              \
+do {                                                                           \
+        (*(volatile uint ## t ## _t *)(x) &= (y));                             \
+} while (false)
+
+#define MEMORY_WRITE_OR(t, x, y)                                               \
+do {                                                                           \
+        (*(volatile uint ## t ## _t *)(x) |= (y));                             \
+} while (false)
+
+extern uint16_t __host_cd_block_regs[CD_BLOCK_REGS_SIZE / 2];
+extern uint32_t __host_scu_regs[SCU_REGS_SIZE / 4];
+
+#endif /* !_CD_BLOCK_READ_TEST_HOST_SCU_INTERNAL_H_ */
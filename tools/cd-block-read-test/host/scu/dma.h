@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Stands in for the SCU-DMA. The transfers are made by the simulated CD-block
+ * in cd_block_model.c */
+
+#ifndef _CD_BLOCK_READ_TEST_HOST_SCU_DMA_H_
+#define _CD_BLOCK_READ_TEST_HOST_SCU_DMA_H_
+
+#include <stdint.h>
+
+typedef enum scu_dma_mode {
+        SCU_DMA_MODE_DIRECT   = 0x00,
+        SCU_DMA_MODE_INDIRECT = 0x01
+} scu_dma_mode_t;
+
+typedef enum scu_dma_space {
+        SCU_DMA_SPACE_BUS_A,
+        SCU_DMA_SPACE_BUS_B,
+        SCU_DMA_SPACE_BUS_CPU
+} scu_dma_space_t;
+
+typedef enum scu_dma_start_factor {
+        SCU_DMA_START_FACTOR_ENABLE = 0x07
+} scu_dma_start_factor_t;
+
+typedef enum scu_dma_stride {
+        SCU_DMA_STRIDE_0_BYTES = 0x00,
+        SCU_DMA_STRIDE_2_BYTES = 0x01
+} scu_dma_stride_t;
+
+typedef enum scu_dma_update {
+        SCU_DMA_UPDATE_NONE = 0x00000000UL
+} scu_dma_update_t;
+
+typedef int32_t scu_dma_level_t;
+
+/* Addresses don't fit in 32 bits on the host, so the destination is taken
+ * from the work pointer given to scu_dma_level_end_set() instead */
+typedef struct scu_dma_level_cfg {
+        scu_dma_mode_t mode;
+
+        union {
+                struct {
+                        uint32_t len;
+                        uint32_t dst;
+                        uintptr_t src;
+                } direct;
+        } xfer;
+
+        scu_dma_space_t space;
+        scu_dma_stride_t stride;
+        scu_dma_update_t update;
+} scu_dma_level_cfg_t;
+
+typedef struct scu_dma_handle {
+        uint32_t dnmd;
+        scu_dma_level_cfg_t cfg;
+} scu_dma_handle_t;
+
+typedef void (*scu_dma_callback_t)(void *);
+
+extern void scu_dma_config_buffer(scu_dma_handle_t *handle,
+    const scu_dma_level_cfg_t *cfg);
+extern void scu_dma_config_set(scu_dma_level_t level,
+    scu_dma_start_factor_t start_factor, const scu_dma_handle_t *handle,
+    scu_dma_callback_t callback);
+extern void scu_dma_level_end_set(scu_dma_level_t level,
+    scu_dma_callback_t callback, void *work);
+extern void scu_dma_level_fast_start(scu_dma_level_t level);
+
+#endif /* !_CD_BLOCK_READ_TEST_HOST_SCU_DMA_H_ */
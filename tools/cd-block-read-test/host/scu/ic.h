@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Stands in for the SCU interrupt controller. The simulated CD-block calls the
+ * CD-block interrupt handler */
+
+#ifndef _CD_BLOCK_READ_TEST_HOST_SCU_IC_H_
+#define _CD_BLOCK_READ_TEST_HOST_SCU_IC_H_
+
+#include <stdint.h>
+
+typedef enum scu_ic_interrupt {
+        SCU_IC_INTERRUPT_CD_BLOCK = 0x50
+} scu_ic_interrupt_t;
+
+typedef enum scu_ic_mask {
+        SCU_IC_MASK_NONE  = 0x00000000,
+        SCU_IC_MASK_A_BUS = 0x00008000,
+        SCU_IC_MASK_ALL   = 0x0000BFFF
+} scu_ic_mask_t;
+
+typedef void (*scu_ic_ihr_t)(void);
+
+extern void scu_ic_ihr_set(scu_ic_interrupt_t vector, scu_ic_ihr_t ihr);
+extern void scu_ic_mask_chg(scu_ic_mask_t and_mask, scu_ic_mask_t or_mask);
+
+#endif /* !_CD_BLOCK_READ_TEST_HOST_SCU_IC_H_ */
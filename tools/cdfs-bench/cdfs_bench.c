@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "cdfs_bench"
+
+/* Number of times the file system is mounted by default */
+#define BENCH_ITERATIONS_DEFAULT 100
+
+/* Sector cache used for the cached mount */
+#define BENCH_CACHE_SECTOR_COUNT    (32)
+#define BENCH_CACHE_READAHEAD_COUNT (8)
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cdfs.h>
+
+#include "image.h"
+
+/* Longest path, with the separators */
+#define PATH_LENGTH_MAX ((ISO_DIR_LEVEL_MAX + 1) * (ISO_FILENAME_MAX_LENGTH + 1))
+
+typedef struct {
+        cdfs_filelist_entry_t *entries;
+        uint32_t count;
+        uint32_t pooled_count;
+} directory_t;
+
+static struct {
+        uint32_t error_count;
+        uint32_t directory_count;
+        uint32_t file_count;
+        uint32_t sector_read_count;
+} _walk;
+
+static cdfs_filelist_entry_t _entries[CDFS_FILELIST_ENTRIES_COUNT];
+static uint16_t _parents[CDFS_FILELIST_ENTRIES_COUNT];
+static cdfs_path_slot_t _slots[CDFS_FILELIST_ENTRIES_COUNT * 2];
+static char _paths[CDFS_FILELIST_ENTRIES_COUNT][PATH_LENGTH_MAX + 1];
+
+static uint8_t _cache_buffer[BENCH_CACHE_SECTOR_COUNT * CDFS_SECTOR_SIZE];
+
+static void _usage_print(void);
+
+static void _directory_walk(cdfs_filelist_t *filelist,
+    const cdfs_filelist_entry_t *directory_entry, const char *path,
+    uint32_t level);
+static void _directory_walker(cdfs_filelist_t *filelist,
+    const cdfs_filelist_entry_t *entry, void *args);
+static void _entry_validate(const cdfs_filelist_entry_t *entry,
+    const char *path, uint32_t image_sector_count);
+static void _error_print(const char *path, const char *message);
+
+static void _mount_bench(cdfs_filelist_t *filelist,
+    cdfs_path_index_t *index, uint32_t iterations, bool cached);
+static void _lookup_bench(const cdfs_filelist_t *filelist,
+    const cdfs_path_index_t *index, uint32_t iterations);
+static void _path_build(const cdfs_filelist_t *filelist, uint32_t entry_index,
+    char *path);
+static uint32_t _slot_count_get(uint32_t entry_count);
+
+static double _time_get(void);
+
+int
+main(int argc, char *argv[])
+{
+        uint32_t iterations = BENCH_ITERATIONS_DEFAULT;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        iterations = strtoul(optarg, NULL, 0);
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if ((iterations == 0) || ((argc - optind) != 1)) {
+                _usage_print();
+
+                return 1;
+        }
+
+        const char * const image_path = argv[optind];
+
+        if (!(image_open(image_path))) {
+                (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, image_path,
+                    strerror(errno));
+
+                return 1;
+        }
+
+        cdfs_filelist_t filelist;
+
+        cdfs_filelist_init(&filelist, _entries, image_sector_read,
+            CDFS_FILELIST_ENTRIES_COUNT);
+
+        (void)printf("Directory                                  Entries  Sectors read\n");
+
+        _directory_walk(&filelist, NULL, "", 0);
+
+        (void)printf("\n%" PRIu32 " directories, %" PRIu32 " files, %" PRIu32
+            " sectors read, %" PRIu32 " errors\n\n",
+            _walk.directory_count, _walk.file_count, _walk.sector_read_count,
+            _walk.error_count);
+
+        cdfs_path_index_t index;
+
+        _mount_bench(&filelist, &index, iterations, false);
+        _mount_bench(&filelist, &index, iterations, true);
+
+        _lookup_bench(&filelist, &index, iterations);
+
+        image_close();
+
+        return ((_walk.error_count == 0) ? 0 : 1);
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-n iterations] image\n", PROGNAME);
+        (void)fprintf(stderr, "Walk and validate the directory tree of a .iso or a .bin image with\n"
+                              "cdfs, and measure how long mounting and looking up paths takes\n");
+        (void)fprintf(stderr, "  -n iterations  Number of times the image is mounted (default: %i)\n",
+            BENCH_ITERATIONS_DEFAULT);
+}
+
+/* Walk a directory, then each of its directories. When directory_entry is
+ * NULL, the root directory is walked */
+static void
+_directory_walk(cdfs_filelist_t *filelist,
+    const cdfs_filelist_entry_t *directory_entry, const char *path,
+    uint32_t level)
+{
+        if (level > ISO_DIR_LEVEL_MAX) {
+                _error_print(path, "Directory is nested too deep");
+
+                return;
+        }
+
+        directory_t directory = {
+                .entries = NULL,
+                .count = 0,
+                .pooled_count = 0
+        };
+
+        image_stats_t stats;
+
+        image_stats_clear();
+
+        cdfs_filelist_walk(filelist, directory_entry, _directory_walker, &directory);
+
+        image_stats_get(&stats);
+
+        (void)printf("%-40s %9" PRIu32 " %13" PRIu32 "\n",
+            (*path == '\0') ? "/" : path, directory.count, stats.sector_read_count);
+
+        _walk.directory_count++;
+        _walk.sector_read_count += stats.sector_read_count;
+
+        for (uint32_t i = 0; i < directory.count; i++) {
+                const cdfs_filelist_entry_t * const entry = &directory.entries[i];
+
+                char entry_path[PATH_LENGTH_MAX + 1];
+
+                (void)snprintf(entry_path, sizeof(entry_path), "%s%s%s",
+                    path, (*path == '\0') ? "" : "/", entry->name);
+
+                _entry_validate(entry, entry_path, stats.sector_count);
+
+                if (entry->type == CDFS_ENTRY_TYPE_DIRECTORY) {
+                        _directory_walk(filelist, entry, entry_path, level + 1);
+                } else {
+                        _walk.file_count++;
+                }
+        }
+
+        free(directory.entries);
+}
+
+static void
+_directory_walker(cdfs_filelist_t *filelist __unused,
+    const cdfs_filelist_entry_t *entry, void *args)
+{
+        directory_t * const directory = args;
+
+        if (directory->count == directory->pooled_count) {
+                directory->pooled_count = (directory->pooled_count == 0) ? 16 : (directory->pooled_count * 2);
+                directory->entries = realloc(directory->entries,
+                    directory->pooled_count * sizeof(cdfs_filelist_entry_t));
+
+                if (directory->entries == NULL) {
+                        (void)fprintf(stderr, "Error: %s: %s\n", PROGNAME, strerror(errno));
+
+                        exit(1);
+                }
+        }
+
+        (void)memcpy(&directory->entries[directory->count], entry,
+            sizeof(cdfs_filelist_entry_t));
+
+        directory->count++;
+}
+
+static void
+_entry_validate(const cdfs_filelist_entry_t *entry, const char *path,
+    uint32_t image_sector_count)
+{
+        if (entry->name[0] == '\0') {
+                _error_print(path, "Empty name");
+        }
+
+        for (const char *c = entry->name; *c != '\0'; c++) {
+                if (!(isprint((unsigned char)*c)) || (*c == '/')) {
+                        _error_print(path, "Invalid character in name");
+
+                        break;
+                }
+        }
+
+        if ((entry->type != CDFS_ENTRY_TYPE_FILE) &&
+            (entry->type != CDFS_ENTRY_TYPE_DIRECTORY)) {
+                _error_print(path, "Invalid type");
+        }
+
+        if (entry->starting_fad < LBA2FAD(0)) {
+                _error_print(path, "Extent starts before the first sector");
+
+                return;
+        }
+
+        if (entry->sector_count != cdfs_sector_count_round(entry->size)) {
+                _error_print(path, "Sector count doesn't match the size");
+        }
+
+        const uint32_t sector = FAD2LBA(entry->starting_fad);
+
+        if ((sector + cdfs_sector_count_round(entry->size)) > image_sector_count) {
+                _error_print(path, "Extent ends past the end of the image");
+        }
+}
+
+static void
+_error_print(const char *path, const char *message)
+{
+        (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, path, message);
+
+        _walk.error_count++;
+}
+
+/* Read the whole directory tree and build the path index, as a program would
+ * when it starts */
+static void
+_mount_bench(cdfs_filelist_t *filelist, cdfs_path_index_t *index,
+    uint32_t iterations, bool cached)
+{
+        const cdfs_sector_read_t sector_read =
+            cached ? cdfs_cache_sector_read : image_sector_read;
+
+        if (cached) {
+                cdfs_cache_init(_cache_buffer, BENCH_CACHE_SECTOR_COUNT,
+                    BENCH_CACHE_READAHEAD_COUNT, image_sectors_read);
+        }
+
+        image_stats_t stats;
+        (void)memset(&stats, 0, sizeof(stats));
+
+        double time = 0.0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                /* Each mount starts cold */
+                if (cached) {
+                        cdfs_cache_flush();
+                }
+
+                image_stats_clear();
+
+                const double start_time = _time_get();
+
+                cdfs_filelist_init(filelist, _entries, sector_read,
+                    CDFS_FILELIST_ENTRIES_COUNT);
+                cdfs_filelist_tree_read(filelist, _parents);
+                cdfs_path_index_build(index, filelist, _parents, _slots,
+                    _slot_count_get(filelist->entries_count));
+
+                time += _time_get() - start_time;
+
+                image_stats_get(&stats);
+        }
+
+        (void)printf("Mount (%s): %.1fus, %" PRIu32 " entries, %" PRIu32
+            " reads, %" PRIu32 " sectors read\n",
+            cached ? "cached" : "uncached",
+            (time * 1000000.0) / iterations,
+            filelist->entries_count, stats.read_count, stats.sector_read_count);
+
+        if (cached) {
+                cdfs_cache_stats_t cache_stats;
+
+                cdfs_cache_stats_get(&cache_stats);
+
+                (void)printf("  Cache: %" PRIu32 " hits, %" PRIu32 " misses per mount\n",
+                    cache_stats.hit_count / iterations,
+                    cache_stats.miss_count / iterations);
+        }
+}
+
+/* Look up the path of every entry, with the path index and then by comparing
+ * against every path in turn */
+static void
+_lookup_bench(const cdfs_filelist_t *filelist, const cdfs_path_index_t *index,
+    uint32_t iterations)
+{
+        const uint32_t entry_count = filelist->entries_count;
+
+        if (entry_count == 0) {
+                return;
+        }
+
+        for (uint32_t i = 0; i < entry_count; i++) {
+                _path_build(filelist, i, _paths[i]);
+
+                if ((cdfs_path_lookup(index, _paths[i])) != &filelist->entries[i]) {
+                        _error_print(_paths[i], "Path lookup found the wrong entry");
+                }
+        }
+
+        double time;
+        time = _time_get();
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                for (uint32_t j = 0; j < entry_count; j++) {
+                        (void)cdfs_path_lookup(index, _paths[j]);
+                }
+        }
+
+        const double index_time = _time_get() - time;
+
+        time = _time_get();
+
+        volatile uint32_t found_count = 0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                for (uint32_t j = 0; j < entry_count; j++) {
+                        for (uint32_t k = 0; k < entry_count; k++) {
+                                if ((strcmp(_paths[k], _paths[j])) == 0) {
+                                        found_count++;
+
+                                        break;
+                                }
+                        }
+                }
+        }
+
+        const double scan_time = _time_get() - time;
+        const double lookup_count = (double)iterations * entry_count;
+
+        (void)printf("Lookup: %.1fns with the path index, %.1fns by scanning\n",
+            (index_time * 1000000000.0) / lookup_count,
+            (scan_time * 1000000000.0) / lookup_count);
+}
+
+static void
+_path_build(const cdfs_filelist_t *filelist, uint32_t entry_index, char *path)
+{
+        if (_parents[entry_index] == CDFS_PATH_PARENT_NONE) {
+                (void)strcpy(path, filelist->entries[entry_index].name);
+
+                return;
+        }
+
+        _path_build(filelist, _parents[entry_index], path);
+
+        (void)strcat(path, "/");
+        (void)strcat(path, filelist->entries[entry_index].name);
+}
+
+static uint32_t
+_slot_count_get(uint32_t entry_count)
+{
+        uint32_t slot_count;
+        slot_count = 16;
+
+        while (slot_count < (entry_count * 2)) {
+                slot_count <<= 1;
+        }
+
+        return slot_count;
+}
+
+static double
+_time_get(void)
+{
+        struct timespec ts;
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (double)ts.tv_sec + ((double)ts.tv_nsec / 1000000000.0);
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Stands in for the CD-block. Sectors are read from an image file instead */
+
+#ifndef _CDFS_BENCH_HOST_CD_BLOCK_H_
+#define _CDFS_BENCH_HOST_CD_BLOCK_H_
+
+#include <stdint.h>
+
+#define CDFS_SECTOR_SIZE (2048U)
+
+#define FAD2LBA(x)      ((x) - 150)
+#define LBA2FAD(x)      ((x) + 150)
+
+typedef uint32_t fad_t;
+
+#endif /* !_CDFS_BENCH_HOST_CD_BLOCK_H_ */
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _CDFS_BENCH_HOST_MATH_H_
+#define _CDFS_BENCH_HOST_MATH_H_
+
+#include_next <math.h>
+
+#include <stdint.h>
+
+static inline uint32_t __always_inline
+uint32_pow2_round(uint32_t value, uint32_t pow)
+{
+        return (((value + ((1 << pow) - 1)) >> pow) << pow);
+}
+
+#endif /* !_CDFS_BENCH_HOST_MATH_H_ */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "image.h"
+
+/* Raw (.bin) images hold 2352-byte sectors. In mode 1, the 2048 bytes of user
+ * data come after the 12-byte sync pattern and the 4-byte header */
+#define RAW_SECTOR_SIZE         (2352)
+#define RAW_DATA_OFFSET         (16)
+
+static const uint8_t _sync_pattern[12] = {
+        0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00
+};
+
+static struct {
+        FILE *fp;
+        uint32_t sector_size;
+        uint32_t data_offset;
+
+        image_stats_t stats;
+} _state;
+
+static void _sector_read(sector_t sector, void *ptr);
+
+bool
+image_open(const char *path)
+{
+        _state.fp = fopen(path, "rb");
+
+        if (_state.fp == NULL) {
+                return false;
+        }
+
+        (void)fseek(_state.fp, 0, SEEK_END);
+        const long size = ftell(_state.fp);
+        (void)fseek(_state.fp, 0, SEEK_SET);
+
+        uint8_t sync[sizeof(_sync_pattern)];
+
+        _state.sector_size = CDFS_SECTOR_SIZE;
+        _state.data_offset = 0;
+
+        if (((size % RAW_SECTOR_SIZE) == 0) &&
+            ((fread(sync, sizeof(sync), 1, _state.fp)) == 1) &&
+            ((memcmp(sync, _sync_pattern, sizeof(sync))) == 0)) {
+                _state.sector_size = RAW_SECTOR_SIZE;
+                _state.data_offset = RAW_DATA_OFFSET;
+        }
+
+        (void)memset(&_state.stats, 0, sizeof(_state.stats));
+
+        _state.stats.sector_count = size / _state.sector_size;
+
+        return true;
+}
+
+void
+image_close(void)
+{
+        if (_state.fp != NULL) {
+                (void)fclose(_state.fp);
+        }
+
+        _state.fp = NULL;
+}
+
+void
+image_stats_get(image_stats_t *stats)
+{
+        (void)memcpy(stats, &_state.stats, sizeof(image_stats_t));
+}
+
+void
+image_stats_clear(void)
+{
+        _state.stats.read_count = 0;
+        _state.stats.sector_read_count = 0;
+}
+
+void
+image_sector_read(sector_t sector, void *ptr)
+{
+        _state.stats.read_count++;
+
+        _sector_read(sector, ptr);
+}
+
+void
+image_sectors_read(sector_t sector, void *ptr, uint32_t count)
+{
+        _state.stats.read_count++;
+
+        uint8_t *p;
+        p = ptr;
+
+        for (uint32_t i = 0; i < count; i++) {
+                _sector_read(sector + i, p);
+
+                p += CDFS_SECTOR_SIZE;
+        }
+}
+
+/* Sectors past the end of the image read as zeros, like the lead-out */
+static void
+_sector_read(sector_t sector, void *ptr)
+{
+        _state.stats.sector_read_count++;
+
+        (void)memset(ptr, 0x00, CDFS_SECTOR_SIZE);
+
+        if (sector >= _state.stats.sector_count) {
+                return;
+        }
+
+        const long offset = ((long)sector * _state.sector_size) + _state.data_offset;
+
+        if ((fseek(_state.fp, offset, SEEK_SET)) != 0) {
+                return;
+        }
+
+        (void)fread(ptr, CDFS_SECTOR_SIZE, 1, _state.fp);
+}
+
+/* On the host, the image is the disc */
+void
+cdfs_sector_read(sector_t sector, void *ptr)
+{
+        image_sector_read(sector, ptr);
+}
+
+void
+cdfs_sectors_read(sector_t sector, void *ptr, uint32_t count)
+{
+        image_sectors_read(sector, ptr, count);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _CDFS_BENCH_IMAGE_H_
+#define _CDFS_BENCH_IMAGE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cdfs.h>
+
+typedef struct {
+        /* Number of sectors in the image */
+        uint32_t sector_count;
+        /* Number of calls made to read, and the sectors read */
+        uint32_t read_count;
+        uint32_t sector_read_count;
+} image_stats_t;
+
+extern bool image_open(const char *path);
+extern void image_close(void);
+
+extern void image_stats_get(image_stats_t *stats);
+extern void image_stats_clear(void);
+
+/* Same types as cdfs_sector_read_t and cdfs_sectors_read_t */
+extern void image_sector_read(sector_t sector, void *ptr);
+extern void image_sectors_read(sector_t sector, void *ptr, uint32_t count);
+
+#endif /* !_CDFS_BENCH_IMAGE_H_ */
@@ -0,0 +1,510 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "cdfs_layout"
+
+/* Rough model of the drive, used to compare layouts. A seek costs a fixed
+ * amount, plus an amount that grows with the square root of the distance, as
+ * the sled moves faster over longer distances */
+#define SEEK_TIME_BASE          (0.080)
+#define SEEK_TIME_DISTANCE      (0.0008)
+
+/* Sectors read per second at 2x speed */
+#define READ_SECTOR_RATE        (150.0)
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cdfs.h>
+
+#include "image.h"
+
+/* Longest path, with the separators */
+#define PATH_LENGTH_MAX ((ISO_DIR_LEVEL_MAX + 1) * (ISO_FILENAME_MAX_LENGTH + 1))
+
+#define FILE_INDEX_NONE (UINT32_MAX)
+
+typedef struct {
+        char path[PATH_LENGTH_MAX + 2];
+        sector_t sector;
+        uint32_t sector_count;
+        /* Position in the new layout, or FILE_INDEX_NONE when never read */
+        uint32_t rank;
+        /* First sector in the new layout */
+        sector_t layout_sector;
+} layout_file_t;
+
+typedef struct {
+        uint32_t file_index;
+        /* Sector offset into the file */
+        uint32_t offset;
+        uint32_t count;
+} access_t;
+
+typedef struct {
+        uint32_t seek_count;
+        uint64_t seek_distance;
+        double seek_time;
+        double read_time;
+} cost_t;
+
+static cdfs_filelist_entry_t _entries[CDFS_FILELIST_ENTRIES_COUNT];
+static uint16_t _parents[CDFS_FILELIST_ENTRIES_COUNT];
+
+static layout_file_t *_files;
+static uint32_t _file_count;
+
+static access_t *_accesses;
+static uint32_t _access_count;
+static uint32_t _access_pooled_count;
+/* Traced sectors that aren't in any file, such as directories */
+static uint32_t _untracked_sector_count;
+
+static void _usage_print(void);
+
+static void _files_read(void);
+static void _path_build(const cdfs_filelist_t *filelist, uint32_t entry_index,
+    char *path);
+static int _file_compare(const void *a, const void *b);
+static uint32_t _file_find(sector_t sector);
+
+static int _trace_read(const char *path);
+static void _access_add(sector_t sector, uint32_t count);
+
+static uint32_t _layout_calculate(void);
+static void _cost_calculate(bool layout, cost_t *cost);
+static void _cost_print(const char *name, const cost_t *cost);
+static int _sort_weights_write(const char *path, uint32_t ranked_count);
+
+int
+main(int argc, char *argv[])
+{
+        const char *output_path = NULL;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "o:")) != -1) {
+                switch (opt) {
+                case 'o':
+                        output_path = optarg;
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if ((argc - optind) != 2) {
+                _usage_print();
+
+                return 1;
+        }
+
+        const char * const image_path = argv[optind];
+        const char * const trace_path = argv[optind + 1];
+
+        if (!(image_open(image_path))) {
+                (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, image_path,
+                    strerror(errno));
+
+                return 1;
+        }
+
+        _files_read();
+
+        if ((_trace_read(trace_path)) != 0) {
+                return 1;
+        }
+
+        const uint32_t ranked_count = _layout_calculate();
+
+        cost_t cost;
+        cost_t layout_cost;
+
+        _cost_calculate(false, &cost);
+        _cost_calculate(true, &layout_cost);
+
+        (void)printf("%" PRIu32 " files, %" PRIu32 " read, %" PRIu32
+            " accesses, %" PRIu32 " sectors outside of files\n",
+            _file_count, ranked_count, _access_count, _untracked_sector_count);
+
+        _cost_print("Current layout", &cost);
+        _cost_print("Trace order layout", &layout_cost);
+
+        if (output_path != NULL) {
+                if ((_sort_weights_write(output_path, ranked_count)) != 0) {
+                        return 1;
+                }
+        }
+
+        image_close();
+
+        return 0;
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-o sort-weight-list] image trace\n", PROGNAME);
+        (void)fprintf(stderr, "Lay out the files of the image in the order the trace reads them, and\n"
+                              "compare the simulated seek cost of both layouts. The trace has one\n"
+                              "\"FAD sector-count\" pair per line, as recorded with cdfs_trace_set()\n");
+        (void)fprintf(stderr, "  -o sort-weight-list  Write the layout as a sort weight list for make-iso\n"
+                              "                       (MAKE_ISO_SORT_WEIGHT_LIST)\n");
+}
+
+/* Read every file in the image, sorted by where the file starts */
+static void
+_files_read(void)
+{
+        cdfs_filelist_t filelist;
+
+        cdfs_filelist_init(&filelist, _entries, image_sector_read,
+            CDFS_FILELIST_ENTRIES_COUNT);
+        cdfs_filelist_tree_read(&filelist, _parents);
+
+        _files = calloc(filelist.entries_count + 1, sizeof(layout_file_t));
+
+        if (_files == NULL) {
+                (void)fprintf(stderr, "Error: %s: %s\n", PROGNAME, strerror(errno));
+
+                exit(1);
+        }
+
+        for (uint32_t i = 0; i < filelist.entries_count; i++) {
+                const cdfs_filelist_entry_t * const entry = &filelist.entries[i];
+
+                if ((entry->type != CDFS_ENTRY_TYPE_FILE) || (entry->sector_count == 0)) {
+                        continue;
+                }
+
+                layout_file_t * const file = &_files[_file_count];
+
+                file->path[0] = '/';
+
+                _path_build(&filelist, i, &file->path[1]);
+
+                file->sector = FAD2LBA(entry->starting_fad);
+                file->sector_count = entry->sector_count;
+                file->rank = FILE_INDEX_NONE;
+
+                _file_count++;
+        }
+
+        qsort(_files, _file_count, sizeof(layout_file_t), _file_compare);
+}
+
+static void
+_path_build(const cdfs_filelist_t *filelist, uint32_t entry_index, char *path)
+{
+        if (_parents[entry_index] == CDFS_PATH_PARENT_NONE) {
+                (void)strcpy(path, filelist->entries[entry_index].name);
+
+                return;
+        }
+
+        _path_build(filelist, _parents[entry_index], path);
+
+        (void)strcat(path, "/");
+        (void)strcat(path, filelist->entries[entry_index].name);
+}
+
+static int
+_file_compare(const void *a, const void *b)
+{
+        const layout_file_t * const file_a = a;
+        const layout_file_t * const file_b = b;
+
+        if (file_a->sector < file_b->sector) {
+                return -1;
+        }
+
+        return (file_a->sector > file_b->sector);
+}
+
+static uint32_t
+_file_find(sector_t sector)
+{
+        uint32_t low = 0;
+        uint32_t high = _file_count;
+
+        while (low < high) {
+                const uint32_t middle = (low + high) / 2;
+                const layout_file_t * const file = &_files[middle];
+
+                if (sector < file->sector) {
+                        high = middle;
+                } else if (sector >= (file->sector + file->sector_count)) {
+                        low = middle + 1;
+                } else {
+                        return middle;
+                }
+        }
+
+        return FILE_INDEX_NONE;
+}
+
+static int
+_trace_read(const char *path)
+{
+        FILE * const fp = fopen(path, "r");
+
+        if (fp == NULL) {
+                (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, path,
+                    strerror(errno));
+
+                return 1;
+        }
+
+        char line[256];
+        uint32_t line_number = 0;
+
+        while ((fgets(line, sizeof(line), fp)) != NULL) {
+                line_number++;
+
+                char *p;
+                p = line;
+
+                while ((*p == ' ') || (*p == '\t')) {
+                        p++;
+                }
+
+                if ((*p == '#') || (*p == '\n') || (*p == '\r') || (*p == '\0')) {
+                        continue;
+                }
+
+                char *end;
+
+                const unsigned long fad = strtoul(p, &end, 0);
+
+                if ((end == p) || (fad < LBA2FAD(0))) {
+                        (void)fprintf(stderr, "Error: %s: %s:%" PRIu32 ": Invalid FAD\n",
+                            PROGNAME, path, line_number);
+
+                        (void)fclose(fp);
+
+                        return 1;
+                }
+
+                p = end;
+
+                unsigned long count = strtoul(p, &end, 0);
+
+                if (end == p) {
+                        count = 1;
+                }
+
+                _access_add(FAD2LBA(fad), count);
+        }
+
+        (void)fclose(fp);
+
+        return 0;
+}
+
+/* A read may span several files. Reads that continue where the last read of
+ * the same file ended are merged */
+static void
+_access_add(sector_t sector, uint32_t count)
+{
+        while (count > 0) {
+                const uint32_t file_index = _file_find(sector);
+
+                if (file_index == FILE_INDEX_NONE) {
+                        _untracked_sector_count++;
+
+                        sector++;
+                        count--;
+
+                        continue;
+                }
+
+                const layout_file_t * const file = &_files[file_index];
+
+                const uint32_t offset = sector - file->sector;
+
+                uint32_t file_count;
+                file_count = file->sector_count - offset;
+
+                if (file_count > count) {
+                        file_count = count;
+                }
+
+                access_t * const last_access =
+                    (_access_count > 0) ? &_accesses[_access_count - 1] : NULL;
+
+                if ((last_access != NULL) &&
+                    (last_access->file_index == file_index) &&
+                    ((last_access->offset + last_access->count) == offset)) {
+                        last_access->count += file_count;
+                } else {
+                        if (_access_count == _access_pooled_count) {
+                                _access_pooled_count =
+                                    (_access_pooled_count == 0) ? 256 : (_access_pooled_count * 2);
+                                _accesses = realloc(_accesses,
+                                    _access_pooled_count * sizeof(access_t));
+
+                                if (_accesses == NULL) {
+                                        (void)fprintf(stderr, "Error: %s: %s\n",
+                                            PROGNAME, strerror(errno));
+
+                                        exit(1);
+                                }
+                        }
+
+                        access_t * const access = &_accesses[_access_count];
+
+                        access->file_index = file_index;
+                        access->offset = offset;
+                        access->count = file_count;
+
+                        _access_count++;
+                }
+
+                sector += file_count;
+                count -= file_count;
+        }
+}
+
+/* Files are placed in the order they're first read in, so that the files read
+ * together are next to each other. The files never read follow, in their
+ * current order. The files keep the same extent of the disc */
+static uint32_t
+_layout_calculate(void)
+{
+        uint32_t ranked_count;
+        ranked_count = 0;
+
+        for (uint32_t i = 0; i < _access_count; i++) {
+                layout_file_t * const file = &_files[_accesses[i].file_index];
+
+                if (file->rank == FILE_INDEX_NONE) {
+                        file->rank = ranked_count;
+
+                        ranked_count++;
+                }
+        }
+
+        uint32_t unranked_index;
+        unranked_index = ranked_count;
+
+        for (uint32_t i = 0; i < _file_count; i++) {
+                if (_files[i].rank == FILE_INDEX_NONE) {
+                        _files[i].rank = unranked_index;
+
+                        unranked_index++;
+                }
+        }
+
+        uint32_t * const order = malloc((_file_count + 1) * sizeof(uint32_t));
+
+        if (order == NULL) {
+                (void)fprintf(stderr, "Error: %s: %s\n", PROGNAME, strerror(errno));
+
+                exit(1);
+        }
+
+        for (uint32_t i = 0; i < _file_count; i++) {
+                order[_files[i].rank] = i;
+        }
+
+        sector_t sector;
+        sector = (_file_count > 0) ? _files[0].sector : 0;
+
+        for (uint32_t i = 0; i < _file_count; i++) {
+                layout_file_t * const file = &_files[order[i]];
+
+                file->layout_sector = sector;
+
+                sector += file->sector_count;
+        }
+
+        free(order);
+
+        return ranked_count;
+}
+
+/* Replay the trace against either the current layout or the new one */
+static void
+_cost_calculate(bool layout, cost_t *cost)
+{
+        (void)memset(cost, 0, sizeof(cost_t));
+
+        sector_t head_sector;
+        head_sector = 0;
+
+        for (uint32_t i = 0; i < _access_count; i++) {
+                const access_t * const access = &_accesses[i];
+                const layout_file_t * const file = &_files[access->file_index];
+
+                const sector_t file_sector = layout ? file->layout_sector : file->sector;
+                const sector_t sector = file_sector + access->offset;
+
+                if ((i == 0) || (sector != head_sector)) {
+                        const uint32_t distance = (sector > head_sector)
+                            ? (sector - head_sector)
+                            : (head_sector - sector);
+
+                        cost->seek_count++;
+                        cost->seek_distance += distance;
+                        cost->seek_time += SEEK_TIME_BASE + (SEEK_TIME_DISTANCE * sqrt(distance));
+                }
+
+                cost->read_time += access->count / READ_SECTOR_RATE;
+
+                head_sector = sector + access->count;
+        }
+}
+
+static void
+_cost_print(const char *name, const cost_t *cost)
+{
+        (void)printf("%s: %" PRIu32 " seeks over %" PRIu64 " sectors, %.2fs seeking, %.2fs reading\n",
+            name, cost->seek_count, cost->seek_distance, cost->seek_time,
+            cost->read_time);
+}
+
+/* Each line holds a weight and a path on the disc. Files with a greater weight
+ * are placed first. Files never read aren't listed */
+static int
+_sort_weights_write(const char *path, uint32_t ranked_count)
+{
+        FILE * const fp = fopen(path, "w");
+
+        if (fp == NULL) {
+                (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, path,
+                    strerror(errno));
+
+                return 1;
+        }
+
+        for (uint32_t i = 0; i < _file_count; i++) {
+                const layout_file_t * const file = &_files[i];
+
+                if (file->rank >= ranked_count) {
+                        continue;
+                }
+
+                (void)fprintf(fp, "%" PRIu32 " %s\n", ranked_count - file->rank,
+                    file->path);
+        }
+
+        if ((fclose(fp)) != 0) {
+                (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, path,
+                    strerror(errno));
+
+                return 1;
+        }
+
+        return 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Built once for each backend. The Makefile sets TRANSFORM_BACKEND, and names
+ * BACKEND and __vertex_pool_transform after the backend */
+
+#include "backend-internal.h"
+
+#include "backend.h"
+
+#define STRINGIFY(x)    #x
+#define NAME_GET(x)     STRINGIFY(x)
+
+static uint32_t
+_mac3(const FIXED *a, const FIXED *b)
+{
+        return __backend_mac3(a, b);
+}
+
+static FIXED
+_fix16_mul(FIXED a, FIXED b)
+{
+        return __backend_fix16_mul(a, b);
+}
+
+static int16_t
+_fix16_int16_muls(FIXED a, FIXED b)
+{
+        return __backend_fix16_int16_muls(a, b);
+}
+
+static FIXED
+_divs(int64_t dividend, FIXED divisor)
+{
+        return __backend_divs(dividend, divisor);
+}
+
+const backend_t BACKEND = {
+        .name = NAME_GET(BACKEND),
+        .mac3 = _mac3,
+        .fix16_mul = _fix16_mul,
+        .fix16_int16_muls = _fix16_int16_muls,
+        .divs = _divs,
+        .vertex_pool_transform = __vertex_pool_transform
+};
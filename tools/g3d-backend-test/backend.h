@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _G3D_BACKEND_TEST_BACKEND_H_
+#define _G3D_BACKEND_TEST_BACKEND_H_
+
+#include <stdint.h>
+
+#include <g3d/sgl.h>
+
+#include "vertex-pool-internal.h"
+
+/* backend.c and vertex_pool.c are built once for each backend */
+typedef struct {
+        const char *name;
+
+        uint32_t (*mac3)(const FIXED *a, const FIXED *b);
+        FIXED (*fix16_mul)(FIXED a, FIXED b);
+        int16_t (*fix16_int16_muls)(FIXED a, FIXED b);
+        FIXED (*divs)(int64_t dividend, FIXED divisor);
+
+        void (*vertex_pool_transform)(const POINT *points, uint16_t vertex_count,
+            transform_proj_t *trans_proj, const FIXED *top_matrix,
+            const vertex_pool_view_t *view);
+} backend_t;
+
+extern const backend_t backend_sh2;
+extern const backend_t backend_reference;
+
+#endif /* !_G3D_BACKEND_TEST_BACKEND_H_ */
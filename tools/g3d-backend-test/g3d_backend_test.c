@@ -0,0 +1,476 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "g3d_backend_test"
+
+/* Number of random cases for each test by default */
+#define TEST_ITERATIONS_DEFAULT 100000
+
+#define TEST_VERTEX_COUNT       (256)
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cpu/map.h>
+
+#include "backend-internal.h"
+
+#include "backend.h"
+
+uint32_t __host_cpu_regs[CPU_REGS_SIZE / 4];
+
+static struct {
+        uint32_t error_count;
+} _results;
+
+static uint64_t _seed = 1;
+
+static const int64_t _edge_dividends[] = {
+        0,
+        1,
+        -1,
+        65536,
+        -65536,
+        INT32_MAX,
+        INT32_MIN,
+        (int64_t)INT32_MAX + 1,
+        (int64_t)INT32_MIN - 1,
+        (int64_t)INT32_MAX << 16,
+        (int64_t)INT32_MIN * 65536,
+        INT64_MAX,
+        INT64_MIN,
+        INT64_MIN + 1
+};
+
+static const FIXED _edge_divisors[] = {
+        0,
+        1,
+        -1,
+        2,
+        -2,
+        3,
+        -3,
+        65536,
+        -65536,
+        INT32_MAX,
+        INT32_MIN,
+        INT32_MIN + 1
+};
+
+static const FIXED _edge_values[] = {
+        0,
+        1,
+        -1,
+        65536,
+        -65536,
+        INT16_MAX,
+        INT16_MIN,
+        INT32_MAX,
+        INT32_MIN,
+        INT32_MIN + 1
+};
+
+static void _usage_print(void);
+static void _results_print(const char *test, uint32_t case_count,
+    uint32_t error_count);
+
+static void _mac3_test(uint32_t iterations);
+static void _fix16_mul_test(uint32_t iterations);
+static void _divs_test(uint32_t iterations);
+static void _divs_compare(int64_t dividend, FIXED divisor);
+static void _vertex_pool_test(uint32_t iterations);
+static void _vertex_pool_compare(const POINT *points, uint16_t vertex_count,
+    const FIXED *matrix, const vertex_pool_view_t *view);
+
+static void _mismatch_print(const char *test, const char *format, ...)
+    __attribute__ ((format(printf, 2, 3)));
+
+static uint32_t _random_get(void);
+static FIXED _random_fixed_get(uint32_t bits);
+
+int
+main(int argc, char *argv[])
+{
+        uint32_t iterations = TEST_ITERATIONS_DEFAULT;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        iterations = strtoul(optarg, NULL, 0);
+                        break;
+                case 's':
+                        _seed = strtoull(optarg, NULL, 0);
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if ((iterations == 0) || (_seed == 0) || (argc != optind)) {
+                _usage_print();
+
+                return 1;
+        }
+
+        (void)printf("Test                           Cases  Mismatches\n");
+
+        _mac3_test(iterations);
+        _fix16_mul_test(iterations);
+        _divs_test(iterations);
+        _vertex_pool_test(iterations / TEST_VERTEX_COUNT);
+
+        return ((_results.error_count > 0) ? 1 : 0);
+}
+
+/* Model of the CPU divider, written from the hardware manual rather than from
+ * __backend_divs(). The magnitudes are divided one quotient bit at a time. When
+ * the quotient doesn't fit, or on a division by zero, the overflow interrupt is
+ * disabled, and the result is H'7FFFFFFF or H'80000000 depending on the signs
+ * of the operands */
+FIXED
+__backend_divu_quotient_get(const uint32_t *divu_regs)
+{
+        const int32_t divisor = (int32_t)divu_regs[BACKEND_DIVU_DVSR];
+        const int64_t dividend =
+            (int64_t)(((uint64_t)divu_regs[BACKEND_DIVU_DVDNTH] << 32) |
+                divu_regs[BACKEND_DIVU_DVDNTL]);
+
+        const bool negative = ((dividend < 0) != (divisor < 0));
+
+        const uint64_t n = (dividend < 0) ? -(uint64_t)dividend : (uint64_t)dividend;
+        const uint64_t d = (divisor < 0) ? -(uint64_t)(int64_t)divisor : (uint64_t)divisor;
+
+        const uint64_t limit = negative ? 0x80000000ULL : 0x7FFFFFFFULL;
+
+        uint64_t q = 0;
+        uint64_t r = 0;
+
+        if (d != 0) {
+                for (int32_t i = 63; i >= 0; i--) {
+                        r = (r << 1) | ((n >> i) & 1);
+                        q <<= 1;
+
+                        if (r >= d) {
+                                r -= d;
+                                q |= 1;
+                        }
+                }
+        }
+
+        if ((d == 0) || (q > limit)) {
+                return (negative ? INT32_MIN : INT32_MAX);
+        }
+
+        return (FIXED)(negative ? -(int64_t)q : (int64_t)q);
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-n iterations] [-s seed]\n", PROGNAME);
+        (void)fprintf(stderr, "Check that the SH-2 and the reference transform backends of libg3d give\n"
+                              "the same results. The SH-2 backend runs against models of the MAC unit\n"
+                              "and the CPU divider\n");
+}
+
+static void
+_results_print(const char *test, uint32_t case_count, uint32_t error_count)
+{
+        (void)printf("%-24s %11" PRIu32 " %11" PRIu32 "\n", test, case_count,
+            error_count);
+}
+
+static void
+_mac3_test(uint32_t iterations)
+{
+        const uint32_t error_count = _results.error_count;
+        const uint32_t edge_count = sizeof(_edge_values) / sizeof(*_edge_values);
+
+        FIXED a[XYZ];
+        FIXED b[XYZ];
+
+        uint32_t case_count;
+        case_count = 0;
+
+        for (uint32_t i = 0; i < (iterations + (edge_count * edge_count)); i++) {
+                if (i < (edge_count * edge_count)) {
+                        /* Sums of products of the extremes wrap around */
+                        a[X] = a[Y] = a[Z] = _edge_values[i / edge_count];
+                        b[X] = b[Y] = b[Z] = _edge_values[i % edge_count];
+                } else {
+                        for (uint32_t j = 0; j < XYZ; j++) {
+                                a[j] = _random_fixed_get(1 + (_random_get() % 32));
+                                b[j] = _random_fixed_get(1 + (_random_get() % 32));
+                        }
+                }
+
+                const uint32_t sh2 = backend_sh2.mac3(a, b);
+                const uint32_t reference = backend_reference.mac3(a, b);
+
+                case_count++;
+
+                if (sh2 != reference) {
+                        _mismatch_print("mac3", "(%08X %08X %08X).(%08X %08X %08X): %08X != %08X",
+                            a[X], a[Y], a[Z], b[X], b[Y], b[Z], sh2, reference);
+                }
+        }
+
+        _results_print("__backend_mac3", case_count, _results.error_count - error_count);
+}
+
+static void
+_fix16_mul_test(uint32_t iterations)
+{
+        const uint32_t error_count = _results.error_count;
+        const uint32_t edge_count = sizeof(_edge_values) / sizeof(*_edge_values);
+
+        uint32_t case_count;
+        case_count = 0;
+
+        for (uint32_t i = 0; i < (iterations + (edge_count * edge_count)); i++) {
+                FIXED a;
+                FIXED b;
+
+                if (i < (edge_count * edge_count)) {
+                        a = _edge_values[i / edge_count];
+                        b = _edge_values[i % edge_count];
+                } else {
+                        a = _random_fixed_get(1 + (_random_get() % 32));
+                        b = _random_fixed_get(1 + (_random_get() % 32));
+                }
+
+                const FIXED sh2_mul = backend_sh2.fix16_mul(a, b);
+                const FIXED reference_mul = backend_reference.fix16_mul(a, b);
+
+                const int16_t sh2_muls = backend_sh2.fix16_int16_muls(a, b);
+                const int16_t reference_muls = backend_reference.fix16_int16_muls(a, b);
+
+                case_count++;
+
+                if (sh2_mul != reference_mul) {
+                        _mismatch_print("fix16_mul", "%08X * %08X: %08X != %08X",
+                            a, b, sh2_mul, reference_mul);
+                }
+
+                if (sh2_muls != reference_muls) {
+                        _mismatch_print("fix16_int16_muls", "%08X * %08X: %04X != %04X",
+                            a, b, (uint16_t)sh2_muls, (uint16_t)reference_muls);
+                }
+        }
+
+        _results_print("__backend_fix16_mul", case_count, _results.error_count - error_count);
+}
+
+static void
+_divs_test(uint32_t iterations)
+{
+        const uint32_t error_count = _results.error_count;
+        const uint32_t dividend_count = sizeof(_edge_dividends) / sizeof(*_edge_dividends);
+        const uint32_t divisor_count = sizeof(_edge_divisors) / sizeof(*_edge_divisors);
+
+        uint32_t case_count;
+        case_count = 0;
+
+        /* Saturation on overflow and on division by zero, with every
+         * combination of signs */
+        for (uint32_t i = 0; i < dividend_count; i++) {
+                for (uint32_t j = 0; j < divisor_count; j++) {
+                        _divs_compare(_edge_dividends[i], _edge_divisors[j]);
+
+                        case_count++;
+                }
+        }
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                /* Mostly quotients that fit, as with the view distance over Z,
+                 * and some that overflow */
+                const uint32_t bits = 1 + (_random_get() % 63);
+
+                int64_t dividend;
+                dividend = ((int64_t)_random_get() << 32) | _random_get();
+                dividend >>= (64 - bits);
+
+                const FIXED divisor = _random_fixed_get(1 + (_random_get() % 32));
+
+                _divs_compare(dividend, divisor);
+
+                case_count++;
+        }
+
+        _results_print("__backend_divs", case_count, _results.error_count - error_count);
+}
+
+static void
+_divs_compare(int64_t dividend, FIXED divisor)
+{
+        const FIXED sh2 = backend_sh2.divs(dividend, divisor);
+        const FIXED reference = backend_reference.divs(dividend, divisor);
+
+        if (sh2 != reference) {
+                _mismatch_print("divs", "%016" PRIX64 " / %08X: %08X != %08X",
+                    (uint64_t)dividend, divisor, sh2, reference);
+        }
+}
+
+static void
+_vertex_pool_test(uint32_t iterations)
+{
+        const uint32_t error_count = _results.error_count;
+
+        static POINT points[TEST_VERTEX_COUNT];
+
+        FIXED matrix[MTRX];
+
+        vertex_pool_view_t view;
+
+        uint32_t case_count;
+        case_count = 0;
+
+        for (uint32_t i = 0; i < (iterations + 4); i++) {
+                /* Matrices of up to 4.0 in magnitude, with translations of up to
+                 * 512.0 */
+                for (uint32_t j = 0; j < MTRX; j++) {
+                        matrix[j] = _random_fixed_get(19);
+                }
+
+                matrix[M03] = _random_fixed_get(26);
+                matrix[M13] = _random_fixed_get(26);
+                matrix[M23] = _random_fixed_get(26);
+
+                view.view_distance = toFIXED(192.0f) + _random_fixed_get(22);
+                view.near = toFIXED(1.0f) + (_random_get() & 0xFFFF);
+                view.ratio = toFIXED(1.0f) + _random_fixed_get(14);
+
+                uint32_t point_bits;
+                point_bits = 26;
+
+                switch (i) {
+                case 0:
+                        /* Points on and behind the near plane */
+                        matrix[M20] = matrix[M21] = matrix[M22] = 0;
+                        matrix[M23] = -toFIXED(8.0f);
+                        break;
+                case 1:
+                        /* A Z value of the smallest near plane saturates the
+                         * quotient of the view distance over Z */
+                        view.near = 1;
+                        matrix[M20] = matrix[M21] = matrix[M22] = 0;
+                        matrix[M23] = 0;
+                        break;
+                case 2:
+                        /* Negative dividends */
+                        view.view_distance = -view.view_distance;
+                        break;
+                case 3:
+                        /* Sums of products that wrap around the MAC
+                         * register */
+                        for (uint32_t j = 0; j < MTRX; j++) {
+                                matrix[j] = _random_fixed_get(32);
+                        }
+
+                        point_bits = 32;
+                        break;
+                }
+
+                for (uint32_t j = 0; j < TEST_VERTEX_COUNT; j++) {
+                        points[j][X] = _random_fixed_get(point_bits);
+                        points[j][Y] = _random_fixed_get(point_bits);
+                        points[j][Z] = _random_fixed_get(point_bits);
+                }
+
+                _vertex_pool_compare(points, TEST_VERTEX_COUNT, matrix, &view);
+
+                case_count += TEST_VERTEX_COUNT;
+        }
+
+        _results_print("__vertex_pool_transform", case_count, _results.error_count - error_count);
+}
+
+static void
+_vertex_pool_compare(const POINT *points, uint16_t vertex_count,
+    const FIXED *matrix, const vertex_pool_view_t *view)
+{
+        static transform_proj_t sh2_pool[TEST_VERTEX_COUNT];
+        static transform_proj_t reference_pool[TEST_VERTEX_COUNT];
+
+        (void)memset(sh2_pool, 0, sizeof(sh2_pool));
+        (void)memset(reference_pool, 0, sizeof(reference_pool));
+
+        backend_sh2.vertex_pool_transform(points, vertex_count, sh2_pool, matrix, view);
+        backend_reference.vertex_pool_transform(points, vertex_count, reference_pool, matrix, view);
+
+        for (uint32_t i = 0; i < vertex_count; i++) {
+                const transform_proj_t * const sh2 = &sh2_pool[i];
+                const transform_proj_t * const reference = &reference_pool[i];
+
+                if ((sh2->point_z != reference->point_z) ||
+                    (sh2->screen.x != reference->screen.x) ||
+                    (sh2->screen.y != reference->screen.y) ||
+                    (sh2->clip_flags != reference->clip_flags)) {
+                        _mismatch_print("vertex_pool_transform",
+                            "(%08X %08X %08X): z=%08X (%d,%d) %02X != z=%08X (%d,%d) %02X",
+                            points[i][X], points[i][Y], points[i][Z],
+                            sh2->point_z, sh2->screen.x, sh2->screen.y,
+                            sh2->clip_flags,
+                            reference->point_z, reference->screen.x,
+                            reference->screen.y, reference->clip_flags);
+                }
+        }
+}
+
+static void
+_mismatch_print(const char *test, const char *format, ...)
+{
+        _results.error_count++;
+
+        /* Only the first few are of any use */
+        if (_results.error_count > 16) {
+                return;
+        }
+
+        va_list args;
+
+        va_start(args, format);
+
+        (void)fprintf(stderr, "Error: %s: %s: ", PROGNAME, test);
+        (void)vfprintf(stderr, format, args);
+        (void)fprintf(stderr, "\n");
+
+        va_end(args);
+}
+
+/* xorshift64, so that runs can be repeated with -s */
+static uint32_t
+_random_get(void)
+{
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 7;
+        _seed ^= _seed << 17;
+
+        return (uint32_t)(_seed >> 32);
+}
+
+/* A signed value of the given number of bits */
+static FIXED
+_random_fixed_get(uint32_t bits)
+{
+        const int32_t value = (int32_t)_random_get();
+
+        if (bits >= 32) {
+                return value;
+        }
+
+        return (value >> (32 - bits));
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The on-chip registers are backed by an array. The divider is modelled by
+ * __backend_divu_quotient_get() in g3d_backend_test.c */
+
+#ifndef _G3D_BACKEND_TEST_HOST_CPU_MAP_H_
+#define _G3D_BACKEND_TEST_HOST_CPU_MAP_H_
+
+#include <stdint.h>
+
+#define CPU_REGS_SIZE   (0x1000UL)
+
+#define DVSR            0x0F00UL
+#define DVDNTH          0x0F10UL
+#define DVDNTL          0x0F14UL
+
+extern uint32_t __host_cpu_regs[CPU_REGS_SIZE / 4];
+
+#define CPU(x)          ((uintptr_t)&__host_cpu_regs[(x) / 4])
+
+#endif /* !_G3D_BACKEND_TEST_HOST_CPU_MAP_H_ */
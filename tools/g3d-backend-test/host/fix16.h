@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Models the DMULS.L based fix16 multiplies of libyaul's <fix16.h> */
+
+#ifndef _G3D_BACKEND_TEST_HOST_FIX16_H_
+#define _G3D_BACKEND_TEST_HOST_FIX16_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+typedef int32_t fix16_t;
+
+/* DMULS.L, then STS MACH. Only the lower 16-bits of MACH are kept */
+static inline int16_t __always_inline
+fix16_int16_muls(const fix16_t a, const fix16_t b)
+{
+        const uint64_t mac = (uint64_t)((int64_t)a * b);
+
+        return (int16_t)(uint16_t)(uint32_t)(mac >> 32);
+}
+
+/* DMULS.L, then XTRCT MACH, MACL */
+static inline fix16_t __always_inline
+fix16_mul(const fix16_t a, const fix16_t b)
+{
+        const uint64_t mac = (uint64_t)((int64_t)a * b);
+
+        const uint32_t mach = (uint32_t)(mac >> 32);
+        const uint32_t macl = (uint32_t)mac;
+
+        return (fix16_t)((mach << 16) | (macl >> 16));
+}
+
+#endif /* !_G3D_BACKEND_TEST_HOST_FIX16_H_ */
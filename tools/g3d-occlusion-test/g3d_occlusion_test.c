@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "g3d_occlusion_test"
+
+/* Number of random scenes for each test by default */
+#define TEST_ITERATIONS_DEFAULT 10000
+
+/* Occluder polygons in each scene, and the bounds tested against them */
+#define TEST_POLYGON_COUNT_MAX  (4)
+#define TEST_BOUNDS_COUNT       (8)
+
+/* Largest distance of a polygon's vertices from its center */
+#define TEST_POLYGON_SPAN_MAX   (160)
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "occlusion-internal.h"
+
+typedef enum {
+        SHAPE_CONVEX,
+        SHAPE_CONCAVE
+} shape_t;
+
+typedef struct {
+        int16_t sw_2;
+        int16_t sh_2;
+} screen_t;
+
+static const screen_t _screens[] = {
+        { 160, 112 },
+        { 160, 120 },
+        { 176, 120 },
+        { 320, 224 },
+        { 352, 256 }
+};
+
+#define SCREEN_COUNT (sizeof(_screens) / sizeof(*_screens))
+
+static struct {
+        uint32_t error_count;
+} _results;
+
+static uint64_t _seed = 1;
+
+static occlusion_grid_t _grid;
+
+/* Tiles as the reference rasterizer sees them */
+static FIXED _reference_tiles[OCCLUSION_GRID_HEIGHT][OCCLUSION_GRID_WIDTH];
+
+static transform_proj_t _projs[TEST_POLYGON_COUNT_MAX][4];
+
+static void _usage_print(void);
+static void _results_print(const char *test, uint32_t case_count,
+    uint32_t error_count);
+
+static void _coverage_test(uint32_t iterations, shape_t shape);
+static void _bounds_test(uint32_t iterations);
+static void _scene_build(const screen_t *screen, shape_t shape);
+
+static void _polygon_generate(const screen_t *screen, shape_t shape,
+    transform_proj_t *polygon);
+static bool _polygon_convex(const int16_vec2_t *screens);
+
+static void _reference_polygon_add(const transform_proj_t *polygon);
+static bool _reference_tile_covered(const int16_vec2_t *screens, int32_t x0,
+    int32_t y0);
+static bool _reference_point_inside(const int16_vec2_t *screens, int32_t x,
+    int32_t y);
+static bool _reference_test(const int16_t *min, const int16_t *max,
+    FIXED near_z);
+static FIXED _tiles_z_max_get(const int16_t *min, const int16_t *max);
+
+static void _mismatch_print(const char *test, const char *format, ...)
+    __attribute__ ((format(printf, 2, 3)));
+
+static uint32_t _random_get(void);
+static int32_t _random_range_get(int32_t low, int32_t high);
+
+int
+main(int argc, char *argv[])
+{
+        uint32_t iterations = TEST_ITERATIONS_DEFAULT;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+                switch (opt) {
+                case 'n':
+                        iterations = strtoul(optarg, NULL, 0);
+                        break;
+                case 's':
+                        _seed = strtoull(optarg, NULL, 0);
+                        break;
+                default:
+                        _usage_print();
+
+                        return 1;
+                }
+        }
+
+        if ((iterations == 0) || (_seed == 0) || (argc != optind)) {
+                _usage_print();
+
+                return 1;
+        }
+
+        (void)printf("Test                           Cases  Mismatches\n");
+
+        _coverage_test(iterations, SHAPE_CONVEX);
+        _coverage_test(iterations, SHAPE_CONCAVE);
+        _bounds_test(iterations);
+
+        return ((_results.error_count > 0) ? 1 : 0);
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-n iterations] [-s seed]\n", PROGNAME);
+        (void)fprintf(stderr, "Check the max-Z tiles of libg3d's occlusion culling against a reference\n"
+                              "rasterizer that tests every pixel of every tile\n");
+}
+
+static void
+_results_print(const char *test, uint32_t case_count, uint32_t error_count)
+{
+        (void)printf("%-24s %11" PRIu32 " %11" PRIu32 "\n", test, case_count,
+            error_count);
+}
+
+/* For convex polygons, a tile is covered when all four of its corners are, so
+ * the tiles must match the reference exactly. Concave polygons are only
+ * expected to never cover more than they do */
+static void
+_coverage_test(uint32_t iterations, shape_t shape)
+{
+        const char * const test =
+            (shape == SHAPE_CONVEX) ? "Convex tiles" : "Concave tiles";
+
+        const uint32_t error_count = _results.error_count;
+
+        uint32_t case_count;
+        case_count = 0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                const screen_t * const screen = &_screens[_random_get() % SCREEN_COUNT];
+
+                _scene_build(screen, shape);
+
+                for (uint32_t y = 0; y < _grid.height; y++) {
+                        for (uint32_t x = 0; x < _grid.width; x++) {
+                                const FIXED z = _grid.tiles[y][x];
+                                const FIXED reference_z = _reference_tiles[y][x];
+
+                                case_count++;
+
+                                if ((shape == SHAPE_CONVEX) && (z != reference_z)) {
+                                        _mismatch_print(test,
+                                            "Tile (%" PRIu32 ",%" PRIu32 "): %08X != %08X",
+                                            x, y, z, reference_z);
+                                } else if (z < reference_z) {
+                                        _mismatch_print(test,
+                                            "Tile (%" PRIu32 ",%" PRIu32 ") isn't fully covered",
+                                            x, y);
+                                }
+                        }
+                }
+        }
+
+        _results_print(test, case_count, _results.error_count - error_count);
+}
+
+static void
+_bounds_test(uint32_t iterations)
+{
+        const char * const test = "__occlusion_grid_test";
+
+        const uint32_t error_count = _results.error_count;
+
+        uint32_t case_count;
+        case_count = 0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+                const screen_t * const screen = &_screens[_random_get() % SCREEN_COUNT];
+
+                _scene_build(screen, SHAPE_CONVEX);
+
+                for (uint32_t j = 0; j < TEST_BOUNDS_COUNT; j++) {
+                        int16_t min[2];
+                        int16_t max[2];
+
+                        min[X] = _random_range_get(-screen->sw_2 - 64, screen->sw_2 + 32);
+                        min[Y] = _random_range_get(-screen->sh_2 - 64, screen->sh_2 + 32);
+                        max[X] = min[X] + _random_range_get(0, ((j & 1) != 0) ? 128 : 24);
+                        max[Y] = min[Y] + _random_range_get(0, ((j & 1) != 0) ? 128 : 24);
+
+                        /* Half of the bounds are placed right around the
+                         * farthest tile they overlap, where being hidden
+                         * flips */
+                        FIXED near_z = _random_range_get(1, 1100) << 16;
+
+                        if ((j & 2) != 0) {
+                                const FIXED z_max = _tiles_z_max_get(min, max);
+
+                                if ((z_max != INT32_MIN) &&
+                                    (z_max != OCCLUSION_TILE_Z_EMPTY)) {
+                                        near_z = z_max + _random_range_get(-1, 1);
+                                }
+                        }
+
+                        const bool hidden = __occlusion_grid_test(&_grid, min, max, near_z);
+                        const bool reference_hidden = _reference_test(min, max, near_z);
+
+                        case_count++;
+
+                        if (hidden != reference_hidden) {
+                                _mismatch_print(test,
+                                    "(%i,%i)-(%i,%i) at %08X: %i != %i",
+                                    min[X], min[Y], max[X], max[Y], near_z,
+                                    hidden, reference_hidden);
+                        }
+                }
+        }
+
+        _results_print(test, case_count, _results.error_count - error_count);
+}
+
+/* Adds random polygons to both the tiles and the reference tiles. Some
+ * polygons are clipped, and must be left out */
+static void
+_scene_build(const screen_t *screen, shape_t shape)
+{
+        __occlusion_grid_clear(&_grid, screen->sw_2, screen->sh_2);
+
+        for (uint32_t y = 0; y < _grid.height; y++) {
+                for (uint32_t x = 0; x < _grid.width; x++) {
+                        _reference_tiles[y][x] = OCCLUSION_TILE_Z_EMPTY;
+                }
+        }
+
+        const uint32_t polygon_count = 1 + (_random_get() % TEST_POLYGON_COUNT_MAX);
+
+        for (uint32_t i = 0; i < polygon_count; i++) {
+                transform_proj_t * const polygon = _projs[i];
+
+                _polygon_generate(screen, shape, polygon);
+
+                const transform_proj_t * const polygon_ptrs[4] = {
+                        &polygon[0],
+                        &polygon[1],
+                        &polygon[2],
+                        &polygon[3]
+                };
+
+                __occlusion_grid_polygon_add(&_grid, polygon_ptrs);
+
+                _reference_polygon_add(polygon);
+        }
+}
+
+static void
+_polygon_generate(const screen_t *screen, shape_t shape,
+    transform_proj_t *polygon)
+{
+        int16_vec2_t screens[4];
+
+        const int32_t center_x = _random_range_get(-screen->sw_2 - 32, screen->sw_2 + 32);
+        const int32_t center_y = _random_range_get(-screen->sh_2 - 32, screen->sh_2 + 32);
+        const int32_t span = _random_range_get(1, TEST_POLYGON_SPAN_MAX);
+
+        /* Random points are tried until they form a convex polygon, in one of
+         * the three orders four points can be joined in */
+        while (true) {
+                int16_vec2_t points[4];
+
+                for (uint32_t i = 0; i < 4; i++) {
+                        points[i].x = center_x + _random_range_get(-span, span);
+                        points[i].y = center_y + _random_range_get(-span, span);
+                }
+
+                static const uint8_t orders[3][4] = {
+                        { 0, 1, 2, 3 },
+                        { 0, 1, 3, 2 },
+                        { 0, 2, 1, 3 }
+                };
+
+                bool convex = false;
+
+                for (uint32_t order = 0; (order < 3) && !convex; order++) {
+                        for (uint32_t i = 0; i < 4; i++) {
+                                screens[i] = points[orders[order][i]];
+                        }
+
+                        convex = _polygon_convex(screens);
+                }
+
+                if (convex) {
+                        break;
+                }
+        }
+
+        /* Pull the third vertex into the triangle of the other three, which
+         * keeps the polygon simple */
+        if (shape == SHAPE_CONCAVE) {
+                const int32_t mid_x = (screens[1].x + screens[3].x) / 2;
+                const int32_t mid_y = (screens[1].y + screens[3].y) / 2;
+                const int32_t weight = _random_range_get(1, 6);
+
+                screens[2].x = mid_x + (((screens[0].x - mid_x) * weight) / 8);
+                screens[2].y = mid_y + (((screens[0].y - mid_y) * weight) / 8);
+        }
+
+        /* Either winding order */
+        const bool reverse = ((_random_get() & 1) != 0);
+
+        for (uint32_t i = 0; i < 4; i++) {
+                transform_proj_t * const proj = &polygon[i];
+
+                proj->screen = screens[reverse ? (3 - i) : i];
+                proj->point_z = _random_range_get(1, 1000) << 16;
+                proj->clip_flags = CLIP_FLAGS_NONE;
+        }
+
+        if ((_random_get() % 8) == 0) {
+                polygon[_random_get() & 3].clip_flags = CLIP_FLAGS_NEAR;
+        }
+}
+
+static bool
+_polygon_convex(const int16_vec2_t *screens)
+{
+        int32_t sign = 0;
+
+        for (uint32_t i = 0; i < 4; i++) {
+                const int16_vec2_t * const a = &screens[i];
+                const int16_vec2_t * const b = &screens[(i + 1) & 3];
+                const int16_vec2_t * const c = &screens[(i + 2) & 3];
+
+                const int32_t cross =
+                    ((b->x - a->x) * (c->y - b->y)) - ((b->y - a->y) * (c->x - b->x));
+
+                if (cross == 0) {
+                        return false;
+                }
+
+                if ((sign != 0) && ((cross > 0) != (sign > 0))) {
+                        return false;
+                }
+
+                sign = cross;
+        }
+
+        return true;
+}
+
+static void
+_reference_polygon_add(const transform_proj_t *polygon)
+{
+        FIXED max_z = polygon[0].point_z;
+
+        int16_vec2_t screens[4];
+
+        for (uint32_t i = 0; i < 4; i++) {
+                if (polygon[i].clip_flags != CLIP_FLAGS_NONE) {
+                        return;
+                }
+
+                screens[i] = polygon[i].screen;
+
+                max_z = (polygon[i].point_z > max_z) ? polygon[i].point_z : max_z;
+        }
+
+        for (uint32_t y = 0; y < _grid.height; y++) {
+                for (uint32_t x = 0; x < _grid.width; x++) {
+                        if (_reference_tiles[y][x] <= max_z) {
+                                continue;
+                        }
+
+                        const int32_t x0 = _grid.origin_x + (x * OCCLUSION_TILE_SIZE);
+                        const int32_t y0 = _grid.origin_y + (y * OCCLUSION_TILE_SIZE);
+
+                        if ((_reference_tile_covered(screens, x0, y0))) {
+                                _reference_tiles[y][x] = max_z;
+                        }
+                }
+        }
+}
+
+static bool
+_reference_tile_covered(const int16_vec2_t *screens, int32_t x0, int32_t y0)
+{
+        for (int32_t y = y0; y < (y0 + OCCLUSION_TILE_SIZE); y++) {
+                for (int32_t x = x0; x < (x0 + OCCLUSION_TILE_SIZE); x++) {
+                        if (!(_reference_point_inside(screens, x, y))) {
+                                return false;
+                        }
+                }
+        }
+
+        return true;
+}
+
+/* Crossing number test. Pixels on an edge are inside */
+static bool
+_reference_point_inside(const int16_vec2_t *screens, int32_t x, int32_t y)
+{
+        bool inside = false;
+
+        for (uint32_t i = 0; i < 4; i++) {
+                const int16_vec2_t * const a = &screens[i];
+                const int16_vec2_t * const b = &screens[(i + 1) & 3];
+
+                const int32_t min_x = (a->x < b->x) ? a->x : b->x;
+                const int32_t max_x = (a->x > b->x) ? a->x : b->x;
+                const int32_t min_y = (a->y < b->y) ? a->y : b->y;
+                const int32_t max_y = (a->y > b->y) ? a->y : b->y;
+
+                const int64_t cross = ((int64_t)(b->x - a->x) * (y - a->y)) -
+                                      ((int64_t)(b->y - a->y) * (x - a->x));
+
+                if ((cross == 0) &&
+                    (x >= min_x) && (x <= max_x) && (y >= min_y) && (y <= max_y)) {
+                        return true;
+                }
+
+                if ((a->y > y) == (b->y > y)) {
+                        continue;
+                }
+
+                /* Is the pixel left of where the edge crosses its row? */
+                const int64_t lhs = (int64_t)(x - a->x) * (b->y - a->y);
+                const int64_t rhs = (int64_t)(y - a->y) * (b->x - a->x);
+
+                if ((b->y > a->y) ? (lhs < rhs) : (lhs > rhs)) {
+                        inside = !inside;
+                }
+        }
+
+        return inside;
+}
+
+/* Hidden when every pixel of the bounds that's on the grid is in a tile that's
+ * nearer than near_z */
+static bool
+_reference_test(const int16_t *min, const int16_t *max, FIXED near_z)
+{
+        const FIXED z_max = _tiles_z_max_get(min, max);
+
+        return ((z_max != INT32_MIN) && (z_max < near_z));
+}
+
+/* Farthest tile under any pixel of the bounds, or INT32_MIN when none of the
+ * bounds are on the grid */
+static FIXED
+_tiles_z_max_get(const int16_t *min, const int16_t *max)
+{
+        FIXED z_max = INT32_MIN;
+
+        for (int32_t y = min[Y]; y <= max[Y]; y++) {
+                for (int32_t x = min[X]; x <= max[X]; x++) {
+                        const int32_t tile_x = (x - _grid.origin_x) / OCCLUSION_TILE_SIZE;
+                        const int32_t tile_y = (y - _grid.origin_y) / OCCLUSION_TILE_SIZE;
+
+                        if ((x < _grid.origin_x) || (tile_x >= _grid.width) ||
+                            (y < _grid.origin_y) || (tile_y >= _grid.height)) {
+                                continue;
+                        }
+
+                        const FIXED z = _grid.tiles[tile_y][tile_x];
+
+                        z_max = (z > z_max) ? z : z_max;
+                }
+        }
+
+        return z_max;
+}
+
+static void
+_mismatch_print(const char *test, const char *format, ...)
+{
+        _results.error_count++;
+
+        /* Only the first few are of any use */
+        if (_results.error_count > 16) {
+                return;
+        }
+
+        va_list args;
+
+        va_start(args, format);
+
+        (void)fprintf(stderr, "Error: %s: %s: ", PROGNAME, test);
+        (void)vfprintf(stderr, format, args);
+        (void)fprintf(stderr, "\n");
+
+        va_end(args);
+}
+
+/* xorshift64, so that runs can be repeated with -s */
+static uint32_t
+_random_get(void)
+{
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 7;
+        _seed ^= _seed << 17;
+
+        return (uint32_t)(_seed >> 32);
+}
+
+/* A value in [low, high] */
+static int32_t
+_random_range_get(int32_t low, int32_t high)
+{
+        return low + (int32_t)(_random_get() % (uint32_t)(high - low + 1));
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what the occlusion tiles expect from libyaul's <fix16.h> */
+
+#ifndef _G3D_OCCLUSION_TEST_HOST_FIX16_H_
+#define _G3D_OCCLUSION_TEST_HOST_FIX16_H_
+
+#include <stdint.h>
+
+#define FIX16_MAX       (0x7FFFFFFF)
+
+typedef int32_t fix16_t;
+
+#endif /* !_G3D_OCCLUSION_TEST_HOST_FIX16_H_ */
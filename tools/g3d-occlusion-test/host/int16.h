@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what the libg3d sources expect from libyaul's <int16.h> */
+
+#ifndef _G3D_OCCLUSION_TEST_HOST_INT16_H_
+#define _G3D_OCCLUSION_TEST_HOST_INT16_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+typedef struct {
+        int16_t x;
+        int16_t y;
+} __aligned(4) int16_vec2_t;
+
+#endif /* !_G3D_OCCLUSION_TEST_HOST_INT16_H_ */
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Stands in for the parts of libyaul that libg3d calls into: the slave CPU,
+ * the FRT, the VDP1 transfer of the orderlist, and the VDP1 VRAM partitions */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <cpu/dual.h>
+#include <cpu/frt.h>
+
+#include <vdp.h>
+
+/* Same as the default VDP1 VRAM partitions of libyaul, which start after the
+ * one command table libyaul keeps */
+#define VRAM_CMDT_BASE          (sizeof(vdp1_cmdt_t))
+#define VRAM_CMDT_SIZE          (2048 * sizeof(vdp1_cmdt_t))
+#define VRAM_TEXTURE_SIZE       (0x0006BFE0)
+
+static struct {
+        cpu_dual_slave_entry_t slave_entry;
+        pthread_t slave_thread;
+        bool slave_started;
+
+        uint16_t frt_count;
+        cpu_frt_ihr_t frt_ovi;
+
+        callback_handler_t put_handler;
+        void *put_work;
+        const vdp1_cmdt_orderlist_t *orderlist;
+
+        uint32_t dma_count;
+} _state;
+
+static _Thread_local cpu_which_t _executor = CPU_MASTER;
+
+static void *_slave_thread(void *arg);
+
+void
+cpu_dual_slave_set(cpu_dual_slave_entry_t entry)
+{
+        __host_cpu_dual_slave_wait();
+
+        _state.slave_entry = entry;
+}
+
+void
+cpu_dual_slave_notify(void)
+{
+        /* On the target, a notification is missed while the slave CPU is
+         * still busy. libg3d never notifies it before it's done */
+        __host_cpu_dual_slave_wait();
+
+        if (_state.slave_entry == NULL) {
+                return;
+        }
+
+        const int ret = pthread_create(&_state.slave_thread, NULL,
+            _slave_thread, _state.slave_entry);
+
+        assert(ret == 0);
+
+        _state.slave_started = true;
+}
+
+cpu_which_t
+cpu_dual_executor_get(void)
+{
+        return _executor;
+}
+
+void
+__host_cpu_dual_slave_wait(void)
+{
+        if (!_state.slave_started) {
+                return;
+        }
+
+        (void)pthread_join(_state.slave_thread, NULL);
+
+        _state.slave_started = false;
+}
+
+void
+cpu_frt_init(uint8_t clock_div __unused)
+{
+        _state.frt_count = 0;
+        _state.frt_ovi = NULL;
+}
+
+void
+cpu_frt_ovi_set(cpu_frt_ihr_t ihr)
+{
+        _state.frt_ovi = ihr;
+}
+
+void
+cpu_frt_interrupt_priority_set(uint8_t priority __unused)
+{
+}
+
+void
+cpu_frt_count_set(uint16_t count)
+{
+        _state.frt_count = count;
+}
+
+uint16_t
+cpu_frt_count_get(void)
+{
+        return _state.frt_count;
+}
+
+void
+vdp1_vram_partitions_get(vdp1_vram_partitions_t *vram_partitions)
+{
+        vram_partitions->cmdt_base = (vdp1_cmdt_t *)VDP1_VRAM(VRAM_CMDT_BASE);
+        vram_partitions->cmdt_size = VRAM_CMDT_SIZE;
+
+        vram_partitions->texture_base =
+            (void *)VDP1_VRAM(VRAM_CMDT_BASE + VRAM_CMDT_SIZE);
+        vram_partitions->texture_size = VRAM_TEXTURE_SIZE;
+
+        vram_partitions->gouraud_base = NULL;
+        vram_partitions->gouraud_size = 0;
+
+        vram_partitions->clut_base = NULL;
+        vram_partitions->clut_size = 0;
+
+        vram_partitions->remaining_base = NULL;
+        vram_partitions->remaining_size = 0;
+}
+
+/* The transfer ends right away */
+void
+vdp1_sync_cmdt_orderlist_put(const vdp1_cmdt_orderlist_t *cmdt_orderlist)
+{
+        _state.orderlist = cmdt_orderlist;
+
+        if (_state.put_handler != NULL) {
+                _state.put_handler(_state.put_work);
+        }
+}
+
+void
+vdp1_sync_put_set(callback_handler_t callback_handler, void *work)
+{
+        _state.put_handler = callback_handler;
+        _state.put_work = work;
+}
+
+const vdp1_cmdt_orderlist_t *
+__host_vdp1_orderlist_get(void)
+{
+        const vdp1_cmdt_orderlist_t * const orderlist = _state.orderlist;
+
+        _state.orderlist = NULL;
+
+        return orderlist;
+}
+
+void
+vdp2_tvmd_display_res_get(uint16_t *width, uint16_t *height)
+{
+        *width = 320;
+        *height = 224;
+}
+
+void
+vdp_dma_enqueue(void *dst __unused, const void *src __unused,
+    size_t len __unused)
+{
+        _state.dma_count++;
+}
+
+uint32_t
+__host_vdp_dma_count_get(void)
+{
+        const uint32_t dma_count = _state.dma_count;
+
+        _state.dma_count = 0;
+
+        return dma_count;
+}
+
+static void *
+_slave_thread(void *arg)
+{
+        const cpu_dual_slave_entry_t entry = arg;
+
+        _executor = CPU_SLAVE;
+
+        entry();
+
+        return NULL;
+}
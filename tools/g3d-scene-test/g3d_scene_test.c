@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#define PROGNAME "g3d_scene_test"
+
+/* Orderlist entries before the offset passed to g3d_start(), which libg3d
+ * must leave alone */
+#define ORDERLIST_OFFSET        (2)
+
+/* Same as the command tables in the VDP1 VRAM partition */
+#define CMDT_COUNT              (2048)
+
+#define ORDERLIST_COUNT         (ORDERLIST_OFFSET + CMDT_COUNT + 1)
+
+#define LINE_SIZE_MAX           (256)
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cpu/dual.h>
+#include <cpu/frt.h>
+
+#include <vdp.h>
+
+#include "g3d.h"
+
+#include "scenes.h"
+
+static vdp1_cmdt_orderlist_t _orderlist[ORDERLIST_COUNT];
+static vdp1_cmdt_t _cmdts[CMDT_COUNT];
+
+/* Stand for what is put in the orderlist before libg3d's command tables */
+static vdp1_cmdt_t _offset_cmdts[ORDERLIST_OFFSET];
+
+/* Command tables the orderlist of the frame points to */
+static bool _cmdt_used[CMDT_COUNT];
+static bool _baked_cmdt_used[SCENE_BAKED_CMDT_COUNT];
+
+/* As g3d_init() left it */
+static g3d_info_t _info;
+
+static uint32_t _error_count;
+
+static void _usage_print(void);
+static bool _scene_test(const scene_t *scene, const char *path, bool record,
+    bool slave);
+static void _scene_run(const scene_t *scene, FILE *fp);
+static void _frame_run(const scene_t *scene, uint32_t frame, FILE *fp);
+static void _frame_orderlist_write(const scene_t *scene,
+    const g3d_results_t *results, FILE *fp);
+static bool _scene_compare(const scene_t *scene, FILE *fp, const char *path);
+static void _g3d_reset(void);
+static void _error_print(const scene_t *scene, const char *message);
+
+int
+main(int argc, char *argv[])
+{
+        bool record = false;
+
+        if ((argc == 3) && ((strcmp(argv[1], "-r")) == 0)) {
+                record = true;
+        } else if (argc != 2) {
+                _usage_print();
+
+                return 1;
+        }
+
+        const char * const directory = argv[argc - 1];
+
+        g3d_init();
+        g3d_info_get(&_info);
+
+        (void)printf("Scene         Result\n");
+
+        for (uint32_t i = 0; i < scene_count; i++) {
+                const scene_t * const scene = &scenes[i];
+
+                char path[FILENAME_MAX];
+
+                (void)snprintf(path, sizeof(path), "%s/%s.txt", directory,
+                    scene->name);
+
+                bool passed;
+                passed = _scene_test(scene, path, record, false);
+
+                /* Drawn again with the slave CPU taking half of the work of
+                 * the larger objects, against what was just recorded */
+                if ((scene->flags & SCENE_FLAGS_SLAVE) != SCENE_FLAGS_NONE) {
+                        passed = (_scene_test(scene, path, false, true)) && passed;
+                }
+
+                (void)printf("%-12s  %s\n", scene->name,
+                    (passed ? (record ? "Recorded" : "Pass") : "Fail"));
+        }
+
+        __host_cpu_dual_slave_wait();
+
+        if (_error_count > 0) {
+                (void)fprintf(stderr, "\n%" PRIu32 " errors\n", _error_count);
+
+                return 1;
+        }
+
+        return 0;
+}
+
+static void
+_usage_print(void)
+{
+        (void)fprintf(stderr, "Usage: %s [-r] directory\n", PROGNAME);
+        (void)fprintf(stderr, "Draw scenes with libg3d, and compare the command tables and orderlist of\n"
+                              "each frame with those recorded in directory. With -r, record them\n"
+                              "instead\n");
+}
+
+static bool
+_scene_test(const scene_t *scene, const char *path, bool record, bool slave)
+{
+        const uint32_t error_count = _error_count;
+
+        FILE * const fp = (record) ? fopen(path, "w") : tmpfile();
+
+        if (fp == NULL) {
+                _error_print(scene, "Couldn't open file to write the frames to");
+
+                return false;
+        }
+
+        _g3d_reset();
+
+        if (slave) {
+                g3d_slave_enable();
+        }
+
+        if (scene->setup != NULL) {
+                scene->setup();
+        }
+
+        _scene_run(scene, fp);
+
+        if (!record) {
+                if (!(_scene_compare(scene, fp, path))) {
+                        _error_print(scene, (slave)
+                            ? "Frames drawn with the slave CPU don't match those recorded"
+                            : "Frames don't match those recorded");
+                }
+        }
+
+        (void)fclose(fp);
+
+        return (_error_count == error_count);
+}
+
+static void
+_scene_run(const scene_t *scene, FILE *fp)
+{
+        (void)fprintf(fp, "scene %s\n", scene->name);
+
+        for (uint32_t frame = 0; frame < scene->frame_count; frame++) {
+                _frame_run(scene, frame, fp);
+        }
+}
+
+static void
+_frame_run(const scene_t *scene, uint32_t frame, FILE *fp)
+{
+        (void)memset(_orderlist, 0, sizeof(_orderlist));
+        (void)memset(_cmdts, 0, sizeof(_cmdts));
+
+        for (uint32_t i = 0; i < ORDERLIST_OFFSET; i++) {
+                _orderlist[i].cmdt = &_offset_cmdts[i];
+        }
+
+        (void)__host_vdp_dma_count_get();
+
+        /* The frame takes as long as the FRT count is at g3d_finish() */
+        cpu_frt_count_set(0);
+
+        g3d_start(_orderlist, ORDERLIST_OFFSET, _cmdts);
+
+        scene->frame(frame);
+
+        cpu_frt_count_set(scene->frame_ticks);
+
+        g3d_results_t results;
+
+        g3d_finish(&results);
+
+        if ((__host_vdp1_orderlist_get()) != _orderlist) {
+                _error_print(scene, "Orderlist wasn't put to VDP1");
+        }
+
+        (void)fprintf(fp, "frame %" PRIu32 "\n", frame);
+        (void)fprintf(fp, "  objects %u polygons %u occluded %u %u lod",
+            results.object_count, results.polygon_count,
+            results.occluded_object_count, results.occluded_polygon_count);
+
+        for (uint32_t i = 0; i < G3D_LOD_LEVEL_COUNT; i++) {
+                (void)fprintf(fp, " %u", results.lod_counts[i]);
+        }
+
+        (void)fprintf(fp, " bias %08" PRIX32 "\n", (uint32_t)results.lod_bias);
+
+        if ((scene->flags & SCENE_FLAGS_QUALITY) != SCENE_FLAGS_NONE) {
+                g3d_quality_status_t status;
+                g3d_info_t info;
+
+                g3d_quality_status_get(&status);
+                g3d_info_get(&info);
+
+                (void)fprintf(fp, "  quality load %" PRIu32 " action %u over %u under %u"
+                    " far %08" PRIX32 " fog %08" PRIX32 " near %08" PRIX32 " level %u\n",
+                    status.load_ticks, status.action, status.over_count,
+                    status.under_count, (uint32_t)status.far,
+                    (uint32_t)status.fog_start_z, (uint32_t)info.near,
+                    status.display_level);
+        }
+
+        if ((scene->flags & SCENE_FLAGS_TCACHE) != SCENE_FLAGS_NONE) {
+                g3d_tcache_stats_t stats;
+
+                g3d_tcache_stats_get(&stats);
+
+                (void)fprintf(fp, "  tcache hits %" PRIu32 " misses %" PRIu32
+                    " evictions %" PRIu32 " overflows %" PRIu32 " skipped %" PRIu32
+                    " resident %u/%u dma %" PRIu32 "\n",
+                    stats.hit_count, stats.miss_count, stats.eviction_count,
+                    stats.overflow_count, stats.skipped_polygon_count,
+                    stats.resident_count, stats.slot_count,
+                    __host_vdp_dma_count_get());
+        }
+
+        _frame_orderlist_write(scene, &results, fp);
+}
+
+/* Write the command tables in the order they're drawn. Which command table of
+ * the frame each polygon took up isn't written, as it changes with the slave
+ * CPU */
+static void
+_frame_orderlist_write(const scene_t *scene, const g3d_results_t *results,
+    FILE *fp)
+{
+        (void)memset(_cmdt_used, 0, sizeof(_cmdt_used));
+        (void)memset(_baked_cmdt_used, 0, sizeof(_baked_cmdt_used));
+
+        for (uint32_t i = 0; i < ORDERLIST_OFFSET; i++) {
+                if (_orderlist[i].cmdt != &_offset_cmdts[i]) {
+                        _error_print(scene, "Orderlist before the offset was written to");
+                }
+        }
+
+        if ((results->polygon_count < ORDERLIST_OFFSET) ||
+            (results->polygon_count >= ORDERLIST_COUNT)) {
+                _error_print(scene, "Orderlist is out of bounds");
+
+                return;
+        }
+
+        for (uint32_t i = ORDERLIST_OFFSET; i < results->polygon_count; i++) {
+                const vdp1_cmdt_t * const cmdt = _orderlist[i].cmdt;
+
+                const uintptr_t cmdt_index = cmdt - _cmdts;
+                const uintptr_t baked_index = cmdt - scene_baked_cmdts;
+
+                char source[16];
+
+                if (cmdt_index < CMDT_COUNT) {
+                        if (_cmdt_used[cmdt_index]) {
+                                _error_print(scene, "Command table is drawn twice");
+                        }
+
+                        _cmdt_used[cmdt_index] = true;
+
+                        (void)snprintf(source, sizeof(source), "cmdt");
+                } else if (baked_index < SCENE_BAKED_CMDT_COUNT) {
+                        if (_baked_cmdt_used[baked_index]) {
+                                _error_print(scene, "Baked command table is drawn twice");
+                        }
+
+                        _baked_cmdt_used[baked_index] = true;
+
+                        (void)snprintf(source, sizeof(source), "baked %u",
+                            (unsigned int)baked_index);
+                } else {
+                        _error_print(scene, "Orderlist points outside of the command tables");
+
+                        return;
+                }
+
+                (void)fprintf(fp, "  %4" PRIu32 " %-8s ctrl %04X link %04X pmod %04X"
+                    " colr %04X srca %04X size %04X grda %04X"
+                    " (%d,%d) (%d,%d) (%d,%d) (%d,%d)\n",
+                    i, source, cmdt->cmd_ctrl, cmdt->cmd_link, cmdt->cmd_pmod,
+                    cmdt->cmd_colr, cmdt->cmd_srca, cmdt->cmd_size,
+                    cmdt->cmd_grda, cmdt->cmd_xa, cmdt->cmd_ya, cmdt->cmd_xb,
+                    cmdt->cmd_yb, cmdt->cmd_xc, cmdt->cmd_yc, cmdt->cmd_xd,
+                    cmdt->cmd_yd);
+        }
+
+        /* The transfer ends on the entry after the last polygon, which points
+         * to a command table that ends drawing */
+        const uintptr_t end = (uintptr_t)_orderlist[results->polygon_count].cmdt;
+        const vdp1_cmdt_t * const end_cmdt =
+            (const vdp1_cmdt_t *)(end & ~VDP1_CMDT_ORDERLIST_END);
+
+        if (((end & VDP1_CMDT_ORDERLIST_END) == 0) ||
+            ((end_cmdt->cmd_ctrl & 0x8000) == 0x0000)) {
+                _error_print(scene, "Orderlist doesn't end after the last polygon");
+        }
+}
+
+/* Compare what was written to fp with the file at path, and print the first
+ * line that differs */
+static bool
+_scene_compare(const scene_t *scene, FILE *fp, const char *path)
+{
+        FILE * const recorded_fp = fopen(path, "r");
+
+        if (recorded_fp == NULL) {
+                _error_print(scene, "Couldn't open the recorded frames");
+
+                return false;
+        }
+
+        rewind(fp);
+
+        char line[LINE_SIZE_MAX];
+        char recorded_line[LINE_SIZE_MAX];
+
+        bool matches = true;
+
+        for (uint32_t line_number = 1; ; line_number++) {
+                const char * const s = fgets(line, sizeof(line), fp);
+                const char * const recorded_s =
+                    fgets(recorded_line, sizeof(recorded_line), recorded_fp);
+
+                if ((s == NULL) && (recorded_s == NULL)) {
+                        break;
+                }
+
+                if ((s != NULL) && (recorded_s != NULL) &&
+                    ((strcmp(line, recorded_line)) == 0)) {
+                        continue;
+                }
+
+                (void)fprintf(stderr, "%s:%" PRIu32 ":\n", path, line_number);
+                (void)fprintf(stderr, "  Recorded: %s", (recorded_s != NULL) ? recorded_line : "(end)\n");
+                (void)fprintf(stderr, "  Drawn:    %s", (s != NULL) ? line : "(end)\n");
+
+                matches = false;
+
+                break;
+        }
+
+        (void)fclose(recorded_fp);
+
+        return matches;
+}
+
+/* Undo what the scenes change */
+static void
+_g3d_reset(void)
+{
+        const POINT position = POStoFIXED(0.0f, 0.0f, 0.0f);
+        const VECTOR rx = POStoFIXED(1.0f, 0.0f, 0.0f);
+        const VECTOR ry = POStoFIXED(0.0f, 1.0f, 0.0f);
+        const VECTOR rz = POStoFIXED(0.0f, 0.0f, 1.0f);
+
+        g3d_slave_disable();
+        g3d_occlusion_disable();
+
+        /* Restores the far plane and display level it changed */
+        g3d_quality_set(NULL);
+
+        g3d_lod_budget_set(0);
+        g3d_lod_bias_set(toFIXED(1.0f));
+
+        g3d_tcache_set(NULL, 0);
+        g3d_tlist_set(NULL, 0);
+        g3d_plist_set(NULL, 0);
+
+        g3d_fog_set(NULL);
+
+        /* The near plane is at the view distance by default, which is further
+         * than where the scenes place most objects */
+        g3d_display_level_set(SCENE_DISPLAY_LEVEL);
+        g3d_far_set(_info.far);
+
+        g3d_frustum_camera_set(position, rx, ry, rz);
+}
+
+static void
+_error_print(const scene_t *scene, const char *message)
+{
+        (void)fprintf(stderr, "Error: %s: %s: %s\n", PROGNAME, scene->name,
+            message);
+
+        _error_count++;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what the libg3d sources expect from libyaul's <color.h>. Bit-fields
+ * are allocated from the least significant bit on the host, so the fields are
+ * in the reverse order to keep the same raw value */
+
+#ifndef _G3D_SCENE_TEST_HOST_COLOR_H_
+#define _G3D_SCENE_TEST_HOST_COLOR_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+typedef union rgb1555 {
+        struct {
+                unsigned int r:5;
+                unsigned int g:5;
+                unsigned int b:5;
+                unsigned int msb:1;
+        } __packed;
+
+        uint16_t raw;
+} __aligned(2) rgb1555_t;
+
+#define RGB1555_INITIALIZER(_msb, _r, _g, _b)                                  \
+    {                                                                          \
+            {                                                                  \
+                _r,                                                            \
+                _g,                                                            \
+                _b,                                                            \
+                _msb                                                           \
+            }                                                                  \
+    }
+
+#define RGB1555(_msb, _r, _g, _b)                                              \
+    ((rgb1555_t)RGB1555_INITIALIZER(_msb, _r, _g, _b))
+
+#endif /* !_G3D_SCENE_TEST_HOST_COLOR_H_ */
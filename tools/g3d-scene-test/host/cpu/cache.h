@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The host keeps the caches coherent. libg3d purges the cache wherever the
+ * other CPU's writes have to be seen, so purging is a full memory barrier */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_CACHE_H_
+#define _G3D_SCENE_TEST_HOST_CPU_CACHE_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+static inline void __always_inline
+cpu_cache_purge(void)
+{
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __always_inline
+cpu_cache_area_purge(void *address __unused, uint32_t len __unused)
+{
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_CACHE_H_ */
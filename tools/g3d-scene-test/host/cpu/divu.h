@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Models the CPU divider with the overflow interrupt disabled. On overflow, or
+ * on a division by zero, the quotient is H'7FFFFFFF or H'80000000 depending on
+ * the signs of the operands */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_DIVU_H_
+#define _G3D_SCENE_TEST_HOST_CPU_DIVU_H_
+
+#include <sys/cdefs.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cpu/instructions.h>
+#include <cpu/map.h>
+
+#include <fix16.h>
+
+/* Each CPU has its own divider */
+static _Thread_local struct {
+        int64_t dividend;
+        int32_t divisor;
+} __host_divu __unused;
+
+static inline uint32_t __always_inline
+cpu_divu_quotient_get(void)
+{
+        const int64_t dividend = __host_divu.dividend;
+        const int32_t divisor = __host_divu.divisor;
+
+        const bool negative = ((dividend < 0) != (divisor < 0));
+
+        if (divisor == 0) {
+                return (negative ? INT32_MIN : INT32_MAX);
+        }
+
+        /* The only quotient that doesn't fit in 64-bits */
+        if ((dividend == INT64_MIN) && (divisor == -1)) {
+                return INT32_MAX;
+        }
+
+        const int64_t quotient = dividend / divisor;
+
+        if ((quotient < INT32_MIN) || (quotient > INT32_MAX)) {
+                return (negative ? INT32_MIN : INT32_MAX);
+        }
+
+        return (uint32_t)(int32_t)quotient;
+}
+
+static inline void __always_inline
+cpu_divu_64_32_set(uint32_t dividendh, uint32_t dividendl, uint32_t divisor)
+{
+        __host_divu.dividend =
+            (int64_t)(((uint64_t)dividendh << 32) | dividendl);
+        __host_divu.divisor = (int32_t)divisor;
+}
+
+static inline void __always_inline
+cpu_divu_fix16_set(fix16_t dividend, fix16_t divisor)
+{
+        const uint32_t dh = cpu_instr_extsw(cpu_instr_swapw(dividend));
+        const uint32_t dl = dividend << 16;
+
+        cpu_divu_64_32_set(dh, dl, divisor);
+}
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_DIVU_H_ */
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The slave CPU is a host thread, started each time the slave CPU is
+ * notified. See g3d_host.c */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_DUAL_H_
+#define _G3D_SCENE_TEST_HOST_CPU_DUAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum cpu_which {
+        CPU_MASTER,
+        CPU_SLAVE
+} cpu_which_t;
+
+typedef void (*cpu_dual_slave_entry_t)(void);
+
+#define cpu_dual_slave_clear()                                                 \
+do {                                                                           \
+        cpu_dual_slave_set(NULL);                                              \
+} while (false)
+
+extern void cpu_dual_slave_set(cpu_dual_slave_entry_t entry);
+extern void cpu_dual_slave_notify(void);
+extern cpu_which_t cpu_dual_executor_get(void);
+
+/* Wait for the slave CPU to return from its entry */
+extern void __host_cpu_dual_slave_wait(void);
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_DUAL_H_ */
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The FRT doesn't count on its own. Scenes set the count to model how long a
+ * frame takes. See g3d_host.c */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_FRT_H_
+#define _G3D_SCENE_TEST_HOST_CPU_FRT_H_
+
+#include <stdint.h>
+
+#define CPU_FRT_CLOCK_DIV_8             0x00
+
+typedef void (*cpu_frt_ihr_t)(void);
+
+extern void cpu_frt_init(uint8_t clock_div);
+extern void cpu_frt_ovi_set(cpu_frt_ihr_t ihr);
+extern void cpu_frt_interrupt_priority_set(uint8_t priority);
+extern void cpu_frt_count_set(uint16_t count);
+extern uint16_t cpu_frt_count_get(void);
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_FRT_H_ */
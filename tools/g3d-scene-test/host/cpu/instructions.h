@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Models the SH-2 instructions used by the libyaul sources built for the host.
+ * MAC.L is modelled with the S bit clear, so the 64-bit MACH:MACL pair wraps
+ * around. Each CPU has its own MACH:MACL pair */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_INSTRUCTIONS_H_
+#define _G3D_SCENE_TEST_HOST_CPU_INSTRUCTIONS_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+static _Thread_local uint64_t __host_mac __unused;
+
+static inline void __always_inline
+cpu_instr_clrmac(void)
+{
+        __host_mac = 0;
+}
+
+/* MAC.L @Rm+, @Rn+ */
+static inline void __always_inline
+cpu_instr_macl(void *a, void *b)
+{
+        const int32_t ** const ap = (const int32_t **)a;
+        const int32_t ** const bp = (const int32_t **)b;
+
+        __host_mac += (uint64_t)((int64_t)**ap * **bp);
+
+        (*ap)++;
+        (*bp)++;
+}
+
+static inline uint32_t __always_inline
+cpu_instr_sts_mach(void)
+{
+        return (uint32_t)(__host_mac >> 32);
+}
+
+static inline uint32_t __always_inline
+cpu_instr_sts_macl(void)
+{
+        return (uint32_t)__host_mac;
+}
+
+/* XTRCT Rm, Rn: the middle 32-bits of Rm:Rn */
+static inline uint32_t __always_inline
+cpu_instr_xtrct(uint32_t rm, uint32_t rn)
+{
+        return ((rm << 16) | (rn >> 16));
+}
+
+static inline uint32_t __always_inline
+cpu_instr_swapw(uint32_t x)
+{
+        return ((x << 16) | (x >> 16));
+}
+
+static inline uint32_t __always_inline
+cpu_instr_extsw(const uint32_t rm)
+{
+        return (uint32_t)(int32_t)(int16_t)(uint16_t)rm;
+}
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_INSTRUCTIONS_H_ */
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The reference transform backend doesn't touch the on-chip registers, and the
+ * divider is modelled in <cpu/divu.h> */
+
+#ifndef _G3D_SCENE_TEST_HOST_CPU_MAP_H_
+#define _G3D_SCENE_TEST_HOST_CPU_MAP_H_
+
+#endif /* !_G3D_SCENE_TEST_HOST_CPU_MAP_H_ */
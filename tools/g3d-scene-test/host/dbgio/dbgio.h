@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* libg3d includes <dbgio/dbgio.h>, but prints nothing */
+
+#ifndef _G3D_SCENE_TEST_HOST_DBGIO_DBGIO_H_
+#define _G3D_SCENE_TEST_HOST_DBGIO_DBGIO_H_
+
+#endif /* !_G3D_SCENE_TEST_HOST_DBGIO_DBGIO_H_ */
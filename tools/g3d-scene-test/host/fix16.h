@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what libg3d expects from libyaul's <fix16.h>. The DMULS.L and MAC.L
+ * based functions are modelled, and the rest of the functions come from the
+ * libyaul sources built for the host */
+
+#ifndef _G3D_SCENE_TEST_HOST_FIX16_H_
+#define _G3D_SCENE_TEST_HOST_FIX16_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+#define FIXMATH_FUNC_ATTRS          __attribute__ ((leaf, nothrow, const))
+#define FIXMATH_FUNC_NONCONST_ATTRS __attribute__ ((leaf, nothrow))
+
+#define FIX16(x) ((fix16_t)(((x) >= 0)                                         \
+        ? ((x) * 65536.0f + 0.5f)                                              \
+        : ((x) * 65536.0f - 0.5f)))
+
+#define FIX16_MAX       (0x7FFFFFFF)
+#define FIX16_MIN       (0x80000000)
+
+#define FIX16_2PI       (0x00064881)
+#define FIX16_PI        (0x00032440)
+#define FIX16_ONE       (0x00010000)
+
+#define FIX16_LUT_SIN_TABLE_COUNT  (1024)
+#define FIX16_LUT_ATAN_TABLE_COUNT (256)
+
+#define FIX16_VEC3_INITIALIZER(x, y, z)                                        \
+    {                                                                          \
+            {                                                                  \
+                    FIX16(x),                                                  \
+                    FIX16(y),                                                  \
+                    FIX16(z)                                                   \
+            }                                                                  \
+    }
+
+typedef int32_t fix16_t;
+
+typedef union fix16_vec3 {
+        struct {
+                fix16_t x;
+                fix16_t y;
+                fix16_t z;
+        };
+
+        fix16_t comp[3];
+} __packed __aligned(4) fix16_vec3_t;
+
+typedef struct fix16_plane {
+        fix16_vec3_t normal;
+        fix16_vec3_t d;
+} __packed __aligned(4) fix16_plane_t;
+
+/* DMULS.L, then STS MACH. Only the lower 16-bits of MACH are kept */
+static inline int16_t __always_inline
+fix16_int16_muls(const fix16_t a, const fix16_t b)
+{
+        const uint64_t mac = (uint64_t)((int64_t)a * b);
+
+        return (int16_t)(uint16_t)(uint32_t)(mac >> 32);
+}
+
+/* DMULS.L, then XTRCT MACH, MACL */
+static inline fix16_t __always_inline
+fix16_mul(const fix16_t a, const fix16_t b)
+{
+        const uint64_t mac = (uint64_t)((int64_t)a * b);
+
+        const uint32_t mach = (uint32_t)(mac >> 32);
+        const uint32_t macl = (uint32_t)mac;
+
+        return (fix16_t)((mach << 16) | (macl >> 16));
+}
+
+static inline fix16_t __always_inline
+fix16_int32_from(int32_t value)
+{
+        return (value * FIX16_ONE);
+}
+
+static inline int32_t __always_inline
+fix16_int32_to(const fix16_t value)
+{
+        return (value >> 16);
+}
+
+static inline fix16_t __always_inline
+fix16_fractional(const fix16_t value)
+{
+        return (value & 0x0000FFFF);
+}
+
+static inline fix16_t __always_inline
+fix16_abs(const fix16_t value)
+{
+        return ((value < 0) ? -value : value);
+}
+
+static inline void __always_inline
+fix16_vec3_sub(const fix16_vec3_t * __restrict v1,
+    const fix16_vec3_t * __restrict const v0, fix16_vec3_t * __restrict const result)
+{
+        result->x = v1->x - v0->x;
+        result->y = v1->y - v0->y;
+        result->z = v1->z - v0->z;
+}
+
+static inline void __always_inline
+fix16_vec3_scale(const fix16_t scalar, fix16_vec3_t *result)
+{
+        result->x = fix16_mul(scalar, result->x);
+        result->y = fix16_mul(scalar, result->y);
+        result->z = fix16_mul(scalar, result->z);
+}
+
+static inline void __always_inline
+fix16_vec3_scaled(const fix16_t scalar, const fix16_vec3_t * __restrict v,
+    fix16_vec3_t * __restrict result)
+{
+        result->x = fix16_mul(scalar, v->x);
+        result->y = fix16_mul(scalar, v->y);
+        result->z = fix16_mul(scalar, v->z);
+}
+
+/* Three MAC.L, then XTRCT MACH, MACL. The MAC register wraps around */
+static inline fix16_t __always_inline
+fix16_vec3_inline_dot(const fix16_vec3_t *a, const fix16_vec3_t *b)
+{
+        uint64_t mac;
+
+        mac  = (uint64_t)((int64_t)a->x * b->x);
+        mac += (uint64_t)((int64_t)a->y * b->y);
+        mac += (uint64_t)((int64_t)a->z * b->z);
+
+        return (fix16_t)(uint32_t)(mac >> 16);
+}
+
+extern fix16_t fix16_sqrt(fix16_t value) FIXMATH_FUNC_ATTRS;
+
+extern uint32_t fix16_str(fix16_t value, char *buffer, int decimals);
+
+extern fix16_t fix16_sin(fix16_t radians) FIXMATH_FUNC_ATTRS;
+extern fix16_t fix16_cos(fix16_t radians) FIXMATH_FUNC_ATTRS;
+extern fix16_t fix16_tan(fix16_t radians) FIXMATH_FUNC_ATTRS;
+extern void fix16_sincos(fix16_t radians, fix16_t *result_sin, fix16_t *result_cos) FIXMATH_FUNC_NONCONST_ATTRS;
+extern fix16_t fix16_atan2(fix16_t y, fix16_t x) FIXMATH_FUNC_ATTRS;
+extern fix16_t fix16_bradians_sin(int32_t bradians) FIXMATH_FUNC_ATTRS;
+extern fix16_t fix16_bradians_cos(int32_t bradians) FIXMATH_FUNC_ATTRS;
+
+extern fix16_t fix16_vec3_length(const fix16_vec3_t *v0);
+extern fix16_t fix16_vec3_sqr_length(const fix16_vec3_t *v0);
+extern void fix16_vec3_normalize(fix16_vec3_t *v0);
+extern void fix16_vec3_normalized(const fix16_vec3_t * __restrict v0,
+    fix16_vec3_t * __restrict result);
+extern fix16_t fix16_vec3_dot(const fix16_vec3_t *v0, const fix16_vec3_t *v1);
+extern void fix16_vec3_cross(const fix16_vec3_t * const __restrict v0,
+    const fix16_vec3_t * const __restrict v1, fix16_vec3_t * __restrict result);
+extern fix16_t fix16_vec3_cross_mag(const fix16_vec3_t * __restrict v0,
+    const fix16_vec3_t * __restrict v1);
+extern uint32_t fix16_vec3_str(const fix16_vec3_t *v0, char *buffer, int decimals);
+
+#endif /* !_G3D_SCENE_TEST_HOST_FIX16_H_ */
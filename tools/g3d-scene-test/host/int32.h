@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what the libg3d sources expect from libyaul's <int32.h> */
+
+#ifndef _G3D_SCENE_TEST_HOST_INT32_H_
+#define _G3D_SCENE_TEST_HOST_INT32_H_
+
+#include <sys/cdefs.h>
+
+#include <stdint.h>
+
+typedef struct {
+        int32_t x;
+        int32_t y;
+} __aligned(4) int32_vec2_t;
+
+#endif /* !_G3D_SCENE_TEST_HOST_INT32_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* libyaul's <math.h> takes the place of the C library's */
+
+#ifndef _G3D_SCENE_TEST_HOST_MATH_H_
+#define _G3D_SCENE_TEST_HOST_MATH_H_
+
+#include_next <math.h>
+
+#include <sys/cdefs.h>
+
+#include <color.h>
+#include <fix16.h>
+#include <int16.h>
+#include <int32.h>
+
+#ifndef min
+#define min(a, b)                                                              \
+        __extension__ ({ __typeof__ (a) _a = (a);                              \
+           __typeof__ (b) _b = (b);                                            \
+           (_a < _b) ? _a : _b;                                                \
+        })
+#endif /* !min */
+
+#ifndef max
+#define max(a, b)                                                              \
+        __extension__ ({ __typeof__ (a) _a = (a);                              \
+           __typeof__ (b) _b = (b);                                            \
+           (_a > _b) ? _a : _b;                                                \
+        })
+#endif /* !max */
+
+#ifndef clamp
+#define clamp(x, y, z)                                                         \
+        __extension__ ({ __typeof__ (x) _x = (x);                              \
+           __typeof__ (y) _y = (y);                                            \
+           __typeof__ (z) _z = (z);                                            \
+           (_x <= _y) ? _y : ((_x >= _z) ? _z : _x);                           \
+        })
+#endif /* !clamp */
+
+#endif /* !_G3D_SCENE_TEST_HOST_MATH_H_ */
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what libg3d expects from libyaul's <vdp.h>. Transfers are counted,
+ * not made. See g3d_host.c */
+
+#ifndef _G3D_SCENE_TEST_HOST_VDP_H_
+#define _G3D_SCENE_TEST_HOST_VDP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vdp1.h>
+#include <vdp2.h>
+
+extern void vdp_dma_enqueue(void *dst, const void *src, size_t len);
+
+/* Transfers enqueued since the last call */
+extern uint32_t __host_vdp_dma_count_get(void);
+
+#endif /* !_G3D_SCENE_TEST_HOST_VDP_H_ */
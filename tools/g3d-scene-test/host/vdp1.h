@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what libg3d expects from libyaul's <vdp1.h>. Nothing is transferred
+ * to VDP1. The last orderlist put is kept instead. See g3d_host.c */
+
+#ifndef _G3D_SCENE_TEST_HOST_VDP1_H_
+#define _G3D_SCENE_TEST_HOST_VDP1_H_
+
+#include <sys/cdefs.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <color.h>
+
+#include <vdp1/cmdt.h>
+
+/* VDP1 VRAM isn't backed by memory. Addresses are only compared */
+#define VDP1_VRAM(x)    (0x25C00000UL + (x))
+
+#define VDP1_VRAM_SIZE  0x00080000UL /* In bytes */
+
+typedef void (*callback_handler_t)(void *work);
+
+typedef struct vdp1_gouraud_table {
+        rgb1555_t colors[4];
+} __aligned(8) vdp1_gouraud_table_t;
+
+typedef struct vdp1_clut {
+        rgb1555_t entries[16];
+} __aligned(32) vdp1_clut_t;
+
+typedef struct vdp1_vram_partitions {
+        vdp1_cmdt_t *cmdt_base;
+        uint32_t cmdt_size;
+
+        void *texture_base;
+        uint32_t texture_size;
+
+        vdp1_gouraud_table_t *gouraud_base;
+        uint32_t gouraud_size;
+
+        vdp1_clut_t *clut_base;
+        uint32_t clut_size;
+
+        void *remaining_base;
+        uint32_t remaining_size;
+} vdp1_vram_partitions_t;
+
+extern void vdp1_vram_partitions_get(vdp1_vram_partitions_t *vram_partitions);
+
+extern void vdp1_sync_cmdt_orderlist_put(const vdp1_cmdt_orderlist_t *cmdt_orderlist);
+extern void vdp1_sync_put_set(callback_handler_t callback_handler,
+    void *work);
+
+/* Orderlist last put, or NULL */
+extern const vdp1_cmdt_orderlist_t *__host_vdp1_orderlist_get(void);
+
+#endif /* !_G3D_SCENE_TEST_HOST_VDP1_H_ */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what libg3d expects from libyaul's <vdp1/cmdt.h>. Command tables are
+ * written to memory, for the scenes to compare */
+
+#ifndef _G3D_SCENE_TEST_HOST_VDP1_CMDT_H_
+#define _G3D_SCENE_TEST_HOST_VDP1_CMDT_H_
+
+#include <sys/cdefs.h>
+
+/* libyaul's <vdp1/cmdt.h> brings in static_assert() and bool */
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <color.h>
+#include <int16.h>
+
+#define VDP1_CMDT_PMOD_MSB_ENABLE               (1 << 15)
+#define VDP1_CMDT_PMOD_HSS_ENABLE               (1 << 12)
+#define VDP1_CMDT_PMOD_PRE_CLIPPING_DISABLE     (1 << 11)
+#define VDP1_CMDT_PMOD_MESH_ENABLE              (1 << 8)
+#define VDP1_CMDT_PMOD_END_CODE_DISABLE         (1 << 7)
+#define VDP1_CMDT_PMOD_TRANS_PIXEL_DISABLE      (1 << 6)
+
+/* On the target, the SCU-DMA indirect mode end bit is bit 31 of the source
+ * address. Command tables are 32-byte aligned, so the host keeps the bit in bit
+ * 0 of the pointer instead */
+#define VDP1_CMDT_ORDERLIST_END                 ((uintptr_t)0x00000001)
+
+typedef struct vdp1_cmdt {
+        uint16_t cmd_ctrl;
+        uint16_t cmd_link;
+        uint16_t cmd_pmod;
+        uint16_t cmd_colr;
+        uint16_t cmd_srca;
+        uint16_t cmd_size;
+        int16_t cmd_xa;
+        int16_t cmd_ya;
+        int16_t cmd_xb;
+        int16_t cmd_yb;
+        int16_t cmd_xc;
+        int16_t cmd_yc;
+        int16_t cmd_xd;
+        int16_t cmd_yd;
+        uint16_t cmd_grda;
+        uint16_t reserved;
+} __aligned(32) vdp1_cmdt_t;
+
+typedef struct {
+        unsigned int :32;
+        unsigned int :32;
+        vdp1_cmdt_t *cmdt;
+} __packed __aligned(4) vdp1_cmdt_orderlist_t;
+
+static inline void __always_inline
+vdp1_cmdt_orderlist_end(vdp1_cmdt_orderlist_t *cmdt_orderlist)
+{
+        cmdt_orderlist->cmdt =
+            (vdp1_cmdt_t *)((uintptr_t)cmdt_orderlist->cmdt | VDP1_CMDT_ORDERLIST_END);
+}
+
+static inline void __always_inline
+vdp1_cmdt_end_set(vdp1_cmdt_t *cmdt)
+{
+        cmdt->cmd_ctrl |= 0x8000;
+}
+
+#endif /* !_G3D_SCENE_TEST_HOST_VDP1_CMDT_H_ */
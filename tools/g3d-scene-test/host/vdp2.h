@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* Provides what libg3d expects from libyaul's <vdp2.h> */
+
+#ifndef _G3D_SCENE_TEST_HOST_VDP2_H_
+#define _G3D_SCENE_TEST_HOST_VDP2_H_
+
+#include <stdint.h>
+
+#include <vdp2/tvmd.h>
+
+typedef uint32_t vdp2_cram_t;
+
+#endif /* !_G3D_SCENE_TEST_HOST_VDP2_H_ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+/* The display resolution is 320x224. See g3d_host.c */
+
+#ifndef _G3D_SCENE_TEST_HOST_VDP2_TVMD_H_
+#define _G3D_SCENE_TEST_HOST_VDP2_TVMD_H_
+
+#include <stdint.h>
+
+extern void vdp2_tvmd_display_res_get(uint16_t *width, uint16_t *height);
+
+#endif /* !_G3D_SCENE_TEST_HOST_VDP2_TVMD_H_ */
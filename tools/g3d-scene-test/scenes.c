@@ -0,0 +1,900 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "scenes.h"
+
+/* Quads on each side of the floor grid, and the length of their sides */
+#define FLOOR_QUAD_COUNT        (8)
+#define FLOOR_QUAD_SIZE         (64.0f)
+
+#define FLOOR_POINT_COUNT       ((FLOOR_QUAD_COUNT + 1) * (FLOOR_QUAD_COUNT + 1))
+#define FLOOR_POLYGON_COUNT     (FLOOR_QUAD_COUNT * FLOOR_QUAD_COUNT)
+
+#define TCACHE_TEXTURE_COUNT    (4)
+/* Leaves room for three slots in the VDP1 texture partition */
+#define TCACHE_SLOT_SIZE        (0x20000)
+
+#define MESH_BUFFER_SIZE        (4096)
+
+#define ATTR_POLYGON(sort, color)                                              \
+        ATTRIBUTE(Single_Plane, sort, No_Texture, color, No_Gouraud,           \
+            CL32KRGB | MESHoff, sprPolygon, No_Option)
+
+#define ATTR_TEXTURE(sort, texno, dir)                                         \
+        ATTRIBUTE(Single_Plane, sort, texno, No_Palet, No_Gouraud,             \
+            CL32KRGB | MESHoff, dir, No_Option)
+
+vdp1_cmdt_t scene_baked_cmdts[SCENE_BAKED_CMDT_COUNT];
+
+static void _cube_setup(void);
+static void _cube_frame(uint32_t frame);
+static void _sort_frame(uint32_t frame);
+static void _clipping_setup(void);
+static void _clipping_frame(uint32_t frame);
+static void _culling_setup(void);
+static void _culling_frame(uint32_t frame);
+static void _fog_setup(void);
+static void _fog_frame(uint32_t frame);
+static void _baked_setup(void);
+static void _baked_frame(uint32_t frame);
+static void _mesh_setup(void);
+static void _mesh_frame(uint32_t frame);
+static void _occlusion_setup(void);
+static void _occlusion_frame(uint32_t frame);
+static void _lod_setup(void);
+static void _lod_frame(uint32_t frame);
+static void _lod_budget_setup(void);
+static void _lod_budget_frame(uint32_t frame);
+static void _quality_setup(void);
+static void _quality_frame(uint32_t frame);
+static void _tcache_setup(void);
+static void _tcache_frame(uint32_t frame);
+static void _debug_frame(uint32_t frame);
+
+static void _floor_build(void);
+static void _object_transform(const g3d_object_t *object, float x, float y,
+    float z, float ry, float rx);
+
+const scene_t scenes[] = {
+        {
+                .name = "cube",
+                .frame_count = 4,
+                .setup = _cube_setup,
+                .frame = _cube_frame
+        }, {
+                .name = "sort",
+                .frame_count = 2,
+                .frame = _sort_frame
+        }, {
+                .name = "clipping",
+                .flags = SCENE_FLAGS_SLAVE,
+                .frame_count = 3,
+                .setup = _clipping_setup,
+                .frame = _clipping_frame
+        }, {
+                .name = "culling",
+                .frame_count = 2,
+                .setup = _culling_setup,
+                .frame = _culling_frame
+        }, {
+                .name = "fog",
+                .frame_count = 2,
+                .setup = _fog_setup,
+                .frame = _fog_frame
+        }, {
+                .name = "baked",
+                .frame_count = 4,
+                .setup = _baked_setup,
+                .frame = _baked_frame
+        }, {
+                .name = "mesh",
+                .flags = SCENE_FLAGS_SLAVE,
+                .frame_count = 2,
+                .setup = _mesh_setup,
+                .frame = _mesh_frame
+        }, {
+                .name = "occlusion",
+                .frame_count = 2,
+                .setup = _occlusion_setup,
+                .frame = _occlusion_frame
+        }, {
+                .name = "lod",
+                .frame_count = 8,
+                .setup = _lod_setup,
+                .frame = _lod_frame
+        }, {
+                .name = "lod-budget",
+                .frame_count = 6,
+                .frame_ticks = 1500,
+                .setup = _lod_budget_setup,
+                .frame = _lod_budget_frame
+        }, {
+                .name = "quality",
+                .flags = SCENE_FLAGS_QUALITY,
+                .frame_count = 16,
+                .frame_ticks = 1600,
+                .setup = _quality_setup,
+                .frame = _quality_frame
+        }, {
+                .name = "tcache",
+                .flags = SCENE_FLAGS_TCACHE,
+                .frame_count = 4,
+                .setup = _tcache_setup,
+                .frame = _tcache_frame
+        }, {
+                .name = "debug",
+                .frame_count = 1,
+                .setup = _cube_setup,
+                .frame = _debug_frame
+        }
+};
+
+const uint32_t scene_count = sizeof(scenes) / sizeof(*scenes);
+
+static POINT _cube_points[] = {
+        POStoFIXED(-16.0f, -16.0f, -16.0f),
+        POStoFIXED( 16.0f, -16.0f, -16.0f),
+        POStoFIXED( 16.0f,  16.0f, -16.0f),
+        POStoFIXED(-16.0f,  16.0f, -16.0f),
+        POStoFIXED(-16.0f, -16.0f,  16.0f),
+        POStoFIXED( 16.0f, -16.0f,  16.0f),
+        POStoFIXED( 16.0f,  16.0f,  16.0f),
+        POStoFIXED(-16.0f,  16.0f,  16.0f)
+};
+
+static POLYGON _cube_polygons[] = {
+        NORMAL( 0.0f,  0.0f, -1.0f), VERTICES(0, 1, 2, 3),
+        NORMAL( 0.0f,  0.0f,  1.0f), VERTICES(5, 4, 7, 6),
+        NORMAL(-1.0f,  0.0f,  0.0f), VERTICES(4, 0, 3, 7),
+        NORMAL( 1.0f,  0.0f,  0.0f), VERTICES(1, 5, 6, 2),
+        NORMAL( 0.0f, -1.0f,  0.0f), VERTICES(4, 5, 1, 0),
+        NORMAL( 0.0f,  1.0f,  0.0f), VERTICES(3, 2, 6, 7)
+};
+
+static ATTR _cube_attributes[] = {
+        ATTR_TEXTURE(SORT_CEN, 0, sprNoflip),
+        ATTR_POLYGON(SORT_CEN, C_RGB(31,  0,  0)),
+        ATTR_TEXTURE(SORT_CEN, 1, sprHflip),
+        ATTR_POLYGON(SORT_CEN, C_RGB( 0, 31,  0)),
+        ATTR_TEXTURE(SORT_MAX, 1, sprVflip),
+        ATTR_POLYGON(SORT_MIN, C_RGB( 0,  0, 31))
+};
+
+/* A single quad facing the camera */
+static POINT _quad_points[] = {
+        POStoFIXED(-16.0f, -16.0f, 0.0f),
+        POStoFIXED( 16.0f, -16.0f, 0.0f),
+        POStoFIXED( 16.0f,  16.0f, 0.0f),
+        POStoFIXED(-16.0f,  16.0f, 0.0f)
+};
+
+static POLYGON _quad_polygons[] = {
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES(0, 1, 2, 3)
+};
+
+static ATTR _quad_attributes[] = {
+        ATTR_POLYGON(SORT_CEN, C_RGB(31, 31, 0))
+};
+
+/* Quads leaning away from the camera by different amounts, so that which one
+ * is drawn first depends on how each is sorted. The first and fifth quads
+ * are sorted on the same Z value */
+static POINT _sort_points[] = {
+        POStoFIXED(-60.0f, -20.0f, 100.0f),
+        POStoFIXED(-20.0f, -20.0f, 100.0f),
+        POStoFIXED(-20.0f,  20.0f, 100.0f),
+        POStoFIXED(-60.0f,  20.0f, 100.0f),
+
+        POStoFIXED(-40.0f, -20.0f,  60.0f),
+        POStoFIXED(  0.0f, -20.0f,  60.0f),
+        POStoFIXED(  0.0f,  20.0f, 160.0f),
+        POStoFIXED(-40.0f,  20.0f, 160.0f),
+
+        POStoFIXED(-20.0f, -20.0f,  60.0f),
+        POStoFIXED( 20.0f, -20.0f,  60.0f),
+        POStoFIXED( 20.0f,  20.0f, 160.0f),
+        POStoFIXED(-20.0f,  20.0f, 160.0f),
+
+        POStoFIXED(  0.0f, -20.0f,  60.0f),
+        POStoFIXED( 40.0f, -20.0f,  60.0f),
+        POStoFIXED( 40.0f,  20.0f, 160.0f),
+        POStoFIXED(  0.0f,  20.0f, 160.0f),
+
+        POStoFIXED( 20.0f, -20.0f, 100.0f),
+        POStoFIXED( 60.0f, -20.0f, 100.0f),
+        POStoFIXED( 60.0f,  20.0f, 100.0f),
+        POStoFIXED( 20.0f,  20.0f, 100.0f),
+
+        POStoFIXED( 40.0f, -20.0f, 140.0f),
+        POStoFIXED( 80.0f, -20.0f, 140.0f),
+        POStoFIXED( 80.0f,  20.0f,  80.0f),
+        POStoFIXED( 40.0f,  20.0f,  80.0f)
+};
+
+static POLYGON _sort_polygons[] = {
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES( 0,  1,  2,  3),
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES( 4,  5,  6,  7),
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES( 8,  9, 10, 11),
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES(12, 13, 14, 15),
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES(16, 17, 18, 19),
+        NORMAL(0.0f, 0.0f, -1.0f), VERTICES(20, 21, 22, 23)
+};
+
+static ATTR _sort_attributes[] = {
+        ATTR_POLYGON(SORT_CEN, C_RGB( 1,  0,  0)),
+        ATTR_POLYGON(SORT_MIN, C_RGB( 2,  0,  0)),
+        ATTR_POLYGON(SORT_MAX, C_RGB( 3,  0,  0)),
+        ATTR_POLYGON(SORT_CEN, C_RGB( 4,  0,  0)),
+        ATTR_POLYGON(SORT_CEN, C_RGB( 5,  0,  0)),
+        ATTR_POLYGON(SORT_MIN, C_RGB( 6,  0,  0))
+};
+
+static POINT _floor_points[FLOOR_POINT_COUNT];
+static POLYGON _floor_polygons[FLOOR_POLYGON_COUNT];
+static ATTR _floor_attributes[FLOOR_POLYGON_COUNT];
+
+static XPDATA _cube_xpdata = {
+        .pntbl     = _cube_points,
+        .nbPoint   = sizeof(_cube_points) / sizeof(*_cube_points),
+        .pltbl     = _cube_polygons,
+        .nbPolygon = sizeof(_cube_polygons) / sizeof(*_cube_polygons),
+        .attbl     = _cube_attributes,
+        .vntbl     = NULL
+};
+
+static XPDATA _quad_xpdata = {
+        .pntbl     = _quad_points,
+        .nbPoint   = sizeof(_quad_points) / sizeof(*_quad_points),
+        .pltbl     = _quad_polygons,
+        .nbPolygon = sizeof(_quad_polygons) / sizeof(*_quad_polygons),
+        .attbl     = _quad_attributes,
+        .vntbl     = NULL
+};
+
+static XPDATA _sort_xpdata = {
+        .pntbl     = _sort_points,
+        .nbPoint   = sizeof(_sort_points) / sizeof(*_sort_points),
+        .pltbl     = _sort_polygons,
+        .nbPolygon = sizeof(_sort_polygons) / sizeof(*_sort_polygons),
+        .attbl     = _sort_attributes,
+        .vntbl     = NULL
+};
+
+static XPDATA _floor_xpdata = {
+        .pntbl     = _floor_points,
+        .nbPoint   = FLOOR_POINT_COUNT,
+        .pltbl     = _floor_polygons,
+        .nbPolygon = FLOOR_POLYGON_COUNT,
+        .attbl     = _floor_attributes,
+        .vntbl     = NULL
+};
+
+/* From the finest level to the coarsest */
+static XPDATA _lod_xpdatas[] = {
+        {
+                .pntbl     = _cube_points,
+                .nbPoint   = sizeof(_cube_points) / sizeof(*_cube_points),
+                .pltbl     = _cube_polygons,
+                .nbPolygon = sizeof(_cube_polygons) / sizeof(*_cube_polygons),
+                .attbl     = _cube_attributes,
+                .vntbl     = NULL
+        }, {
+                /* Only the front and back of the cube */
+                .pntbl     = _cube_points,
+                .nbPoint   = sizeof(_cube_points) / sizeof(*_cube_points),
+                .pltbl     = _cube_polygons,
+                .nbPolygon = 2,
+                .attbl     = _cube_attributes,
+                .vntbl     = NULL
+        }, {
+                .pntbl     = _quad_points,
+                .nbPoint   = sizeof(_quad_points) / sizeof(*_quad_points),
+                .pltbl     = _quad_polygons,
+                .nbPolygon = sizeof(_quad_polygons) / sizeof(*_quad_polygons),
+                .attbl     = _quad_attributes,
+                .vntbl     = NULL
+        }
+};
+
+static const FIXED _lod_distances[] = {
+        toFIXED(200.0f),
+        toFIXED(400.0f)
+};
+
+static g3d_lod_t _lods[2];
+
+static TEXTURE _textures[] = {
+        TEXTBL(16, 16, 0x10000),
+        TEXTBL(32,  8, 0x10200)
+};
+
+static g3d_cull_sphere_t _cube_sphere = {
+        .origin = POStoFIXED(0.0f, 0.0f, 0.0f),
+        .radius = toFIXED(28.0f)
+};
+
+static g3d_cull_aabb_t _cube_aabb = {
+        .origin = POStoFIXED(0.0f, 0.0f, 0.0f),
+        .length = POStoFIXED(16.0f, 16.0f, 16.0f)
+};
+
+static const rgb1555_t _fog_colors[] = {
+        RGB1555(1,  0,  0,  0),
+        RGB1555(1,  4,  4,  4),
+        RGB1555(1,  8,  8,  8),
+        RGB1555(1, 12, 12, 12),
+        RGB1555(1, 16, 16, 16),
+        RGB1555(1, 20, 20, 20),
+        RGB1555(1, 24, 24, 24),
+        RGB1555(1, 28, 28, 28)
+};
+
+static const uint8_t _fog_z[] = {
+        0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7
+};
+
+static const g3d_fog_t _fog = {
+        .depth_colors       = _fog_colors,
+        .depth_z            = _fog_z,
+        .depth_count        = sizeof(_fog_z) / sizeof(*_fog_z),
+        .step               = toFIXED(1 / 32.0f),
+        .start_z            = toFIXED(150.0f),
+        .end_z              = toFIXED(500.0f),
+        .near_ambient_color = RGB1555_INITIALIZER(1, 31,  0, 31),
+        .far_ambient_color  = RGB1555_INITIALIZER(1, 31, 31, 31)
+};
+
+static TEXTURE _tcache_textures[TCACHE_TEXTURE_COUNT];
+
+static const uint16_t _tcache_texture_data[TCACHE_TEXTURE_COUNT][8 * 8];
+
+static const g3d_texture_source_t _tcache_sources[TCACHE_TEXTURE_COUNT] = {
+        { _tcache_texture_data[0], sizeof(_tcache_texture_data[0]) },
+        { _tcache_texture_data[1], sizeof(_tcache_texture_data[1]) },
+        { _tcache_texture_data[2], sizeof(_tcache_texture_data[2]) },
+        { _tcache_texture_data[3], sizeof(_tcache_texture_data[3]) }
+};
+
+/* One quad for each texture */
+static ATTR _tcache_attributes[TCACHE_TEXTURE_COUNT][1] = {
+        { ATTR_TEXTURE(SORT_CEN, 0, sprNoflip) },
+        { ATTR_TEXTURE(SORT_CEN, 1, sprNoflip) },
+        { ATTR_TEXTURE(SORT_CEN, 2, sprNoflip) },
+        { ATTR_TEXTURE(SORT_CEN, 3, sprNoflip) }
+};
+
+static XPDATA _tcache_xpdatas[TCACHE_TEXTURE_COUNT];
+
+static uint8_t _mesh_buffers[2][MESH_BUFFER_SIZE] __aligned(4);
+static uint16_t _mesh_work[MESH_BUFFER_SIZE / sizeof(uint16_t)];
+
+static void
+_cube_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+}
+
+/* A cube spinning in front of the camera, with its back faces culled, next to
+ * one that isn't culled */
+static void
+_cube_frame(uint32_t frame)
+{
+        const g3d_object_t culled_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1
+        };
+
+        const g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1
+        };
+
+        _object_transform(&culled_cube, 0.0f, 0.0f, 96.0f, 30.0f + (35.0f * frame),
+            15.0f + (20.0f * frame));
+        _object_transform(&cube, -48.0f, 24.0f, 160.0f, 10.0f * frame, 0.0f);
+}
+
+/* The second frame looks at the quads from the side */
+static void
+_sort_frame(uint32_t frame)
+{
+        const g3d_object_t quads = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = &_sort_xpdata,
+                .xpdata_count = 1
+        };
+
+        _object_transform(&quads, 0.0f, 0.0f, 80.0f, 40.0f * frame, 0.0f);
+}
+
+static void
+_clipping_setup(void)
+{
+        _floor_build();
+}
+
+/* The floor runs from behind the camera to well past the sides of the screen,
+ * so its polygons cross the near plane and the sides of the screen, or are
+ * entirely off screen */
+static void
+_clipping_frame(uint32_t frame)
+{
+        const g3d_object_t floor = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = &_floor_xpdata,
+                .xpdata_count = 1
+        };
+
+        _object_transform(&floor, 0.0f, 48.0f, 200.0f - (60.0f * frame),
+            30.0f * frame, 0.0f);
+}
+
+static void
+_culling_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+}
+
+/* Cubes in front, to the side of, behind, and past the far plane of the
+ * camera. The camera moves to the left on the second frame */
+static void
+_culling_frame(uint32_t frame)
+{
+        static const float positions[][3] = {
+                {    0.0f, 0.0f,  200.0f },
+                { -220.0f, 0.0f,  200.0f },
+                { -600.0f, 0.0f,  200.0f },
+                {    0.0f, 0.0f, -100.0f },
+                {    0.0f, 0.0f, 1200.0f }
+        };
+
+        const g3d_object_t sphere_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SPHERE,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1,
+                .cull_shape = &_cube_sphere
+        };
+
+        const g3d_object_t aabb_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_AABB,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1,
+                .cull_shape = &_cube_aabb
+        };
+
+        const POINT camera = POStoFIXED(-200.0f * frame, 0.0f, 0.0f);
+        const VECTOR rx = POStoFIXED(1.0f, 0.0f, 0.0f);
+        const VECTOR ry = POStoFIXED(0.0f, 1.0f, 0.0f);
+        const VECTOR rz = POStoFIXED(0.0f, 0.0f, 1.0f);
+
+        g3d_frustum_camera_set(camera, rx, ry, rz);
+
+        for (uint32_t i = 0; i < (sizeof(positions) / sizeof(*positions)); i++) {
+                const float * const position = positions[i];
+
+                _object_transform(&sphere_cube, position[0], position[1] - 20.0f,
+                    position[2], 0.0f, 0.0f);
+                _object_transform(&aabb_cube, position[0], position[1] + 20.0f,
+                    position[2], 0.0f, 0.0f);
+        }
+}
+
+static void
+_fog_setup(void)
+{
+        g3d_fog_set(&_fog);
+}
+
+/* Quads from the near ambient color to the far ambient color. The fog is
+ * pulled in on the second frame */
+static void
+_fog_frame(uint32_t frame)
+{
+        static const float depths[] = {
+                100.0f, 200.0f, 300.0f, 400.0f, 550.0f, 700.0f
+        };
+
+        const g3d_object_t quad = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = &_quad_xpdata,
+                .xpdata_count = 1
+        };
+
+        const g3d_object_t excluded_quad = {
+                .flags = G3D_OBJECT_FLAGS_FOG_EXCLUDE,
+                .xpdatas = &_quad_xpdata,
+                .xpdata_count = 1
+        };
+
+        if (frame == 1) {
+                g3d_fog_limits_set(toFIXED(250.0f), toFIXED(450.0f));
+        }
+
+        for (uint32_t i = 0; i < (sizeof(depths) / sizeof(*depths)); i++) {
+                _object_transform(&quad, -100.0f + (40.0f * i), 0.0f, depths[i],
+                    0.0f, 0.0f);
+        }
+
+        _object_transform(&excluded_quad, 0.0f, 40.0f, 300.0f, 0.0f, 0.0f);
+}
+
+static void
+_baked_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+
+        _lods[0].distances = _lod_distances;
+        _lods[0].level = 0;
+}
+
+/* A baked cube that picks up fog and pre-clipping on the second frame, and
+ * loses them on the third. On the last frame, it's far enough to be drawn at
+ * its second level */
+static void
+_baked_frame(uint32_t frame)
+{
+        static g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = &_lod_xpdatas[0],
+                .xpdata_count = 2,
+                .lod = &_lods[0]
+        };
+
+        if (frame == 0) {
+                assert((g3d_object_bake_count_get(&cube)) <= SCENE_BAKED_CMDT_COUNT);
+
+                g3d_object_bake(&cube, scene_baked_cmdts);
+        }
+
+        if (frame == 1) {
+                g3d_fog_set(&_fog);
+        } else {
+                g3d_fog_set(NULL);
+        }
+
+        const float x = (frame == 1) ? 170.0f : 0.0f;
+        const float z = (frame == 3) ? 300.0f : 150.0f;
+
+        _object_transform(&cube, x, 0.0f, z, 45.0f, 30.0f);
+}
+
+static void
+_mesh_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+
+        _floor_build();
+
+        const XPDATA * const xpdatas[] = {
+                &_cube_xpdata,
+                &_floor_xpdata
+        };
+
+        for (uint32_t i = 0; i < 2; i++) {
+                assert((sizeof(g3d_mesh_t) + g3d_mesh_size_get(xpdatas[i])) <= MESH_BUFFER_SIZE);
+                assert((g3d_mesh_work_size_get(xpdatas[i])) <= sizeof(_mesh_work));
+
+                g3d_mesh_t * const mesh = (g3d_mesh_t *)_mesh_buffers[i];
+
+                g3d_mesh_build(mesh, xpdatas[i], &mesh[1], _mesh_work);
+        }
+}
+
+/* The cube and floor of the other scenes, as meshes */
+static void
+_mesh_frame(uint32_t frame)
+{
+        const g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_MESH | G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = _mesh_buffers[0],
+                .xpdata_count = 1
+        };
+
+        const g3d_object_t floor = {
+                .flags = G3D_OBJECT_FLAGS_MESH,
+                .xpdatas = _mesh_buffers[1],
+                .xpdata_count = 1
+        };
+
+        _object_transform(&floor, 0.0f, 48.0f, 200.0f - (60.0f * frame),
+            30.0f * frame, 0.0f);
+        _object_transform(&cube, 0.0f, 0.0f, 96.0f, 30.0f + (35.0f * frame),
+            15.0f + (20.0f * frame));
+}
+
+static void
+_occlusion_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+
+        g3d_occlusion_enable();
+}
+
+/* A wall hides the cubes behind it, but not the ones beside or in front of it,
+ * or the one without a shape to test. The wall moves aside on the second
+ * frame */
+static void
+_occlusion_frame(uint32_t frame)
+{
+        static POINT wall_points[] = {
+                POStoFIXED(-96.0f, -64.0f, 0.0f),
+                POStoFIXED( 96.0f, -64.0f, 0.0f),
+                POStoFIXED( 96.0f,  64.0f, 0.0f),
+                POStoFIXED(-96.0f,  64.0f, 0.0f)
+        };
+
+        static XPDATA wall_xpdata = {
+                .pntbl     = wall_points,
+                .nbPoint   = sizeof(wall_points) / sizeof(*wall_points),
+                .pltbl     = _quad_polygons,
+                .nbPolygon = 1,
+                .attbl     = _quad_attributes,
+                .vntbl     = NULL
+        };
+
+        const g3d_object_t wall = {
+                .flags = G3D_OBJECT_FLAGS_OCCLUDER,
+                .xpdatas = &wall_xpdata,
+                .xpdata_count = 1
+        };
+
+        const g3d_object_t sphere_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SPHERE,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1,
+                .cull_shape = &_cube_sphere
+        };
+
+        const g3d_object_t aabb_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_AABB,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1,
+                .cull_shape = &_cube_aabb
+        };
+
+        const g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1
+        };
+
+        _object_transform(&wall, (frame == 1) ? -250.0f : 0.0f, 0.0f, 150.0f,
+            0.0f, 0.0f);
+
+        _object_transform(&sphere_cube, -20.0f, 0.0f, 300.0f, 0.0f, 0.0f);
+        _object_transform(&aabb_cube, 20.0f, 0.0f, 400.0f, 0.0f, 0.0f);
+        _object_transform(&sphere_cube, 200.0f, 0.0f, 300.0f, 0.0f, 0.0f);
+        _object_transform(&sphere_cube, 0.0f, 0.0f, 100.0f, 0.0f, 0.0f);
+        _object_transform(&cube, 0.0f, 0.0f, 350.0f, 0.0f, 0.0f);
+}
+
+static void
+_lod_setup(void)
+{
+        g3d_tlist_set(_textures, sizeof(_textures) / sizeof(*_textures));
+
+        for (uint32_t i = 0; i < 2; i++) {
+                _lods[i].distances = _lod_distances;
+                _lods[i].level = 0;
+        }
+}
+
+/* Two cubes move away from the camera and back, across the distances of their
+ * levels and the hysteresis around them. Only the second has a sphere to cull
+ * with, which the distance is then taken from */
+static void
+_lod_frame(uint32_t frame)
+{
+        static const float depths[] = {
+                150.0f, 210.0f, 230.0f, 195.0f, 180.0f, 450.0f, 600.0f, 150.0f
+        };
+
+        const g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = _lod_xpdatas,
+                .xpdata_count = sizeof(_lod_xpdatas) / sizeof(*_lod_xpdatas),
+                .lod = &_lods[0]
+        };
+
+        const g3d_object_t sphere_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SPHERE,
+                .xpdatas = _lod_xpdatas,
+                .xpdata_count = sizeof(_lod_xpdatas) / sizeof(*_lod_xpdatas),
+                .cull_shape = &_cube_sphere,
+                .lod = &_lods[1]
+        };
+
+        _object_transform(&cube, -40.0f, 0.0f, depths[frame], 0.0f, 0.0f);
+        _object_transform(&sphere_cube, 40.0f, 0.0f, depths[frame], 0.0f, 0.0f);
+}
+
+static void
+_lod_budget_setup(void)
+{
+        _lod_setup();
+
+        g3d_lod_budget_set(1000);
+}
+
+/* Every frame is over budget, so the bias pushes the cube to its next level
+ * without it moving */
+static void
+_lod_budget_frame(uint32_t frame __unused)
+{
+        const g3d_object_t cube = {
+                .flags = G3D_OBJECT_FLAGS_NONE,
+                .xpdatas = _lod_xpdatas,
+                .xpdata_count = sizeof(_lod_xpdatas) / sizeof(*_lod_xpdatas),
+                .lod = &_lods[0]
+        };
+
+        _object_transform(&cube, 0.0f, 0.0f, 190.0f, 0.0f, 0.0f);
+}
+
+static void
+_quality_setup(void)
+{
+        static const g3d_quality_t quality = {
+                .target_ticks = 1000,
+                .far_min = toFIXED(512.0f),
+                .far_max = toFIXED(1024.0f),
+                .display_level_min = 1
+        };
+
+        g3d_display_level_set(2);
+        g3d_fog_set(&_fog);
+        g3d_fog_limits_set(toFIXED(300.0f), toFIXED(1000.0f));
+        g3d_quality_set(&quality);
+}
+
+/* Every frame is over target, so the far plane is brought in until it reaches
+ * its minimum, then the display level is lowered. Cubes are culled as the far
+ * plane passes them, and the fog is pulled in along with it */
+static void
+_quality_frame(uint32_t frame __unused)
+{
+        const g3d_object_t sphere_cube = {
+                .flags = G3D_OBJECT_FLAGS_CULL_SPHERE | G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1,
+                .cull_shape = &_cube_sphere
+        };
+
+        for (uint32_t i = 0; i < 4; i++) {
+                _object_transform(&sphere_cube, -90.0f + (60.0f * i), 0.0f,
+                    300.0f + (200.0f * i), 0.0f, 0.0f);
+        }
+}
+
+static void
+_tcache_setup(void)
+{
+        for (uint32_t i = 0; i < TCACHE_TEXTURE_COUNT; i++) {
+                _tcache_textures[i] = (TEXTURE)TEXTBL(8, 8, 0x0000);
+
+                _tcache_xpdatas[i] = _quad_xpdata;
+                _tcache_xpdatas[i].attbl = _tcache_attributes[i];
+        }
+
+        g3d_tlist_set(_tcache_textures, TCACHE_TEXTURE_COUNT);
+        g3d_tcache_set(_tcache_sources, TCACHE_SLOT_SIZE);
+}
+
+/* Four textures share three slots. All four are used on the second frame, so
+ * one of them doesn't fit, and its polygon is left out. The least recently
+ * used textures are evicted on the frames after */
+static void
+_tcache_frame(uint32_t frame)
+{
+        static const uint8_t frame_textures[][TCACHE_TEXTURE_COUNT] = {
+                { 1, 1, 0, 0 },
+                { 1, 1, 1, 1 },
+                { 0, 0, 0, 1 },
+                { 1, 0, 0, 0 }
+        };
+
+        for (uint32_t i = 0; i < TCACHE_TEXTURE_COUNT; i++) {
+                if (frame_textures[frame][i] == 0) {
+                        continue;
+                }
+
+                const g3d_object_t quad = {
+                        .flags = G3D_OBJECT_FLAGS_NONE,
+                        .xpdatas = &_tcache_xpdatas[i],
+                        .xpdata_count = 1
+                };
+
+                _object_transform(&quad, -60.0f + (40.0f * i), 0.0f, 150.0f,
+                    0.0f, 0.0f);
+        }
+}
+
+/* Cubes drawn for debugging, whose attributes are ignored */
+static void
+_debug_frame(uint32_t frame __unused)
+{
+        const g3d_object_t wireframe_cube = {
+                .flags = G3D_OBJECT_FLAGS_WIREFRAME | G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1
+        };
+
+        const g3d_object_t non_textured_cube = {
+                .flags = G3D_OBJECT_FLAGS_NON_TEXTURED | G3D_OBJECT_FLAGS_CULL_SCREEN,
+                .xpdatas = &_cube_xpdata,
+                .xpdata_count = 1
+        };
+
+        _object_transform(&wireframe_cube, -40.0f, 0.0f, 120.0f, 30.0f, 15.0f);
+        _object_transform(&non_textured_cube, 40.0f, 0.0f, 120.0f, 30.0f, 15.0f);
+}
+
+/* A checkerboard of quads on the XZ plane, centered on the origin */
+static void
+_floor_build(void)
+{
+        const uint32_t point_columns = FLOOR_QUAD_COUNT + 1;
+        const float origin = -(FLOOR_QUAD_COUNT * FLOOR_QUAD_SIZE) / 2.0f;
+
+        for (uint32_t z = 0; z < point_columns; z++) {
+                for (uint32_t x = 0; x < point_columns; x++) {
+                        FIXED * const point = _floor_points[(z * point_columns) + x];
+
+                        point[X] = toFIXED(origin + (x * FLOOR_QUAD_SIZE));
+                        point[Y] = toFIXED(0.0f);
+                        point[Z] = toFIXED(origin + (z * FLOOR_QUAD_SIZE));
+                }
+        }
+
+        for (uint32_t z = 0; z < FLOOR_QUAD_COUNT; z++) {
+                for (uint32_t x = 0; x < FLOOR_QUAD_COUNT; x++) {
+                        const uint32_t i = (z * FLOOR_QUAD_COUNT) + x;
+                        const uint16_t vertex = (z * point_columns) + x;
+
+                        POLYGON * const polygon = &_floor_polygons[i];
+
+                        polygon->norm[X] = toFIXED(0.0f);
+                        polygon->norm[Y] = toFIXED(-1.0f);
+                        polygon->norm[Z] = toFIXED(0.0f);
+
+                        polygon->Vertices[0] = vertex;
+                        polygon->Vertices[1] = vertex + 1;
+                        polygon->Vertices[2] = vertex + point_columns + 1;
+                        polygon->Vertices[3] = vertex + point_columns;
+
+                        if (((x + z) & 1) == 0) {
+                                _floor_attributes[i] = (ATTR)ATTR_POLYGON(SORT_MAX,
+                                    C_RGB(31, 31, 31));
+                        } else {
+                                _floor_attributes[i] = (ATTR)ATTR_POLYGON(SORT_MAX,
+                                    C_RGB(8, 8, 8));
+                        }
+                }
+        }
+}
+
+/* Transform the object at (x, y, z), turned by ry degrees around the Y axis,
+ * then by rx degrees around the X axis */
+static void
+_object_transform(const g3d_object_t *object, float x, float y, float z,
+    float ry, float rx)
+{
+        g3d_matrix_push(G3D_MATRIX_TYPE_PUSH); {
+                g3d_matrix_trans(toFIXED(x), toFIXED(y), toFIXED(z));
+                g3d_matrix_rot_y(DEGtoANG(ry));
+                g3d_matrix_rot_x(DEGtoANG(rx));
+
+                g3d_object_transform(object, 0);
+        } g3d_matrix_pop();
+}
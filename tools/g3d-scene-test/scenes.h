@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2012-2022 Israel Jacquez
+ * See LICENSE for details.
+ *
+ * Israel Jacquez <mrkotfw@gmail.com>
+ */
+
+#ifndef _G3D_SCENE_TEST_SCENES_H_
+#define _G3D_SCENE_TEST_SCENES_H_
+
+#include <stdint.h>
+
+#include "g3d.h"
+
+/* Display level each scene starts with */
+#define SCENE_DISPLAY_LEVEL     (2)
+
+/* Most command tables objects can be baked into */
+#define SCENE_BAKED_CMDT_COUNT  (64)
+
+typedef enum {
+        SCENE_FLAGS_NONE    = 0,
+        /* The scene is run a second time with the slave CPU enabled, and has
+         * to draw the same */
+        SCENE_FLAGS_SLAVE   = 1 << 0,
+        /* Record the status of the quality controller */
+        SCENE_FLAGS_QUALITY = 1 << 1,
+        /* Record the statistics of the texture cache */
+        SCENE_FLAGS_TCACHE  = 1 << 2
+} scene_flags_t;
+
+typedef struct {
+        const char *name;
+        scene_flags_t flags;
+        uint32_t frame_count;
+        /* FRT ticks each frame takes up to g3d_finish(). Drives the level of
+         * detail budget and the quality controller */
+        uint16_t frame_ticks;
+        /* Called once libg3d is back to how g3d_init() left it */
+        void (*setup)(void);
+        /* Transforms the objects of the frame, between g3d_start() and
+         * g3d_finish() */
+        void (*frame)(uint32_t frame);
+} scene_t;
+
+extern const scene_t scenes[];
+extern const uint32_t scene_count;
+
+/* Shared by every scene that bakes its objects */
+extern vdp1_cmdt_t scene_baked_cmdts[SCENE_BAKED_CMDT_COUNT];
+
+#endif /* !_G3D_SCENE_TEST_SCENES_H_ */